@@ -0,0 +1,290 @@
+// EtcDecoder.cpp
+// Follows the ETC2 and EAC block formats in appendix C of the OpenGL ES
+// 3.0 specification. Blocks are big endian; pixel i of a block's index
+// bits is the one at x = i / 4, y = i % 4.
+
+#include "EtcDecoder.h"
+
+static const int s_etc1Modifiers[8][4] = {
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 },
+};
+
+static const int s_etc2Distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int s_eacModifiers[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+static inline int clamp255(int v) { return (v < 0) ? 0 : ((v > 255) ? 255 : v); }
+static inline int extend4(int v) { return (v << 4) | v; }
+static inline int extend5(int v) { return (v << 3) | (v >> 2); }
+static inline int extend6(int v) { return (v << 2) | (v >> 4); }
+static inline int extend7(int v) { return (v << 1) | (v >> 6); }
+static inline int signExtend3(int v) { return (v & 4) ? (v - 8) : v; }
+
+// Fill pRgba from four "paint" colors chosen by each pixel's 2-bit index.
+static void paintBlock(const int paint[4][3], unsigned int indexBits, unsigned char* pRgba)
+{
+    for (int i=0; i<16; ++i)
+    {
+        const int index = ((indexBits >> (15 + i)) & 2) | ((indexBits >> i) & 1);
+        unsigned char* p = pRgba + 4 * ((i & 3) * 4 + (i >> 2));
+        p[0] = static_cast<unsigned char>(paint[index][0]);
+        p[1] = static_cast<unsigned char>(paint[index][1]);
+        p[2] = static_cast<unsigned char>(paint[index][2]);
+        p[3] = 255;
+    }
+}
+
+///@brief Decode one 8-byte ETC2 RGB block (ETC1 blocks included), alpha 255.
+void DecodeEtc2RgbBlock(const unsigned char* b, unsigned char* pRgba)
+{
+    const unsigned int indexBits =
+        (static_cast<unsigned int>(b[4]) << 24) | (b[5] << 16) | (b[6] << 8) | b[7];
+    int base[2][3];
+
+    if ((b[3] & 2) == 0)
+    {
+        // Individual: two 4-bit colors
+        for (int c=0; c<3; ++c)
+        {
+            base[0][c] = extend4(b[c] >> 4);
+            base[1][c] = extend4(b[c] & 15);
+        }
+    }
+    else
+    {
+        // Differential: a 5-bit color and a 3-bit signed delta. Deltas
+        // leaving the 5-bit range select the ETC2 modes.
+        const int r = b[0] >> 3, dr = signExtend3(b[0] & 7);
+        const int g = b[1] >> 3, dg = signExtend3(b[1] & 7);
+        const int bl = b[2] >> 3, db = signExtend3(b[2] & 7);
+
+        if ((r + dr < 0) || (r + dr > 31))
+        {
+            // T mode
+            const int c1[3] = {
+                extend4(((b[0] >> 1) & 12) | (b[0] & 3)),
+                extend4(b[1] >> 4),
+                extend4(b[1] & 15) };
+            const int c2[3] = { extend4(b[2] >> 4), extend4(b[2] & 15), extend4(b[3] >> 4) };
+            const int d = s_etc2Distances[((b[3] >> 1) & 6) | (b[3] & 1)];
+            int paint[4][3];
+            for (int c=0; c<3; ++c)
+            {
+                paint[0][c] = c1[c];
+                paint[1][c] = clamp255(c2[c] + d);
+                paint[2][c] = c2[c];
+                paint[3][c] = clamp255(c2[c] - d);
+            }
+            paintBlock(paint, indexBits, pRgba);
+            return;
+        }
+        if ((g + dg < 0) || (g + dg > 31))
+        {
+            // H mode
+            const int c1[3] = {
+                extend4((b[0] >> 3) & 15),
+                extend4(((b[0] & 7) << 1) | ((b[1] >> 4) & 1)),
+                extend4((b[1] & 8) | ((b[1] & 3) << 1) | (b[2] >> 7)) };
+            const int c2[3] = {
+                extend4((b[2] >> 3) & 15),
+                extend4(((b[2] & 7) << 1) | (b[3] >> 7)),
+                extend4((b[3] >> 3) & 15) };
+            const int v1 = (c1[0] << 16) | (c1[1] << 8) | c1[2];
+            const int v2 = (c2[0] << 16) | (c2[1] << 8) | c2[2];
+            const int d = s_etc2Distances[(b[3] & 4) | ((b[3] & 1) << 1) | ((v1 >= v2) ? 1 : 0)];
+            int paint[4][3];
+            for (int c=0; c<3; ++c)
+            {
+                paint[0][c] = clamp255(c1[c] + d);
+                paint[1][c] = clamp255(c1[c] - d);
+                paint[2][c] = clamp255(c2[c] + d);
+                paint[3][c] = clamp255(c2[c] - d);
+            }
+            paintBlock(paint, indexBits, pRgba);
+            return;
+        }
+        if ((bl + db < 0) || (bl + db > 31))
+        {
+            // Planar: colors at three corners, interpolated
+            const int o[3] = {
+                extend6((b[0] >> 1) & 63),
+                extend7(((b[0] & 1) << 6) | ((b[1] >> 1) & 63)),
+                extend6(((b[1] & 1) << 5) | (b[2] & 0x18) | ((b[2] & 3) << 1) | (b[3] >> 7)) };
+            const int h[3] = {
+                extend6((((b[3] >> 2) & 31) << 1) | (b[3] & 1)),
+                extend7(b[4] >> 1),
+                extend6(((b[4] & 1) << 5) | (b[5] >> 3)) };
+            const int v[3] = {
+                extend6(((b[5] & 7) << 3) | (b[6] >> 5)),
+                extend7(((b[6] & 31) << 2) | (b[7] >> 6)),
+                extend6(b[7] & 63) };
+            for (int y=0; y<4; ++y)
+            {
+                for (int x=0; x<4; ++x)
+                {
+                    unsigned char* p = pRgba + 4 * (y * 4 + x);
+                    for (int c=0; c<3; ++c)
+                    {
+                        p[c] = static_cast<unsigned char>(clamp255(
+                            (x * (h[c] - o[c]) + y * (v[c] - o[c]) + 4 * o[c] + 2) >> 2));
+                    }
+                    p[3] = 255;
+                }
+            }
+            return;
+        }
+
+        base[0][0] = extend5(r);
+        base[0][1] = extend5(g);
+        base[0][2] = extend5(bl);
+        base[1][0] = extend5(r + dr);
+        base[1][1] = extend5(g + dg);
+        base[1][2] = extend5(bl + db);
+    }
+
+    // Individual and differential: two 2x4 or 4x2 halves, each a color
+    // plus one of four modifiers from its table.
+    const int* tables[2] = { s_etc1Modifiers[b[3] >> 5], s_etc1Modifiers[(b[3] >> 2) & 7] };
+    const bool flip = (b[3] & 1) != 0;
+    for (int i=0; i<16; ++i)
+    {
+        const int x = i >> 2;
+        const int y = i & 3;
+        const int half = flip ? (y >> 1) : (x >> 1);
+        const int index = ((indexBits >> (15 + i)) & 2) | ((indexBits >> i) & 1);
+        const int modifier = tables[half][index];
+        unsigned char* p = pRgba + 4 * (y * 4 + x);
+        p[0] = static_cast<unsigned char>(clamp255(base[half][0] + modifier));
+        p[1] = static_cast<unsigned char>(clamp255(base[half][1] + modifier));
+        p[2] = static_cast<unsigned char>(clamp255(base[half][2] + modifier));
+        p[3] = 255;
+    }
+}
+
+///@brief Decode one 8-byte EAC block: 11-bit values for R11/RG11 formats,
+/// 8-bit ones for the alpha of RGBA8_ETC2_EAC.
+void DecodeEacBlock(const unsigned char* b, bool elevenBit, unsigned short* pValues)
+{
+    const int base = b[0];
+    const int multiplier = b[1] >> 4;
+    const int* modifiers = s_eacModifiers[b[1] & 15];
+    unsigned int hi = (b[2] << 16) | (b[3] << 8) | b[4]; // pixels 0-7
+    unsigned int lo = (b[5] << 16) | (b[6] << 8) | b[7]; // pixels 8-15
+    for (int i=0; i<16; ++i)
+    {
+        const int index = (i < 8) ? ((hi >> (21 - 3 * i)) & 7) : ((lo >> (21 - 3 * (i - 8))) & 7);
+        int v;
+        if (elevenBit)
+        {
+            v = base * 8 + 4 + ((multiplier != 0) ? modifiers[index] * multiplier * 8 : modifiers[index]);
+            v = (v < 0) ? 0 : ((v > 2047) ? 2047 : v);
+        }
+        else
+        {
+            v = clamp255(base + modifiers[index] * multiplier);
+        }
+        pValues[(i & 3) * 4 + (i >> 2)] = static_cast<unsigned short>(v);
+    }
+}
+
+///@return Bytes per pixel DecodeEtcImage writes for internalFormat.
+int EtcDecodedChannels(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_COMPRESSED_R11_EAC:  return 1;
+    case GL_COMPRESSED_RG11_EAC: return 2;
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_SRGB8_ETC2: return 3;
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC: return 4;
+    default: return 0;
+    }
+}
+
+///@brief Decode a whole image to 8 bits per channel (11-bit channels are
+/// rounded), tightly packed within rows of rowStride bytes.
+bool DecodeEtcImage(GLenum internalFormat, const unsigned char* pBlocks,
+    unsigned int width, unsigned int height, unsigned char* pOut, unsigned int rowStride)
+{
+    const int channels = EtcDecodedChannels(internalFormat);
+    if (channels == 0)
+        return false;
+    const bool twoBlocks = (channels == 2) || (channels == 4);
+
+    unsigned char rgba[16*4];
+    unsigned short values[2][16];
+    for (unsigned int by=0; by<height; by+=4)
+    {
+        for (unsigned int bx=0; bx<width; bx+=4)
+        {
+            switch (channels)
+            {
+            case 1:
+                DecodeEacBlock(pBlocks, true, values[0]);
+                break;
+            case 2:
+                DecodeEacBlock(pBlocks, true, values[0]);
+                DecodeEacBlock(pBlocks + 8, true, values[1]);
+                break;
+            case 3:
+                DecodeEtc2RgbBlock(pBlocks, rgba);
+                break;
+            default:
+                DecodeEacBlock(pBlocks, false, values[0]);
+                DecodeEtc2RgbBlock(pBlocks + 8, rgba);
+                break;
+            }
+            pBlocks += twoBlocks ? 16 : 8;
+
+            for (unsigned int y=0; (y<4) && (by+y<height); ++y)
+            {
+                unsigned char* p = pOut + (by + y) * rowStride + bx * channels;
+                for (unsigned int x=0; (x<4) && (bx+x<width); ++x, p+=channels)
+                {
+                    const int i = y * 4 + x;
+                    if (channels <= 2)
+                    {
+                        for (int c=0; c<channels; ++c)
+                        {
+                            p[c] = static_cast<unsigned char>((values[c][i] * 255 + 1023) / 2047);
+                        }
+                    }
+                    else
+                    {
+                        p[0] = rgba[4*i];
+                        p[1] = rgba[4*i + 1];
+                        p[2] = rgba[4*i + 2];
+                        if (channels == 4)
+                            p[3] = static_cast<unsigned char>(values[0][i]);
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
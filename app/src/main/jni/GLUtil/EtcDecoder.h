@@ -0,0 +1,14 @@
+// EtcDecoder.h
+// CPU decoding of ETC2 and EAC blocks, for GL implementations that cannot
+// sample them (desktop GL before 4.3) and for measuring encoder error.
+
+#pragma once
+
+#include "GL_Includes.h"
+
+void DecodeEtc2RgbBlock(const unsigned char* pBlock, unsigned char* pRgba); // 4x4 RGBA, row by row
+void DecodeEacBlock(const unsigned char* pBlock, bool elevenBit, unsigned short* pValues); // 4x4, row by row
+
+int  EtcDecodedChannels(GLenum internalFormat); // 0 if DecodeEtcImage cannot do it
+bool DecodeEtcImage(GLenum internalFormat, const unsigned char* pBlocks,
+    unsigned int width, unsigned int height, unsigned char* pOut, unsigned int rowStride);
@@ -5,25 +5,50 @@
 #include "DataDirectoryLocation.h"
 #include "ShaderFunctions.h"
 #include "TextureFunctions.h"
+#include "TextureLoader.h"
 
+#include "AssetArchive.h"
 #include "Logging.h"
 #include "MatrixMath.h"
-#include <fstream>
+#include <sstream>
+#include <algorithm>
 #include <string.h>
+#include <stddef.h>
+
+// Hashed once; lookups on the draw path then need no string construction.
+static const ShaderVar s_mvmtx("mvmtx");
+static const ShaderVar s_prmtx("prmtx");
+static const ShaderVar s_sTexture("s_texture");
+static const ShaderVar s_aPosition("a_position");
+static const ShaderVar s_aTexCoord("a_texCoord");
+static const ShaderVar s_aColor("a_color");
 
 /// Static map of all unrecognize characters so we print each message only once.
 static std::map<wchar_t,int> s_unrecognizedChars;
 
 FontRenderer::FontRenderer(const char* pFontName, int windowHeight)
 : m_texDimension(0)
-, m_charTable()
+, m_glyphs()
+, m_denseGlyphIdx(s_denseGlyphRange, static_cast<unsigned short>(s_noGlyph))
+, m_sparseGlyphIdx()
 , m_kernTable()
+, m_kernCount(0)
 , m_pageFilenames()
 , m_pageTextures()
 , m_windowHeight(windowHeight)
 , m_lineHeight(0)
 , m_basePx(0)
 , m_shader()
+, m_pageVbos()
+, m_pageVboCapacity()
+, m_indexVbo(0)
+, m_pageVerts()
+, m_batchHasMatrices(false)
+, m_batching(false)
+, m_layoutLru()
+, m_layoutIndex()
+, m_layoutHits(0)
+, m_layoutMisses(0)
 {
     const std::string fontName = pFontName;
     const std::string dataHome = APP_DATA_DIRECTORY;
@@ -47,30 +72,55 @@ FontRenderer::FontRenderer(const char* pFontName, int windowHeight)
         const std::string suffixless = pageName.substr(0, pageName.length()-4);
         ///@todo png support
         const std::string texFilename = homedir + suffixless + ".raw";
-        const GLuint tex = CreateTextureFromRawFile(texFilename.c_str(), m_texDimension);
+        // Glyphs draw as blank until the page has loaded in the background.
+        const GLuint tex = TextureLoader::Instance().LoadRaw(texFilename.c_str(), m_texDimension, m_texDimension, 1);
         m_pageTextures.push_back(tex);
     }
 
     m_shader.initProgram("fontrenderer");
+    _InitBuffers();
+}
+
+///@brief Create a streaming vertex buffer for each page and one shared
+/// index buffer; every glyph is a quad so the index pattern never changes.
+void FontRenderer::_InitBuffers()
+{
+    const int numPages = static_cast<int>(m_pageTextures.size());
+    m_pageVerts.resize(numPages);
+    m_pageVboCapacity.assign(numPages, 0);
+
     m_shader.bindVAO();
+    for (int i=0; i<numPages; ++i)
     {
-        GLuint vertVbo = 0;
-        glGenBuffers(1, &vertVbo);
-        m_shader.AddVbo("a_position", vertVbo);
-        glBindBuffer(GL_ARRAY_BUFFER, vertVbo);
-        glBufferData(GL_ARRAY_BUFFER, 4*3*sizeof(GLfloat), NULL, GL_STATIC_DRAW);
-        glVertexAttribPointer(m_shader.GetAttrLoc("a_position"), 3, GL_FLOAT, GL_FALSE, 0, NULL);
-
-        GLuint colVbo = 0;
-        glGenBuffers(1, &colVbo);
-        m_shader.AddVbo("a_texCoord", colVbo);
-        glBindBuffer(GL_ARRAY_BUFFER, colVbo);
-        glBufferData(GL_ARRAY_BUFFER, 4*2*sizeof(GLfloat), NULL, GL_STATIC_DRAW);
-        glVertexAttribPointer(m_shader.GetAttrLoc("a_texCoord"), 2, GL_FLOAT, GL_FALSE, 0, NULL);
-
-        glEnableVertexAttribArray(m_shader.GetAttrLoc("a_position"));
-        glEnableVertexAttribArray(m_shader.GetAttrLoc("a_texCoord"));
+        GLuint vbo = 0;
+        glGenBuffers(1, &vbo);
+        std::ostringstream oss;
+        oss << "page" << i;
+        m_shader.AddVbo(oss.str(), vbo);
+        m_pageVbos.push_back(vbo);
     }
+
+    std::vector<GLushort> indices(6 * s_maxGlyphsPerDraw);
+    for (int g=0; g<s_maxGlyphsPerDraw; ++g)
+    {
+        const GLushort b = static_cast<GLushort>(4 * g);
+        GLushort* pI = &indices[6 * g];
+        // CCW triangles by default
+        pI[0] = b;
+        pI[1] = b + 1;
+        pI[2] = b + 2;
+        pI[3] = b + 3;
+        pI[4] = b;
+        pI[5] = b + 2;
+    }
+    glGenBuffers(1, &m_indexVbo);
+    m_shader.AddVbo("indices", m_indexVbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexVbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(m_shader.GetAttrLoc(s_aPosition));
+    glEnableVertexAttribArray(m_shader.GetAttrLoc(s_aTexCoord));
+    glEnableVertexAttribArray(m_shader.GetAttrLoc(s_aColor));
     glBindVertexArray(0);
 }
 
@@ -84,22 +134,27 @@ FontRenderer::~FontRenderer()
 
 /// Utility function for BMF binary font reading
 /// Blocks are preceded by 1 byte identifier and 4 byte size.
-/// Allocates and returns a block of memory to be frreed by the caller.
-unsigned char* GetBlock(std::ifstream& fin, unsigned char& id, unsigned int& sz)
+/// Returns the block in place and advances pCursor past it, or NULL if
+/// the block runs past pEnd.
+const unsigned char* GetBlock(const unsigned char*& pCursor, const unsigned char* pEnd, unsigned char& id, unsigned int& sz)
 {
-    fin.read(reinterpret_cast<char*>(&id), 1);
-    fin.read(reinterpret_cast<char*>(&sz), sizeof(unsigned int));
-
-    unsigned char* pBlock = new unsigned char[sz];
-    fin.read(reinterpret_cast<char*>(pBlock), sz);
-
+    if (pEnd - pCursor < 5)
+        return NULL;
+    id = pCursor[0];
+    memcpy(&sz, pCursor + 1, sizeof(unsigned int));
+    pCursor += 5;
+
+    if (static_cast<size_t>(pEnd - pCursor) < sz)
+        return NULL;
+    const unsigned char* pBlock = pCursor;
+    pCursor += sz;
     return pBlock;
 }
 
 
 /// See BMF docs
 /// http://www.angelcode.com/products/bmfont/doc/file_format.html
-void FontRenderer::_ProcessBlock(unsigned char id, unsigned int sz, unsigned char* pBlock)
+void FontRenderer::_ProcessBlock(unsigned char id, unsigned int sz, const unsigned char* pBlock)
 {
     switch(id)
     {
@@ -141,7 +196,8 @@ void FontRenderer::_ProcessBlock(unsigned char id, unsigned int sz, unsigned cha
                 {
                     m_pageFilenames.push_back(name);
                     pName += len;
-                    name.assign(pName);
+                    if (i+1 < num)
+                        name.assign(pName);
                 }
             }
         }
@@ -150,22 +206,18 @@ void FontRenderer::_ProcessBlock(unsigned char id, unsigned int sz, unsigned cha
     case 4: // chars
         {
             const size_t charCount = sz / sizeof(BMF_char);
-            //m_charTable.resize(charCount);
-            //memcpy(&m_charTable[0], pBlock, charCount * sizeof(BMF_char));
             const BMF_char* pCharBlock = reinterpret_cast<const BMF_char*>(pBlock);
             for(int i=0; i<static_cast<int>(charCount); ++i)
             {
-                const BMF_char& pC = pCharBlock[i];
-                m_charTable[pC.id] = pC;
+                _AddGlyph(pCharBlock[i]);
             }
+            _SortSparseGlyphs();
         }
         break;
 
     case 5: /// kerning pairs
         {
             const size_t kernCount = sz / sizeof(BMF_kern);
-            //m_kernTable.resize(kernCount);
-            //memcpy(&m_kernTable[0], pBlock, kernCount * sizeof(BMF_kern));
             const BMF_kern* pKernBlock = reinterpret_cast<const BMF_kern*>(pBlock);
             for(int i=0; i<static_cast<int>(kernCount); ++i)
             {
@@ -187,31 +239,32 @@ void FontRenderer::_LoadFntFile(const char* pFilename)
         return;
 
     LOG_INFO_NONEWLINE("Opening font file %s ...", pFilename);
-    std::ifstream fin(pFilename, std::ios::binary);
+    AssetFile file;
 
-    if (fin)
+    if (file.Open(pFilename))
     {
         // Header is 4 bytes, BMF followed by 3.
-        unsigned char header[4];
-        fin.read(reinterpret_cast<char*>(header), 4);
-        if ((header[0] == 'B') &&
+        const unsigned char* header = file.Data();
+        const unsigned char* pEnd = file.Data() + file.Size();
+        if ((file.Size() >= 4) &&
+            (header[0] == 'B') &&
             (header[1] == 'M') &&
             (header[2] == 'F') &&
             (header[3] == 3))
         {
+            const unsigned char* pCursor = header + 4;
             for (unsigned int i=0; i<5; ++i)
             {
                 unsigned char id;
                 unsigned int sz;
-                unsigned char* pBlock = GetBlock(fin, id, sz);
+                const unsigned char* pBlock = GetBlock(pCursor, pEnd, id, sz);
+                if (pBlock == NULL)
+                    break;
 
                 _ProcessBlock(id, sz, pBlock);
-
-                delete [] pBlock;
             }
         }
 
-        fin.close();
         LOG_INFO("success.");
     }
     else
@@ -224,27 +277,146 @@ void FontRenderer::_LoadFntFile(const char* pFilename)
 /// Just for curiosity, print a list of the font's kerning pairs to stdout.
 void FontRenderer::PrintKerningPairs(int firstChar, int secondChar) const
 {
-    LOG_INFO("___Kerning pairs(%d):___", m_kernTable.size());
-    for (std::map< std::pair<int,int>,short >::const_iterator it = m_kernTable.begin();
+    LOG_INFO("___Kerning pairs(%d):___", m_kernCount);
+    for (std::vector<kernEntry>::const_iterator it = m_kernTable.begin();
         it != m_kernTable.end();
         ++it)
     {
-        const std::pair<int,int>& key = it->first;
-        const short& val = it->second;
+        const kernEntry& k = *it;
+        if (k.first == s_emptyKern)
+            continue;
 
-        if ((firstChar != 0) && (key.first != firstChar))
+        if ((firstChar != 0) && (k.first != static_cast<unsigned int>(firstChar)))
             continue;
-        if ((secondChar != 0) && (key.second != secondChar))
+        if ((secondChar != 0) && (k.second != static_cast<unsigned int>(secondChar)))
             continue;
 
-        LOG_INFO("  %c %c  %dpx", key.first, key.second, val);
+        LOG_INFO("  %c %c  %dpx", k.first, k.second, k.amount);
     }
 }
 
+/// Glyphs below s_denseGlyphRange get a direct index; the rest go in a
+/// list that _SortSparseGlyphs orders for binary search.
+void FontRenderer::_AddGlyph(const BMF_char& glyph)
+{
+    const unsigned int ch = glyph.id;
+    if ((ch < s_denseGlyphRange) && (m_denseGlyphIdx[ch] != s_noGlyph))
+    {
+        m_glyphs[m_denseGlyphIdx[ch]] = glyph;
+        return;
+    }
+    if (m_glyphs.size() >= s_noGlyph)
+        return;
+
+    const unsigned int idx = static_cast<unsigned int>(m_glyphs.size());
+    m_glyphs.push_back(glyph);
+    if (ch < s_denseGlyphRange)
+    {
+        m_denseGlyphIdx[ch] = static_cast<unsigned short>(idx);
+    }
+    else
+    {
+        m_sparseGlyphIdx.push_back(std::make_pair(ch, idx));
+    }
+}
+
+/// Sort the sparse list by char. If a char was listed twice, the later
+/// entry (higher index) wins, matching what the old std::map did.
+void FontRenderer::_SortSparseGlyphs()
+{
+    std::sort(m_sparseGlyphIdx.begin(), m_sparseGlyphIdx.end());
+
+    std::vector< std::pair<unsigned int, unsigned int> > unique;
+    unique.reserve(m_sparseGlyphIdx.size());
+    for (size_t i=0; i<m_sparseGlyphIdx.size(); ++i)
+    {
+        if (!unique.empty() && (unique.back().first == m_sparseGlyphIdx[i].first))
+            unique.back() = m_sparseGlyphIdx[i];
+        else
+            unique.push_back(m_sparseGlyphIdx[i]);
+    }
+    m_sparseGlyphIdx.swap(unique);
+}
+
+///@return Glyph info for ch, or NULL if the font does not have it.
+const BMF_char* FontRenderer::_FindGlyph(unsigned int ch) const
+{
+    if (ch < s_denseGlyphRange)
+    {
+        const unsigned short idx = m_denseGlyphIdx[ch];
+        return (idx == s_noGlyph) ? NULL : &m_glyphs[idx];
+    }
+
+    // Sorted by char; the index half of the key never affects the search.
+    const std::pair<unsigned int, unsigned int> key(ch, 0);
+    std::vector< std::pair<unsigned int, unsigned int> >::const_iterator it =
+        std::lower_bound(m_sparseGlyphIdx.begin(), m_sparseGlyphIdx.end(), key);
+    if ((it == m_sparseGlyphIdx.end()) || (it->first != ch))
+        return NULL;
+    return &m_glyphs[it->second];
+}
+
+static unsigned int kernHash(unsigned int chprev, unsigned int ch)
+{
+    return (chprev * 2654435761u) ^ (ch * 40503u);
+}
+
 void FontRenderer::_AddKerningEntry(int chprev, int ch, short amount)
 {
-    const std::pair<int,int> kp(chprev, ch);
-    m_kernTable[kp] = amount;
+    // Grow to keep the load factor at or below 1/2 so probe runs stay short.
+    if (2 * (m_kernCount + 1) > m_kernTable.size())
+    {
+        std::vector<kernEntry> old;
+        old.swap(m_kernTable);
+        const kernEntry empty = { s_emptyKern, 0, 0 };
+        m_kernTable.assign(old.empty() ? 64 : 2 * old.size(), empty);
+        m_kernCount = 0;
+        for (std::vector<kernEntry>::const_iterator it = old.begin(); it != old.end(); ++it)
+        {
+            if (it->first != s_emptyKern)
+                _AddKerningEntry(it->first, it->second, it->amount);
+        }
+    }
+
+    const unsigned int a = static_cast<unsigned int>(chprev);
+    const unsigned int b = static_cast<unsigned int>(ch);
+    const unsigned int mask = static_cast<unsigned int>(m_kernTable.size()) - 1;
+    for (unsigned int i = kernHash(a, b) & mask; ; i = (i + 1) & mask)
+    {
+        kernEntry& k = m_kernTable[i];
+        if (k.first == s_emptyKern)
+        {
+            k.first = a;
+            k.second = b;
+            k.amount = amount;
+            ++m_kernCount;
+            return;
+        }
+        if ((k.first == a) && (k.second == b))
+        {
+            k.amount = amount;
+            return;
+        }
+    }
+}
+
+///@return Pixel adjustment for ch following chprev, 0 if the pair is not listed.
+short FontRenderer::_KerningAmount(int chprev, int ch) const
+{
+    if (m_kernCount == 0)
+        return 0;
+
+    const unsigned int a = static_cast<unsigned int>(chprev);
+    const unsigned int b = static_cast<unsigned int>(ch);
+    const unsigned int mask = static_cast<unsigned int>(m_kernTable.size()) - 1;
+    for (unsigned int i = kernHash(a, b) & mask; ; i = (i + 1) & mask)
+    {
+        const kernEntry& k = m_kernTable[i];
+        if (k.first == s_emptyKern)
+            return 0;
+        if ((k.first == a) && (k.second == b))
+            return k.amount;
+    }
 }
 
 ///@brief Load custom kerning entries from .kern file.
@@ -311,12 +483,10 @@ int FontRenderer::StringLengthPixels(const wchar_t* pWStr) const
     const unsigned int len = wcslen(pWStr);
     for (unsigned int i=0; i<len; ++i)
     {
-        const wchar_t ch = pWStr[i];
-        const std::map<wchar_t, BMF_char>::const_iterator it = m_charTable.find(ch);
-        if (it != m_charTable.end())
+        const BMF_char* pGlyph = _FindGlyph(pWStr[i]);
+        if (pGlyph != NULL)
         {
-            const BMF_char& charInfo = it->second;
-            totalPx += charInfo.xadv;
+            totalPx += pGlyph->xadv;
         }
     }
     return totalPx;
@@ -355,6 +525,8 @@ void FontRenderer::DrawString(
 
 
 /// Draw an ASCII string of text using font texture and data.
+/// Outside of a BeginBatch/EndBatch pair the string is drawn immediately,
+/// with one draw call per font page it touches.
 ///@param pStr [in] The ASCII string to display
 ///@param x The x location on screen
 ///@param y The y location on screen
@@ -371,35 +543,71 @@ void FontRenderer::DrawWString(const wchar_t* pStr,
                               bool doKerning,
                               const float* pMvMtx) const
 {
-    const float tracking = 1.0f;
-
-    if (m_charTable.empty())
+    if (m_glyphs.empty())
         return;
 
-    const GLuint prog = m_shader.prog();
-    glUseProgram(prog);
+    _SetBatchMatrices(pProjMtx, pMvMtx);
+    _AppendWString(pStr, x, y, color, doKerning);
+
+    if (m_batching == false)
+    {
+        _Flush();
+    }
+}
+
+/// Queue all following Draw calls until EndBatch.
+void FontRenderer::BeginBatch() const
+{
+    m_batching = true;
+}
+
+/// Draw everything queued since BeginBatch.
+void FontRenderer::EndBatch() const
+{
+    _Flush();
+    m_batching = false;
+}
 
+///@brief Queued quads share one set of matrices; a string with different
+/// matrices flushes what is already queued first.
+void FontRenderer::_SetBatchMatrices(const float* pProjMtx, const float* pMvMtx) const
+{
+    float mvmtx[16];
     if (pMvMtx == NULL)
     {
         // The old 2D path - assume an identity mv matrix
-        float mvmtx[16];
         MakeIdentityMatrix(mvmtx);
-        glUniformMatrix4fv(m_shader.GetUniLoc("mvmtx"), 1, false, mvmtx);
-        glUniformMatrix4fv(m_shader.GetUniLoc("prmtx"), 1, false, pProjMtx);
+        pMvMtx = mvmtx;
     }
-    else
+
+    if (m_batchHasMatrices)
     {
-        glUniformMatrix4fv(m_shader.GetUniLoc("mvmtx"), 1, false, pMvMtx);
-        glUniformMatrix4fv(m_shader.GetUniLoc("prmtx"), 1, false, pProjMtx);
+        const size_t sz = 16 * sizeof(float);
+        if ((memcmp(m_batchProj, pProjMtx, sz) == 0) &&
+            (memcmp(m_batchMv, pMvMtx, sz) == 0))
+            return;
+        _Flush();
     }
 
+    memcpy(m_batchProj, pProjMtx, 16 * sizeof(float));
+    memcpy(m_batchMv, pMvMtx, 16 * sizeof(float));
+    m_batchHasMatrices = true;
+}
+
+/// Lay out e.text into glyph quads starting at the origin.
+void FontRenderer::_LayoutWString(layoutEntry& e, bool doKerning) const
+{
+    e.pages.clear();
+    e.verts.clear();
+    const wchar_t* pStr = e.text.c_str();
+
+    const float tracking = 1.0f;
     const int texDim = m_texDimension;
     const float fTexDim = static_cast<float>(texDim);
 
-    float currx = static_cast<float>(x); // incremented with each character drawn
+    float currx = 0.f; // incremented with each character drawn
 
-    // Let's hope that the string is properly NULL terminated here.
-    const unsigned int len = wcslen(pStr);
+    const unsigned int len = static_cast<unsigned int>(e.text.length());
     for (unsigned int i=0; i<len; ++i)
     {
         const wchar_t ch = pStr[i];
@@ -412,7 +620,8 @@ void FontRenderer::DrawWString(const wchar_t* pStr,
         //if (ch == 0x09) ///<@todo Handle tab characters?
         //    continue;
 
-        if (m_charTable.find(ch) == m_charTable.end())
+        const BMF_char* pGlyph = _FindGlyph(ch);
+        if (pGlyph == NULL)
         {
             // Since the draw function is const, we use a static table to hold
             // unrecognized chars for just one print each.
@@ -423,42 +632,17 @@ void FontRenderer::DrawWString(const wchar_t* pStr,
             }
             continue;
         }
+        const BMF_char& charInfo = *pGlyph;
 
-        const std::map<wchar_t, BMF_char>::const_iterator it = m_charTable.find(ch);
-        if (it == m_charTable.end())
-            continue;
-        const BMF_char& charInfo = it->second;
-
-        ///@todo Cache the value so we don't have to rebind it if it doesn't change.
-        /// This is probably exactly what the driver does...
         const unsigned int tIdx = charInfo.page;
-        if (tIdx >= m_pageTextures.size())
+        if (tIdx >= m_pageVerts.size())
             continue;
-        const GLuint texID = m_pageTextures[tIdx];
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texID);
-        glUniform1i(m_shader.GetUniLoc("s_texture"), 0);
-
-        glUniform3f(m_shader.GetUniLoc("u_fontColor"), color.x, color.y, color.z);
 
         int kernamt = 0;
-        if (doKerning)
+        if (doKerning && (i > 0))
         {
-            //if (i < (len-1))
-            if (i > 0)
-            {
-                const wchar_t chprev = pStr[i-1];
-                //const wchar_t chnext = pStr[i+1];
-
-                // Find kern delta value for this specific character pair.
-                std::pair<int,int> kpair(chprev, ch);
-                const std::map<std::pair<int,int>,short>::const_iterator kit = m_kernTable.find(kpair);
-                if (kit != m_kernTable.end())
-                {
-                    const short& val = kit->second;
-                    kernamt = val;
-                }
-            }
+            // Find kern delta value for this specific character pair.
+            kernamt = _KerningAmount(pStr[i-1], ch);
         }
 
         // Shrink down some characters to 2/3 width
@@ -468,37 +652,159 @@ void FontRenderer::DrawWString(const wchar_t* pStr,
         const float widthScale = shrink ? 2.f/3.f : 1.f;
 
         const float xoff = currx + static_cast<float>(kernamt);
-        const float yoff = static_cast<float>(y + charInfo.yoff); ///@note Characters are top-aligned
+        const float yoff = static_cast<float>(charInfo.yoff); ///@note Characters are top-aligned
         const float xf = static_cast<float>(charInfo.x);
         const float yf = static_cast<float>(charInfo.y);
         const float wf = static_cast<float>(charInfo.w);
         const float hf = static_cast<float>(charInfo.h);
-        const GLfloat vVertices[] = {
-            xoff                , yoff + hf, 0.0f,
-            xoff                , yoff     , 0.0f,
-            xoff + wf*widthScale, yoff     , 0.0f,
-            xoff + wf*widthScale, yoff + hf, 0.0f,
+        const glyphVertex quad[] = {
+            { xoff                , yoff + hf, 0.0f,  (xf     )/fTexDim, (yf + hf)/fTexDim,  1.f, 1.f, 1.f },
+            { xoff                , yoff     , 0.0f,  (xf     )/fTexDim, (yf     )/fTexDim,  1.f, 1.f, 1.f },
+            { xoff + wf*widthScale, yoff     , 0.0f,  (xf + wf)/fTexDim, (yf     )/fTexDim,  1.f, 1.f, 1.f },
+            { xoff + wf*widthScale, yoff + hf, 0.0f,  (xf + wf)/fTexDim, (yf + hf)/fTexDim,  1.f, 1.f, 1.f },
         };
+        e.pages.push_back(tIdx);
+        e.verts.insert(e.verts.end(), quad, quad + 4);
 
-        const GLfloat vTexCoords[] = {
-            (xf     )/fTexDim,  (yf + hf)/fTexDim,
-            (xf     )/fTexDim,  (yf     )/fTexDim,
-            (xf + wf)/fTexDim,  (yf     )/fTexDim,
-            (xf + wf)/fTexDim,  (yf + hf)/fTexDim
-        };
+        currx += tracking * static_cast<float>(charInfo.xadv) * widthScale;
+    }
+}
 
-        const GLushort indices[] = { 0,1,2, 3,0,2 }; // CCW triangles by default
+/// Queue the quads of a string at (x,y) in the given color, laying it
+/// out only if it is not already in the cache.
+void FontRenderer::_AppendWString(const wchar_t* pStr,
+                                  int x,
+                                  int y,
+                                  float3 color,
+                                  bool doKerning) const
+{
+    const layoutEntry& e = _GetLayout(pStr, doKerning);
 
-        m_shader.bindVAO();
+    const float fx = static_cast<float>(x);
+    const float fy = static_cast<float>(y);
+    for (size_t g=0; g<e.pages.size(); ++g)
+    {
+        std::vector<glyphVertex>& verts = m_pageVerts[e.pages[g]];
+        for (int k=0; k<4; ++k)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, m_shader.GetVboLoc("a_position"));
-            glBufferData(GL_ARRAY_BUFFER, 4*3*sizeof(GLfloat), vVertices, GL_STATIC_DRAW);
-            glBindBuffer(GL_ARRAY_BUFFER, m_shader.GetVboLoc("a_texCoord"));
-            glBufferData(GL_ARRAY_BUFFER, 4*2*sizeof(GLfloat), vTexCoords, GL_STATIC_DRAW);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, indices);
+            glyphVertex v = e.verts[4*g + k];
+            v.x += fx;
+            v.y += fy;
+            v.r = color.x;
+            v.g = color.y;
+            v.b = color.z;
+            verts.push_back(v);
         }
-        glBindVertexArray(0);
+    }
+}
 
-        currx += tracking * static_cast<float>(charInfo.xadv) * widthScale;
+/// FNV-1a over the string's characters
+static unsigned int hashWString(const wchar_t* pStr)
+{
+    unsigned int h = 2166136261u;
+    for (const wchar_t* p = pStr; *p != 0; ++p)
+    {
+        h ^= static_cast<unsigned int>(*p);
+        h *= 16777619u;
     }
+    return h;
+}
+
+///@brief Find the cached layout of a string, laying it out on a miss.
+/// The least recently used entry is evicted beyond s_layoutCacheSize.
+const FontRenderer::layoutEntry& FontRenderer::_GetLayout(const wchar_t* pStr, bool doKerning) const
+{
+    const std::pair<unsigned int, bool> key(hashWString(pStr), doKerning);
+    const layoutIndex::iterator found = m_layoutIndex.find(key);
+    if (found != m_layoutIndex.end())
+    {
+        const layoutList::iterator it = found->second;
+        m_layoutLru.splice(m_layoutLru.begin(), m_layoutLru, it);
+        if (it->text.compare(pStr) == 0)
+        {
+            ++m_layoutHits;
+            return *it;
+        }
+
+        // Hash collision: re-use the entry for the new string.
+        ++m_layoutMisses;
+        it->text = pStr;
+        _LayoutWString(*it, doKerning);
+        return *it;
+    }
+
+    ++m_layoutMisses;
+    if (m_layoutLru.size() >= s_layoutCacheSize)
+    {
+        m_layoutIndex.erase(m_layoutLru.back().key);
+        m_layoutLru.pop_back();
+    }
+
+    m_layoutLru.push_front(layoutEntry());
+    layoutEntry& e = m_layoutLru.front();
+    e.key = key;
+    e.text = pStr;
+    _LayoutWString(e, doKerning);
+    m_layoutIndex[key] = m_layoutLru.begin();
+    return e;
+}
+
+///@brief Draw all queued quads: one upload and one draw call per page,
+/// split only if a page holds more than s_maxGlyphsPerDraw glyphs.
+void FontRenderer::_Flush() const
+{
+    bool empty = true;
+    for (size_t p=0; p<m_pageVerts.size(); ++p)
+    {
+        if (m_pageVerts[p].empty() == false)
+            empty = false;
+    }
+    if (empty || (m_batchHasMatrices == false))
+        return;
+
+    glUseProgram(m_shader.prog());
+    glUniformMatrix4fv(m_shader.GetUniLoc(s_mvmtx), 1, false, m_batchMv);
+    glUniformMatrix4fv(m_shader.GetUniLoc(s_prmtx), 1, false, m_batchProj);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(m_shader.GetUniLoc(s_sTexture), 0);
+
+    const GLint posLoc = m_shader.GetAttrLoc(s_aPosition);
+    const GLint texLoc = m_shader.GetAttrLoc(s_aTexCoord);
+    const GLint colLoc = m_shader.GetAttrLoc(s_aColor);
+    const GLsizei stride = sizeof(glyphVertex);
+
+    m_shader.bindVAO();
+    for (size_t p=0; p<m_pageVerts.size(); ++p)
+    {
+        std::vector<glyphVertex>& verts = m_pageVerts[p];
+        if (verts.empty())
+            continue;
+
+        glBindTexture(GL_TEXTURE_2D, m_pageTextures[p]);
+        glBindBuffer(GL_ARRAY_BUFFER, m_pageVbos[p]);
+
+        // Re-specify (orphan) the storage each flush so the driver can hand
+        // back fresh memory instead of waiting on last frame's draw.
+        const unsigned int count = static_cast<unsigned int>(verts.size());
+        if (count > m_pageVboCapacity[p])
+        {
+            m_pageVboCapacity[p] = std::max(count, 2 * m_pageVboCapacity[p]);
+        }
+        glBufferData(GL_ARRAY_BUFFER, m_pageVboCapacity[p] * stride, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * stride, &verts[0]);
+
+        const int glyphs = static_cast<int>(count / 4);
+        const int maxGlyphs = s_maxGlyphsPerDraw;
+        for (int first=0; first<glyphs; first += maxGlyphs)
+        {
+            const int n = std::min(maxGlyphs, glyphs - first);
+            const size_t base = 4 * first * stride;
+            glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base + offsetof(glyphVertex, x)));
+            glVertexAttribPointer(texLoc, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base + offsetof(glyphVertex, s)));
+            glVertexAttribPointer(colLoc, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(base + offsetof(glyphVertex, r)));
+            glDrawElements(GL_TRIANGLES, 6 * n, GL_UNSIGNED_SHORT, NULL);
+        }
+        verts.clear();
+    }
+    glBindVertexArray(0);
 }
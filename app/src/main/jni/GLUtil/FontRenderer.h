@@ -8,12 +8,18 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <list>
 #include "vectortypes.h"
 
 #include "BMFont_structs.h"
 
 /// Loads bitmap fonts created by AngelSoft's BMFont and displays text
 /// using textured triangles in OpenGLES.
+/// Glyph quads are queued per font page and drawn with one call per page.
+/// Between BeginBatch and EndBatch, strings drawn with the same matrices
+/// are coalesced into a single flush.
+/// Laid out strings are kept in a small LRU cache, so an unchanged string
+/// is re-submitted by copying its quads.
 class FontRenderer : public Renderer
 {
 public:
@@ -38,8 +44,15 @@ public:
         bool doKerning,
         const float* pMvMtx=NULL) const;
 
+    void BeginBatch() const;
+    void EndBatch() const;
+
     void PrintKerningPairs(int firstChar=0, int secondChar=0) const;
 
+    unsigned int GetLayoutCacheHits  () const { return m_layoutHits; }
+    unsigned int GetLayoutCacheMisses() const { return m_layoutMisses; }
+    void ResetLayoutCacheStats() const { m_layoutHits = 0; m_layoutMisses = 0; }
+
     /// const Accessors
     int StringLengthPixels(const char* pStr) const;
     int StringLengthPixels(const wchar_t* pWStr) const;
@@ -48,16 +61,54 @@ public:
     int GetBase        () const { return m_basePx; }
 
 protected:
+    struct glyphVertex {
+        GLfloat x, y, z;
+        GLfloat s, t;
+        GLfloat r, g, b;
+    };
+
+    ///@brief Glyph quads for one string laid out at (0,0) in white;
+    /// position and color are applied when the quads are queued.
+    struct layoutEntry {
+        std::pair<unsigned int, bool> key; ///< String hash and kerning flag
+        std::wstring text;
+        std::vector<unsigned int> pages;   ///< Font page of each glyph
+        std::vector<glyphVertex> verts;    ///< 4 per glyph
+    };
+    typedef std::list<layoutEntry> layoutList;
+    typedef std::map<std::pair<unsigned int, bool>, layoutList::iterator> layoutIndex;
+
+    void _InitBuffers();
+    void _SetBatchMatrices(const float* pProjMtx, const float* pMvMtx) const;
+    void _AppendWString(const wchar_t* pStr, int x, int y, float3 color, bool doKerning) const;
+    const layoutEntry& _GetLayout(const wchar_t* pStr, bool doKerning) const;
+    void _LayoutWString(layoutEntry& e, bool doKerning) const;
+    void _Flush() const;
+
     void _LoadFntFile(const char* pFilename);
-    void _ProcessBlock(unsigned char id, unsigned int sz, unsigned char* pBlock);
+    void _ProcessBlock(unsigned char id, unsigned int sz, const unsigned char* pBlock);
+    void _AddGlyph(const BMF_char& glyph);
+    void _SortSparseGlyphs();
+    const BMF_char* _FindGlyph(unsigned int ch) const;
     void _AddKerningEntry(int chprev, int ch, short amount);
+    short _KerningAmount(int chprev, int ch) const;
     int _AddCustomKerningEntries(const char* pFilename);
 
+    ///@brief Open-addressing slot for a kerning pair; first == s_emptyKern marks a free slot.
+    struct kernEntry {
+        unsigned int first;
+        unsigned int second;
+        short amount;
+    };
+
     GLuint                            m_texDimension; ///< Square power-of-two dimension textures preferred
-    std::map<wchar_t, BMF_char>       m_charTable;
-    std::map<
-        std::pair<int,int>,
-        short >                       m_kernTable;
+    std::vector<BMF_char>             m_glyphs;
+    std::vector<unsigned short>       m_denseGlyphIdx;  ///< Index into m_glyphs by char, below s_denseGlyphRange
+    std::vector<
+        std::pair<unsigned int,
+        unsigned int> >               m_sparseGlyphIdx; ///< (char, index into m_glyphs) sorted by char, for the rest
+    std::vector<kernEntry>            m_kernTable;      ///< Power-of-two sized, at most half full
+    unsigned int                      m_kernCount;
     std::vector<std::string>          m_pageFilenames;
     std::vector<GLuint>               m_pageTextures;
     int                               m_windowHeight;
@@ -65,6 +116,28 @@ protected:
     int                               m_basePx;
 
     ShaderWithVariables m_shader;
+    std::vector<GLuint>               m_pageVbos;        ///< Streaming vertex buffer per page
+    mutable std::vector<unsigned int> m_pageVboCapacity; ///< In vertices
+    GLuint                            m_indexVbo;        ///< Shared quad indices, s_maxGlyphsPerDraw long
+
+    // Queued glyph quads waiting for the next flush. Mutable so the const
+    // Draw functions can queue.
+    mutable std::vector< std::vector<glyphVertex> > m_pageVerts;
+    mutable float                     m_batchProj[16];
+    mutable float                     m_batchMv[16];
+    mutable bool                      m_batchHasMatrices;
+    mutable bool                      m_batching;
+
+    mutable layoutList                m_layoutLru;   ///< Most recently used at front
+    mutable layoutIndex               m_layoutIndex;
+    mutable unsigned int              m_layoutHits;
+    mutable unsigned int              m_layoutMisses;
+
+    static const int s_maxGlyphsPerDraw = 4096; ///< 4 vertices each must fit GLushort indices
+    static const unsigned int s_layoutCacheSize = 64; ///< Strings per font
+    static const unsigned int s_denseGlyphRange = 0x3000; ///< Latin through the CJK symbols block
+    static const unsigned short s_noGlyph = 0xffff;
+    static const unsigned int s_emptyKern = 0xffffffff;
 
 private:
     FontRenderer();                                 ///< disallow default constructor
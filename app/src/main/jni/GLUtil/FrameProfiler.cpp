@@ -0,0 +1,338 @@
+// FrameProfiler.cpp
+
+#include "FrameProfiler.h"
+#include "Logging.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+/// Zone handles carry the low bits of the frame number so that a zone
+/// left open across NextFrame (e.g. by a Lua error) cannot close a zone
+/// in the new frame.
+static const int s_handleFrameMask = 0xffff;
+
+FrameProfiler::FrameProfiler()
+: m_enabled(true)
+, m_timer()
+, m_frameNumber(0)
+, m_depth(0)
+, m_frames(s_historyFrames)
+, m_nameIds()
+, m_names()
+, m_queriesInitialized(false)
+, m_gpuTimeOffset(0.)
+, m_queries()
+{
+    for (int i=0; i<s_historyFrames; ++i)
+    {
+        m_frames[i].frameNumber = -1;
+        m_frames[i].zoneCount = 0;
+        m_frames[i].gpuPending = false;
+    }
+    m_frames[0].frameNumber = 0;
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    /// Destroy() should be called before the context is torn down.
+}
+
+/// Release GL query objects before the context is torn down.
+/// Queries still in flight are forgotten; those frames keep CPU times only.
+void FrameProfiler::Destroy()
+{
+    if (m_queriesInitialized && !m_queries.empty())
+    {
+        glDeleteQueries(static_cast<GLsizei>(m_queries.size()), &m_queries[0]);
+    }
+    m_queries.clear();
+    m_queriesInitialized = false;
+    for (int i=0; i<s_historyFrames; ++i)
+    {
+        m_frames[i].gpuPending = false;
+    }
+}
+
+bool FrameProfiler::_HasGpuTimers() const
+{
+#ifdef __ANDROID__
+    // GLES 3.1 only has timestamps through EXT_disjoint_timer_query.
+    return false;
+#else
+    return (glQueryCounter != NULL) &&
+        (glGetQueryObjectui64v != NULL) &&
+        (glGetInteger64v != NULL);
+#endif
+}
+
+///@brief Allocate 2 queries per zone for every frame that can be in flight,
+/// and sample both clocks once to put GPU times on the CPU time axis.
+void FrameProfiler::_InitQueries()
+{
+    m_queriesInitialized = true;
+    if (!_HasGpuTimers())
+        return;
+
+#ifndef __ANDROID__
+    m_queries.resize(2 * s_maxZones * (s_queryLatency + 1));
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), &m_queries[0]);
+
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    m_gpuTimeOffset = m_timer.seconds() - 1.e-9 * static_cast<double>(gpuNow);
+#endif
+}
+
+GLuint* FrameProfiler::_QueriesForFrame(int frameNumber)
+{
+    if (m_queries.empty())
+        return NULL;
+    const int slot = frameNumber % (s_queryLatency + 1);
+    return &m_queries[2 * s_maxZones * slot];
+}
+
+///@brief Read back timestamps for a frame issued s_queryLatency frames ago.
+/// If the GPU is further behind than that, drop the GPU times rather than wait.
+void FrameProfiler::_ResolveGpuTimes(profileFrame& f)
+{
+    if (f.gpuPending == false)
+        return;
+    f.gpuPending = false;
+
+#ifndef __ANDROID__
+    const GLuint* pQ = _QueriesForFrame(f.frameNumber);
+    if (pQ == NULL)
+        return;
+
+    for (int i=0; i<2*f.zoneCount; ++i)
+    {
+        GLuint available = 0;
+        glGetQueryObjectuiv(pQ[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0)
+            return;
+    }
+
+    for (int i=0; i<f.zoneCount; ++i)
+    {
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(pQ[2*i], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(pQ[2*i+1], GL_QUERY_RESULT, &end);
+        profileZone& z = f.zones[i];
+        z.gpuStart = m_gpuTimeOffset + 1.e-9 * static_cast<double>(start);
+        z.gpuEnd = m_gpuTimeOffset + 1.e-9 * static_cast<double>(end);
+    }
+#endif
+}
+
+///@brief Close the current frame and start recording the next.
+/// Zones still open are closed here so every recorded zone has an end.
+void FrameProfiler::NextFrame()
+{
+    if (m_enabled == false)
+        return;
+
+    const double now = m_timer.seconds();
+    profileFrame& cur = m_frames[m_frameNumber % s_historyFrames];
+    GLuint* pQ = cur.gpuPending ? _QueriesForFrame(m_frameNumber) : NULL;
+    for (int i=0; i<cur.zoneCount; ++i)
+    {
+        profileZone& z = cur.zones[i];
+        if (z.cpuEnd < 0.)
+        {
+            z.cpuEnd = now;
+#ifndef __ANDROID__
+            if (pQ != NULL)
+                glQueryCounter(pQ[2*i+1], GL_TIMESTAMP);
+#endif
+        }
+    }
+    m_depth = 0;
+
+    const int resolveFrame = m_frameNumber - s_queryLatency;
+    if (resolveFrame >= 0)
+    {
+        _ResolveGpuTimes(m_frames[resolveFrame % s_historyFrames]);
+    }
+
+    ++m_frameNumber;
+    profileFrame& next = m_frames[m_frameNumber % s_historyFrames];
+    next.frameNumber = m_frameNumber;
+    next.zoneCount = 0;
+    next.gpuPending = false;
+}
+
+///@return An id for the given zone name, to be passed to BeginZone.
+int FrameProfiler::RegisterName(const char* pName)
+{
+    const std::string name(pName != NULL ? pName : "");
+    std::map<std::string, int>::const_iterator it = m_nameIds.find(name);
+    if (it != m_nameIds.end())
+        return it->second;
+
+    const int id = static_cast<int>(m_names.size());
+    m_names.push_back(name);
+    m_nameIds[name] = id;
+    return id;
+}
+
+///@return A handle for EndZone, or -1 if the zone was not recorded.
+int FrameProfiler::BeginZone(int nameId)
+{
+    const int depth = m_depth++;
+    if (m_enabled == false)
+        return -1;
+
+    profileFrame& f = m_frames[m_frameNumber % s_historyFrames];
+    if (f.zoneCount >= s_maxZones)
+        return -1;
+
+    if (m_queriesInitialized == false)
+    {
+        _InitQueries();
+    }
+
+    const int idx = f.zoneCount++;
+    profileZone& z = f.zones[idx];
+    z.nameId = nameId;
+    z.depth = depth;
+    z.cpuStart = m_timer.seconds();
+    z.cpuEnd = -1.;
+    z.gpuStart = -1.;
+    z.gpuEnd = -1.;
+
+#ifndef __ANDROID__
+    GLuint* pQ = _QueriesForFrame(m_frameNumber);
+    if (pQ != NULL)
+    {
+        glQueryCounter(pQ[2*idx], GL_TIMESTAMP);
+        f.gpuPending = true;
+    }
+#endif
+
+    return (m_frameNumber & s_handleFrameMask) * s_maxZones + idx;
+}
+
+void FrameProfiler::EndZone(int zoneIdx)
+{
+    if (m_depth > 0)
+        --m_depth;
+    if (zoneIdx < 0)
+        return;
+    if ((zoneIdx / s_maxZones) != (m_frameNumber & s_handleFrameMask))
+        return;
+
+    profileFrame& f = m_frames[m_frameNumber % s_historyFrames];
+    const int idx = zoneIdx % s_maxZones;
+    if (idx >= f.zoneCount)
+        return;
+    profileZone& z = f.zones[idx];
+    z.cpuEnd = m_timer.seconds();
+
+#ifndef __ANDROID__
+    GLuint* pQ = f.gpuPending ? _QueriesForFrame(m_frameNumber) : NULL;
+    if (pQ != NULL)
+    {
+        glQueryCounter(pQ[2*idx+1], GL_TIMESTAMP);
+    }
+#endif
+}
+
+static void writeJsonString(FILE* pF, const std::string& s)
+{
+    fputc('"', pF);
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+        const char c = *it;
+        if ((c == '"') || (c == '\\'))
+            fputc('\\', pF);
+        if (static_cast<unsigned char>(c) >= 0x20)
+            fputc(c, pF);
+    }
+    fputc('"', pF);
+}
+
+///@brief Write all completed frames in the ring as trace events:
+/// CPU zones on thread 1, GPU zones on thread 2. Times are in microseconds.
+bool FrameProfiler::WriteChromeTrace(const char* pFilename) const
+{
+    FILE* pF = fopen(pFilename, "w");
+    if (pF == NULL)
+    {
+        LOG_ERROR("FrameProfiler: could not open %s for writing.", pFilename);
+        return false;
+    }
+
+    fprintf(pF, "{\"traceEvents\":[\n");
+    fprintf(pF, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(pF, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    int events = 0;
+    const int first = std::max(0, m_frameNumber - s_historyFrames + 1);
+    for (int n=first; n<m_frameNumber; ++n)
+    {
+        const profileFrame& f = m_frames[n % s_historyFrames];
+        if (f.frameNumber != n)
+            continue;
+        for (int i=0; i<f.zoneCount; ++i)
+        {
+            const profileZone& z = f.zones[i];
+            const std::string& name = m_names[z.nameId];
+            fprintf(pF, ",\n{\"name\":");
+            writeJsonString(pF, name);
+            fprintf(pF, ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%d,\"depth\":%d}}",
+                1.e6 * z.cpuStart, 1.e6 * (z.cpuEnd - z.cpuStart), n, z.depth);
+            ++events;
+
+            if (z.gpuStart >= 0.)
+            {
+                fprintf(pF, ",\n{\"name\":");
+                writeJsonString(pF, name);
+                fprintf(pF, ",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%d,\"depth\":%d}}",
+                    1.e6 * z.gpuStart, 1.e6 * (z.gpuEnd - z.gpuStart), n, z.depth);
+                ++events;
+            }
+        }
+    }
+    fprintf(pF, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(pF);
+
+    LOG_INFO("FrameProfiler: wrote %d events to %s", events, pFilename);
+    return true;
+}
+
+
+extern "C" {
+
+static int profilerRegisterName(const char* pName)
+{
+    return FrameProfiler::Instance().RegisterName(pName);
+}
+
+static int profilerBeginZone(int nameId)
+{
+    return FrameProfiler::Instance().BeginZone(nameId);
+}
+
+static void profilerEndZone(int zoneIdx)
+{
+    FrameProfiler::Instance().EndZone(zoneIdx);
+}
+
+static int profilerWriteTrace(const char* pFilename)
+{
+    return FrameProfiler::Instance().WriteChromeTrace(pFilename) ? 1 : 0;
+}
+
+}
+
+const FrameProfilerApi* GetFrameProfilerApi()
+{
+    static const FrameProfilerApi api = {
+        profilerRegisterName,
+        profilerBeginZone,
+        profilerEndZone,
+        profilerWriteTrace,
+    };
+    return &api;
+}
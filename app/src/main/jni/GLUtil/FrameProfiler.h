@@ -0,0 +1,122 @@
+// FrameProfiler.h
+
+#pragma once
+
+#include "Singleton.h"
+#include "GL_Includes.h"
+#include "Timer.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+///@brief Records named, nested CPU zones for each frame into a ring buffer,
+/// with matching GPU times from timestamp queries where the context has them.
+/// GPU results are read back s_queryLatency frames later so the pipeline
+/// never stalls. The ring can be written out as Chrome trace-event JSON
+/// (load it in chrome://tracing or ui.perfetto.dev).
+///@warning Do not attempt to access this object outside of the GL thread!
+class FrameProfiler : public Singleton
+{
+public:
+    static FrameProfiler& Instance()
+    {
+        static FrameProfiler instance;
+        return instance;
+    }
+    void Destroy();
+
+    void NextFrame();
+    int RegisterName(const char* pName);
+    int BeginZone(int nameId);
+    void EndZone(int zoneIdx);
+
+    bool WriteChromeTrace(const char* pFilename) const;
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    static const int s_maxZones = 64;     ///< Per frame; deeper zones are dropped
+    static const int s_historyFrames = 120;
+    static const int s_queryLatency = 3;  ///< Frames between issuing and reading GPU queries
+
+protected:
+    struct profileZone {
+        int nameId;
+        int depth;
+        double cpuStart; ///< Seconds since the profiler was created
+        double cpuEnd;
+        double gpuStart; ///< Seconds, on the same axis as cpuStart; negative if unknown
+        double gpuEnd;
+    };
+
+    struct profileFrame {
+        int frameNumber;
+        int zoneCount;
+        bool gpuPending; ///< Timestamp queries issued but not yet read back
+        profileZone zones[s_maxZones];
+    };
+
+    bool _HasGpuTimers() const;
+    void _InitQueries();
+    GLuint* _QueriesForFrame(int frameNumber);
+    void _ResolveGpuTimes(profileFrame& f);
+
+    bool m_enabled;
+    Timer m_timer;
+    int m_frameNumber;
+    int m_depth;
+    std::vector<profileFrame> m_frames;
+    std::map<std::string, int> m_nameIds;
+    std::vector<std::string> m_names;
+
+    bool m_queriesInitialized;
+    double m_gpuTimeOffset; ///< Add to GPU timestamps (in seconds) to get profiler time
+    std::vector<GLuint> m_queries; ///< 2 per zone per in-flight frame
+
+private:
+    FrameProfiler();
+    ~FrameProfiler();
+    FrameProfiler(FrameProfiler const& copy);            // Not Implemented
+    FrameProfiler& operator=(FrameProfiler const& copy); // Not Implemented
+};
+
+///@brief Opens a zone in its constructor and closes it in its destructor.
+class ScopedProfileZone
+{
+public:
+    explicit ScopedProfileZone(int nameId)
+    : m_zoneIdx(FrameProfiler::Instance().BeginZone(nameId))
+    {
+    }
+    ~ScopedProfileZone()
+    {
+        FrameProfiler::Instance().EndZone(m_zoneIdx);
+    }
+
+protected:
+    int m_zoneIdx;
+
+private:
+    ScopedProfileZone(const ScopedProfileZone&);
+    ScopedProfileZone& operator=(const ScopedProfileZone&);
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/// Profile the rest of the enclosing scope. The name is looked up once per call site.
+#define PROFILE_ZONE(name) \
+    static const int PROFILE_CONCAT(profNameId_, __LINE__) = FrameProfiler::Instance().RegisterName(name); \
+    ScopedProfileZone PROFILE_CONCAT(profZone_, __LINE__)(PROFILE_CONCAT(profNameId_, __LINE__))
+
+/// Function pointers handed to Lua so scenes can mark zones of their own
+/// through FFI. Must match the cdef in deploy/lua/util/profiler.lua.
+struct FrameProfilerApi {
+    int (*registerName)(const char* pName);
+    int (*beginZone)(int nameId);
+    void (*endZone)(int zoneIdx);
+    int (*writeTrace)(const char* pFilename);
+};
+
+const FrameProfilerApi* GetFrameProfilerApi();
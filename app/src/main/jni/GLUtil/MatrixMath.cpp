@@ -7,6 +7,19 @@
 #include "VectorMath.h"
 #include "MatrixMath.h"
 
+// Pick SIMD kernels for whatever the compiler is targeting.
+#if defined(__AVX__)
+#  include <immintrin.h>
+#  define MATRIXMATH_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define MATRIXMATH_SSE2 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define MATRIXMATH_NEON 1
+#endif
+
 #ifndef M_PI
 #  define M_PI   3.14159265358979323846264338327
 #endif
@@ -281,3 +294,440 @@ void glhOrtho(float *matrix,
 
     memcpy(matrix, mtx, 16*sizeof(float));
 }
+
+const char* mat4KernelName()
+{
+#if defined(MATRIXMATH_AVX)
+    return "AVX";
+#elif defined(MATRIXMATH_SSE2)
+    return "SSE2";
+#elif defined(MATRIXMATH_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+// The kernels work on plain floats with unaligned loads, so the C surface
+// can pass through whatever pointers Lua has. Each one reads all of an
+// element before writing it, so output may alias input.
+//
+// Affine inverse: the rows of the inverse 3x3 are cross products of the
+// columns over the determinant; the translation is negated and carried
+// through the inverse 3x3. The bottom row is taken to be 0,0,0,1.
+static const float s_singularDeterminant = 1.e-12f;
+
+#if defined(MATRIXMATH_SSE2)
+
+#define SPLAT(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i,i,i,i))
+
+// c0*v.x + c1*v.y + c2*v.z + c3*v.w: one column of a product, or one
+// transformed float4.
+static inline __m128 combineColumns(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 v)
+{
+    const __m128 xy = _mm_add_ps(_mm_mul_ps(c0, SPLAT(v,0)), _mm_mul_ps(c1, SPLAT(v,1)));
+    const __m128 zw = _mm_add_ps(_mm_mul_ps(c2, SPLAT(v,2)), _mm_mul_ps(c3, SPLAT(v,3)));
+    return _mm_add_ps(xy, zw);
+}
+
+static inline __m128 cross3(__m128 a, __m128 b)
+{
+    const __m128 ayzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3,0,2,1));
+    const __m128 byzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3,0,2,1));
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, byzx), _mm_mul_ps(ayzx, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3,0,2,1));
+}
+
+static inline void storeFloat3(float* pOut, __m128 v)
+{
+    _mm_storel_pi(reinterpret_cast<__m64*>(pOut), v);
+    _mm_store_ss(pOut + 2, _mm_movehl_ps(v, v));
+}
+
+static void multiplyKernel(float* pOut, const float* pA, const float* pB)
+{
+    const __m128 a0 = _mm_loadu_ps(pA);
+    const __m128 a1 = _mm_loadu_ps(pA + 4);
+    const __m128 a2 = _mm_loadu_ps(pA + 8);
+    const __m128 a3 = _mm_loadu_ps(pA + 12);
+    const __m128 b0 = _mm_loadu_ps(pB);
+    const __m128 b1 = _mm_loadu_ps(pB + 4);
+    const __m128 b2 = _mm_loadu_ps(pB + 8);
+    const __m128 b3 = _mm_loadu_ps(pB + 12);
+    _mm_storeu_ps(pOut,      combineColumns(a0, a1, a2, a3, b0));
+    _mm_storeu_ps(pOut + 4,  combineColumns(a0, a1, a2, a3, b1));
+    _mm_storeu_ps(pOut + 8,  combineColumns(a0, a1, a2, a3, b2));
+    _mm_storeu_ps(pOut + 12, combineColumns(a0, a1, a2, a3, b3));
+}
+
+static bool affineInverseKernel(float* pOut, const float* pA)
+{
+    // Zero w so it drops out of the cross products and the determinant.
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 c0 = _mm_and_ps(_mm_loadu_ps(pA), xyzMask);
+    const __m128 c1 = _mm_and_ps(_mm_loadu_ps(pA + 4), xyzMask);
+    const __m128 c2 = _mm_and_ps(_mm_loadu_ps(pA + 8), xyzMask);
+    const __m128 t  = _mm_loadu_ps(pA + 12);
+
+    __m128 r0 = cross3(c1, c2);
+    __m128 r1 = cross3(c2, c0);
+    __m128 r2 = cross3(c0, c1);
+
+    const __m128 d = _mm_mul_ps(c0, r0);
+    const __m128 d2 = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2,3,0,1)));
+    const float det = _mm_cvtss_f32(_mm_add_ps(d2, _mm_shuffle_ps(d2, d2, _MM_SHUFFLE(1,0,3,2))));
+    if (fabs(det) < s_singularDeterminant)
+        return false;
+
+    const __m128 invDet = _mm_set1_ps(1.f / det);
+    r0 = _mm_mul_ps(r0, invDet);
+    r1 = _mm_mul_ps(r1, invDet);
+    r2 = _mm_mul_ps(r2, invDet);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    const __m128 rt = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(r0, SPLAT(t,0)), _mm_mul_ps(r1, SPLAT(t,1))),
+        _mm_mul_ps(r2, SPLAT(t,2)));
+
+    _mm_storeu_ps(pOut, r0);
+    _mm_storeu_ps(pOut + 4, r1);
+    _mm_storeu_ps(pOut + 8, r2);
+    _mm_storeu_ps(pOut + 12, _mm_sub_ps(_mm_set_ps(1.f, 0.f, 0.f, 0.f), rt));
+    return true;
+}
+
+static void transformFloat4Kernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const __m128 c0 = _mm_loadu_ps(pM);
+    const __m128 c1 = _mm_loadu_ps(pM + 4);
+    const __m128 c2 = _mm_loadu_ps(pM + 8);
+    const __m128 c3 = _mm_loadu_ps(pM + 12);
+    int i = 0;
+
+#if defined(MATRIXMATH_AVX)
+    // Two float4s per iteration, one in each 128 bit lane.
+    const __m256 w0 = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c0, 1);
+    const __m256 w1 = _mm256_insertf128_ps(_mm256_castps128_ps256(c1), c1, 1);
+    const __m256 w2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c2), c2, 1);
+    const __m256 w3 = _mm256_insertf128_ps(_mm256_castps128_ps256(c3), c3, 1);
+    for (; i+2 <= count; i += 2)
+    {
+        const __m256 v = _mm256_loadu_ps(pIn + 4*i);
+        const __m256 xy = _mm256_add_ps(
+            _mm256_mul_ps(w0, _mm256_permute_ps(v, 0x00)),
+            _mm256_mul_ps(w1, _mm256_permute_ps(v, 0x55)));
+        const __m256 zw = _mm256_add_ps(
+            _mm256_mul_ps(w2, _mm256_permute_ps(v, 0xAA)),
+            _mm256_mul_ps(w3, _mm256_permute_ps(v, 0xFF)));
+        _mm256_storeu_ps(pOut + 4*i, _mm256_add_ps(xy, zw));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        const __m128 v = _mm_loadu_ps(pIn + 4*i);
+        _mm_storeu_ps(pOut + 4*i, combineColumns(c0, c1, c2, c3, v));
+    }
+}
+
+static void transformPointsKernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const __m128 c0 = _mm_loadu_ps(pM);
+    const __m128 c1 = _mm_loadu_ps(pM + 4);
+    const __m128 c2 = _mm_loadu_ps(pM + 8);
+    const __m128 c3 = _mm_loadu_ps(pM + 12);
+    for (int i=0; i<count; ++i)
+    {
+        const float* p = pIn + 3*i;
+        const __m128 xy = _mm_add_ps(_mm_mul_ps(c0, _mm_load1_ps(p)), _mm_mul_ps(c1, _mm_load1_ps(p + 1)));
+        const __m128 z1 = _mm_add_ps(_mm_mul_ps(c2, _mm_load1_ps(p + 2)), c3);
+        storeFloat3(pOut + 3*i, _mm_add_ps(xy, z1));
+    }
+}
+
+static void transformVectorsKernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const __m128 c0 = _mm_loadu_ps(pM);
+    const __m128 c1 = _mm_loadu_ps(pM + 4);
+    const __m128 c2 = _mm_loadu_ps(pM + 8);
+    for (int i=0; i<count; ++i)
+    {
+        const float* p = pIn + 3*i;
+        const __m128 xy = _mm_add_ps(_mm_mul_ps(c0, _mm_load1_ps(p)), _mm_mul_ps(c1, _mm_load1_ps(p + 1)));
+        storeFloat3(pOut + 3*i, _mm_add_ps(xy, _mm_mul_ps(c2, _mm_load1_ps(p + 2))));
+    }
+}
+
+#undef SPLAT
+
+#elif defined(MATRIXMATH_NEON)
+
+static inline float32x4_t combineColumns(float32x4_t c0, float32x4_t c1, float32x4_t c2, float32x4_t c3, float32x4_t v)
+{
+    const float32x2_t lo = vget_low_f32(v);
+    const float32x2_t hi = vget_high_f32(v);
+    float32x4_t r = vmulq_lane_f32(c0, lo, 0);
+    r = vmlaq_lane_f32(r, c1, lo, 1);
+    r = vmlaq_lane_f32(r, c2, hi, 0);
+    return vmlaq_lane_f32(r, c3, hi, 1);
+}
+
+static inline void storeFloat3(float* pOut, float32x4_t v)
+{
+    vst1_f32(pOut, vget_low_f32(v));
+    vst1q_lane_f32(pOut + 2, v, 2);
+}
+
+static void multiplyKernel(float* pOut, const float* pA, const float* pB)
+{
+    const float32x4_t a0 = vld1q_f32(pA);
+    const float32x4_t a1 = vld1q_f32(pA + 4);
+    const float32x4_t a2 = vld1q_f32(pA + 8);
+    const float32x4_t a3 = vld1q_f32(pA + 12);
+    const float32x4_t b0 = vld1q_f32(pB);
+    const float32x4_t b1 = vld1q_f32(pB + 4);
+    const float32x4_t b2 = vld1q_f32(pB + 8);
+    const float32x4_t b3 = vld1q_f32(pB + 12);
+    vst1q_f32(pOut,      combineColumns(a0, a1, a2, a3, b0));
+    vst1q_f32(pOut + 4,  combineColumns(a0, a1, a2, a3, b1));
+    vst1q_f32(pOut + 8,  combineColumns(a0, a1, a2, a3, b2));
+    vst1q_f32(pOut + 12, combineColumns(a0, a1, a2, a3, b3));
+}
+
+// ARMv7 NEON has no general shuffle for the cross products, and this runs
+// once per matrix rather than per vertex, so the 3x3 part stays scalar.
+static bool affineInverseKernel(float* pOut, const float* pA)
+{
+    const float3 c0 = {pA[0], pA[1], pA[2]};
+    const float3 c1 = {pA[4], pA[5], pA[6]};
+    const float3 c2 = {pA[8], pA[9], pA[10]};
+    const float3 r0 = cross(c1, c2);
+    const float3 r1 = cross(c2, c0);
+    const float3 r2 = cross(c0, c1);
+    const float det = dot(c0, r0);
+    if (fabs(det) < s_singularDeterminant)
+        return false;
+
+    const float cols[16] = {
+        r0.x, r1.x, r2.x, 0.f,
+        r0.y, r1.y, r2.y, 0.f,
+        r0.z, r1.z, r2.z, 0.f,
+        0.f, 0.f, 0.f, 0.f,
+    };
+    const float t[4] = {pA[12], pA[13], pA[14], 0.f};
+    const float one[4] = {0.f, 0.f, 0.f, 1.f};
+
+    const float32x4_t s = vdupq_n_f32(1.f / det);
+    const float32x4_t i0 = vmulq_f32(vld1q_f32(cols), s);
+    const float32x4_t i1 = vmulq_f32(vld1q_f32(cols + 4), s);
+    const float32x4_t i2 = vmulq_f32(vld1q_f32(cols + 8), s);
+    const float32x4_t i3 = vld1q_f32(cols + 12);
+    const float32x4_t rt = combineColumns(i0, i1, i2, i3, vld1q_f32(t));
+
+    vst1q_f32(pOut, i0);
+    vst1q_f32(pOut + 4, i1);
+    vst1q_f32(pOut + 8, i2);
+    vst1q_f32(pOut + 12, vsubq_f32(vld1q_f32(one), rt));
+    return true;
+}
+
+static void transformFloat4Kernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const float32x4_t c0 = vld1q_f32(pM);
+    const float32x4_t c1 = vld1q_f32(pM + 4);
+    const float32x4_t c2 = vld1q_f32(pM + 8);
+    const float32x4_t c3 = vld1q_f32(pM + 12);
+    for (int i=0; i<count; ++i)
+    {
+        vst1q_f32(pOut + 4*i, combineColumns(c0, c1, c2, c3, vld1q_f32(pIn + 4*i)));
+    }
+}
+
+static void transformPointsKernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const float32x4_t c0 = vld1q_f32(pM);
+    const float32x4_t c1 = vld1q_f32(pM + 4);
+    const float32x4_t c2 = vld1q_f32(pM + 8);
+    const float32x4_t c3 = vld1q_f32(pM + 12);
+    for (int i=0; i<count; ++i)
+    {
+        const float* p = pIn + 3*i;
+        float32x4_t r = vmlaq_f32(c3, c0, vld1q_dup_f32(p));
+        r = vmlaq_f32(r, c1, vld1q_dup_f32(p + 1));
+        r = vmlaq_f32(r, c2, vld1q_dup_f32(p + 2));
+        storeFloat3(pOut + 3*i, r);
+    }
+}
+
+static void transformVectorsKernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const float32x4_t c0 = vld1q_f32(pM);
+    const float32x4_t c1 = vld1q_f32(pM + 4);
+    const float32x4_t c2 = vld1q_f32(pM + 8);
+    for (int i=0; i<count; ++i)
+    {
+        const float* p = pIn + 3*i;
+        float32x4_t r = vmulq_f32(c0, vld1q_dup_f32(p));
+        r = vmlaq_f32(r, c1, vld1q_dup_f32(p + 1));
+        r = vmlaq_f32(r, c2, vld1q_dup_f32(p + 2));
+        storeFloat3(pOut + 3*i, r);
+    }
+}
+
+#else // Plain C++
+
+static void multiplyKernel(float* pOut, const float* pA, const float* pB)
+{
+    float result[16];
+    for (unsigned int i=0; i<16; i+=4)
+    {
+        for (unsigned int j=0; j<4; ++j)
+        {
+            result[i+j] =  pB[i+0] * pA[j+0]
+                         + pB[i+1] * pA[j+4]
+                         + pB[i+2] * pA[j+8]
+                         + pB[i+3] * pA[j+12];
+        }
+    }
+    memcpy(pOut, result, 16*sizeof(float));
+}
+
+static bool affineInverseKernel(float* pOut, const float* pA)
+{
+    const float3 c0 = {pA[0], pA[1], pA[2]};
+    const float3 c1 = {pA[4], pA[5], pA[6]};
+    const float3 c2 = {pA[8], pA[9], pA[10]};
+    const float3 r0 = cross(c1, c2);
+    const float3 r1 = cross(c2, c0);
+    const float3 r2 = cross(c0, c1);
+    const float det = dot(c0, r0);
+    if (fabs(det) < s_singularDeterminant)
+        return false;
+
+    const float s = 1.f / det;
+    const float3 t = {pA[12], pA[13], pA[14]};
+    const float result[16] = {
+        s*r0.x, s*r1.x, s*r2.x, 0.f,
+        s*r0.y, s*r1.y, s*r2.y, 0.f,
+        s*r0.z, s*r1.z, s*r2.z, 0.f,
+        -s*dot(r0, t), -s*dot(r1, t), -s*dot(r2, t), 1.f,
+    };
+    memcpy(pOut, result, 16*sizeof(float));
+    return true;
+}
+
+static void transformFloat4Kernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const float* c = pM;
+    for (int i=0; i<count; ++i)
+    {
+        const float x = pIn[4*i], y = pIn[4*i+1], z = pIn[4*i+2], w = pIn[4*i+3];
+        float* o = pOut + 4*i;
+        o[0] = c[0]*x + c[4]*y + c[ 8]*z + c[12]*w;
+        o[1] = c[1]*x + c[5]*y + c[ 9]*z + c[13]*w;
+        o[2] = c[2]*x + c[6]*y + c[10]*z + c[14]*w;
+        o[3] = c[3]*x + c[7]*y + c[11]*z + c[15]*w;
+    }
+}
+
+static void transformPointsKernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const float* c = pM;
+    for (int i=0; i<count; ++i)
+    {
+        const float x = pIn[3*i], y = pIn[3*i+1], z = pIn[3*i+2];
+        float* o = pOut + 3*i;
+        o[0] = c[0]*x + c[4]*y + c[ 8]*z + c[12];
+        o[1] = c[1]*x + c[5]*y + c[ 9]*z + c[13];
+        o[2] = c[2]*x + c[6]*y + c[10]*z + c[14];
+    }
+}
+
+static void transformVectorsKernel(float* pOut, const float* pM, const float* pIn, int count)
+{
+    const float* c = pM;
+    for (int i=0; i<count; ++i)
+    {
+        const float x = pIn[3*i], y = pIn[3*i+1], z = pIn[3*i+2];
+        float* o = pOut + 3*i;
+        o[0] = c[0]*x + c[4]*y + c[ 8]*z;
+        o[1] = c[1]*x + c[5]*y + c[ 9]*z;
+        o[2] = c[2]*x + c[6]*y + c[10]*z;
+    }
+}
+
+#endif
+
+void mat4Multiply(mat4& out, const mat4& a, const mat4& b)
+{
+    multiplyKernel(out.m, a.m, b.m);
+}
+
+bool mat4AffineInverse(mat4& out, const mat4& a)
+{
+    return affineInverseKernel(out.m, a.m);
+}
+
+void mat4TransformFloat4(float4* pOut, const mat4& m, const float4* pIn, int count)
+{
+    transformFloat4Kernel(&pOut->x, m.m, &pIn->x, count);
+}
+
+void mat4TransformPoints(float3* pOut, const mat4& m, const float3* pIn, int count)
+{
+    transformPointsKernel(&pOut->x, m.m, &pIn->x, count);
+}
+
+void mat4TransformVectors(float3* pOut, const mat4& m, const float3* pIn, int count)
+{
+    transformVectorsKernel(&pOut->x, m.m, &pIn->x, count);
+}
+
+
+extern "C" {
+
+void fc_mat4_multiply(float* pOut, const float* pA, const float* pB)
+{
+    multiplyKernel(pOut, pA, pB);
+}
+
+int fc_mat4_affine_inverse(float* pOut, const float* pA)
+{
+    return affineInverseKernel(pOut, pA) ? 1 : 0;
+}
+
+void fc_mat4_transform_float4(float* pOut, const float* pM, const float* pIn, int count)
+{
+    transformFloat4Kernel(pOut, pM, pIn, count);
+}
+
+void fc_mat4_transform_points(float* pOut, const float* pM, const float* pIn, int count)
+{
+    transformPointsKernel(pOut, pM, pIn, count);
+}
+
+void fc_mat4_transform_vectors(float* pOut, const float* pM, const float* pIn, int count)
+{
+    transformVectorsKernel(pOut, pM, pIn, count);
+}
+
+const char* fc_mat4_kernel_name()
+{
+    return mat4KernelName();
+}
+
+}
+
+const MatrixMathApi* GetMatrixMathApi()
+{
+    static const MatrixMathApi api = {
+        fc_mat4_multiply,
+        fc_mat4_affine_inverse,
+        fc_mat4_transform_float4,
+        fc_mat4_transform_points,
+        fc_mat4_transform_vectors,
+        fc_mat4_kernel_name,
+    };
+    return &api;
+}
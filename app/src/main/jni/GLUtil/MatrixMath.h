@@ -58,3 +58,44 @@ void glhOrtho(float *matrix,
               float top,
               float near,
               float far);
+
+// SIMD kernels on mat4 and float4 (see vectortypes.h), built for SSE2,
+// AVX or NEON when the compiler targets them and in plain C++ otherwise.
+// Arrays need not be aligned. Output may alias input.
+void mat4Multiply        (mat4& out, const mat4& a, const mat4& b); // out = a * b
+bool mat4AffineInverse   (mat4& out, const mat4& a);                // false if a is singular
+void mat4TransformFloat4 (float4* pOut, const mat4& m, const float4* pIn, int count);
+void mat4TransformPoints (float3* pOut, const mat4& m, const float3* pIn, int count); // w = 1
+void mat4TransformVectors(float3* pOut, const mat4& m, const float3* pIn, int count); // w = 0
+const char* mat4KernelName();
+
+#if defined(_WIN32)
+#  define MATRIXMATH_EXPORT __declspec(dllexport)
+#else
+#  define MATRIXMATH_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// The kernels above on plain float arrays, for Lua to call through ffi.C
+/// where the host exports its symbols. Names and signatures are stable.
+/// Must match the cdef in deploy/lua/util/simdmath.lua.
+extern "C" {
+MATRIXMATH_EXPORT void fc_mat4_multiply(float* pOut, const float* pA, const float* pB);
+MATRIXMATH_EXPORT int  fc_mat4_affine_inverse(float* pOut, const float* pA);
+MATRIXMATH_EXPORT void fc_mat4_transform_float4(float* pOut, const float* pM, const float* pIn, int count);
+MATRIXMATH_EXPORT void fc_mat4_transform_points(float* pOut, const float* pM, const float* pIn, int count);
+MATRIXMATH_EXPORT void fc_mat4_transform_vectors(float* pOut, const float* pM, const float* pIn, int count);
+MATRIXMATH_EXPORT const char* fc_mat4_kernel_name();
+}
+
+/// The same functions as pointers, handed to Lua as native_matrix_api for
+/// hosts whose symbols ffi.C cannot see (e.g. the Android shared library).
+struct MatrixMathApi {
+    void (*fc_mat4_multiply)(float* pOut, const float* pA, const float* pB);
+    int  (*fc_mat4_affine_inverse)(float* pOut, const float* pA);
+    void (*fc_mat4_transform_float4)(float* pOut, const float* pM, const float* pIn, int count);
+    void (*fc_mat4_transform_points)(float* pOut, const float* pM, const float* pIn, int count);
+    void (*fc_mat4_transform_vectors)(float* pOut, const float* pM, const float* pIn, int count);
+    const char* (*fc_mat4_kernel_name)();
+};
+
+const MatrixMathApi* GetMatrixMathApi();
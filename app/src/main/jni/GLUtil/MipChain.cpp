@@ -0,0 +1,375 @@
+// MipChain.cpp
+
+#include "MipChain.h"
+#include "Threads.h"
+
+#include <math.h>
+#include <string.h>
+
+// Pick SIMD kernels for whatever the compiler is targeting, as MatrixMath.cpp does.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define MIPCHAIN_SSE2 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define MIPCHAIN_NEON 1
+#endif
+
+static const char s_mipChainMagic[4] = { 'F', 'C', 'M', 'P' };
+static const int s_maxMipThreads = 16;
+static const unsigned int s_minPixelsPerThread = 16 * 1024;
+
+// Conversions between 8-bit sRGB and 16-bit linear, and back from linear
+// rounded to 12 bits. Built during static initialization, before any
+// thread can ask for them.
+struct srgbTables {
+    unsigned short toLinear[256];
+    unsigned char toSrgb[4096];
+
+    srgbTables()
+    {
+        for (int i=0; i<256; ++i)
+        {
+            const double s = i / 255.;
+            const double l = (s <= .04045) ? s / 12.92 : pow((s + .055) / 1.055, 2.4);
+            toLinear[i] = static_cast<unsigned short>(l * 65535. + .5);
+        }
+        for (int i=0; i<4096; ++i)
+        {
+            const double l = i / 4095.;
+            const double s = (l <= .0031308) ? l * 12.92 : 1.055 * pow(l, 1. / 2.4) - .055;
+            toSrgb[i] = static_cast<unsigned char>(s * 255. + .5);
+        }
+    }
+};
+static const srgbTables s_srgb;
+
+unsigned int MipLevelCount(unsigned int width, unsigned int height)
+{
+    unsigned int largest = (width > height) ? width : height;
+    unsigned int levels = 1;
+    while (largest > 1)
+    {
+        largest >>= 1;
+        ++levels;
+    }
+    return levels;
+}
+
+void MipLevelDimensions(unsigned int width, unsigned int height, unsigned int level,
+                        unsigned int& levelWidth, unsigned int& levelHeight)
+{
+    levelWidth = width >> level;
+    levelHeight = height >> level;
+    if (levelWidth == 0)
+        levelWidth = 1;
+    if (levelHeight == 0)
+        levelHeight = 1;
+}
+
+///@return Bytes from the start of level 0 to the start of level.
+size_t MipLevelOffset(unsigned int width, unsigned int height, int channels, unsigned int level)
+{
+    size_t offset = 0;
+    for (unsigned int i=0; i<level; ++i)
+    {
+        unsigned int w, h;
+        MipLevelDimensions(width, height, i, w, h);
+        offset += static_cast<size_t>(w) * h * channels;
+    }
+    return offset;
+}
+
+size_t MipChainSize(unsigned int width, unsigned int height, int channels)
+{
+    return MipLevelOffset(width, height, channels, MipLevelCount(width, height));
+}
+
+size_t MipChainFileSize(unsigned int width, unsigned int height, int channels)
+{
+    return sizeof(MipChainHeader) + MipChainSize(width, height, channels);
+}
+
+void WriteMipChainHeader(MipChainHeader& header,
+    unsigned int width, unsigned int height, int channels, unsigned int flags)
+{
+    memcpy(header.magic, s_mipChainMagic, sizeof(header.magic));
+    header.version = s_mipChainVersion;
+    header.width = width;
+    header.height = height;
+    header.channels = channels;
+    header.levels = MipLevelCount(width, height);
+    header.flags = flags;
+    header.reserved = 0;
+}
+
+///@return The header if pData holds a whole .mip file, NULL if not.
+const MipChainHeader* ParseMipChain(const unsigned char* pData, size_t size)
+{
+    if ((pData == NULL) || (size < sizeof(MipChainHeader)))
+        return NULL;
+    const MipChainHeader* pHeader = reinterpret_cast<const MipChainHeader*>(pData);
+    if ((memcmp(pHeader->magic, s_mipChainMagic, sizeof(s_mipChainMagic)) != 0) ||
+        (pHeader->version != s_mipChainVersion) ||
+        (pHeader->width == 0) || (pHeader->height == 0) ||
+        (pHeader->channels < 1) || (pHeader->channels > 4) ||
+        (pHeader->levels != MipLevelCount(pHeader->width, pHeader->height)))
+        return NULL;
+    if (size < MipChainFileSize(pHeader->width, pHeader->height, pHeader->channels))
+        return NULL;
+    return pHeader;
+}
+
+// Average 2x2 blocks of rows pRow0 and pRow1 into dstWidth pixels, starting
+// at dstX. The last source column repeats when the source is 1 wide.
+static void boxRowLinear(unsigned char* pDst, const unsigned char* pRow0, const unsigned char* pRow1,
+    unsigned int dstX, unsigned int dstWidth, unsigned int srcWidth, int channels)
+{
+    for (unsigned int x=dstX; x<dstWidth; ++x)
+    {
+        const unsigned int x0 = 2 * x * channels;
+        const unsigned int x1 = (2 * x + 1 < srcWidth) ? x0 + channels : x0;
+        for (int c=0; c<channels; ++c)
+        {
+            const unsigned int sum = pRow0[x0+c] + pRow0[x1+c] + pRow1[x0+c] + pRow1[x1+c];
+            pDst[x*channels + c] = static_cast<unsigned char>((sum + 2) >> 2);
+        }
+    }
+}
+
+// As boxRowLinear, but averages the color channels in linear light. A
+// fourth channel is alpha and stays linear. Lookups dominate here, and
+// SSE2 and NEON have no gather to speed them up.
+static void boxRowSrgb(unsigned char* pDst, const unsigned char* pRow0, const unsigned char* pRow1,
+    unsigned int dstWidth, unsigned int srcWidth, int channels)
+{
+    const unsigned short* toLinear = s_srgb.toLinear;
+    for (unsigned int x=0; x<dstWidth; ++x)
+    {
+        const unsigned int x0 = 2 * x * channels;
+        const unsigned int x1 = (2 * x + 1 < srcWidth) ? x0 + channels : x0;
+        for (int c=0; c<3; ++c)
+        {
+            const unsigned int sum =
+                toLinear[pRow0[x0+c]] + toLinear[pRow0[x1+c]] +
+                toLinear[pRow1[x0+c]] + toLinear[pRow1[x1+c]];
+            unsigned int index = (sum + 32) >> 6; // mean, rounded to 12 bits
+            if (index > 4095)
+                index = 4095;
+            pDst[x*channels + c] = s_srgb.toSrgb[index];
+        }
+        if (channels == 4)
+        {
+            const unsigned int sum = pRow0[x0+3] + pRow0[x1+3] + pRow1[x0+3] + pRow1[x1+3];
+            pDst[x*channels + 3] = static_cast<unsigned char>((sum + 2) >> 2);
+        }
+    }
+}
+
+// SIMD versions of boxRowLinear for 1 and 4 channels. Return how many
+// destination pixels they did; boxRowLinear finishes the row.
+#if defined(MIPCHAIN_SSE2)
+static unsigned int boxRowSimd(unsigned char* pDst, const unsigned char* pRow0, const unsigned char* pRow1,
+    unsigned int dstWidth, int channels)
+{
+    const __m128i two = _mm_set1_epi16(2);
+    unsigned int x = 0;
+    if (channels == 1)
+    {
+        // Each 16-bit lane of a row holds one horizontal pair.
+        const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+        for (; x + 16 <= dstWidth; x += 16)
+        {
+            const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + 2*x));
+            const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + 2*x + 16));
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + 2*x));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + 2*x + 16));
+            __m128i s0 = _mm_add_epi16(
+                _mm_add_epi16(_mm_and_si128(a0, lowBytes), _mm_srli_epi16(a0, 8)),
+                _mm_add_epi16(_mm_and_si128(b0, lowBytes), _mm_srli_epi16(b0, 8)));
+            __m128i s1 = _mm_add_epi16(
+                _mm_add_epi16(_mm_and_si128(a1, lowBytes), _mm_srli_epi16(a1, 8)),
+                _mm_add_epi16(_mm_and_si128(b1, lowBytes), _mm_srli_epi16(b1, 8)));
+            s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+            s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + x), _mm_packus_epi16(s0, s1));
+        }
+    }
+    else if (channels == 4)
+    {
+        // Widen 4 pixels to 16 bits and add each 64-bit half to the other.
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 4 <= dstWidth; x += 4)
+        {
+            __m128i out[2];
+            for (int half=0; half<2; ++half)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + 8*x + 16*half));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + 8*x + 16*half));
+                const __m128i aLo = _mm_unpacklo_epi8(a, zero);
+                const __m128i aHi = _mm_unpackhi_epi8(a, zero);
+                const __m128i bLo = _mm_unpacklo_epi8(b, zero);
+                const __m128i bHi = _mm_unpackhi_epi8(b, zero);
+                const __m128i sa = _mm_add_epi16(_mm_unpacklo_epi64(aLo, aHi), _mm_unpackhi_epi64(aLo, aHi));
+                const __m128i sb = _mm_add_epi16(_mm_unpacklo_epi64(bLo, bHi), _mm_unpackhi_epi64(bLo, bHi));
+                out[half] = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sa, sb), two), 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4*x), _mm_packus_epi16(out[0], out[1]));
+        }
+    }
+    return x;
+}
+#elif defined(MIPCHAIN_NEON)
+static unsigned int boxRowSimd(unsigned char* pDst, const unsigned char* pRow0, const unsigned char* pRow1,
+    unsigned int dstWidth, int channels)
+{
+    // Pairwise widening adds, then a rounding narrowing shift.
+    unsigned int x = 0;
+    if (channels == 1)
+    {
+        for (; x + 8 <= dstWidth; x += 8)
+        {
+            const uint16x8_t s = vpadalq_u8(vpaddlq_u8(vld1q_u8(pRow0 + 2*x)), vld1q_u8(pRow1 + 2*x));
+            vst1_u8(pDst + x, vrshrn_n_u16(s, 2));
+        }
+    }
+    else if (channels == 4)
+    {
+        for (; x + 8 <= dstWidth; x += 8)
+        {
+            const uint8x16x4_t a = vld4q_u8(pRow0 + 8*x);
+            const uint8x16x4_t b = vld4q_u8(pRow1 + 8*x);
+            uint8x8x4_t out;
+            out.val[0] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[0]), b.val[0]), 2);
+            out.val[1] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[1]), b.val[1]), 2);
+            out.val[2] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[2]), b.val[2]), 2);
+            out.val[3] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[3]), b.val[3]), 2);
+            vst4_u8(pDst + 4*x, out);
+        }
+    }
+    return x;
+}
+#endif
+
+///@brief Box filter one level down to the next, rows [firstRow, endRow)
+/// of the destination only, so bands can run on separate threads.
+///@param pDst Start of the destination level, (srcWidth/2)x(srcHeight/2)
+///@param srgb Filter color channels in linear light; ignored below 3 channels
+void DownsampleLevel(unsigned char* pDst, const unsigned char* pSrc,
+    unsigned int srcWidth, unsigned int srcHeight, int channels, bool srgb,
+    unsigned int firstRow, unsigned int endRow)
+{
+    unsigned int dstWidth, dstHeight;
+    MipLevelDimensions(srcWidth, srcHeight, 1, dstWidth, dstHeight);
+    if (endRow > dstHeight)
+        endRow = dstHeight;
+
+    const size_t srcStride = static_cast<size_t>(srcWidth) * channels;
+    const size_t dstStride = static_cast<size_t>(dstWidth) * channels;
+    for (unsigned int y=firstRow; y<endRow; ++y)
+    {
+        const unsigned char* pRow0 = pSrc + 2 * y * srcStride;
+        const unsigned char* pRow1 = (2 * y + 1 < srcHeight) ? pRow0 + srcStride : pRow0;
+        unsigned char* pOut = pDst + y * dstStride;
+        if (srgb && (channels >= 3))
+        {
+            boxRowSrgb(pOut, pRow0, pRow1, dstWidth, srcWidth, channels);
+            continue;
+        }
+
+        unsigned int x = 0;
+#if defined(MIPCHAIN_SSE2) || defined(MIPCHAIN_NEON)
+        if (srcWidth >= 2)
+        {
+            x = boxRowSimd(pOut, pRow0, pRow1, dstWidth, channels);
+        }
+#endif
+        boxRowLinear(pOut, pRow0, pRow1, x, dstWidth, srcWidth, channels);
+    }
+}
+
+struct downsampleBand {
+    unsigned char* pDst;
+    const unsigned char* pSrc;
+    unsigned int srcWidth;
+    unsigned int srcHeight;
+    int channels;
+    bool srgb;
+    unsigned int firstRow;
+    unsigned int endRow;
+};
+
+static void downsampleBandEntry(void* pArg)
+{
+    const downsampleBand& b = *reinterpret_cast<const downsampleBand*>(pArg);
+    DownsampleLevel(b.pDst, b.pSrc, b.srcWidth, b.srcHeight, b.channels, b.srgb, b.firstRow, b.endRow);
+}
+
+///@brief Fill in levels 1 and up of a chain laid out as in a .mip file.
+///@param pChain Level 0, followed by room for the rest (see MipChainSize)
+///@param threadCount Split large levels into this many bands of rows
+void BuildMipChain(unsigned char* pChain,
+    unsigned int width, unsigned int height, int channels, bool srgb,
+    int threadCount)
+{
+    if (threadCount > s_maxMipThreads)
+        threadCount = s_maxMipThreads;
+
+    const unsigned int levels = MipLevelCount(width, height);
+    const unsigned char* pSrc = pChain;
+    for (unsigned int level=1; level<levels; ++level)
+    {
+        unsigned int srcWidth, srcHeight, dstWidth, dstHeight;
+        MipLevelDimensions(width, height, level - 1, srcWidth, srcHeight);
+        MipLevelDimensions(width, height, level, dstWidth, dstHeight);
+        unsigned char* pDst = pChain + MipLevelOffset(width, height, channels, level);
+
+        int bands = static_cast<int>(dstWidth * dstHeight / s_minPixelsPerThread);
+        if (bands > threadCount)
+            bands = threadCount;
+        if (bands > static_cast<int>(dstHeight))
+            bands = static_cast<int>(dstHeight);
+        if (bands <= 1)
+        {
+            DownsampleLevel(pDst, pSrc, srcWidth, srcHeight, channels, srgb);
+        }
+        else
+        {
+            downsampleBand band[s_maxMipThreads];
+            Thread threads[s_maxMipThreads];
+            for (int i=0; i<bands; ++i)
+            {
+                downsampleBand& b = band[i];
+                b.pDst = pDst;
+                b.pSrc = pSrc;
+                b.srcWidth = srcWidth;
+                b.srcHeight = srcHeight;
+                b.channels = channels;
+                b.srgb = srgb;
+                b.firstRow = dstHeight * i / bands;
+                b.endRow = dstHeight * (i + 1) / bands;
+                if ((i > 0) && (threads[i].Start(downsampleBandEntry, &b) == false))
+                {
+                    downsampleBandEntry(&b);
+                }
+            }
+            downsampleBandEntry(&band[0]);
+            for (int i=1; i<bands; ++i)
+            {
+                threads[i].Join();
+            }
+        }
+        pSrc = pDst;
+    }
+}
+
+const char* mipKernelName()
+{
+#if defined(MIPCHAIN_SSE2)
+    return "SSE2";
+#elif defined(MIPCHAIN_NEON)
+    return "NEON";
+#else
+    return "C++";
+#endif
+}
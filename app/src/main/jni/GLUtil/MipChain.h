@@ -0,0 +1,47 @@
+// MipChain.h
+// Full mip chains for raw 8-bit textures, built by 2x2 box downsampling on
+// the CPU: offline by Flickercladding-MipBake, which writes them to .mip
+// files, or at load time by TextureLoader. Needs no GL context.
+
+#pragma once
+
+#include <stddef.h>
+
+///@brief Header of a .mip file. Levels follow it tightly packed, level 0
+/// first, each halving width and height (rounding down, at least 1) down
+/// to 1x1. All fields little endian.
+struct MipChainHeader {
+    char magic[4];         ///< "FCMP"
+    unsigned int version;  ///< s_mipChainVersion
+    unsigned int width;
+    unsigned int height;
+    unsigned int channels; ///< 1 to 4 bytes per pixel
+    unsigned int levels;
+    unsigned int flags;    ///< MipChainSRGB
+    unsigned int reserved;
+};
+
+static const unsigned int s_mipChainVersion = 1;
+
+enum mipChainFlags {
+    MipChainSRGB = 1 ///< Color channels were filtered as sRGB; alpha always linear
+};
+
+unsigned int MipLevelCount(unsigned int width, unsigned int height);
+void   MipLevelDimensions(unsigned int width, unsigned int height, unsigned int level,
+                          unsigned int& levelWidth, unsigned int& levelHeight);
+size_t MipLevelOffset(unsigned int width, unsigned int height, int channels, unsigned int level);
+size_t MipChainSize(unsigned int width, unsigned int height, int channels);     // all levels
+size_t MipChainFileSize(unsigned int width, unsigned int height, int channels); // header + all levels
+
+void WriteMipChainHeader(MipChainHeader& header,
+    unsigned int width, unsigned int height, int channels, unsigned int flags);
+const MipChainHeader* ParseMipChain(const unsigned char* pData, size_t size);
+
+void DownsampleLevel(unsigned char* pDst, const unsigned char* pSrc,
+    unsigned int srcWidth, unsigned int srcHeight, int channels, bool srgb,
+    unsigned int firstRow = 0, unsigned int endRow = 0xffffffff);
+void BuildMipChain(unsigned char* pChain,
+    unsigned int width, unsigned int height, int channels, bool srgb,
+    int threadCount = 1);
+const char* mipKernelName();
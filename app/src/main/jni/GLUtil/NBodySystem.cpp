@@ -0,0 +1,716 @@
+// NBodySystem.cpp
+
+#include "NBodySystem.h"
+#include "JobSystem.h"
+#include "FrameProfiler.h"
+#include "Logging.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+// Pick SIMD kernels for whatever the compiler is targeting.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define NBODY_SSE2 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define NBODY_NEON 1
+#endif
+
+/// Softening below this is raised to it, so a body's pull on itself,
+/// at distance 0, stays 0 rather than 0/0.
+static const float s_minSoftening = 1.e-6f;
+
+//
+// The pair kernel: the pull on a body at p from count sources. The
+// self term, where p is a source, is 0 since its d is.
+//
+
+#if defined(NBODY_SSE2)
+
+static void accumulatePairs(float px, float py, float pz,
+    const float* pX, const float* pY, const float* pZ, const float* pMass, const float* pEps,
+    int count, float& ax, float& ay, float& az)
+{
+    const __m128 vpx = _mm_set1_ps(px);
+    const __m128 vpy = _mm_set1_ps(py);
+    const __m128 vpz = _mm_set1_ps(pz);
+    const __m128 one = _mm_set1_ps(1.f);
+    __m128 sx = _mm_setzero_ps();
+    __m128 sy = _mm_setzero_ps();
+    __m128 sz = _mm_setzero_ps();
+    int j = 0;
+    for (; j + 4 <= count; j += 4)
+    {
+        const __m128 dx = _mm_sub_ps(vpx, _mm_loadu_ps(pX + j));
+        const __m128 dy = _mm_sub_ps(vpy, _mm_loadu_ps(pY + j));
+        const __m128 dz = _mm_sub_ps(vpz, _mm_loadu_ps(pZ + j));
+        const __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        const __m128 inv = _mm_div_ps(one, _mm_add_ps(_mm_sqrt_ps(r2), _mm_loadu_ps(pEps + j)));
+        const __m128 s = _mm_mul_ps(_mm_loadu_ps(pMass + j), _mm_mul_ps(inv, _mm_mul_ps(inv, inv)));
+        sx = _mm_add_ps(sx, _mm_mul_ps(dx, s));
+        sy = _mm_add_ps(sy, _mm_mul_ps(dy, s));
+        sz = _mm_add_ps(sz, _mm_mul_ps(dz, s));
+    }
+    float lanes[3][4];
+    _mm_storeu_ps(lanes[0], sx);
+    _mm_storeu_ps(lanes[1], sy);
+    _mm_storeu_ps(lanes[2], sz);
+    float tx = (lanes[0][0] + lanes[0][1]) + (lanes[0][2] + lanes[0][3]);
+    float ty = (lanes[1][0] + lanes[1][1]) + (lanes[1][2] + lanes[1][3]);
+    float tz = (lanes[2][0] + lanes[2][1]) + (lanes[2][2] + lanes[2][3]);
+
+    for (; j < count; ++j)
+    {
+        const float dx = px - pX[j];
+        const float dy = py - pY[j];
+        const float dz = pz - pZ[j];
+        const float inv = 1.f / (sqrtf(dx*dx + dy*dy + dz*dz) + pEps[j]);
+        const float s = pMass[j] * inv * inv * inv;
+        tx += dx * s;
+        ty += dy * s;
+        tz += dz * s;
+    }
+    ax -= tx;
+    ay -= ty;
+    az -= tz;
+}
+
+#elif defined(NBODY_NEON)
+
+// ARMv7 NEON has no square root or divide: both are estimates refined by
+// two Newton-Raphson steps, which is within a few ulps.
+static void accumulatePairs(float px, float py, float pz,
+    const float* pX, const float* pY, const float* pZ, const float* pMass, const float* pEps,
+    int count, float& ax, float& ay, float& az)
+{
+    const float32x4_t vpx = vdupq_n_f32(px);
+    const float32x4_t vpy = vdupq_n_f32(py);
+    const float32x4_t vpz = vdupq_n_f32(pz);
+    const float32x4_t tiny = vdupq_n_f32(1.e-30f);
+    float32x4_t sx = vdupq_n_f32(0.f);
+    float32x4_t sy = vdupq_n_f32(0.f);
+    float32x4_t sz = vdupq_n_f32(0.f);
+    int j = 0;
+    for (; j + 4 <= count; j += 4)
+    {
+        const float32x4_t dx = vsubq_f32(vpx, vld1q_f32(pX + j));
+        const float32x4_t dy = vsubq_f32(vpy, vld1q_f32(pY + j));
+        const float32x4_t dz = vsubq_f32(vpz, vld1q_f32(pZ + j));
+        const float32x4_t r2 = vmlaq_f32(vmlaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz);
+
+        // |d| = r2 / sqrt(r2); the max keeps the estimate finite at 0.
+        const float32x4_t r2s = vmaxq_f32(r2, tiny);
+        float32x4_t rs = vrsqrteq_f32(r2s);
+        rs = vmulq_f32(rs, vrsqrtsq_f32(vmulq_f32(r2s, rs), rs));
+        rs = vmulq_f32(rs, vrsqrtsq_f32(vmulq_f32(r2s, rs), rs));
+        const float32x4_t den = vaddq_f32(vmulq_f32(r2, rs), vld1q_f32(pEps + j));
+
+        float32x4_t inv = vrecpeq_f32(den);
+        inv = vmulq_f32(inv, vrecpsq_f32(den, inv));
+        inv = vmulq_f32(inv, vrecpsq_f32(den, inv));
+        const float32x4_t s = vmulq_f32(vld1q_f32(pMass + j), vmulq_f32(inv, vmulq_f32(inv, inv)));
+        sx = vmlaq_f32(sx, dx, s);
+        sy = vmlaq_f32(sy, dy, s);
+        sz = vmlaq_f32(sz, dz, s);
+    }
+    float lanes[3][4];
+    vst1q_f32(lanes[0], sx);
+    vst1q_f32(lanes[1], sy);
+    vst1q_f32(lanes[2], sz);
+    float tx = (lanes[0][0] + lanes[0][1]) + (lanes[0][2] + lanes[0][3]);
+    float ty = (lanes[1][0] + lanes[1][1]) + (lanes[1][2] + lanes[1][3]);
+    float tz = (lanes[2][0] + lanes[2][1]) + (lanes[2][2] + lanes[2][3]);
+
+    for (; j < count; ++j)
+    {
+        const float dx = px - pX[j];
+        const float dy = py - pY[j];
+        const float dz = pz - pZ[j];
+        const float inv = 1.f / (sqrtf(dx*dx + dy*dy + dz*dz) + pEps[j]);
+        const float s = pMass[j] * inv * inv * inv;
+        tx += dx * s;
+        ty += dy * s;
+        tz += dz * s;
+    }
+    ax -= tx;
+    ay -= ty;
+    az -= tz;
+}
+
+#else // Plain C++
+
+static void accumulatePairs(float px, float py, float pz,
+    const float* pX, const float* pY, const float* pZ, const float* pMass, const float* pEps,
+    int count, float& ax, float& ay, float& az)
+{
+    float tx = 0.f, ty = 0.f, tz = 0.f;
+    for (int j = 0; j < count; ++j)
+    {
+        const float dx = px - pX[j];
+        const float dy = py - pY[j];
+        const float dz = pz - pZ[j];
+        const float inv = 1.f / (sqrtf(dx*dx + dy*dy + dz*dz) + pEps[j]);
+        const float s = pMass[j] * inv * inv * inv;
+        tx += dx * s;
+        ty += dy * s;
+        tz += dz * s;
+    }
+    ax -= tx;
+    ay -= ty;
+    az -= tz;
+}
+
+#endif
+
+const char* NBodySystem::KernelName()
+{
+#if defined(NBODY_SSE2)
+    return "SSE2";
+#elif defined(NBODY_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+const float NBodySystem::s_defaultTheta = 0.5f;
+
+NBodySystem::NBodySystem()
+: m_x(), m_y(), m_z()
+, m_vx(), m_vy(), m_vz()
+, m_ax(), m_ay(), m_az()
+, m_mass(), m_eps()
+, m_order()
+, m_sortScratch()
+, m_sx(), m_sy(), m_sz(), m_smass(), m_seps()
+, m_nodes()
+, m_leaves()
+, m_method(NBodyTree)
+, m_theta(s_defaultTheta)
+, m_dt(0.f)
+, m_pOut(NULL)
+, m_grain(1)
+, m_chunkInteractions()
+, m_staging()
+, m_timer()
+, m_stepSeconds(0.)
+, m_interactionsPerSecond(0.)
+, m_reportStart(0.)
+, m_reportInteractions(0.)
+, m_reportSeconds(0.)
+, m_reportSteps(0)
+{
+}
+
+NBodySystem::~NBodySystem()
+{
+}
+
+///@brief Take a copy of count bodies from x,y,z,w position, mass,
+/// softening,*,* attribute and x,y,z,w velocity arrays.
+bool NBodySystem::Init(int count, const float* pPositions, const float* pAttributes, const float* pVelocities)
+{
+    Clear();
+    if ((count <= 0) || (pPositions == NULL) || (pAttributes == NULL))
+        return false;
+
+    m_x.resize(count); m_y.resize(count); m_z.resize(count);
+    m_vx.assign(count, 0.f); m_vy.assign(count, 0.f); m_vz.assign(count, 0.f);
+    m_ax.assign(count, 0.f); m_ay.assign(count, 0.f); m_az.assign(count, 0.f);
+    m_mass.resize(count); m_eps.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        m_x[i] = pPositions[4*i];
+        m_y[i] = pPositions[4*i+1];
+        m_z[i] = pPositions[4*i+2];
+        m_mass[i] = pAttributes[4*i];
+        m_eps[i] = std::max(pAttributes[4*i+1], s_minSoftening);
+        if (pVelocities != NULL)
+        {
+            m_vx[i] = pVelocities[4*i];
+            m_vy[i] = pVelocities[4*i+1];
+            m_vz[i] = pVelocities[4*i+2];
+        }
+    }
+
+    m_reportStart = m_timer.seconds();
+    m_reportInteractions = 0.;
+    m_reportSeconds = 0.;
+    m_reportSteps = 0;
+    LOG_INFO("NBodySystem: %d bodies, %s kernel", count, KernelName());
+    return true;
+}
+
+///@brief Release every array.
+void NBodySystem::Clear()
+{
+    std::vector<float>* const arrays[] = {
+        &m_x, &m_y, &m_z, &m_vx, &m_vy, &m_vz, &m_ax, &m_ay, &m_az, &m_mass, &m_eps,
+        &m_sx, &m_sy, &m_sz, &m_smass, &m_seps, &m_staging,
+    };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i)
+    {
+        std::vector<float>().swap(*arrays[i]);
+    }
+    std::vector<int>().swap(m_order);
+    std::vector<int>().swap(m_sortScratch);
+    std::vector<treeNode>().swap(m_nodes);
+    std::vector<int>().swap(m_leaves);
+    m_stepSeconds = 0.;
+    m_interactionsPerSecond = 0.;
+}
+
+///@brief Advance dt, writing the new positions to pPositionsOut as
+/// x,y,z,1 if it is not NULL. Runs on the JobSystem workers and waits for
+/// them, so call it from the thread that submits jobs.
+void NBodySystem::Step(float dt, float* pPositionsOut)
+{
+    PROFILE_ZONE("nbody step");
+    const int count = BodyCount();
+    if (count == 0)
+        return;
+
+    const double start = m_timer.seconds();
+    if (m_method == NBodyTree)
+    {
+        _BuildTree();
+    }
+
+    // Choose the grain here, not in Submit, so a chunk knows its index.
+    // The tree's parallel-for is over leaves, the direct one over bodies.
+    const bool tree = (m_method == NBodyTree);
+    const int items = tree ? static_cast<int>(m_leaves.size()) : count;
+    m_dt = dt;
+    m_pOut = pPositionsOut;
+    m_grain = std::max(tree ? 1 : 64, (items + JobSystem::s_maxChunks - 1) / JobSystem::s_maxChunks);
+    m_chunkInteractions.assign((items + m_grain - 1) / m_grain, 0.);
+
+    JobSystem& js = JobSystem::Instance();
+    const int accel = js.Submit(tree ? _TreeKernel : _AccelerationKernel, this, items, m_grain);
+    const int grain = std::max(256, (count + JobSystem::s_maxChunks - 1) / JobSystem::s_maxChunks);
+    js.Wait(js.Submit(_IntegrateKernel, this, count, grain, accel));
+    m_pOut = NULL;
+
+    double interactions = 0.;
+    for (std::vector<double>::const_iterator it = m_chunkInteractions.begin(); it != m_chunkInteractions.end(); ++it)
+    {
+        interactions += *it;
+    }
+    _Report(interactions, m_timer.seconds() - start);
+}
+
+///@brief Step, writing positions into the x,y,z,w vertex buffer vbo while
+/// it is mapped. Where it cannot be mapped they are uploaded from a copy.
+///@return true if the buffer was mapped.
+bool NBodySystem::StepToBuffer(float dt, GLuint vbo)
+{
+    const GLsizeiptr size = static_cast<GLsizeiptr>(BodyCount()) * 4 * sizeof(float);
+    if (size == 0)
+        return false;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    float* pMapped = reinterpret_cast<float*>(glMapBufferRange(
+        GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (pMapped != NULL)
+    {
+        Step(dt, pMapped);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    else
+    {
+        m_staging.resize(4 * BodyCount());
+        Step(dt, &m_staging[0]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, &m_staging[0]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return pMapped != NULL;
+}
+
+void NBodySystem::_AccelerationKernel(void* pArg, int begin, int end)
+{
+    NBodySystem* pSys = reinterpret_cast<NBodySystem*>(pArg);
+    pSys->m_chunkInteractions[begin / pSys->m_grain] = pSys->_Accelerate(begin, end);
+}
+
+/// New accelerations for bodies [begin, end) by direct summation.
+double NBodySystem::_Accelerate(int begin, int end)
+{
+    const int count = BodyCount();
+    for (int i = begin; i < end; ++i)
+    {
+        float ax = 0.f, ay = 0.f, az = 0.f;
+        accumulatePairs(m_x[i], m_y[i], m_z[i],
+            &m_x[0], &m_y[0], &m_z[0], &m_mass[0], &m_eps[0], count, ax, ay, az);
+        _Kick(i, ax, ay, az);
+    }
+    return static_cast<double>(end - begin) * count;
+}
+
+void NBodySystem::_TreeKernel(void* pArg, int begin, int end)
+{
+    NBodySystem* pSys = reinterpret_cast<NBodySystem*>(pArg);
+    interactionList list;
+    double interactions = 0.;
+    for (int l = begin; l < end; ++l)
+    {
+        interactions += pSys->_TreeGroup(pSys->m_leaves[l], list);
+    }
+    pSys->m_chunkInteractions[begin / pSys->m_grain] = interactions;
+}
+
+/// Store body i's new acceleration, and the second half-kick of its
+/// velocity with it.
+void NBodySystem::_Kick(int i, float ax, float ay, float az)
+{
+    const float halfDt = 0.5f * m_dt;
+    m_vx[i] += halfDt * (ax + m_ax[i]);
+    m_vy[i] += halfDt * (ay + m_ay[i]);
+    m_vz[i] += halfDt * (az + m_az[i]);
+    m_ax[i] = ax;
+    m_ay[i] = ay;
+    m_az[i] = az;
+}
+
+void NBodySystem::_IntegrateKernel(void* pArg, int begin, int end)
+{
+    NBodySystem* pSys = reinterpret_cast<NBodySystem*>(pArg);
+    const float dt = pSys->m_dt;
+    float* pOut = pSys->m_pOut;
+    for (int i = begin; i < end; ++i)
+    {
+        pSys->m_x[i] += dt * (pSys->m_vx[i] + 0.5f * dt * pSys->m_ax[i]);
+        pSys->m_y[i] += dt * (pSys->m_vy[i] + 0.5f * dt * pSys->m_ay[i]);
+        pSys->m_z[i] += dt * (pSys->m_vz[i] + 0.5f * dt * pSys->m_az[i]);
+        if (pOut != NULL)
+        {
+            pOut[4*i]   = pSys->m_x[i];
+            pOut[4*i+1] = pSys->m_y[i];
+            pOut[4*i+2] = pSys->m_z[i];
+            pOut[4*i+3] = 1.f;
+        }
+    }
+}
+
+/// Walk the tree once for the bodies of a leaf. A cell is taken whole
+/// only if it does not overlap the leaf's bounding box and is small as
+/// seen from its nearest point; otherwise leaves add their bodies to the
+/// list. Every body of the leaf is then summed over the list. Returns the
+/// interaction count.
+double NBodySystem::_TreeGroup(int leaf, interactionList& list)
+{
+    const treeNode& g = m_nodes[leaf];
+    const int gBegin = g.bodyStart;
+    const int gEnd = g.bodyStart + g.bodyCount;
+    float lo[3] = { m_sx[gBegin], m_sy[gBegin], m_sz[gBegin] };
+    float hi[3] = { m_sx[gBegin], m_sy[gBegin], m_sz[gBegin] };
+    for (int k = gBegin + 1; k < gEnd; ++k)
+    {
+        lo[0] = std::min(lo[0], m_sx[k]); hi[0] = std::max(hi[0], m_sx[k]);
+        lo[1] = std::min(lo[1], m_sy[k]); hi[1] = std::max(hi[1], m_sy[k]);
+        lo[2] = std::min(lo[2], m_sz[k]); hi[2] = std::max(hi[2], m_sz[k]);
+    }
+    const float gc[3] = { 0.5f * (lo[0] + hi[0]), 0.5f * (lo[1] + hi[1]), 0.5f * (lo[2] + hi[2]) };
+    const float gh[3] = { 0.5f * (hi[0] - lo[0]), 0.5f * (hi[1] - lo[1]), 0.5f * (hi[2] - lo[2]) };
+    const float theta2 = m_theta * m_theta;
+
+    list.clear();
+    int stack[8 * (s_maxDepth + 2)];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0)
+    {
+        const treeNode& n = m_nodes[stack[--depth]];
+        const bool overlaps =
+            (fabsf(n.cx - gc[0]) <= n.half + gh[0]) &&
+            (fabsf(n.cy - gc[1]) <= n.half + gh[1]) &&
+            (fabsf(n.cz - gc[2]) <= n.half + gh[2]);
+        bool take = false;
+        if (overlaps == false)
+        {
+            // Distance from the center of mass to the nearest point of the box
+            const float bx = std::max(fabsf(n.comX - gc[0]) - gh[0], 0.f);
+            const float by = std::max(fabsf(n.comY - gc[1]) - gh[1], 0.f);
+            const float bz = std::max(fabsf(n.comZ - gc[2]) - gh[2], 0.f);
+            const float side = 2.f * n.half;
+            take = (side * side < theta2 * (bx*bx + by*by + bz*bz));
+        }
+
+        if (take)
+        {
+            // The monopole of bodies with differing softening is short by
+            // about 6 var(eps) / (r + eps)^2; put that back in the mass.
+            const float dx = n.comX - gc[0];
+            const float dy = n.comY - gc[1];
+            const float dz = n.comZ - gc[2];
+            const float r = sqrtf(dx*dx + dy*dy + dz*dz) + n.eps;
+            list.x.push_back(n.comX);
+            list.y.push_back(n.comY);
+            list.z.push_back(n.comZ);
+            list.mass.push_back(n.mass * (1.f + 6.f * n.epsVar / (r * r)));
+            list.eps.push_back(n.eps);
+        }
+        else if (n.firstChild < 0)
+        {
+            const int b = n.bodyStart;
+            const int e = n.bodyStart + n.bodyCount;
+            list.x.insert(list.x.end(), m_sx.begin() + b, m_sx.begin() + e);
+            list.y.insert(list.y.end(), m_sy.begin() + b, m_sy.begin() + e);
+            list.z.insert(list.z.end(), m_sz.begin() + b, m_sz.begin() + e);
+            list.mass.insert(list.mass.end(), m_smass.begin() + b, m_smass.begin() + e);
+            list.eps.insert(list.eps.end(), m_seps.begin() + b, m_seps.begin() + e);
+        }
+        else
+        {
+            for (int c = 0; c < n.childCount; ++c)
+            {
+                stack[depth++] = n.firstChild + c;
+            }
+        }
+    }
+
+    const int listed = list.size();
+    for (int k = gBegin; k < gEnd; ++k)
+    {
+        float ax = 0.f, ay = 0.f, az = 0.f;
+        accumulatePairs(m_sx[k], m_sy[k], m_sz[k],
+            &list.x[0], &list.y[0], &list.z[0], &list.mass[0], &list.eps[0], listed, ax, ay, az);
+        _Kick(m_order[k], ax, ay, az);
+    }
+    return static_cast<double>(listed) * g.bodyCount;
+}
+
+/// Sort the bodies into an octree around their bounding cube, and copy
+/// them into leaf order for the pair kernel.
+void NBodySystem::_BuildTree()
+{
+    PROFILE_ZONE("nbody tree");
+    const int count = BodyCount();
+    float lo[3] = { m_x[0], m_y[0], m_z[0] };
+    float hi[3] = { m_x[0], m_y[0], m_z[0] };
+    for (int i = 1; i < count; ++i)
+    {
+        lo[0] = std::min(lo[0], m_x[i]); hi[0] = std::max(hi[0], m_x[i]);
+        lo[1] = std::min(lo[1], m_y[i]); hi[1] = std::max(hi[1], m_y[i]);
+        lo[2] = std::min(lo[2], m_z[i]); hi[2] = std::max(hi[2], m_z[i]);
+    }
+    const float half = 0.5f * std::max(std::max(hi[0] - lo[0], hi[1] - lo[1]), hi[2] - lo[2]);
+
+    m_order.resize(count);
+    m_sortScratch.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        m_order[i] = i;
+    }
+    m_nodes.clear();
+    m_nodes.resize(1);
+    m_leaves.clear();
+    _BuildNode(0, 0, count,
+        0.5f * (lo[0] + hi[0]), 0.5f * (lo[1] + hi[1]), 0.5f * (lo[2] + hi[2]),
+        1.0001f * half + 1.e-6f, 0);
+
+    m_sx.resize(count); m_sy.resize(count); m_sz.resize(count);
+    m_smass.resize(count); m_seps.resize(count);
+    for (int k = 0; k < count; ++k)
+    {
+        const int i = m_order[k];
+        m_sx[k] = m_x[i];
+        m_sy[k] = m_y[i];
+        m_sz[k] = m_z[i];
+        m_smass[k] = m_mass[i];
+        m_seps[k] = m_eps[i];
+    }
+}
+
+/// Fill in node idx for bodies m_order[begin, end) in the given cube. A
+/// node's children are allocated together, so they are contiguous.
+void NBodySystem::_BuildNode(int idx, int begin, int end, float cx, float cy, float cz, float half, int depth)
+{
+    treeNode n;
+    n.cx = cx; n.cy = cy; n.cz = cz;
+    n.half = half;
+    n.firstChild = -1;
+    n.childCount = 0;
+    n.bodyStart = begin;
+    n.bodyCount = end - begin;
+
+    double mass = 0., mx = 0., my = 0., mz = 0., meps = 0., meps2 = 0.;
+    if ((n.bodyCount <= s_leafSize) || (depth >= s_maxDepth))
+    {
+        m_leaves.push_back(idx);
+        for (int k = begin; k < end; ++k)
+        {
+            const int i = m_order[k];
+            mass += m_mass[i];
+            mx += m_mass[i] * m_x[i];
+            my += m_mass[i] * m_y[i];
+            mz += m_mass[i] * m_z[i];
+            meps += m_mass[i] * m_eps[i];
+            meps2 += m_mass[i] * m_eps[i] * m_eps[i];
+        }
+    }
+    else
+    {
+        // Counting sort by octant: bit 0 is x, 1 is y, 2 is z.
+        int counts[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        for (int k = begin; k < end; ++k)
+        {
+            const int i = m_order[k];
+            ++counts[(m_x[i] >= cx ? 1 : 0) | (m_y[i] >= cy ? 2 : 0) | (m_z[i] >= cz ? 4 : 0)];
+        }
+        int starts[8];
+        int next[8];
+        int children = 0;
+        for (int o = 0; o < 8; ++o)
+        {
+            starts[o] = (o == 0) ? begin : (starts[o-1] + counts[o-1]);
+            next[o] = starts[o];
+            if (counts[o] > 0) ++children;
+        }
+        for (int k = begin; k < end; ++k)
+        {
+            const int i = m_order[k];
+            m_sortScratch[next[(m_x[i] >= cx ? 1 : 0) | (m_y[i] >= cy ? 2 : 0) | (m_z[i] >= cz ? 4 : 0)]++] = i;
+        }
+        std::copy(m_sortScratch.begin() + begin, m_sortScratch.begin() + end, m_order.begin() + begin);
+
+        n.firstChild = static_cast<int>(m_nodes.size());
+        n.childCount = children;
+        m_nodes.resize(m_nodes.size() + children);
+
+        const float q = 0.5f * half;
+        int child = n.firstChild;
+        for (int o = 0; o < 8; ++o)
+        {
+            if (counts[o] == 0)
+                continue;
+            _BuildNode(child, starts[o], starts[o] + counts[o],
+                cx + ((o & 1) ? q : -q), cy + ((o & 2) ? q : -q), cz + ((o & 4) ? q : -q),
+                q, depth + 1);
+            const treeNode& c = m_nodes[child];
+            mass += c.mass;
+            mx += c.mass * c.comX;
+            my += c.mass * c.comY;
+            mz += c.mass * c.comZ;
+            meps += c.mass * c.eps;
+            meps2 += c.mass * (c.epsVar + c.eps * c.eps);
+            ++child;
+        }
+    }
+
+    n.mass = static_cast<float>(mass);
+    if (mass > 0.)
+    {
+        n.comX = static_cast<float>(mx / mass);
+        n.comY = static_cast<float>(my / mass);
+        n.comZ = static_cast<float>(mz / mass);
+        n.eps = static_cast<float>(meps / mass);
+        n.epsVar = static_cast<float>(std::max(meps2 / mass - (meps / mass) * (meps / mass), 0.));
+    }
+    else
+    {
+        n.comX = cx; n.comY = cy; n.comZ = cz;
+        n.eps = 1.f;
+        n.epsVar = 0.f;
+    }
+    m_nodes[idx] = n;
+}
+
+/// Log the rate once a second, like the frame pipeline does.
+void NBodySystem::_Report(double interactions, double seconds)
+{
+    m_stepSeconds = seconds;
+    m_interactionsPerSecond = (seconds > 0.) ? (interactions / seconds) : 0.;
+
+    m_reportInteractions += interactions;
+    m_reportSeconds += seconds;
+    ++m_reportSteps;
+    const double now = m_timer.seconds();
+    if (now - m_reportStart < 1.)
+        return;
+
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(1);
+    oss << "NBody (" << ((m_method == NBodyTree) ? "tree" : "direct") << ", "
+        << BodyCount() << " bodies, " << JobSystem::Instance().WorkerCount() << " workers): "
+        << 1.e-6 * m_reportInteractions / std::max(m_reportSeconds, 1.e-9) << " M interactions/s"
+        << ", " << 1000. * m_reportSeconds / m_reportSteps << " ms/step";
+    LOG_INFO("%s", oss.str().c_str());
+
+    m_reportStart = now;
+    m_reportInteractions = 0.;
+    m_reportSeconds = 0.;
+    m_reportSteps = 0;
+}
+
+//
+// Lua interface
+//
+
+int fc_nbody_init(int count, const float* pPositions, const float* pAttributes, const float* pVelocities)
+{
+    NBodySystem& nb = NBodySystem::Instance();
+    return nb.Init(count, pPositions, pAttributes, pVelocities) ? nb.BodyCount() : 0;
+}
+
+void fc_nbody_clear()
+{
+    NBodySystem::Instance().Clear();
+}
+
+void fc_nbody_set_method(int method)
+{
+    if ((method >= 0) && (method < NBodyMethodCount))
+    {
+        NBodySystem::Instance().SetMethod(static_cast<NBodyMethod>(method));
+    }
+}
+
+void fc_nbody_set_theta(float theta)
+{
+    NBodySystem::Instance().SetTheta(theta);
+}
+
+void fc_nbody_step(float dt, float* pPositionsOut)
+{
+    NBodySystem::Instance().Step(dt, pPositionsOut);
+}
+
+int fc_nbody_step_to_buffer(float dt, unsigned int vbo)
+{
+    return NBodySystem::Instance().StepToBuffer(dt, vbo) ? 1 : 0;
+}
+
+double fc_nbody_interactions_per_second()
+{
+    return NBodySystem::Instance().InteractionsPerSecond();
+}
+
+double fc_nbody_step_seconds()
+{
+    return NBodySystem::Instance().StepSeconds();
+}
+
+const char* fc_nbody_kernel_name()
+{
+    return NBodySystem::KernelName();
+}
+
+const NBodyApi* GetNBodyApi()
+{
+    static const NBodyApi api = {
+        fc_nbody_init,
+        fc_nbody_clear,
+        fc_nbody_set_method,
+        fc_nbody_set_theta,
+        fc_nbody_step,
+        fc_nbody_step_to_buffer,
+        fc_nbody_interactions_per_second,
+        fc_nbody_step_seconds,
+        fc_nbody_kernel_name,
+    };
+    return &api;
+}
@@ -0,0 +1,170 @@
+// NBodySystem.h
+
+#pragma once
+
+#include "Singleton.h"
+#include "GL_Includes.h"
+#include "Timer.h"
+
+#include <vector>
+
+/// How NBodySystem finds each body's acceleration.
+enum NBodyMethod {
+    NBodyDirect = 0,   ///< Every pair, O(N^2)
+    NBodyTree,         ///< Barnes-Hut octree, O(N log N)
+    NBodyMethodCount
+};
+
+///@brief Gravitational n-body integration on the CPU, for nbody07 where
+/// there are no compute shaders. The physics is that of its accel and
+/// integ shaders: acceleration from each body j is
+/// -m_j * d / (|d| + eps_j)^3, with eps_j the body's softening, and a
+/// velocity Verlet step.
+///
+/// Bodies are held as separate x, y, z arrays so the pair kernel can take
+/// four sources at a time in SSE2 or NEON registers. Each step is two
+/// parallel-fors on the JobSystem workers: accelerations and velocities,
+/// then positions, which are written as x,y,z,1 straight into the
+/// caller's array or a mapped vertex buffer.
+///
+/// NBodyTree sorts the bodies into an octree each step. Each leaf then
+/// walks it once for all its bodies, gathering the bodies of nearby leaves
+/// and the centers of mass of cells that are small enough as seen from
+/// anywhere in the leaf, and runs the same pair kernel over that list for
+/// each of them. The parallel-for is over leaves rather than bodies.
+class NBodySystem : public Singleton
+{
+public:
+    static NBodySystem& Instance()
+    {
+        static NBodySystem instance;
+        return instance;
+    }
+
+    bool Init(int count, const float* pPositions, const float* pAttributes, const float* pVelocities);
+    void Clear();
+    int BodyCount() const { return static_cast<int>(m_x.size()); }
+
+    void SetMethod(NBodyMethod method) { m_method = method; }
+    NBodyMethod GetMethod() const { return m_method; }
+    void SetTheta(float theta) { m_theta = theta; }
+
+    void Step(float dt, float* pPositionsOut);
+    bool StepToBuffer(float dt, GLuint vbo);
+
+    double InteractionsPerSecond() const { return m_interactionsPerSecond; }
+    double StepSeconds() const { return m_stepSeconds; }
+
+    static const char* KernelName();
+
+    static const int s_leafSize = 16; ///< Bodies per octree leaf, at most
+    static const int s_maxDepth = 24; ///< Below this, leaves take any number
+    static const float s_defaultTheta; ///< 0.5; about 1% force error at 12k bodies
+
+protected:
+    struct treeNode {
+        float comX, comY, comZ;
+        float mass;
+        float eps;            ///< Mass-weighted softening of what is inside
+        float epsVar;         ///< Their mass-weighted variance
+        float cx, cy, cz;     ///< Center of the cube
+        float half;           ///< Half its side
+        int firstChild;       ///< -1 for a leaf
+        int childCount;
+        int bodyStart;        ///< Into the sorted arrays
+        int bodyCount;
+    };
+
+    /// Sources for the pair kernel, gathered by a tree walk.
+    struct interactionList {
+        std::vector<float> x, y, z, mass, eps;
+        void clear() { x.clear(); y.clear(); z.clear(); mass.clear(); eps.clear(); }
+        int size() const { return static_cast<int>(x.size()); }
+    };
+
+    static void _AccelerationKernel(void* pArg, int begin, int end);
+    static void _TreeKernel(void* pArg, int begin, int end);
+    static void _IntegrateKernel(void* pArg, int begin, int end);
+    double _Accelerate(int begin, int end);
+    double _TreeGroup(int leaf, interactionList& list);
+    void _Kick(int i, float ax, float ay, float az);
+
+    void _BuildTree();
+    void _BuildNode(int idx, int begin, int end, float cx, float cy, float cz, float half, int depth);
+    void _Report(double interactions, double seconds);
+
+    // Body state, in the order given to Init
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<float> m_vx, m_vy, m_vz;
+    std::vector<float> m_ax, m_ay, m_az;
+    std::vector<float> m_mass, m_eps;
+
+    // NBodyTree: the sources sorted into leaf order, and the tree over them
+    std::vector<int> m_order;
+    std::vector<int> m_sortScratch; ///< Order within a node while it is split
+    std::vector<float> m_sx, m_sy, m_sz, m_smass, m_seps;
+    std::vector<treeNode> m_nodes;
+    std::vector<int> m_leaves;
+
+    NBodyMethod m_method;
+    float m_theta;          ///< Cells are taken whole when side < theta * distance
+
+    // Per step, for the kernels
+    float m_dt;
+    float* m_pOut;
+    int m_grain;
+    std::vector<double> m_chunkInteractions;
+    std::vector<float> m_staging;   ///< Positions, where the buffer cannot be mapped
+
+    Timer m_timer;
+    double m_stepSeconds;
+    double m_interactionsPerSecond;
+    double m_reportStart;
+    double m_reportInteractions;
+    double m_reportSeconds;
+    int m_reportSteps;
+
+private:
+    NBodySystem();
+    ~NBodySystem();
+    NBodySystem(NBodySystem const& copy);            // Not Implemented
+    NBodySystem& operator=(NBodySystem const& copy); // Not Implemented
+};
+
+#if defined(_WIN32)
+#  define NBODY_EXPORT __declspec(dllexport)
+#else
+#  define NBODY_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// For Lua through ffi.C where the host exports its symbols. Arrays are
+/// of count x,y,z,w quadruples as nbody07 keeps them; attributes are
+/// mass, softening, brightness, radius.
+/// Must match the cdef in deploy/lua/util/nbody.lua.
+extern "C" {
+NBODY_EXPORT int    fc_nbody_init(int count, const float* pPositions, const float* pAttributes, const float* pVelocities);
+NBODY_EXPORT void   fc_nbody_clear();
+NBODY_EXPORT void   fc_nbody_set_method(int method);
+NBODY_EXPORT void   fc_nbody_set_theta(float theta);
+NBODY_EXPORT void   fc_nbody_step(float dt, float* pPositionsOut);
+NBODY_EXPORT int    fc_nbody_step_to_buffer(float dt, unsigned int vbo);
+NBODY_EXPORT double fc_nbody_interactions_per_second();
+NBODY_EXPORT double fc_nbody_step_seconds();
+NBODY_EXPORT const char* fc_nbody_kernel_name();
+}
+
+/// The same functions as pointers, handed to Lua as native_nbody_api for
+/// hosts that do not export symbols (e.g. the Android .so).
+struct NBodyApi {
+    int    (*fc_nbody_init)(int count, const float* pPositions, const float* pAttributes, const float* pVelocities);
+    void   (*fc_nbody_clear)();
+    void   (*fc_nbody_set_method)(int method);
+    void   (*fc_nbody_set_theta)(float theta);
+    void   (*fc_nbody_step)(float dt, float* pPositionsOut);
+    int    (*fc_nbody_step_to_buffer)(float dt, unsigned int vbo);
+    double (*fc_nbody_interactions_per_second)();
+    double (*fc_nbody_step_seconds)();
+    const char* (*fc_nbody_kernel_name)();
+};
+
+const NBodyApi* GetNBodyApi();
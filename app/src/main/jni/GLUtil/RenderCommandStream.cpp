@@ -0,0 +1,306 @@
+// RenderCommandStream.cpp
+
+#include "RenderCommandStream.h"
+#include "Logging.h"
+
+#include <stddef.h>
+
+RenderCommandStream::RenderCommandStream()
+: m_recordIdx(0)
+{
+}
+
+RenderCommandStream::~RenderCommandStream()
+{
+}
+
+void RenderCommandStream::Push(RenderCommandType type, int i0, int i1, int i2, int i3)
+{
+    renderCommand c;
+    c.type = type;
+    c.i[0] = i0;
+    c.i[1] = i1;
+    c.i[2] = i2;
+    c.i[3] = i3;
+    c.f[0] = c.f[1] = c.f[2] = c.f[3] = 0.f;
+    c.dataOffset = 0;
+    m_frames[m_recordIdx].commands.push_back(c);
+}
+
+void RenderCommandStream::PushFloats(RenderCommandType type, int i0, float f0, float f1, float f2, float f3)
+{
+    renderCommand c;
+    c.type = type;
+    c.i[0] = i0;
+    c.i[1] = c.i[2] = c.i[3] = 0;
+    c.f[0] = f0;
+    c.f[1] = f1;
+    c.f[2] = f2;
+    c.f[3] = f3;
+    c.dataOffset = 0;
+    m_frames[m_recordIdx].commands.push_back(c);
+}
+
+///@brief Copy count 4x4 matrices for glUniformMatrix4fv.
+void RenderCommandStream::PushMatrices(int location, int count, bool transpose, const float* pValues)
+{
+    if ((pValues == NULL) || (count <= 0) || (count > s_maxMatrices))
+    {
+        LOG_ERROR("RenderCommandStream: cannot record %d matrices.", count);
+        return;
+    }
+
+    commandFrame& f = m_frames[m_recordIdx];
+    renderCommand c;
+    c.type = CmdUniformMatrix4fv;
+    c.i[0] = location;
+    c.i[1] = count;
+    c.i[2] = transpose ? 1 : 0;
+    c.i[3] = 0;
+    c.f[0] = c.f[1] = c.f[2] = c.f[3] = 0.f;
+    c.dataOffset = static_cast<unsigned int>(f.floats.size());
+    f.floats.insert(f.floats.end(), pValues, pValues + 16 * count);
+    f.commands.push_back(c);
+}
+
+///@brief The one call with five integer arguments: the instance count
+/// rides in the first float slot.
+void RenderCommandStream::PushDrawElementsInstanced(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances)
+{
+    renderCommand c;
+    c.type = CmdDrawElementsInstanced;
+    c.i[0] = static_cast<int>(mode);
+    c.i[1] = count;
+    c.i[2] = static_cast<int>(type);
+    c.i[3] = static_cast<int>(offset);
+    c.f[0] = static_cast<float>(instances);
+    c.f[1] = c.f[2] = c.f[3] = 0.f;
+    c.dataOffset = 0;
+    m_frames[m_recordIdx].commands.push_back(c);
+}
+
+///@brief Make the recorded frame the one Execute plays and start
+/// recording over the one it played before.
+///@warning Neither Execute nor recording may be under way.
+void RenderCommandStream::Swap()
+{
+    m_recordIdx ^= 1;
+    ClearRecording();
+}
+
+///@brief Throw away what has been recorded since the last Swap.
+void RenderCommandStream::ClearRecording()
+{
+    commandFrame& f = m_frames[m_recordIdx];
+    f.commands.clear();
+    f.floats.clear();
+}
+
+///@brief Make the GL calls of the frame last swapped in, in order.
+void RenderCommandStream::Execute() const
+{
+    const commandFrame& f = m_frames[m_recordIdx ^ 1];
+    for (std::vector<renderCommand>::const_iterator it = f.commands.begin();
+        it != f.commands.end();
+        ++it)
+    {
+        _Execute(f, *it);
+    }
+}
+
+void RenderCommandStream::_Execute(const commandFrame& frame, const renderCommand& c) const
+{
+    const int* i = c.i;
+    const float* f = c.f;
+    switch (c.type)
+    {
+    default:
+        break;
+
+    case CmdViewport:     glViewport(i[0], i[1], i[2], i[3]); break;
+    case CmdClearColor:   glClearColor(f[0], f[1], f[2], f[3]); break;
+    case CmdClear:        glClear(static_cast<GLbitfield>(i[0])); break;
+    case CmdEnable:       glEnable(static_cast<GLenum>(i[0])); break;
+    case CmdDisable:      glDisable(static_cast<GLenum>(i[0])); break;
+    case CmdBlendFunc:    glBlendFunc(static_cast<GLenum>(i[0]), static_cast<GLenum>(i[1])); break;
+    case CmdDepthMask:    glDepthMask(i[0] != 0 ? GL_TRUE : GL_FALSE); break;
+    case CmdUseProgram:   glUseProgram(static_cast<GLuint>(i[0])); break;
+    case CmdBindVertexArray: glBindVertexArray(static_cast<GLuint>(i[0])); break;
+    case CmdBindBuffer:   glBindBuffer(static_cast<GLenum>(i[0]), static_cast<GLuint>(i[1])); break;
+    case CmdActiveTexture: glActiveTexture(static_cast<GLenum>(i[0])); break;
+    case CmdBindTexture:  glBindTexture(static_cast<GLenum>(i[0]), static_cast<GLuint>(i[1])); break;
+    case CmdUniform1i:    glUniform1i(i[0], i[1]); break;
+    case CmdUniform1f:    glUniform1f(i[0], f[0]); break;
+    case CmdUniform2f:    glUniform2f(i[0], f[0], f[1]); break;
+    case CmdUniform3f:    glUniform3f(i[0], f[0], f[1], f[2]); break;
+    case CmdUniform4f:    glUniform4f(i[0], f[0], f[1], f[2], f[3]); break;
+
+    case CmdUniformMatrix4fv:
+        glUniformMatrix4fv(i[0], i[1], i[2] != 0 ? GL_TRUE : GL_FALSE, &frame.floats[c.dataOffset]);
+        break;
+
+    case CmdDrawArrays:
+        glDrawArrays(static_cast<GLenum>(i[0]), i[1], i[2]);
+        break;
+
+    case CmdDrawElements:
+        glDrawElements(static_cast<GLenum>(i[0]), i[1], static_cast<GLenum>(i[2]),
+            reinterpret_cast<const void*>(static_cast<size_t>(static_cast<unsigned int>(i[3]))));
+        break;
+
+    case CmdDrawArraysInstanced:
+        glDrawArraysInstanced(static_cast<GLenum>(i[0]), i[1], i[2], i[3]);
+        break;
+
+    case CmdDrawElementsInstanced:
+        glDrawElementsInstanced(static_cast<GLenum>(i[0]), i[1], static_cast<GLenum>(i[2]),
+            reinterpret_cast<const void*>(static_cast<size_t>(static_cast<unsigned int>(i[3]))),
+            static_cast<GLsizei>(f[0]));
+        break;
+    }
+}
+
+
+extern "C" {
+
+void fc_cmd_viewport(int x, int y, int w, int h)
+{
+    RenderCommandStream::Instance().Push(CmdViewport, x, y, w, h);
+}
+
+void fc_cmd_clear_color(float r, float g, float b, float a)
+{
+    RenderCommandStream::Instance().PushFloats(CmdClearColor, 0, r, g, b, a);
+}
+
+void fc_cmd_clear(unsigned int mask)
+{
+    RenderCommandStream::Instance().Push(CmdClear, static_cast<int>(mask));
+}
+
+void fc_cmd_enable(unsigned int cap)
+{
+    RenderCommandStream::Instance().Push(CmdEnable, static_cast<int>(cap));
+}
+
+void fc_cmd_disable(unsigned int cap)
+{
+    RenderCommandStream::Instance().Push(CmdDisable, static_cast<int>(cap));
+}
+
+void fc_cmd_blend_func(unsigned int sfactor, unsigned int dfactor)
+{
+    RenderCommandStream::Instance().Push(CmdBlendFunc, static_cast<int>(sfactor), static_cast<int>(dfactor));
+}
+
+void fc_cmd_depth_mask(int flag)
+{
+    RenderCommandStream::Instance().Push(CmdDepthMask, flag);
+}
+
+void fc_cmd_use_program(unsigned int program)
+{
+    RenderCommandStream::Instance().Push(CmdUseProgram, static_cast<int>(program));
+}
+
+void fc_cmd_bind_vertex_array(unsigned int vao)
+{
+    RenderCommandStream::Instance().Push(CmdBindVertexArray, static_cast<int>(vao));
+}
+
+void fc_cmd_bind_buffer(unsigned int target, unsigned int buffer)
+{
+    RenderCommandStream::Instance().Push(CmdBindBuffer, static_cast<int>(target), static_cast<int>(buffer));
+}
+
+void fc_cmd_active_texture(unsigned int unit)
+{
+    RenderCommandStream::Instance().Push(CmdActiveTexture, static_cast<int>(unit));
+}
+
+void fc_cmd_bind_texture(unsigned int target, unsigned int texture)
+{
+    RenderCommandStream::Instance().Push(CmdBindTexture, static_cast<int>(target), static_cast<int>(texture));
+}
+
+void fc_cmd_uniform1i(int location, int v)
+{
+    RenderCommandStream::Instance().Push(CmdUniform1i, location, v);
+}
+
+void fc_cmd_uniform1f(int location, float v)
+{
+    RenderCommandStream::Instance().PushFloats(CmdUniform1f, location, v);
+}
+
+void fc_cmd_uniform2f(int location, float x, float y)
+{
+    RenderCommandStream::Instance().PushFloats(CmdUniform2f, location, x, y);
+}
+
+void fc_cmd_uniform3f(int location, float x, float y, float z)
+{
+    RenderCommandStream::Instance().PushFloats(CmdUniform3f, location, x, y, z);
+}
+
+void fc_cmd_uniform4f(int location, float x, float y, float z, float w)
+{
+    RenderCommandStream::Instance().PushFloats(CmdUniform4f, location, x, y, z, w);
+}
+
+void fc_cmd_uniform_matrix4fv(int location, int count, int transpose, const float* pValues)
+{
+    RenderCommandStream::Instance().PushMatrices(location, count, transpose != 0, pValues);
+}
+
+void fc_cmd_draw_arrays(unsigned int mode, int first, int count)
+{
+    RenderCommandStream::Instance().Push(CmdDrawArrays, static_cast<int>(mode), first, count);
+}
+
+void fc_cmd_draw_elements(unsigned int mode, int count, unsigned int type, unsigned int offset)
+{
+    RenderCommandStream::Instance().Push(CmdDrawElements,
+        static_cast<int>(mode), count, static_cast<int>(type), static_cast<int>(offset));
+}
+
+void fc_cmd_draw_arrays_instanced(unsigned int mode, int first, int count, int instances)
+{
+    RenderCommandStream::Instance().Push(CmdDrawArraysInstanced, static_cast<int>(mode), first, count, instances);
+}
+
+void fc_cmd_draw_elements_instanced(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances)
+{
+    RenderCommandStream::Instance().PushDrawElementsInstanced(mode, count, type, offset, instances);
+}
+
+}
+
+const RenderCommandApi* GetRenderCommandApi()
+{
+    static const RenderCommandApi api = {
+        fc_cmd_viewport,
+        fc_cmd_clear_color,
+        fc_cmd_clear,
+        fc_cmd_enable,
+        fc_cmd_disable,
+        fc_cmd_blend_func,
+        fc_cmd_depth_mask,
+        fc_cmd_use_program,
+        fc_cmd_bind_vertex_array,
+        fc_cmd_bind_buffer,
+        fc_cmd_active_texture,
+        fc_cmd_bind_texture,
+        fc_cmd_uniform1i,
+        fc_cmd_uniform1f,
+        fc_cmd_uniform2f,
+        fc_cmd_uniform3f,
+        fc_cmd_uniform4f,
+        fc_cmd_uniform_matrix4fv,
+        fc_cmd_draw_arrays,
+        fc_cmd_draw_elements,
+        fc_cmd_draw_arrays_instanced,
+        fc_cmd_draw_elements_instanced,
+    };
+    return &api;
+}
@@ -0,0 +1,156 @@
+// RenderCommandStream.h
+
+#pragma once
+
+#include "Singleton.h"
+#include "GL_Includes.h"
+
+#include <vector>
+
+/// What a renderCommand does; each names the GL call Execute makes for it.
+enum RenderCommandType {
+    CmdViewport = 0,
+    CmdClearColor,
+    CmdClear,
+    CmdEnable,
+    CmdDisable,
+    CmdBlendFunc,
+    CmdDepthMask,
+    CmdUseProgram,
+    CmdBindVertexArray,
+    CmdBindBuffer,
+    CmdActiveTexture,
+    CmdBindTexture,
+    CmdUniform1i,
+    CmdUniform1f,
+    CmdUniform2f,
+    CmdUniform3f,
+    CmdUniform4f,
+    CmdUniformMatrix4fv,
+    CmdDrawArrays,
+    CmdDrawElements,
+    CmdDrawArraysInstanced,
+    CmdDrawElementsInstanced,
+    CmdTypeCount
+};
+
+///@brief GL calls recorded on one thread to be made on another.
+/// The logic thread records a frame's draw calls, with their arguments
+/// copied, while the render thread (see RenderThread.h) replays the frame
+/// recorded before it. There are two frames: Swap, called when neither
+/// thread is in one, turns the recorded frame into the one Execute plays
+/// and clears the other for recording. Both keep their storage, so after
+/// the first few frames recording allocates nothing.
+///@note Only calls whose arguments can be copied are recorded; anything
+/// that reads back from GL or creates objects is made directly while the
+/// recording thread holds the context.
+class RenderCommandStream : public Singleton
+{
+public:
+    static RenderCommandStream& Instance()
+    {
+        static RenderCommandStream instance;
+        return instance;
+    }
+
+    void Push(RenderCommandType type, int i0 = 0, int i1 = 0, int i2 = 0, int i3 = 0);
+    void PushFloats(RenderCommandType type, int i0, float f0, float f1 = 0.f, float f2 = 0.f, float f3 = 0.f);
+    void PushMatrices(int location, int count, bool transpose, const float* pValues);
+    void PushDrawElementsInstanced(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances);
+
+    void Swap();
+    void ClearRecording();
+    void Execute() const;
+
+    int RecordedCount() const { return static_cast<int>(m_frames[m_recordIdx].commands.size()); }
+    int ExecutableCount() const { return static_cast<int>(m_frames[m_recordIdx ^ 1].commands.size()); }
+
+    static const int s_maxMatrices = 64; ///< Per CmdUniformMatrix4fv
+
+protected:
+    struct renderCommand {
+        int type;
+        int i[4];
+        float f[4];
+        unsigned int dataOffset; ///< Into the frame's floats, for matrices
+    };
+
+    struct commandFrame {
+        std::vector<renderCommand> commands;
+        std::vector<float> floats;
+    };
+
+    void _Execute(const commandFrame& frame, const renderCommand& c) const;
+
+    commandFrame m_frames[2];
+    int m_recordIdx; ///< The other frame is the one Execute plays
+
+private:
+    RenderCommandStream();
+    ~RenderCommandStream();
+    RenderCommandStream(RenderCommandStream const& copy);            // Not Implemented
+    RenderCommandStream& operator=(RenderCommandStream const& copy); // Not Implemented
+};
+
+#if defined(_WIN32)
+#  define RENDERCOMMAND_EXPORT __declspec(dllexport)
+#else
+#  define RENDERCOMMAND_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// Recording for Lua through ffi.C where the host exports its symbols.
+/// Arguments are those of the GL call of the same name.
+/// Must match the cdef in deploy/lua/util/rendercommands.lua.
+extern "C" {
+RENDERCOMMAND_EXPORT void fc_cmd_viewport(int x, int y, int w, int h);
+RENDERCOMMAND_EXPORT void fc_cmd_clear_color(float r, float g, float b, float a);
+RENDERCOMMAND_EXPORT void fc_cmd_clear(unsigned int mask);
+RENDERCOMMAND_EXPORT void fc_cmd_enable(unsigned int cap);
+RENDERCOMMAND_EXPORT void fc_cmd_disable(unsigned int cap);
+RENDERCOMMAND_EXPORT void fc_cmd_blend_func(unsigned int sfactor, unsigned int dfactor);
+RENDERCOMMAND_EXPORT void fc_cmd_depth_mask(int flag);
+RENDERCOMMAND_EXPORT void fc_cmd_use_program(unsigned int program);
+RENDERCOMMAND_EXPORT void fc_cmd_bind_vertex_array(unsigned int vao);
+RENDERCOMMAND_EXPORT void fc_cmd_bind_buffer(unsigned int target, unsigned int buffer);
+RENDERCOMMAND_EXPORT void fc_cmd_active_texture(unsigned int unit);
+RENDERCOMMAND_EXPORT void fc_cmd_bind_texture(unsigned int target, unsigned int texture);
+RENDERCOMMAND_EXPORT void fc_cmd_uniform1i(int location, int v);
+RENDERCOMMAND_EXPORT void fc_cmd_uniform1f(int location, float v);
+RENDERCOMMAND_EXPORT void fc_cmd_uniform2f(int location, float x, float y);
+RENDERCOMMAND_EXPORT void fc_cmd_uniform3f(int location, float x, float y, float z);
+RENDERCOMMAND_EXPORT void fc_cmd_uniform4f(int location, float x, float y, float z, float w);
+RENDERCOMMAND_EXPORT void fc_cmd_uniform_matrix4fv(int location, int count, int transpose, const float* pValues);
+RENDERCOMMAND_EXPORT void fc_cmd_draw_arrays(unsigned int mode, int first, int count);
+RENDERCOMMAND_EXPORT void fc_cmd_draw_elements(unsigned int mode, int count, unsigned int type, unsigned int offset);
+RENDERCOMMAND_EXPORT void fc_cmd_draw_arrays_instanced(unsigned int mode, int first, int count, int instances);
+RENDERCOMMAND_EXPORT void fc_cmd_draw_elements_instanced(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances);
+}
+
+/// The same functions as pointers, handed to Lua as native_render_api for
+/// hosts that do not export symbols (e.g. the Android .so).
+struct RenderCommandApi {
+    void (*fc_cmd_viewport)(int x, int y, int w, int h);
+    void (*fc_cmd_clear_color)(float r, float g, float b, float a);
+    void (*fc_cmd_clear)(unsigned int mask);
+    void (*fc_cmd_enable)(unsigned int cap);
+    void (*fc_cmd_disable)(unsigned int cap);
+    void (*fc_cmd_blend_func)(unsigned int sfactor, unsigned int dfactor);
+    void (*fc_cmd_depth_mask)(int flag);
+    void (*fc_cmd_use_program)(unsigned int program);
+    void (*fc_cmd_bind_vertex_array)(unsigned int vao);
+    void (*fc_cmd_bind_buffer)(unsigned int target, unsigned int buffer);
+    void (*fc_cmd_active_texture)(unsigned int unit);
+    void (*fc_cmd_bind_texture)(unsigned int target, unsigned int texture);
+    void (*fc_cmd_uniform1i)(int location, int v);
+    void (*fc_cmd_uniform1f)(int location, float v);
+    void (*fc_cmd_uniform2f)(int location, float x, float y);
+    void (*fc_cmd_uniform3f)(int location, float x, float y, float z);
+    void (*fc_cmd_uniform4f)(int location, float x, float y, float z, float w);
+    void (*fc_cmd_uniform_matrix4fv)(int location, int count, int transpose, const float* pValues);
+    void (*fc_cmd_draw_arrays)(unsigned int mode, int first, int count);
+    void (*fc_cmd_draw_elements)(unsigned int mode, int count, unsigned int type, unsigned int offset);
+    void (*fc_cmd_draw_arrays_instanced)(unsigned int mode, int first, int count, int instances);
+    void (*fc_cmd_draw_elements_instanced)(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances);
+};
+
+const RenderCommandApi* GetRenderCommandApi();
@@ -0,0 +1,228 @@
+// RenderThread.cpp
+
+#include "RenderThread.h"
+#include "RenderCommandStream.h"
+#include "Logging.h"
+
+RenderThread::RenderThread()
+: m_ctx()
+, m_thread()
+, m_timer()
+, m_callerHasContext(true)
+, m_mutex()
+, m_cond()
+, m_pending(false)
+, m_releaseRequested(false)
+, m_renderHasContext(false)
+, m_quit(false)
+, m_pendingStart(0.)
+, m_latency()
+, m_interval()
+, m_lastPresent(-1.)
+{
+    m_ctx.makeCurrent = NULL;
+    m_ctx.releaseCurrent = NULL;
+    m_ctx.swapBuffers = NULL;
+    m_ctx.pUser = NULL;
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+///@brief Start replaying on a new thread. The calling thread must have the
+/// context current; it keeps it until the first Submit.
+bool RenderThread::Start(const renderContextCallbacks& ctx)
+{
+    if (IsRunning())
+        return true;
+    if ((ctx.makeCurrent == NULL) || (ctx.releaseCurrent == NULL) || (ctx.swapBuffers == NULL))
+    {
+        LOG_ERROR("RenderThread: the host gave no context callbacks.");
+        return false;
+    }
+
+    m_ctx = ctx;
+    m_callerHasContext = true;
+    m_pending = false;
+    m_releaseRequested = false;
+    m_renderHasContext = false;
+    m_quit = false;
+    m_lastPresent = -1.;
+    ResetStats();
+    RenderCommandStream::Instance().ClearRecording();
+
+    if (m_thread.Start(_ThreadEntry, this) == false)
+    {
+        LOG_ERROR("RenderThread: could not start the thread.");
+        return false;
+    }
+    LOG_INFO("RenderThread: started");
+    return true;
+}
+
+///@brief Present the frame in flight, if any, and join the thread. The
+/// context ends up current on the calling thread again.
+void RenderThread::Stop()
+{
+    if (IsRunning() == false)
+        return;
+
+    {
+        ScopedLock lock(m_mutex);
+        m_quit = true;
+        m_cond.Broadcast();
+    }
+    m_thread.Join();
+
+    if (m_callerHasContext == false)
+    {
+        m_ctx.makeCurrent(m_ctx.pUser);
+        m_callerHasContext = true;
+    }
+    LOG_INFO("RenderThread: stopped");
+}
+
+///@brief Wait for the frame in flight to be presented and take the context
+/// back, so the calling thread can make GL calls until its next Submit.
+void RenderThread::AcquireContext()
+{
+    if (m_callerHasContext)
+        return;
+
+    {
+        ScopedLock lock(m_mutex);
+        while (m_pending)
+        {
+            m_cond.Wait(m_mutex);
+        }
+        if (m_renderHasContext)
+        {
+            m_releaseRequested = true;
+            m_cond.Broadcast();
+            while (m_releaseRequested)
+            {
+                m_cond.Wait(m_mutex);
+            }
+        }
+    }
+
+    m_ctx.makeCurrent(m_ctx.pUser);
+    m_callerHasContext = true;
+}
+
+///@brief Hand over everything recorded since the last Submit to be
+/// replayed and presented. Waits if the previous frame is still in flight.
+///@param frameStart When this frame's logic began, on Now's clock.
+void RenderThread::Submit(double frameStart)
+{
+    if (m_callerHasContext)
+    {
+        m_ctx.releaseCurrent(m_ctx.pUser);
+        m_callerHasContext = false;
+    }
+
+    ScopedLock lock(m_mutex);
+    while (m_pending)
+    {
+        m_cond.Wait(m_mutex);
+    }
+    RenderCommandStream::Instance().Swap();
+    m_pendingStart = frameStart;
+    m_pending = true;
+    m_cond.Broadcast();
+}
+
+///@brief Swap buffers for a frame the calling thread drew itself after
+/// AcquireContext, counting it in the same statistics.
+void RenderThread::PresentFromCaller(double frameStart)
+{
+    AcquireContext();
+    m_ctx.swapBuffers(m_ctx.pUser);
+    ScopedLock lock(m_mutex);
+    _AddPresent(frameStart);
+}
+
+///@brief Block until the frame in flight, if any, is on screen.
+void RenderThread::WaitIdle()
+{
+    ScopedLock lock(m_mutex);
+    while (m_pending)
+    {
+        m_cond.Wait(m_mutex);
+    }
+}
+
+void RenderThread::ResetStats()
+{
+    m_latency.Reset();
+    m_interval.Reset();
+}
+
+/// m_mutex must be locked.
+void RenderThread::_AddPresent(double frameStart)
+{
+    const double now = m_timer.seconds();
+    m_latency.AddSample(now - frameStart);
+    if (m_lastPresent >= 0.)
+    {
+        m_interval.AddSample(now - m_lastPresent);
+    }
+    m_lastPresent = now;
+}
+
+void RenderThread::_ThreadEntry(void* pArg)
+{
+    reinterpret_cast<RenderThread*>(pArg)->_RenderLoop();
+}
+
+void RenderThread::_RenderLoop()
+{
+    ScopedLock lock(m_mutex);
+    for (;;)
+    {
+        while ((m_pending == false) && (m_quit == false) && (m_releaseRequested == false))
+        {
+            m_cond.Wait(m_mutex);
+        }
+
+        if (m_releaseRequested)
+        {
+            if (m_renderHasContext)
+            {
+                m_ctx.releaseCurrent(m_ctx.pUser);
+                m_renderHasContext = false;
+            }
+            m_releaseRequested = false;
+            m_cond.Broadcast();
+            continue;
+        }
+
+        if (m_pending == false) // m_quit
+            break;
+
+        // The logic thread waits for m_pending to clear before touching the
+        // stream or the context, so neither needs the lock while we replay.
+        const double frameStart = m_pendingStart;
+        m_mutex.Unlock();
+        if (m_renderHasContext == false)
+        {
+            m_ctx.makeCurrent(m_ctx.pUser);
+        }
+        RenderCommandStream::Instance().Execute();
+        m_ctx.swapBuffers(m_ctx.pUser);
+        m_mutex.Lock();
+
+        m_renderHasContext = true;
+        _AddPresent(frameStart);
+        m_pending = false;
+        m_cond.Broadcast();
+    }
+
+    if (m_renderHasContext)
+    {
+        m_ctx.releaseCurrent(m_ctx.pUser);
+        m_renderHasContext = false;
+    }
+}
@@ -0,0 +1,76 @@
+// RenderThread.h
+
+#pragma once
+
+#include "Threads.h"
+#include "Timer.h"
+#include "FrameTimeHistogram.h"
+
+/// How the render thread gets at the host's GL context and window.
+/// makeCurrent and releaseCurrent are called on whichever thread is taking
+/// or giving up the context; swapBuffers with it current.
+struct renderContextCallbacks {
+    void (*makeCurrent)(void* pUser);
+    void (*releaseCurrent)(void* pUser);
+    void (*swapBuffers)(void* pUser);
+    void* pUser;
+};
+
+///@brief Replays recorded frames (see RenderCommandStream.h) on a thread
+/// of its own while the logic thread records the next.
+/// The GL context moves between the two threads: the render thread takes
+/// it to replay and present a submitted frame, and keeps it until the
+/// logic thread calls AcquireContext to make GL calls of its own (loading
+/// a scene, uploading textures, or drawing a frame directly). Submit gives
+/// it back. At most one frame is in flight, so the logic thread is never
+/// more than one frame ahead of what is on screen.
+///
+/// Each presented frame adds to two histograms: latency, from the start of
+/// the frame's logic to its swap, and the interval between swaps.
+class RenderThread
+{
+public:
+    RenderThread();
+    virtual ~RenderThread();
+
+    bool Start(const renderContextCallbacks& ctx);
+    void Stop();
+    bool IsRunning() const { return m_thread.IsRunning(); }
+
+    void AcquireContext();
+    void Submit(double frameStart);
+    void PresentFromCaller(double frameStart);
+    void WaitIdle();
+
+    double Now() const { return m_timer.seconds(); } ///< The clock frame starts are on
+
+    const FrameTimeHistogram& GetLatency() const { return m_latency; }
+    const FrameTimeHistogram& GetInterval() const { return m_interval; }
+    void ResetStats();
+
+protected:
+    static void _ThreadEntry(void* pArg);
+    void _RenderLoop();
+    void _AddPresent(double frameStart);
+
+    renderContextCallbacks m_ctx;
+    Thread m_thread;
+    Timer m_timer;
+    bool m_callerHasContext;  ///< Logic thread only
+
+    Mutex m_mutex;
+    ConditionVariable m_cond;
+    bool m_pending;           ///< Guarded by m_mutex; a submitted frame not yet presented
+    bool m_releaseRequested;  ///< Guarded by m_mutex
+    bool m_renderHasContext;  ///< Guarded by m_mutex
+    bool m_quit;              ///< Guarded by m_mutex
+    double m_pendingStart;    ///< Guarded by m_mutex
+
+    FrameTimeHistogram m_latency;
+    FrameTimeHistogram m_interval;
+    double m_lastPresent;     ///< Guarded by m_mutex; negative before the first
+
+private: // Disallow copy ctor and assignment operator
+    RenderThread(const RenderThread&);
+    RenderThread& operator=(const RenderThread&);
+};
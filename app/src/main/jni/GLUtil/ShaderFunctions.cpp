@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include <string>
+#include <vector>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -11,6 +12,7 @@
 #include "GL_Includes.h"
 
 #include "ShaderFunctions.h"
+#include "AssetArchive.h"
 #include "Logging.h"
 #ifdef __ANDROID__
 #define LOG_INFO(...) LOGI(__VA_ARGS__)
@@ -22,6 +24,13 @@
 #endif
 
 #include "g_shaders.h"
+#include "DataDirectoryLocation.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 // Convenience wrapper for setting uniform variables
 GLint getUniLoc(const GLuint program, const GLchar *name)
@@ -106,10 +115,28 @@ const std::string GetShaderSourceFromFile(const char* filename)
 }
 #endif
 
-// Return shader source from filename, if it can be retrieved.
-// If not, fall back to the hard-coded array in our global std::map.
+// Look the shader up in the asset archive, where tools/make_asset_archive.py
+// packs shaders/ under the same name.
+const std::string GetShaderSourceFromArchive(const char* filename)
+{
+    const std::string shaderName = std::string("shaders/") + filename;
+
+    AssetFile file;
+    if (!file.Open(shaderName.c_str()) || (file.Size() == 0))
+        return "";
+    return std::string(reinterpret_cast<const char*>(file.Data()), file.Size());
+}
+
+// Return shader source from filename, if it can be retrieved from the asset
+// archive or the file system. If not, fall back to the hard-coded array in
+// our global std::map.
 const std::string GetShaderSource(const char* filename)
 {
+    const std::string archiveSrc = GetShaderSourceFromArchive(filename);
+    if (archiveSrc.empty() == false)
+    {
+        return archiveSrc;
+    }
 #if LOAD_SHADERS_FROM_FILESYSTEM
     const std::string fileSrc = GetShaderSourceFromFile(filename);
     if (fileSrc.empty() == false)
@@ -133,15 +160,19 @@ void myReplace(std::string& str,
     }
 }
 
-// Once source is obtained from either file or hard-coded map, compile the
-// shader, release the string memory and return the ID.
-GLuint loadShaderFile(const char* filename, const unsigned long Type)
+// Fetch shader source by filename and patch it up for the platform.
+static std::string getPlatformShaderSource(const char* filename)
 {
     std::string shaderSource = GetShaderSource(filename);
 #ifdef _MACOS
     myReplace(shaderSource, "#version 310 es", "#version 330");
 #endif
-    
+    return shaderSource;
+}
+
+// Compile the given source, returning the ID or 0 if source is empty.
+static GLuint compileShaderSource(const std::string& shaderSource, const unsigned long Type)
+{
     if (shaderSource.empty())
         return 0;
     GLint length = shaderSource.length();
@@ -156,53 +187,205 @@ GLuint loadShaderFile(const char* filename, const unsigned long Type)
     return shaderId;
 }
 
-// Append any applicable suffixes to the name given and attempt to find
-// vertex, fragment and (optionally) geometry shader source.
-GLuint makeShaderByName(const char* name)
+// Once source is obtained from either file or hard-coded map, compile the
+// shader, release the string memory and return the ID.
+GLuint loadShaderFile(const char* filename, const unsigned long Type)
 {
-    if (!name)
-        return 0;
+    return compileShaderSource(getPlatformShaderSource(filename), Type);
+}
 
-    std::string vs(name);
-    std::string fs(name);
-    vs += ".vert";
-    fs += ".frag";
+// Linked programs are saved with glGetProgramBinary under
+// APP_DATA_DIRECTORY/shadercache/ and reloaded with glProgramBinary on the
+// next launch, skipping compilation. Each file is named for its pair of
+// shader filenames and its header records the source and driver it came
+// from; any mismatch or load failure falls back to compiling from source,
+// which then overwrites the stale entry.
+struct programCacheHeader {
+    unsigned int magic;
+    unsigned int sourceHash;   ///< Of both sources' text
+    unsigned int sourceLength; ///< Of both sources together
+    unsigned int driverHash;   ///< Of GL_VENDOR, GL_RENDERER and GL_VERSION
+    unsigned int binaryFormat;
+    unsigned int binaryLength;
+};
+
+static const unsigned int s_programCacheMagic = 0x31504346; // "FCP1"
+static const unsigned int s_maxProgramBinaryLength = 16 * 1024 * 1024;
+static int s_programCacheHits = 0;
+static int s_programCacheMisses = 0;
+
+// FNV-1a, continued from h.
+static unsigned int hashBytes(unsigned int h, const char* p, size_t len)
+{
+    for (size_t i=0; i<len; ++i)
+    {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
 
-    LOG_INFO("Create shader: [%s] ...", name);
+static unsigned int hashString(unsigned int h, const char* p)
+{
+    if (p == NULL)
+        return h;
+    // Include the terminator so "ab","c" and "a","bc" differ.
+    return hashBytes(h, p, strlen(p) + 1);
+}
 
-    GLint compileStatus = GL_FALSE;
+static unsigned int hashDriver()
+{
+    unsigned int h = 2166136261u;
+    h = hashString(h, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    h = hashString(h, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    h = hashString(h, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    return h;
+}
 
-    /// Vertex shader
-    GLuint vertSrc = loadShaderFile(vs.c_str(), GL_VERTEX_SHADER);
-    compileStatus = GL_FALSE;
-    glGetShaderiv(vertSrc, GL_COMPILE_STATUS, &compileStatus);
-    if (compileStatus == GL_FALSE)
+static bool programBinariesSupported()
+{
+#ifndef __ANDROID__
+    if ((glGetProgramBinary == NULL) ||
+        (glProgramBinary == NULL) ||
+        (glProgramParameteri == NULL))
     {
-        printShaderInfoLog(vertSrc);
+        return false;
     }
+#endif
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    return numFormats > 0;
+}
+
+static std::string programCacheDirectory()
+{
+    const std::string dataHome = APP_DATA_DIRECTORY;
+    return dataHome + "shadercache/";
+}
+
+static std::string programCacheFilename(unsigned int nameHash)
+{
+    std::ostringstream oss;
+    oss << programCacheDirectory() << std::hex << nameHash << ".bin";
+    return oss.str();
+}
 
-    /// Fragment shader
-    GLuint fragSrc = loadShaderFile(fs.c_str(), GL_FRAGMENT_SHADER);
-    compileStatus = GL_FALSE;
-    glGetShaderiv(fragSrc, GL_COMPILE_STATUS, &compileStatus);
-    if (compileStatus == GL_FALSE)
+static std::string programCacheFilename(const char* vert, const char* frag)
+{
+    unsigned int h = 2166136261u;
+    h = hashString(h, vert);
+    h = hashString(h, frag);
+    return programCacheFilename(h);
+}
+
+static void initProgramCacheHeader(programCacheHeader& header, unsigned int sourceHash, size_t sourceLength)
+{
+    header.magic = s_programCacheMagic;
+    header.sourceHash = sourceHash;
+    header.sourceLength = static_cast<unsigned int>(sourceLength);
+    header.driverHash = hashDriver();
+    header.binaryFormat = 0;
+    header.binaryLength = 0;
+}
+
+static void logProgramCacheResult(const char* result)
+{
+    LOG_INFO("  Program binary cache %s (%d hits, %d misses)",
+        result, s_programCacheHits, s_programCacheMisses);
+}
+
+// Return a program created from the cached binary for this header's source
+// and driver, or 0 if there is none or the driver rejects it.
+static GLuint loadCachedProgram(const std::string& filename, const programCacheHeader& want)
+{
+    FILE* pF = fopen(filename.c_str(), "rb");
+    if (pF == NULL)
+        return 0;
+
+    programCacheHeader have;
+    const bool headerRead = (fread(&have, sizeof(have), 1, pF) == 1);
+    if (!headerRead ||
+        (have.magic != want.magic) ||
+        (have.sourceHash != want.sourceHash) ||
+        (have.sourceLength != want.sourceLength) ||
+        (have.driverHash != want.driverHash) ||
+        (have.binaryLength == 0) ||
+        (have.binaryLength > s_maxProgramBinaryLength))
     {
-        printShaderInfoLog(fragSrc);
+        fclose(pF);
+        return 0;
     }
 
-    GLuint program = glCreateProgram();
+    std::vector<char> binary(have.binaryLength);
+    const bool binaryRead = (fread(&binary[0], 1, binary.size(), pF) == binary.size());
+    fclose(pF);
+    if (!binaryRead)
+        return 0;
 
-    glCompileShader(vertSrc);
-    glCompileShader(fragSrc);
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, have.binaryFormat, &binary[0], static_cast<GLsizei>(binary.size()));
 
-    glAttachShader(program, vertSrc);
-    glAttachShader(program, fragSrc);
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus != GL_TRUE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
 
-    // Will be deleted when program is.
-    glDeleteShader(vertSrc);
-    glDeleteShader(fragSrc);
+static void storeCachedProgram(GLuint program, const std::string& filename, programCacheHeader header)
+{
+    GLint binaryLength = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0)
+        return;
+
+    std::vector<char> binary(binaryLength);
+    GLsizei written = 0;
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, binaryLength, &written, &binaryFormat, &binary[0]);
+    if (written <= 0)
+        return;
+
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = static_cast<unsigned int>(written);
+
+    const std::string dir = programCacheDirectory();
+#ifdef _WIN32
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
 
-    glLinkProgram(program);
+    FILE* pF = fopen(filename.c_str(), "wb");
+    if (pF == NULL)
+    {
+        LOG_ERROR("  Could not write program binary cache %s", filename.c_str());
+        return;
+    }
+    fwrite(&header, sizeof(header), 1, pF);
+    fwrite(&binary[0], 1, written, pF);
+    fclose(pF);
+}
+// Append any applicable suffixes to the name given and attempt to find
+// vertex, fragment and (optionally) geometry shader source.
+GLuint makeShaderByName(const char* name)
+{
+    if (!name)
+        return 0;
+
+    std::string vs(name);
+    std::string fs(name);
+    vs += ".vert";
+    fs += ".frag";
+
+    LOG_INFO("Create shader: [%s] ...", name);
+
+    const GLuint program = makeShaderFromSource(vs.c_str(), fs.c_str());
+    if (program == 0)
+        return 0;
 
     GLint linkStatus = GL_FALSE;
     glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
@@ -213,10 +396,8 @@ GLuint makeShaderByName(const char* name)
     else
     {
         LOG_ERROR("  Link failed: ");
-        printProgramInfoLog(program);
     }
 
-    glUseProgram(0);
     return program;
 }
 
@@ -224,23 +405,46 @@ GLuint makeShaderFromSource(
     const char* vert,
     const char* frag)
 {
-    const GLuint vertSrc = loadShaderFile(vert, GL_VERTEX_SHADER);
-    printShaderInfoLog(vertSrc);
-
-    const GLuint fragSrc = loadShaderFile(frag, GL_FRAGMENT_SHADER);
-    printShaderInfoLog(fragSrc);
+    const std::string vertSource = getPlatformShaderSource(vert);
+    const std::string fragSource = getPlatformShaderSource(frag);
 
     // Vertex and fragment shaders are required
-    if ((vertSrc == 0) || (fragSrc == 0))
+    if (vertSource.empty() || fragSource.empty())
     {
         LOG_ERROR("  SHADER NOT COMPILED - source not found.");
         return 0;
     }
 
-    const GLuint program = glCreateProgram();
+    const bool useCache = programBinariesSupported();
+    std::string cacheFilename;
+    programCacheHeader header;
+    if (useCache)
+    {
+        cacheFilename = programCacheFilename(vert, frag);
+
+        unsigned int h = 2166136261u;
+        h = hashString(h, vertSource.c_str());
+        h = hashString(h, fragSource.c_str());
+        initProgramCacheHeader(header, h, vertSource.length() + fragSource.length());
+
+        const GLuint cached = loadCachedProgram(cacheFilename, header);
+        if (cached != 0)
+        {
+            ++s_programCacheHits;
+            logProgramCacheResult("hit");
+            return cached;
+        }
+        ++s_programCacheMisses;
+        logProgramCacheResult("miss");
+    }
+
+    const GLuint vertSrc = compileShaderSource(vertSource, GL_VERTEX_SHADER);
+    printShaderInfoLog(vertSrc);
+
+    const GLuint fragSrc = compileShaderSource(fragSource, GL_FRAGMENT_SHADER);
+    printShaderInfoLog(fragSrc);
 
-    glCompileShader(vertSrc);
-    glCompileShader(fragSrc);
+    const GLuint program = glCreateProgram();
 
     GLint success = 0;
     glGetShaderiv(vertSrc, GL_COMPILE_STATUS, &success);
@@ -255,9 +459,82 @@ GLuint makeShaderFromSource(
     glDeleteShader(vertSrc);
     glDeleteShader(fragSrc);
 
+    if (useCache)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(program);
     printProgramInfoLog(program);
 
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (useCache && (linkStatus == GL_TRUE))
+    {
+        storeCachedProgram(program, cacheFilename, header);
+    }
+
     glUseProgram(0);
     return program;
 }
+
+// Lua scenes compile and attach their own stages, keying the cache on
+// their concatenated sources. A file holding one of these is named for
+// the hash of that key rather than for any shader filenames.
+static std::string programCacheFilename(const char* pSources, programCacheHeader& header)
+{
+    const unsigned int h = hashString(2166136261u, pSources);
+    initProgramCacheHeader(header, h, strlen(pSources));
+    return programCacheFilename(h);
+}
+
+extern "C" {
+
+unsigned int fc_program_load_cached(const char* pSources)
+{
+    if ((pSources == NULL) || !programBinariesSupported())
+        return 0;
+
+    programCacheHeader header;
+    const std::string cacheFilename = programCacheFilename(pSources, header);
+    const GLuint cached = loadCachedProgram(cacheFilename, header);
+    if (cached != 0)
+    {
+        ++s_programCacheHits;
+        logProgramCacheResult("hit");
+        return cached;
+    }
+    ++s_programCacheMisses;
+    logProgramCacheResult("miss");
+    return 0;
+}
+
+int fc_program_link_cached(unsigned int program, const char* pSources)
+{
+    const bool useCache = (pSources != NULL) && programBinariesSupported();
+    if (useCache)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (useCache && (linkStatus == GL_TRUE))
+    {
+        programCacheHeader header;
+        const std::string cacheFilename = programCacheFilename(pSources, header);
+        storeCachedProgram(program, cacheFilename, header);
+    }
+    return (linkStatus == GL_TRUE) ? 1 : 0;
+}
+
+}
+
+const ShaderFunctionsApi* GetShaderFunctionsApi()
+{
+    static const ShaderFunctionsApi api = {
+        fc_program_load_cached,
+        fc_program_link_cached,
+    };
+    return &api;
+}
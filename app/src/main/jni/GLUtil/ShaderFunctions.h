@@ -18,3 +18,29 @@ GLuint makeShaderByName(const char* name);
 GLuint makeShaderFromSource(
     const char* vertSrc,
     const char* fragSrc);
+
+#if defined(_WIN32)
+#  define SHADERFUNCTIONS_EXPORT __declspec(dllexport)
+#else
+#  define SHADERFUNCTIONS_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// The program binary cache for Lua through ffi.C where the host exports its
+/// symbols. pSources is the key, all of a program's stage sources together.
+/// fc_program_load_cached returns 0 on a miss or when the driver rejects the
+/// binary; fc_program_link_cached links the attached stages, stores the
+/// binary if it linked and returns 1 if it did.
+/// Must match the cdef in deploy/lua/util/shaderfunctions.lua.
+extern "C" {
+SHADERFUNCTIONS_EXPORT unsigned int fc_program_load_cached(const char* pSources);
+SHADERFUNCTIONS_EXPORT int fc_program_link_cached(unsigned int program, const char* pSources);
+}
+
+/// The same functions as pointers, handed to Lua as native_shader_api for
+/// hosts that do not export symbols (e.g. the Android .so).
+struct ShaderFunctionsApi {
+    unsigned int (*fc_program_load_cached)(const char* pSources);
+    int (*fc_program_link_cached)(unsigned int program, const char* pSources);
+};
+
+const ShaderFunctionsApi* GetShaderFunctionsApi();
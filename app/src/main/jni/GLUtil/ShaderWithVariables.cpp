@@ -16,6 +16,8 @@ ShaderWithVariables::ShaderWithVariables()
 , m_attrs()
 , m_unis()
 , m_vbos()
+, m_attrSlots()
+, m_uniSlots()
 {
 }
 
@@ -49,6 +51,8 @@ void ShaderWithVariables::destroy()
     m_attrs.clear();
     m_unis.clear();
     m_vbos.clear();
+    m_attrSlots.clear();
+    m_uniSlots.clear();
 }
 
 void ShaderWithVariables::initProgram(const char* shadername)
@@ -141,19 +145,86 @@ void ShaderWithVariables::findVariables(const char* vertsrc)
         if (!tokens[0].compare("uniform"))
         {
             m_unis[var] = glGetUniformLocation(m_program, var.c_str());
+            _InsertSlot(m_uniSlots, var, m_unis[var]);
         }
         else if (!tokens[0].compare("in"))
         {
             m_attrs[var] = glGetAttribLocation(m_program, var.c_str());
+            _InsertSlot(m_attrSlots, var, m_attrs[var]);
         }
         else if (!tokens[0].compare("attribute")) // deprecated keyword
         {
             m_attrs[var] = glGetAttribLocation(m_program, var.c_str());
+            _InsertSlot(m_attrSlots, var, m_attrs[var]);
         }
     }
 }
 
-GLint ShaderWithVariables::GetAttrLoc(const std::string name) const
+///@brief Add a location to a hashed table, doubling it to stay at most half full.
+/// Two names with the same hash are reported; the string lookups still work for both.
+void ShaderWithVariables::_InsertSlot(std::vector<varSlot>& slots, const std::string& name, GLint loc)
+{
+    const unsigned int hash = ShaderVar::HashName(name.c_str());
+
+    size_t used = 0;
+    for (std::vector<varSlot>::const_iterator it = slots.begin(); it != slots.end(); ++it)
+    {
+        if (it->hash == hash)
+        {
+            if (it->loc != loc)
+            {
+                LOG_ERROR("Shader variable %s collides with another hashed name.", name.c_str());
+            }
+            return;
+        }
+        if (it->hash != 0)
+            ++used;
+    }
+
+    if (2 * (used + 1) > slots.size())
+    {
+        std::vector<varSlot> old;
+        old.swap(slots);
+        const varSlot empty = { 0, -1 };
+        slots.assign(old.empty() ? 16 : 2 * old.size(), empty);
+        for (std::vector<varSlot>::const_iterator it = old.begin(); it != old.end(); ++it)
+        {
+            if (it->hash == 0)
+                continue;
+            const size_t mask = slots.size() - 1;
+            size_t i = it->hash & mask;
+            while (slots[i].hash != 0)
+                i = (i + 1) & mask;
+            slots[i] = *it;
+        }
+    }
+
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].hash != 0)
+        i = (i + 1) & mask;
+    slots[i].hash = hash;
+    slots[i].loc = loc;
+}
+
+///@return Location stored for hash, or -1 (ignored silently by GL) if there is none.
+GLint ShaderWithVariables::_FindSlot(const std::vector<varSlot>& slots, unsigned int hash)
+{
+    if (slots.empty())
+        return -1;
+
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        const varSlot& s = slots[i];
+        if (s.hash == hash)
+            return s.loc;
+        if (s.hash == 0)
+            return -1;
+    }
+}
+
+GLint ShaderWithVariables::GetAttrLoc(const std::string& name) const
 {
     std::map<std::string, GLint>::const_iterator it = m_attrs.find(name);
     if (it == m_attrs.end()) // key not found
@@ -161,7 +232,7 @@ GLint ShaderWithVariables::GetAttrLoc(const std::string name) const
     return it->second;
 }
 
-GLint ShaderWithVariables::GetUniLoc(const std::string name) const
+GLint ShaderWithVariables::GetUniLoc(const std::string& name) const
 {
     std::map<std::string, GLint>::const_iterator it = m_unis.find(name);
     if (it == m_unis.end()) // key not found
@@ -169,7 +240,7 @@ GLint ShaderWithVariables::GetUniLoc(const std::string name) const
     return it->second;
 }
 
-GLuint ShaderWithVariables::GetVboLoc(const std::string name) const
+GLuint ShaderWithVariables::GetVboLoc(const std::string& name) const
 {
     std::map<std::string, GLuint>::const_iterator it = m_vbos.find(name);
     if (it == m_vbos.end()) // key not found
@@ -12,6 +12,29 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+///@brief A hashed shader variable name for allocation-free location lookups.
+/// Construct once, e.g. as a static, and pass to the GetUniLoc/GetAttrLoc
+/// overloads on hot paths.
+struct ShaderVar
+{
+    explicit ShaderVar(const char* pName) : hash(HashName(pName)) {}
+
+    /// FNV-1a; 0 is reserved to mark empty table slots.
+    static unsigned int HashName(const char* pName)
+    {
+        unsigned int h = 2166136261u;
+        for (const char* p = pName; *p != 0; ++p)
+        {
+            h ^= static_cast<unsigned char>(*p);
+            h *= 16777619u;
+        }
+        return (h == 0) ? 1 : h;
+    }
+
+    unsigned int hash;
+};
 
 ///@brief 
 class ShaderWithVariables
@@ -27,18 +50,31 @@ public:
 
     virtual GLuint prog() const { return m_program; }
     virtual void bindVAO() const { glBindVertexArray(m_vao); }
-    virtual GLint GetAttrLoc(const std::string name) const;
-    virtual GLint GetUniLoc(const std::string name) const;
-    virtual GLuint GetVboLoc(const std::string name) const;
+    virtual GLint GetAttrLoc(const std::string& name) const;
+    virtual GLint GetUniLoc(const std::string& name) const;
+    virtual GLuint GetVboLoc(const std::string& name) const;
+
+    GLint GetAttrLoc(const ShaderVar& var) const { return _FindSlot(m_attrSlots, var.hash); }
+    GLint GetUniLoc(const ShaderVar& var) const { return _FindSlot(m_uniSlots, var.hash); }
 
 protected:
+    /// Open-addressing slot keyed by ShaderVar hash; hash 0 marks a free slot.
+    struct varSlot {
+        unsigned int hash;
+        GLint loc;
+    };
+
     virtual void findVariables(const char* vertsrc);
+    static void _InsertSlot(std::vector<varSlot>& slots, const std::string& name, GLint loc);
+    static GLint _FindSlot(const std::vector<varSlot>& slots, unsigned int hash);
 
     GLuint m_program;
     GLuint m_vao;
     std::map<std::string, GLint> m_attrs;
     std::map<std::string, GLint> m_unis;
     std::map<std::string, GLuint> m_vbos;
+    std::vector<varSlot> m_attrSlots; ///< Power-of-two sized, at most half full
+    std::vector<varSlot> m_uniSlots;
 
 private: // Disallow copy ctor and assignment operator
     ShaderWithVariables(const ShaderWithVariables&);
@@ -3,12 +3,57 @@
 #include "GL_Includes.h"
 
 #include "TextureFunctions.h"
+#include "AssetArchive.h"
+#include "MipChain.h"
+#include "EtcDecoder.h"
 #include "Logging.h"
 #include <stdio.h>
-#include <fstream>
+#include <string.h>
+
+/// Create a trilinear filtered texture from every level of a .mip file.
+static GLuint createTextureFromMipChain(const MipChainHeader& header, const unsigned char* pData)
+{
+    static const GLint internalFormats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    static const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    const GLint internalFormat = internalFormats[header.channels - 1];
+    const GLenum format = formats[header.channels - 1];
+
+    GLuint textureId = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &textureId);
+    if (textureId == 0)
+    {
+        LOG_ERROR("Failed to create GL texture.");
+        return 0;
+    }
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.levels - 1);
+
+    const unsigned char* pLevels = pData + sizeof(MipChainHeader);
+    for (unsigned int level=0; level<header.levels; ++level)
+    {
+        unsigned int w, h;
+        MipLevelDimensions(header.width, header.height, level, w, h);
+        glTexImage2D(GL_TEXTURE_2D,
+            level,
+            internalFormat,
+            w,
+            h,
+            0,
+            format,
+            GL_UNSIGNED_BYTE,
+            pLevels + MipLevelOffset(header.width, header.height, header.channels, level));
+    }
+    return textureId;
+}
 
 /// Load a square, power-of-two sized texture file from raw format.
 /// Assume file is luminance(grayscale) format, 8 bits per pixel.
+/// A .mip file from Flickercladding-MipBake is loaded with all its levels.
 ///@param pFilename Fully qualified path name
 ///@param dimension Size in pixels of one dimension of the square image
 ///@return TextureID of created texture (0 for none)
@@ -20,22 +65,30 @@ GLuint CreateTextureFromRawFile(const char* pFilename, unsigned int dimension, i
     GLuint textureId = 0;
 
     LOG_INFO("Opening %d px square file %s ...", dimension, pFilename);
-    std::ifstream fs;
-    fs.open(pFilename, std::ios::in|std::ios::binary);
-    if (!fs.is_open())
+    AssetFile file;
+    if (!file.Open(pFilename))
     {
         LOG_ERROR("File %s not found.", pFilename);
         return 0;
     }
-
-    fs.seekg(offset, fs.beg);
+    if (const MipChainHeader* pHeader = ParseMipChain(file.Data(), file.Size()))
+    {
+        const GLuint textureId = createTextureFromMipChain(*pHeader, file.Data());
+        LOG_INFO("%u mip levels.", pHeader->levels);
+        return textureId;
+    }
 
     const unsigned int dimx = dimension;
     const unsigned int dimy = dimension;
     const unsigned int sz = dimx * dimy;
     const unsigned int szBytes = sz;
-    GLubyte* pPixels = new GLubyte[szBytes];
-    fs.read(reinterpret_cast<char*>(pPixels), szBytes);
+    if ((offset < 0) || (file.Size() < static_cast<size_t>(offset) + szBytes))
+    {
+        LOG_ERROR("File %s is too short.", pFilename);
+        return 0;
+    }
+    // Straight from the archive mapping when the file is in it.
+    const GLubyte* pPixels = file.Data() + offset;
 
     /// Create an OpenGL texture
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -64,8 +117,6 @@ GLuint CreateTextureFromRawFile(const char* pFilename, unsigned int dimension, i
         LOG_INFO("Failed to create GL texture.");
     }
 
-    delete [] pPixels;
-    fs.close();
     if (textureId != 0)
     {
         LOG_INFO("success.");
@@ -78,7 +129,7 @@ GLuint CreateTextureFromRawFile(const char* pFilename, unsigned int dimension, i
 }
 
 
-/// Load a color texture file from raw format.
+/// Load a color texture file from raw format, or all levels of a .mip file.
 ///@param pFilename Fully qualified path name
 ///@param x Size in pixels of horizontal dimension of the image
 ///@param y Size in pixels of vertical dimension of the image
@@ -94,18 +145,27 @@ GLuint CreateColorTextureFromRawFile(
     GLuint textureId = 0;
 
     LOG_INFO_NONEWLINE("Opening %d x %d px texture file %s ...", x, y, pFilename);
-    std::ifstream fs;
-    fs.open(pFilename, std::ios::in|std::ios::binary);
-    if (!fs.is_open())
+    AssetFile file;
+    if (!file.Open(pFilename))
     {
         LOG_ERROR("File %s not found.", pFilename);
         return 0;
     }
+    if (const MipChainHeader* pHeader = ParseMipChain(file.Data(), file.Size()))
+    {
+        const GLuint textureId = createTextureFromMipChain(*pHeader, file.Data());
+        LOG_INFO("%u mip levels.", pHeader->levels);
+        return textureId;
+    }
 
     const unsigned int sz = x * y * 3; ///< RGB
     const unsigned int szBytes = sz;
-    GLubyte* pPixels = new GLubyte[szBytes];
-    fs.read(reinterpret_cast<char*>(pPixels), szBytes);
+    if (file.Size() < szBytes)
+    {
+        LOG_ERROR("File %s is too short.", pFilename);
+        return 0;
+    }
+    const GLubyte* pPixels = file.Data();
 
     /// Create an OpenGL texture
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -131,11 +191,524 @@ GLuint CreateColorTextureFromRawFile(
         LOG_ERROR("Failed to create GL texture.");
     }
 
-    delete [] pPixels;
-    fs.close();
     if (textureId != 0)
     {
         LOG_INFO("success.");
     }
     return textureId;
 }
+
+
+// ASTC enums are only in extension headers on some platforms.
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#  define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+#  define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR 0x93D0
+#endif
+
+static const unsigned char s_ktx1Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const unsigned char s_ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const unsigned int s_astcFootprints[14][2] = {
+    { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+    { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 },
+};
+
+static unsigned int readU32(const unsigned char* u)
+{
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<unsigned int>(u[3]) << 24);
+}
+
+static int astcFootprint(GLenum internalFormat)
+{
+    if ((internalFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR) && (internalFormat < GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 14))
+        return internalFormat - GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+    if ((internalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR) && (internalFormat < GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 14))
+        return internalFormat - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+    return -1;
+}
+
+/// Block size and the channel count an uncompressed equivalent would need.
+///@return false for formats we do not know.
+static bool compressedBlockInfo(GLenum internalFormat,
+    unsigned int& blockWidth, unsigned int& blockHeight, unsigned int& blockBytes, int& channels)
+{
+    blockWidth = 4;
+    blockHeight = 4;
+    switch (internalFormat)
+    {
+    case GL_COMPRESSED_R11_EAC:
+    case GL_COMPRESSED_SIGNED_R11_EAC:  blockBytes = 8;  channels = 1; return true;
+    case GL_COMPRESSED_RG11_EAC:
+    case GL_COMPRESSED_SIGNED_RG11_EAC: blockBytes = 16; channels = 2; return true;
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_SRGB8_ETC2:      blockBytes = 8;  channels = 3; return true;
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2: blockBytes = 8; channels = 4; return true;
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC: blockBytes = 16; channels = 4; return true;
+    default:
+        break;
+    }
+    const int astc = astcFootprint(internalFormat);
+    if (astc < 0)
+        return false;
+    blockWidth = s_astcFootprints[astc][0];
+    blockHeight = s_astcFootprints[astc][1];
+    blockBytes = 16;
+    channels = 4;
+    return true;
+}
+
+static int uncompressedChannels(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RED:  return 1;
+    case GL_RG:   return 2;
+    case GL_RGB:  return 3;
+    case GL_RGBA: return 4;
+    default:      return 0;
+    }
+}
+
+static const char* ktxFormatName(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_COMPRESSED_R11_EAC:                        return "EAC R11";
+    case GL_COMPRESSED_SIGNED_R11_EAC:                 return "EAC signed R11";
+    case GL_COMPRESSED_RG11_EAC:                       return "EAC RG11";
+    case GL_COMPRESSED_SIGNED_RG11_EAC:                return "EAC signed RG11";
+    case GL_COMPRESSED_RGB8_ETC2:                      return "ETC2 RGB8";
+    case GL_COMPRESSED_SRGB8_ETC2:                     return "ETC2 sRGB8";
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:  return "ETC2 RGB8A1";
+    case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2: return "ETC2 sRGB8A1";
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:                 return "ETC2 RGBA8";
+    case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:          return "ETC2 sRGB8 A8";
+    case GL_R8:           return "R8";
+    case GL_RG8:          return "RG8";
+    case GL_RGB8:         return "RGB8";
+    case GL_SRGB8:        return "sRGB8";
+    case GL_RGBA8:        return "RGBA8";
+    case GL_SRGB8_ALPHA8: return "sRGB8 A8";
+    default:
+        return (astcFootprint(internalFormat) >= 0) ? "ASTC" : "unknown";
+    }
+}
+
+/// The sized internal format and client format of 8-bit uncompressed data.
+static bool uncompressedFormat(GLenum internalFormat, GLenum& format)
+{
+    switch (internalFormat)
+    {
+    case GL_R8:           format = GL_RED;  return true;
+    case GL_RG8:          format = GL_RG;   return true;
+    case GL_RGB8:
+    case GL_SRGB8:        format = GL_RGB;  return true;
+    case GL_RGBA8:
+    case GL_SRGB8_ALPHA8: format = GL_RGBA; return true;
+    default:              return false;
+    }
+}
+
+/// Vulkan format numbers used by KTX2, for the formats ParseKtx knows.
+static GLenum glFormatForVk(unsigned int vkFormat)
+{
+    switch (vkFormat)
+    {
+    case 9:   return GL_R8;
+    case 16:  return GL_RG8;
+    case 23:  return GL_RGB8;
+    case 29:  return GL_SRGB8;
+    case 37:  return GL_RGBA8;
+    case 43:  return GL_SRGB8_ALPHA8;
+    case 147: return GL_COMPRESSED_RGB8_ETC2;
+    case 148: return GL_COMPRESSED_SRGB8_ETC2;
+    case 149: return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+    case 150: return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+    case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+    case 153: return GL_COMPRESSED_R11_EAC;
+    case 154: return GL_COMPRESSED_SIGNED_R11_EAC;
+    case 155: return GL_COMPRESSED_RG11_EAC;
+    case 156: return GL_COMPRESSED_SIGNED_RG11_EAC;
+    default:
+        break;
+    }
+    // VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK alternate UNORM and SRGB.
+    if ((vkFormat >= 157) && (vkFormat <= 184))
+    {
+        const unsigned int i = (vkFormat - 157) / 2;
+        return ((vkFormat - 157) & 1) ? (GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + i) : (GL_COMPRESSED_RGBA_ASTC_4x4_KHR + i);
+    }
+    return 0;
+}
+
+/// Bytes one face of a level takes.
+static size_t ktxImageSize(const KtxImage& image, unsigned int level)
+{
+    unsigned int w, h;
+    MipLevelDimensions(image.width, image.height, level, w, h);
+    if (image.format == 0)
+    {
+        unsigned int bw, bh, blockBytes;
+        int channels;
+        compressedBlockInfo(image.internalFormat, bw, bh, blockBytes, channels);
+        return static_cast<size_t>((w + bw - 1) / bw) * ((h + bh - 1) / bh) * blockBytes;
+    }
+    const size_t align = image.rowAlignment;
+    const size_t row = (w * uncompressedChannels(image.format) + align - 1) / align * align;
+    return row * h;
+}
+
+// Look for KTXswizzle in the key/value data, the same layout in both versions.
+static void parseKtxMetadata(const unsigned char* p, size_t size, KtxImage& image)
+{
+    memcpy(image.swizzle, "rgba", 4);
+    size_t pos = 0;
+    while (pos + 4 <= size)
+    {
+        const size_t length = readU32(p + pos);
+        pos += 4;
+        if (length > size - pos)
+            return;
+        const char* pKey = reinterpret_cast<const char*>(p + pos);
+        if ((length >= 15) && (memcmp(pKey, "KTXswizzle\0", 11) == 0))
+        {
+            memcpy(image.swizzle, pKey + 11, 4);
+        }
+        pos += (length + 3) & ~static_cast<size_t>(3);
+    }
+}
+
+///@brief Fill in image from a KTX 1.1 or KTX2 file in memory, checking that
+/// every image lies within it. Byte-swapped KTX 1.1 files are not supported.
+bool ParseKtx(const unsigned char* pData, size_t size, KtxImage& image)
+{
+    memset(&image, 0, sizeof(image));
+    if ((pData == NULL) || (size < 80))
+        return false;
+
+    const bool ktx2 = (memcmp(pData, s_ktx2Identifier, sizeof(s_ktx2Identifier)) == 0);
+    if ((ktx2 == false) && (memcmp(pData, s_ktx1Identifier, sizeof(s_ktx1Identifier)) != 0))
+        return false;
+
+    unsigned int depth, arrayElements;
+    size_t pos = 0;
+    if (ktx2)
+    {
+        image.internalFormat = glFormatForVk(readU32(pData + 12));
+        image.width          = readU32(pData + 20);
+        image.height         = readU32(pData + 24);
+        depth                = readU32(pData + 28);
+        arrayElements        = readU32(pData + 32);
+        image.faces          = readU32(pData + 36);
+        image.levels         = readU32(pData + 40);
+        image.rowAlignment   = 1;
+        if (readU32(pData + 44) != 0) // supercompression
+            return false;
+        const size_t kvdOffset = readU32(pData + 56);
+        const size_t kvdSize = readU32(pData + 60);
+        if ((kvdOffset > size) || (kvdSize > size - kvdOffset))
+            return false;
+        parseKtxMetadata(pData + kvdOffset, kvdSize, image);
+        uncompressedFormat(image.internalFormat, image.format);
+        image.type = (image.format != 0) ? GL_UNSIGNED_BYTE : 0;
+    }
+    else
+    {
+        if (readU32(pData + 12) != 0x04030201)
+            return false;
+        image.type           = readU32(pData + 16);
+        image.format         = readU32(pData + 24);
+        image.internalFormat = readU32(pData + 28);
+        image.width          = readU32(pData + 36);
+        image.height         = readU32(pData + 40);
+        depth                = readU32(pData + 44);
+        arrayElements        = readU32(pData + 48);
+        image.faces          = readU32(pData + 52);
+        image.levels         = readU32(pData + 56);
+        image.rowAlignment   = 4;
+        const size_t kvdSize = readU32(pData + 60);
+        if (kvdSize > size - 64)
+            return false;
+        parseKtxMetadata(pData + 64, kvdSize, image);
+        pos = 64 + kvdSize;
+        if ((image.type != 0) && (image.type != GL_UNSIGNED_BYTE))
+            return false;
+    }
+
+    if (image.levels == 0)
+        image.levels = 1;
+    GLenum format = 0;
+    unsigned int bw, bh, blockBytes;
+    int channels;
+    if ((image.internalFormat == 0) || (image.width == 0) || (image.height == 0) ||
+        (depth > 1) || (arrayElements > 1) ||
+        ((image.faces != 1) && (image.faces != 6)) ||
+        (image.levels > s_ktxMaxLevels) || (image.levels > MipLevelCount(image.width, image.height)))
+        return false;
+    if ((image.format == 0) ?
+            (compressedBlockInfo(image.internalFormat, bw, bh, blockBytes, channels) == false) :
+            (uncompressedFormat(image.internalFormat, format) == false) || (format != image.format))
+        return false;
+
+    for (unsigned int level=0; level<image.levels; ++level)
+    {
+        const size_t expected = ktxImageSize(image, level);
+        size_t faceSize = 0;
+        if (ktx2)
+        {
+            const unsigned char* pIndex = pData + 80 + 24 * level;
+            if ((pIndex + 24 > pData + size) || (readU32(pIndex + 4) != 0) || (readU32(pIndex + 12) != 0))
+                return false;
+            pos = readU32(pIndex);
+            faceSize = readU32(pIndex + 8) / image.faces;
+        }
+        else
+        {
+            if (pos + 4 > size)
+                return false;
+            faceSize = readU32(pData + pos);
+            pos += 4;
+        }
+        if (faceSize < expected)
+            return false;
+
+        for (unsigned int face=0; face<image.faces; ++face)
+        {
+            if ((pos > size) || (expected > size - pos))
+                return false;
+            image.pImages[level][face] = pData + pos;
+            pos += ktx2 ? faceSize : ((faceSize + 3) & ~static_cast<size_t>(3));
+        }
+        image.imageSize[level] = expected;
+    }
+    return true;
+}
+
+/// Check once, on the GL thread, which compressed formats GL can sample.
+const CompressedTextureSupport& GetCompressedTextureSupport()
+{
+    static bool s_checked = false;
+    static CompressedTextureSupport s_support;
+    if (s_checked)
+        return s_support;
+    s_checked = true;
+
+#ifdef __ANDROID__
+    s_support.etc2 = true; // Mandatory in GLES 3
+#else
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    s_support.etc2 = (major > 4) || ((major == 4) && (minor >= 3));
+#endif
+    s_support.astc = false;
+
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i=0; i<extensionCount; ++i)
+    {
+        const char* pExt = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (pExt == NULL)
+            continue;
+        if (strcmp(pExt, "GL_ARB_ES3_compatibility") == 0)
+            s_support.etc2 = true;
+        if (strcmp(pExt, "GL_KHR_texture_compression_astc_ldr") == 0)
+            s_support.astc = true;
+    }
+    LOG_INFO("Compressed textures: ETC2 %s, ASTC %s",
+        s_support.etc2 ? "yes" : "no (decoded on the CPU)",
+        s_support.astc ? "yes" : "no");
+    return s_support;
+}
+
+bool KtxFormatSupported(GLenum internalFormat, const CompressedTextureSupport& support)
+{
+    GLenum format;
+    if (uncompressedFormat(internalFormat, format))
+        return true;
+    if (astcFootprint(internalFormat) >= 0)
+        return support.astc;
+    unsigned int bw, bh, blockBytes;
+    int channels;
+    return support.etc2 && compressedBlockInfo(internalFormat, bw, bh, blockBytes, channels);
+}
+
+///@brief Decode an ETC2 or EAC image to 8-bit channels in pixels, which
+/// decoded then points into.
+///@return false if image is in some other format.
+bool DecodeKtx(const KtxImage& image, std::vector<unsigned char>& pixels, KtxImage& decoded)
+{
+    static const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    static const GLenum internalFormats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    const int channels = EtcDecodedChannels(image.internalFormat);
+    if (channels == 0)
+        return false;
+
+    decoded = image;
+    decoded.format = formats[channels - 1];
+    decoded.type = GL_UNSIGNED_BYTE;
+    decoded.rowAlignment = 1;
+    decoded.internalFormat = internalFormats[channels - 1];
+    if (image.internalFormat == GL_COMPRESSED_SRGB8_ETC2)
+        decoded.internalFormat = GL_SRGB8;
+    if (image.internalFormat == GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC)
+        decoded.internalFormat = GL_SRGB8_ALPHA8;
+
+    size_t total = 0;
+    for (unsigned int level=0; level<image.levels; ++level)
+    {
+        decoded.imageSize[level] = ktxImageSize(decoded, level);
+        total += decoded.imageSize[level] * image.faces;
+    }
+    pixels.resize(total);
+
+    size_t pos = 0;
+    for (unsigned int level=0; level<image.levels; ++level)
+    {
+        unsigned int w, h;
+        MipLevelDimensions(image.width, image.height, level, w, h);
+        for (unsigned int face=0; face<image.faces; ++face)
+        {
+            DecodeEtcImage(image.internalFormat, image.pImages[level][face], w, h, &pixels[pos], w * channels);
+            decoded.pImages[level][face] = &pixels[pos];
+            pos += decoded.imageSize[level];
+        }
+    }
+    return true;
+}
+
+static GLenum swizzleFor(char c, GLenum channel)
+{
+    switch (c)
+    {
+    case 'r': return GL_RED;
+    case 'g': return GL_GREEN;
+    case 'b': return GL_BLUE;
+    case 'a': return GL_ALPHA;
+    case '0': return GL_ZERO;
+    case '1': return GL_ONE;
+    default:  return channel;
+    }
+}
+
+///@brief Upload every level (and face) of image into texture, which gets
+/// GL_TEXTURE_MAX_LEVEL and any swizzle from the file, and log how much
+/// memory the format saves over 8-bit uncompressed data.
+///@param imageTarget GL_TEXTURE_2D or a cube map face; ignored for cube map files.
+bool UploadKtx(const KtxImage& image, GLuint texture, GLenum imageTarget, const char* pName)
+{
+    if (image.faces == 6)
+        imageTarget = GL_TEXTURE_CUBE_MAP;
+    const GLenum bindTarget = (imageTarget == GL_TEXTURE_2D) ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP;
+    const bool compressed = (image.format == 0);
+
+    glBindTexture(bindTarget, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, image.rowAlignment);
+    size_t bytes = 0;
+    size_t uncompressedBytes = 0;
+    for (unsigned int level=0; level<image.levels; ++level)
+    {
+        unsigned int w, h;
+        MipLevelDimensions(image.width, image.height, level, w, h);
+        for (unsigned int face=0; face<image.faces; ++face)
+        {
+            const GLenum target = (image.faces == 6) ? (GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : imageTarget;
+            if (compressed)
+            {
+                glCompressedTexImage2D(target, level, image.internalFormat, w, h, 0,
+                    static_cast<GLsizei>(image.imageSize[level]), image.pImages[level][face]);
+            }
+            else
+            {
+                glTexImage2D(target, level, image.internalFormat, w, h, 0,
+                    image.format, image.type, image.pImages[level][face]);
+            }
+            bytes += image.imageSize[level];
+        }
+
+        unsigned int bw, bh, blockBytes;
+        int channels = uncompressedChannels(image.format);
+        if (compressed)
+            compressedBlockInfo(image.internalFormat, bw, bh, blockBytes, channels);
+        uncompressedBytes += static_cast<size_t>(w) * h * channels * image.faces;
+    }
+    glTexParameteri(bindTarget, GL_TEXTURE_MAX_LEVEL, image.levels - 1);
+    if (memcmp(image.swizzle, "rgba", 4) != 0)
+    {
+        glTexParameteri(bindTarget, GL_TEXTURE_SWIZZLE_R, swizzleFor(image.swizzle[0], GL_RED));
+        glTexParameteri(bindTarget, GL_TEXTURE_SWIZZLE_G, swizzleFor(image.swizzle[1], GL_GREEN));
+        glTexParameteri(bindTarget, GL_TEXTURE_SWIZZLE_B, swizzleFor(image.swizzle[2], GL_BLUE));
+        glTexParameteri(bindTarget, GL_TEXTURE_SWIZZLE_A, swizzleFor(image.swizzle[3], GL_ALPHA));
+    }
+    glBindTexture(bindTarget, 0);
+
+    if (compressed)
+    {
+        // Signed: a block format may round a small level up past 8 bits a texel.
+        const long saved = static_cast<long>(uncompressedBytes) - static_cast<long>(bytes);
+        LOG_INFO("%s: %ux%u %s, %u levels, %u kB (%ld kB saved)",
+            pName, image.width, image.height, ktxFormatName(image.internalFormat), image.levels,
+            static_cast<unsigned int>(bytes / 1024), saved / 1024);
+    }
+    else
+    {
+        // Uploaded rows may be padded, so there is no saving to report.
+        LOG_INFO("%s: %ux%u %s, %u levels, %u kB",
+            pName, image.width, image.height, ktxFormatName(image.internalFormat), image.levels,
+            static_cast<unsigned int>(bytes / 1024));
+    }
+    return true;
+}
+
+///@return TextureID of created texture (0 for none)
+GLuint CreateTextureFromKtxFile(const char* pFilename)
+{
+    if (pFilename == NULL)
+        return 0;
+
+    AssetFile file;
+    if (!file.Open(pFilename))
+    {
+        LOG_ERROR("File %s not found.", pFilename);
+        return 0;
+    }
+    KtxImage image;
+    if (ParseKtx(file.Data(), file.Size(), image) == false)
+    {
+        LOG_ERROR("%s is not a KTX file we can load.", pFilename);
+        return 0;
+    }
+
+    std::vector<unsigned char> pixels;
+    if (KtxFormatSupported(image.internalFormat, GetCompressedTextureSupport()) == false)
+    {
+        KtxImage decoded;
+        if (DecodeKtx(image, pixels, decoded) == false)
+        {
+            LOG_ERROR("%s: %s is not supported here.", pFilename, ktxFormatName(image.internalFormat));
+            return 0;
+        }
+        LOG_INFO("%s: decoded %s on the CPU.", pFilename, ktxFormatName(image.internalFormat));
+        image = decoded;
+    }
+
+    GLuint textureId = 0;
+    glGenTextures(1, &textureId);
+    if (textureId == 0)
+    {
+        LOG_ERROR("Failed to create GL texture.");
+        return 0;
+    }
+    const GLenum bindTarget = (image.faces == 6) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    glBindTexture(bindTarget, textureId);
+    glTexParameteri(bindTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(bindTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, (image.levels > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(bindTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    UploadKtx(image, textureId, GL_TEXTURE_2D, pFilename);
+    return textureId;
+}
@@ -4,6 +4,9 @@
 
 #include "GL_Includes.h"
 
+#include <stddef.h>
+#include <vector>
+
 /// Load a square, power-of-two sized texture file from raw format
 GLuint CreateTextureFromRawFile(const char* pFilename, unsigned int dimension, int offset = 0);
 
@@ -11,3 +14,37 @@ GLuint CreateColorTextureFromRawFile(
     const char* pFilename,
     unsigned int x,
     unsigned int y);
+
+static const unsigned int s_ktxMaxLevels = 16;
+
+///@brief The images in a KTX 1.1 or KTX2 file (2D or cube map, no arrays,
+/// no supercompression), pointing into the file's bytes.
+struct KtxImage {
+    GLenum internalFormat;
+    GLenum format;             ///< 0 for compressed formats
+    GLenum type;               ///< 0 for compressed formats
+    unsigned int width;
+    unsigned int height;
+    unsigned int levels;
+    unsigned int faces;        ///< 1, or 6 for a cube map
+    unsigned int rowAlignment; ///< Of uncompressed rows: 4 in KTX 1.1, 1 in KTX2
+    char swizzle[4];           ///< From KTXswizzle metadata, "rgba" if none
+    const unsigned char* pImages[s_ktxMaxLevels][6];
+    size_t imageSize[s_ktxMaxLevels]; ///< Bytes per face
+};
+
+/// Which compressed families the current context can sample directly.
+struct CompressedTextureSupport {
+    bool etc2; ///< ETC2 and EAC: GLES 3, GL 4.3 or ARB_ES3_compatibility
+    bool astc; ///< KHR_texture_compression_astc_ldr
+};
+
+const CompressedTextureSupport& GetCompressedTextureSupport();
+bool KtxFormatSupported(GLenum internalFormat, const CompressedTextureSupport& support);
+
+bool ParseKtx(const unsigned char* pData, size_t size, KtxImage& image);
+bool DecodeKtx(const KtxImage& image, std::vector<unsigned char>& pixels, KtxImage& decoded);
+bool UploadKtx(const KtxImage& image, GLuint texture, GLenum imageTarget, const char* pName);
+
+/// Load a .ktx file, decoding ETC2/EAC on the CPU where GL cannot sample them.
+GLuint CreateTextureFromKtxFile(const char* pFilename);
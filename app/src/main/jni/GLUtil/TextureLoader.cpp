@@ -0,0 +1,612 @@
+// TextureLoader.cpp
+
+#include "TextureLoader.h"
+#include "AssetArchive.h"
+#include "MipChain.h"
+#include "FrameProfiler.h"
+#include "Atomics.h"
+#include "Logging.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void formatForChannels(int channels, GLint& internalFormat, GLenum& format)
+{
+    switch (channels)
+    {
+    case 1:  internalFormat = GL_R8;    format = GL_RED;  break;
+    case 2:  internalFormat = GL_RG8;   format = GL_RG;   break;
+    case 3:  internalFormat = GL_RGB8;  format = GL_RGB;  break;
+    default: internalFormat = GL_RGBA8; format = GL_RGBA; break;
+    }
+}
+
+static GLenum bindTargetFor(GLenum imageTarget)
+{
+    if ((imageTarget >= GL_TEXTURE_CUBE_MAP_POSITIVE_X) &&
+        (imageTarget <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z))
+        return GL_TEXTURE_CUBE_MAP;
+    return imageTarget;
+}
+
+TextureLoader::TextureLoader()
+: m_waiting()
+, m_inFlight()
+, m_freePbos()
+, m_pendingPerTexture()
+, m_uploadBudget(s_defaultUploadBudget)
+, m_thread()
+, m_mutex()
+, m_cond()
+, m_workQueue()
+, m_quit(false)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    /// Destroy() should be called before the context is torn down.
+}
+
+/// Stop the worker and release every buffer; pending textures keep their
+/// placeholders.
+void TextureLoader::Destroy()
+{
+    {
+        ScopedLock lock(m_mutex);
+        m_quit = true;
+        m_cond.Broadcast();
+    }
+    m_thread.Join();
+
+    m_workQueue.clear();
+    for (std::vector<textureJob*>::iterator it = m_inFlight.begin(); it != m_inFlight.end(); ++it)
+    {
+        _Retire(*it);
+    }
+    m_inFlight.clear();
+    for (std::deque<textureJob*>::iterator it = m_waiting.begin(); it != m_waiting.end(); ++it)
+    {
+        delete *it;
+    }
+    m_waiting.clear();
+    m_pendingPerTexture.clear();
+
+    if (m_freePbos.empty() == false)
+    {
+        glDeleteBuffers(static_cast<GLsizei>(m_freePbos.size()), &m_freePbos[0]);
+        m_freePbos.clear();
+    }
+    m_quit = false;
+}
+
+unsigned int TextureLoader::textureJob::byteSize() const
+{
+    if (kind == KindKtx)
+        return static_cast<unsigned int>(cpuPixels.size());
+    if (kind == KindMipChain)
+        return static_cast<unsigned int>(MipChainFileSize(width, height, channels));
+    return width * height * channels;
+}
+
+///@brief Request an uncompressed, tightly packed image of the given size.
+///@param texture Texture to load into, or 0 to create one with linear
+/// filtering, edge clamping and no mipmaps.
+///@param imageTarget GL_TEXTURE_2D or a cube map face.
+///@param offset Bytes to skip at the start of the file.
+///@param pArchiveName Name to look up in the AssetArchive, where it differs
+/// from the file name (e.g. for paths relative to Lua's working directory).
+///@return The texture, at once holding a 1x1 placeholder; 0 on failure.
+GLuint TextureLoader::LoadRaw(
+    const char* pFilename,
+    unsigned int width,
+    unsigned int height,
+    int channels,
+    GLuint texture,
+    GLenum imageTarget,
+    unsigned int offset,
+    const char* pArchiveName)
+{
+    return _Request(pFilename, width, height, channels, texture, imageTarget, offset, pArchiveName, KindRaw);
+}
+
+///@brief Request every mip level of a width x height image, from a .mip file
+/// baked by Flickercladding-MipBake, or else built on the worker from a raw
+/// file holding level 0 (filtering 3 and 4 channel images as sRGB).
+/// The texture's GL_TEXTURE_MAX_LEVEL is raised once the levels are in.
+///@param texture Texture to load into, or 0 to create one with trilinear
+/// filtering and edge clamping.
+///@return The texture, at once holding a 1x1 placeholder; 0 on failure.
+GLuint TextureLoader::LoadMipChain(
+    const char* pFilename,
+    unsigned int width,
+    unsigned int height,
+    int channels,
+    GLuint texture,
+    GLenum imageTarget,
+    const char* pArchiveName)
+{
+    return _Request(pFilename, width, height, channels, texture, imageTarget, 0, pArchiveName, KindMipChain);
+}
+
+///@brief Request every level in a KTX 1.1 or KTX2 file (one face), kept in
+/// its stored format where GL can sample it, else decoded on the worker.
+/// The file's KTXswizzle, if any, is applied to the texture.
+///@param texture Texture to load into, or 0 to create one with trilinear
+/// filtering and edge clamping.
+///@return The texture, at once holding a 1x1 placeholder; 0 on failure.
+GLuint TextureLoader::LoadKtx(
+    const char* pFilename,
+    GLuint texture,
+    GLenum imageTarget,
+    const char* pArchiveName)
+{
+    return _Request(pFilename, 1, 1, 4, texture, imageTarget, 0, pArchiveName, KindKtx);
+}
+
+GLuint TextureLoader::_Request(
+    const char* pFilename,
+    unsigned int width,
+    unsigned int height,
+    int channels,
+    GLuint texture,
+    GLenum imageTarget,
+    unsigned int offset,
+    const char* pArchiveName,
+    jobKind kind)
+{
+    if ((pFilename == NULL) || (width == 0) || (height == 0) || (channels < 1) || (channels > 4))
+        return 0;
+
+    const GLenum bindTarget = bindTargetFor(imageTarget);
+    if (texture == 0)
+    {
+        glGenTextures(1, &texture);
+        if (texture == 0)
+            return 0;
+        glBindTexture(bindTarget, texture);
+        glTexParameteri(bindTarget, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(bindTarget, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, (kind == KindRaw) ? GL_LINEAR : GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(bindTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(bindTarget, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+    else
+    {
+        glBindTexture(bindTarget, texture);
+    }
+
+    GLint internalFormat = GL_RGBA8;
+    GLenum format = GL_RGBA;
+    formatForChannels(channels, internalFormat, format);
+    const unsigned char zeros[4] = { 0, 0, 0, 0 };
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(imageTarget, 0, internalFormat, 1, 1, 0, format, GL_UNSIGNED_BYTE, zeros);
+    glBindTexture(bindTarget, 0);
+
+    textureJob* pJob = new textureJob();
+    pJob->filename = pFilename;
+    if (pArchiveName != NULL)
+        pJob->archiveName = pArchiveName;
+    pJob->offset = offset;
+    pJob->width = width;
+    pJob->height = height;
+    pJob->channels = channels;
+    pJob->texture = texture;
+    pJob->imageTarget = imageTarget;
+    pJob->kind = kind;
+    if (kind == KindKtx)
+        pJob->support = GetCompressedTextureSupport();
+    pJob->decoded = false;
+    pJob->cancelled = false;
+    pJob->pbo = 0;
+    pJob->mapped = false;
+    pJob->pStaging = NULL;
+    pJob->state = JobStaged;
+    m_waiting.push_back(pJob);
+    ++m_pendingPerTexture[texture];
+
+    if (m_thread.IsRunning() == false)
+    {
+        m_thread.Start(_WorkerEntry, this);
+    }
+
+    _StageWaitingJobs();
+    return texture;
+}
+
+///@brief Drop any pending loads into texture, e.g. before deleting it.
+void TextureLoader::Cancel(GLuint texture)
+{
+    for (std::deque<textureJob*>::iterator it = m_waiting.begin(); it != m_waiting.end(); ++it)
+    {
+        if ((*it)->texture == texture)
+            (*it)->cancelled = true;
+    }
+    for (std::vector<textureJob*>::iterator it = m_inFlight.begin(); it != m_inFlight.end(); ++it)
+    {
+        if ((*it)->texture == texture)
+            (*it)->cancelled = true;
+    }
+}
+
+///@brief Upload what the worker has finished, within the byte budget but at
+/// least one texture, then hand the worker more.
+void TextureLoader::Update()
+{
+    if (m_inFlight.empty() && m_waiting.empty())
+        return;
+
+    PROFILE_ZONE("texture uploads");
+    _UploadLoadedJobs();
+    _StageWaitingJobs();
+}
+
+// Map an unpack buffer for each waiting job, up to s_maxStaged at a time,
+// and queue them for the worker.
+void TextureLoader::_StageWaitingJobs()
+{
+    while ((m_waiting.empty() == false) &&
+           (static_cast<int>(m_inFlight.size()) < s_maxStaged))
+    {
+        textureJob* pJob = m_waiting.front();
+        m_waiting.pop_front();
+        if (pJob->cancelled)
+        {
+            _Retire(pJob);
+            continue;
+        }
+        if (pJob->kind == KindKtx)
+        {
+            // Its size is only known once read; upload from client memory.
+            m_inFlight.push_back(pJob);
+            ScopedLock lock(m_mutex);
+            m_workQueue.push_back(pJob);
+            m_cond.Signal();
+            continue;
+        }
+
+        const unsigned int size = pJob->byteSize();
+        if (m_freePbos.empty())
+        {
+            glGenBuffers(1, &pJob->pbo);
+        }
+        else
+        {
+            pJob->pbo = m_freePbos.back();
+            m_freePbos.pop_back();
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pJob->pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        pJob->pStaging = reinterpret_cast<unsigned char*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pJob->mapped = (pJob->pStaging != NULL);
+        if (pJob->pStaging == NULL)
+        {
+            // Upload from client memory instead.
+            pJob->cpuPixels.resize(size);
+            pJob->pStaging = &pJob->cpuPixels[0];
+        }
+
+        m_inFlight.push_back(pJob);
+        ScopedLock lock(m_mutex);
+        m_workQueue.push_back(pJob);
+        m_cond.Signal();
+    }
+}
+
+void TextureLoader::_UploadLoadedJobs()
+{
+    unsigned int uploadedBytes = 0;
+    int uploaded = 0;
+    std::vector<textureJob*>::iterator it = m_inFlight.begin();
+    while (it != m_inFlight.end())
+    {
+        textureJob* pJob = *it;
+        const long state = AtomicLoad(&pJob->state);
+        if (state == JobStaged)
+        {
+            ++it;
+            continue;
+        }
+        if ((state == JobLoaded) && (pJob->cancelled == false) &&
+            (uploaded > 0) && (uploadedBytes + pJob->byteSize() > m_uploadBudget))
+            break;
+
+        if (state == JobFailed)
+        {
+            LOG_ERROR("TextureLoader: could not load %s", pJob->filename.c_str());
+        }
+        else if ((pJob->cancelled == false) && glIsTexture(pJob->texture))
+        {
+            _Upload(*pJob);
+            uploadedBytes += pJob->byteSize();
+            ++uploaded;
+        }
+        _Retire(pJob);
+        it = m_inFlight.erase(it);
+    }
+}
+
+void TextureLoader::_Upload(textureJob& job)
+{
+    if (job.kind == KindKtx)
+    {
+        if (job.decoded)
+            LOG_INFO("TextureLoader: %s was decoded on the CPU", job.filename.c_str());
+        UploadKtx(job.ktx, job.texture, job.imageTarget, job.filename.c_str());
+        return;
+    }
+
+    GLint internalFormat = GL_RGBA8;
+    GLenum format = GL_RGBA;
+    formatForChannels(job.channels, internalFormat, format);
+    const GLenum bindTarget = bindTargetFor(job.imageTarget);
+
+    glBindTexture(bindTarget, job.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // Offsets into the bound unpack buffer, or pointers into cpuPixels.
+    const unsigned char* pBase = NULL;
+    if (job.mapped)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.pbo);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        job.mapped = false;
+    }
+    else
+    {
+        pBase = &job.cpuPixels[0];
+    }
+
+    if (job.kind == KindMipChain)
+    {
+        const unsigned int levels = MipLevelCount(job.width, job.height);
+        for (unsigned int level=0; level<levels; ++level)
+        {
+            unsigned int w, h;
+            MipLevelDimensions(job.width, job.height, level, w, h);
+            const size_t offset = sizeof(MipChainHeader) + MipLevelOffset(job.width, job.height, job.channels, level);
+            glTexImage2D(job.imageTarget, level, internalFormat, w, h, 0,
+                format, GL_UNSIGNED_BYTE, pBase + offset);
+        }
+        glTexParameteri(bindTarget, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    }
+    else
+    {
+        glTexImage2D(job.imageTarget, 0, internalFormat, job.width, job.height, 0,
+            format, GL_UNSIGNED_BYTE, pBase);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(bindTarget, 0);
+}
+
+// Unmap and recycle the job's buffer, then free it. The worker must be
+// done with the job.
+void TextureLoader::_Retire(textureJob* pJob)
+{
+    if (pJob->mapped)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pJob->pbo);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (pJob->pbo != 0)
+    {
+        m_freePbos.push_back(pJob->pbo);
+    }
+
+    std::map<GLuint, int>::iterator pending = m_pendingPerTexture.find(pJob->texture);
+    if ((pending != m_pendingPerTexture.end()) && (--pending->second <= 0))
+    {
+        m_pendingPerTexture.erase(pending);
+    }
+    delete pJob;
+}
+
+void TextureLoader::_WorkerEntry(void* pArg)
+{
+    reinterpret_cast<TextureLoader*>(pArg)->_WorkerLoop();
+}
+
+void TextureLoader::_WorkerLoop()
+{
+    for (;;)
+    {
+        textureJob* pJob = NULL;
+        {
+            ScopedLock lock(m_mutex);
+            while ((m_quit == false) && m_workQueue.empty())
+            {
+                m_cond.Wait(m_mutex);
+            }
+            if (m_quit)
+                return;
+            pJob = m_workQueue.front();
+            m_workQueue.pop_front();
+        }
+
+        const bool ok = _ReadPixels(*pJob);
+        AtomicStore(&pJob->state, ok ? JobLoaded : JobFailed);
+    }
+}
+
+///@brief Worker thread: fill the job's staging memory from the file.
+bool TextureLoader::_ReadPixels(textureJob& job)
+{
+    if (job.kind == KindKtx)
+        return _ReadKtx(job);
+    if (job.kind == KindMipChain)
+        return _ReadMipChain(job);
+    size_t fileSize = 0;
+    return _ReadFile(job, job.pStaging, job.byteSize(), fileSize);
+}
+
+///@brief Worker thread: copy a .mip file of the expected size as it is, or
+/// read level 0 and build the rest. The chain is built in memory of our
+/// own, since reading back from a mapped buffer can be very slow.
+bool TextureLoader::_ReadMipChain(const textureJob& job)
+{
+    size_t fileSize = 0;
+    if (_ReadFile(job, NULL, 0, fileSize) == false)
+        return false;
+
+    const size_t chainFileSize = job.byteSize();
+    if (fileSize == chainFileSize)
+    {
+        if (_ReadFile(job, job.pStaging, chainFileSize, fileSize) == false)
+            return false;
+        const MipChainHeader* pHeader = ParseMipChain(job.pStaging, chainFileSize);
+        return (pHeader != NULL) &&
+            (pHeader->width == job.width) &&
+            (pHeader->height == job.height) &&
+            (pHeader->channels == static_cast<unsigned int>(job.channels));
+    }
+
+    std::vector<unsigned char> chain(MipChainSize(job.width, job.height, job.channels));
+    const size_t levelSize = static_cast<size_t>(job.width) * job.height * job.channels;
+    if (_ReadFile(job, &chain[0], levelSize, fileSize) == false)
+        return false;
+    const bool srgb = (job.channels >= 3);
+    BuildMipChain(&chain[0], job.width, job.height, job.channels, srgb);
+
+    MipChainHeader header;
+    WriteMipChainHeader(header, job.width, job.height, job.channels, srgb ? MipChainSRGB : 0);
+    memcpy(job.pStaging, &header, sizeof(header));
+    memcpy(job.pStaging + sizeof(header), &chain[0], chain.size());
+    return true;
+}
+
+///@brief Worker thread: read a whole KTX file into cpuPixels and parse it,
+/// decoding it there if GL cannot sample its format.
+bool TextureLoader::_ReadKtx(textureJob& job)
+{
+    size_t fileSize = 0;
+    if ((_ReadFile(job, NULL, 0, fileSize) == false) || (fileSize == 0))
+        return false;
+    job.cpuPixels.resize(fileSize);
+    if ((_ReadFile(job, &job.cpuPixels[0], fileSize, fileSize) == false) ||
+        (ParseKtx(&job.cpuPixels[0], fileSize, job.ktx) == false) ||
+        (job.ktx.faces != 1))
+        return false;
+    if (KtxFormatSupported(job.ktx.internalFormat, job.support))
+        return true;
+
+    std::vector<unsigned char> pixels;
+    KtxImage decoded;
+    if (DecodeKtx(job.ktx, pixels, decoded) == false)
+        return false;
+    // Swapping keeps decoded's pointers valid.
+    job.cpuPixels.swap(pixels);
+    job.ktx = decoded;
+    job.decoded = true;
+    return true;
+}
+
+///@brief Worker thread: read size bytes from job.offset into pOut, from the
+/// AssetArchive if it has the file, decompressing straight into pOut where
+/// possible, or from the file system. Also reports the whole file's size;
+/// with pOut NULL, only that.
+bool TextureLoader::_ReadFile(const textureJob& job, unsigned char* pOut, size_t size, size_t& fileSize)
+{
+    const char* pName = job.archiveName.empty() ? job.filename.c_str() : job.archiveName.c_str();
+
+    const AssetArchive& archive = AssetArchive::Instance();
+    size_t storedSize = 0;
+    bool compressed = false;
+    const unsigned char* pStored = archive.Find(pName, storedSize, compressed);
+    if ((pStored != NULL) || compressed)
+    {
+        fileSize = storedSize;
+        if (pOut == NULL)
+            return true;
+        if (storedSize < job.offset + size)
+            return false;
+        if (pStored != NULL)
+        {
+            memcpy(pOut, pStored + job.offset, size);
+            return true;
+        }
+        if ((job.offset == 0) && (storedSize == size))
+            return archive.Read(pName, pOut, size);
+
+        std::vector<unsigned char> unpacked(storedSize);
+        if (archive.Read(pName, &unpacked[0], storedSize) == false)
+            return false;
+        memcpy(pOut, &unpacked[job.offset], size);
+        return true;
+    }
+
+    FILE* pF = fopen(job.filename.c_str(), "rb");
+    if (pF == NULL)
+        return false;
+    bool ok = (fseek(pF, 0, SEEK_END) == 0);
+    const long end = ftell(pF);
+    fileSize = (end > 0) ? static_cast<size_t>(end) : 0;
+    if (pOut != NULL)
+    {
+        ok = ok &&
+            (fseek(pF, static_cast<long>(job.offset), SEEK_SET) == 0) &&
+            (fread(pOut, 1, size, pF) == size);
+    }
+    fclose(pF);
+    return ok;
+}
+
+
+extern "C" {
+
+unsigned int fc_texture_load_raw(
+    const char* pPath, const char* pArchiveName,
+    int width, int height, int channels,
+    unsigned int texture, unsigned int imageTarget)
+{
+    if ((width <= 0) || (height <= 0))
+        return 0;
+    return TextureLoader::Instance().LoadRaw(pPath,
+        static_cast<unsigned int>(width), static_cast<unsigned int>(height), channels,
+        texture, imageTarget, 0, pArchiveName);
+}
+
+int fc_texture_is_ready(unsigned int texture)
+{
+    return TextureLoader::Instance().IsReady(texture) ? 1 : 0;
+}
+
+void fc_texture_cancel(unsigned int texture)
+{
+    TextureLoader::Instance().Cancel(texture);
+}
+
+unsigned int fc_texture_load_mips(
+    const char* pPath, const char* pArchiveName,
+    int width, int height, int channels,
+    unsigned int texture, unsigned int imageTarget)
+{
+    if ((width <= 0) || (height <= 0))
+        return 0;
+    return TextureLoader::Instance().LoadMipChain(pPath,
+        static_cast<unsigned int>(width), static_cast<unsigned int>(height), channels,
+        texture, imageTarget, pArchiveName);
+}
+
+unsigned int fc_texture_load_ktx(
+    const char* pPath, const char* pArchiveName,
+    unsigned int texture, unsigned int imageTarget)
+{
+    return TextureLoader::Instance().LoadKtx(pPath, texture, imageTarget, pArchiveName);
+}
+
+}
+
+const TextureLoaderApi* GetTextureLoaderApi()
+{
+    static const TextureLoaderApi api = {
+        fc_texture_load_raw,
+        fc_texture_is_ready,
+        fc_texture_cancel,
+        fc_texture_load_mips,
+        fc_texture_load_ktx,
+    };
+    return &api;
+}
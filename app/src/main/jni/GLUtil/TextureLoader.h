@@ -0,0 +1,188 @@
+// TextureLoader.h
+
+#pragma once
+
+#include "Singleton.h"
+#include "GL_Includes.h"
+#include "Threads.h"
+#include "TextureFunctions.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+///@brief Loads raw texture files without stalling the GL thread.
+/// LoadRaw returns a texture name at once, holding a 1x1 placeholder of
+/// zeros (transparent black). A worker thread reads the file (or unpacks
+/// it from the AssetArchive) straight into a mapped pixel unpack buffer,
+/// and Update, once per frame, uploads finished ones into their textures
+/// up to a byte budget. Until then IsReady is false and the texture can be
+/// drawn with as usual. LoadMipChain does the same for every level of a
+/// .mip file (see MipChain.h), or builds them from a raw file on the worker.
+/// LoadKtx takes a KTX file in its stored (e.g. ETC2 or ASTC) format, which
+/// the worker decodes only if GL cannot sample that format.
+///@warning Apart from the worker it owns, only call this from the GL thread.
+class TextureLoader : public Singleton
+{
+public:
+    static TextureLoader& Instance()
+    {
+        static TextureLoader instance;
+        return instance;
+    }
+    void Destroy();
+
+    GLuint LoadRaw(
+        const char* pFilename,
+        unsigned int width,
+        unsigned int height,
+        int channels,
+        GLuint texture = 0,
+        GLenum imageTarget = GL_TEXTURE_2D,
+        unsigned int offset = 0,
+        const char* pArchiveName = NULL);
+    GLuint LoadMipChain(
+        const char* pFilename,
+        unsigned int width,
+        unsigned int height,
+        int channels,
+        GLuint texture = 0,
+        GLenum imageTarget = GL_TEXTURE_2D,
+        const char* pArchiveName = NULL);
+    GLuint LoadKtx(
+        const char* pFilename,
+        GLuint texture = 0,
+        GLenum imageTarget = GL_TEXTURE_2D,
+        const char* pArchiveName = NULL);
+    void Cancel(GLuint texture);
+    void Update();
+
+    bool IsReady(GLuint texture) const { return m_pendingPerTexture.count(texture) == 0; }
+    int PendingCount() const { return static_cast<int>(m_waiting.size() + m_inFlight.size()); }
+    void SetUploadBudget(unsigned int bytesPerFrame) { m_uploadBudget = bytesPerFrame; }
+
+    static const int s_maxStaged = 4; ///< Unpack buffers mapped at once
+    static const unsigned int s_defaultUploadBudget = 4 * 1024 * 1024;
+
+protected:
+    enum jobState {
+        JobStaged, ///< Handed to the worker
+        JobLoaded,
+        JobFailed
+    };
+
+    enum jobKind {
+        KindRaw,
+        KindMipChain, ///< Staging holds a .mip file's header and all levels
+        KindKtx       ///< No unpack buffer: cpuPixels holds the file, ktx points into it
+    };
+
+    struct textureJob {
+        std::string filename;
+        std::string archiveName; ///< Name in the AssetArchive if not filename
+        unsigned int offset;
+        unsigned int width;
+        unsigned int height;
+        int channels;
+        GLuint texture;
+        GLenum imageTarget;
+        jobKind kind;
+        bool cancelled; ///< GL thread only
+        GLuint pbo;
+        bool mapped; ///< GL thread only
+        unsigned char* pStaging; ///< Mapped unpack buffer, or &cpuPixels[0] if mapping failed
+        std::vector<unsigned char> cpuPixels;
+        CompressedTextureSupport support; ///< What GL can sample, for the worker
+        KtxImage ktx;
+        bool decoded; ///< The worker decoded ktx from a format GL cannot sample
+        volatile long state;
+
+        unsigned int byteSize() const;
+    };
+
+    static void _WorkerEntry(void* pArg);
+    void _WorkerLoop();
+    static bool _ReadPixels(textureJob& job);
+    static bool _ReadMipChain(const textureJob& job);
+    static bool _ReadKtx(textureJob& job);
+    static bool _ReadFile(const textureJob& job, unsigned char* pOut, size_t size, size_t& fileSize);
+
+    GLuint _Request(
+        const char* pFilename,
+        unsigned int width,
+        unsigned int height,
+        int channels,
+        GLuint texture,
+        GLenum imageTarget,
+        unsigned int offset,
+        const char* pArchiveName,
+        jobKind kind);
+
+    void _StageWaitingJobs();
+    void _UploadLoadedJobs();
+    void _Upload(textureJob& job);
+    void _Retire(textureJob* pJob);
+
+    std::deque<textureJob*> m_waiting;   ///< Requested, no staging buffer yet
+    std::vector<textureJob*> m_inFlight; ///< Staged, in request order
+    std::vector<GLuint> m_freePbos;
+    std::map<GLuint, int> m_pendingPerTexture;
+    unsigned int m_uploadBudget;
+
+    Thread m_thread;
+    Mutex m_mutex;
+    ConditionVariable m_cond;
+    std::deque<textureJob*> m_workQueue; ///< Guarded by m_mutex
+    bool m_quit;                          ///< Guarded by m_mutex
+
+private:
+    TextureLoader();
+    ~TextureLoader();
+    TextureLoader(TextureLoader const& copy);            // Not Implemented
+    TextureLoader& operator=(TextureLoader const& copy); // Not Implemented
+};
+
+#if defined(_WIN32)
+#  define TEXTURELOADER_EXPORT __declspec(dllexport)
+#else
+#  define TEXTURELOADER_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// TextureLoader for Lua through ffi.C where the host exports its symbols.
+/// pArchiveName may be NULL. Must match the cdef in deploy/lua/util/textureloader.lua.
+extern "C" {
+TEXTURELOADER_EXPORT unsigned int fc_texture_load_raw(
+    const char* pPath, const char* pArchiveName,
+    int width, int height, int channels,
+    unsigned int texture, unsigned int imageTarget);
+TEXTURELOADER_EXPORT int fc_texture_is_ready(unsigned int texture);
+TEXTURELOADER_EXPORT void fc_texture_cancel(unsigned int texture);
+TEXTURELOADER_EXPORT unsigned int fc_texture_load_mips(
+    const char* pPath, const char* pArchiveName,
+    int width, int height, int channels,
+    unsigned int texture, unsigned int imageTarget);
+TEXTURELOADER_EXPORT unsigned int fc_texture_load_ktx(
+    const char* pPath, const char* pArchiveName,
+    unsigned int texture, unsigned int imageTarget);
+}
+
+/// The same functions as pointers, handed to Lua as native_texture_api for
+/// hosts that do not export symbols (e.g. the Android .so).
+struct TextureLoaderApi {
+    unsigned int (*fc_texture_load_raw)(
+        const char* pPath, const char* pArchiveName,
+        int width, int height, int channels,
+        unsigned int texture, unsigned int imageTarget);
+    int (*fc_texture_is_ready)(unsigned int texture);
+    void (*fc_texture_cancel)(unsigned int texture);
+    unsigned int (*fc_texture_load_mips)(
+        const char* pPath, const char* pArchiveName,
+        int width, int height, int channels,
+        unsigned int texture, unsigned int imageTarget);
+    unsigned int (*fc_texture_load_ktx)(
+        const char* pPath, const char* pArchiveName,
+        unsigned int texture, unsigned int imageTarget);
+};
+
+const TextureLoaderApi* GetTextureLoaderApi();
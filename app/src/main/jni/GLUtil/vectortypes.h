@@ -23,12 +23,6 @@ struct float3 {
     //float3(float _x, float _y, float _z): x(_x), y(_y), z(_z) {}
 };
 
-/// A point in 3 space with homogeneous coordinate.
-/// Used for transforming float3 by 4x4 matrix.
-struct float4 {
-    float x,y,z,w;
-};
-
 /// An axis-aligned rectangle in screen space.
 struct rect {
     int x,y,w,h;
@@ -43,3 +37,22 @@ struct float3Idx {
 };
 
 #pragma pack(pop)
+
+#if defined(_MSC_VER)
+#  define ALIGN16 __declspec(align(16))
+#else
+#  define ALIGN16 __attribute__((aligned(16)))
+#endif
+
+/// A point in 3 space with homogeneous coordinate.
+/// Used for transforming float3 by 4x4 matrix. Aligned so that
+/// arrays of them can be loaded straight into SIMD registers.
+struct ALIGN16 float4 {
+    float x,y,z,w;
+};
+
+/// A 4x4 matrix in COLUMN order, as GL expects it, aligned for SIMD.
+/// Operations on it are in MatrixMath.h.
+struct ALIGN16 mat4 {
+    float m[16];
+};
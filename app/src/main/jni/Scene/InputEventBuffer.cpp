@@ -0,0 +1,76 @@
+// InputEventBuffer.cpp
+
+#include "InputEventBuffer.h"
+#include "Logging.h"
+
+InputEventBuffer::InputEventBuffer()
+: m_count(0)
+, m_dropped(0)
+{
+}
+
+InputEventBuffer::~InputEventBuffer()
+{
+}
+
+///@return Pointer to the next free slot, or NULL if the buffer is full.
+queuedInputEvent* InputEventBuffer::_Next()
+{
+    if (m_count >= s_capacity)
+    {
+        ++m_dropped;
+        return NULL;
+    }
+    return &m_events[m_count++];
+}
+
+void InputEventBuffer::PushTouch(int pointerid, int action, int x, int y)
+{
+    queuedInputEvent* pE = _Next();
+    if (pE == NULL)
+        return;
+    pE->type = EventTouch;
+    pE->touch.pointerid = pointerid;
+    pE->touch.action = action;
+    pE->touch.x = x;
+    pE->touch.y = y;
+}
+
+void InputEventBuffer::PushAccelerometer(float x, float y, float z, int accuracy)
+{
+    queuedInputEvent* pE = _Next();
+    if (pE == NULL)
+        return;
+    pE->type = EventAccelerometer;
+    pE->accel.x = x;
+    pE->accel.y = y;
+    pE->accel.z = z;
+    pE->accel.accuracy = accuracy;
+}
+
+void InputEventBuffer::PushKey(int key, int scancode, int action, int mods)
+{
+    queuedInputEvent* pE = _Next();
+    if (pE == NULL)
+        return;
+    pE->type = EventKey;
+    pE->key.key = key;
+    pE->key.scancode = scancode;
+    pE->key.action = action;
+    pE->key.mods = mods;
+}
+
+/// Called once all events have been delivered; the next frame starts at slot 0.
+void InputEventBuffer::Clear()
+{
+    m_count = 0;
+}
+
+///@return Events dropped because the buffer was full since the last call,
+/// which reports them; Clear leaves the count alone.
+unsigned int InputEventBuffer::TakeDroppedCount()
+{
+    const unsigned int dropped = m_dropped;
+    m_dropped = 0;
+    return dropped;
+}
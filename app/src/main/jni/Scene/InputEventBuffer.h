@@ -0,0 +1,77 @@
+// InputEventBuffer.h
+
+#pragma once
+
+struct queuedTouchEvent {
+    int pointerid;
+    int action;
+    int x;
+    int y;
+};
+
+struct queuedAccelerometerEvent {
+    float x;
+    float y;
+    float z;
+    int accuracy;
+};
+
+struct queuedKeyEvent {
+    int key;
+    int scancode;
+    int action;
+    int mods;
+};
+
+/// Tags for the payload of a queuedInputEvent.
+///@note Mirrored by the ffi.cdef block in luaentry.lua - keep them in sync.
+enum InputEventType {
+    EventTouch = 0,
+    EventAccelerometer = 1,
+    EventKey = 2
+};
+
+/// One input event of any type, plain old data so Lua can read it through the FFI.
+struct queuedInputEvent {
+    int type; ///< One of InputEventType
+    union {
+        queuedTouchEvent touch;
+        queuedAccelerometerEvent accel;
+        queuedKeyEvent key;
+    };
+};
+
+///@brief A fixed-capacity buffer of input events collected between timesteps.
+/// Events are stored contiguously so the whole frame's worth can be handed to
+/// Lua as a single cdata array. The buffer is drained completely once per frame,
+/// so no allocation happens after construction.
+class InputEventBuffer
+{
+public:
+    InputEventBuffer();
+    virtual ~InputEventBuffer();
+
+    void PushTouch(int pointerid, int action, int x, int y);
+    void PushAccelerometer(float x, float y, float z, int accuracy);
+    void PushKey(int key, int scancode, int action, int mods);
+    void Clear();
+
+    const queuedInputEvent* Data() const { return m_events; }
+    int Count() const { return m_count; }
+    int Capacity() const { return s_capacity; }
+    bool Empty() const { return m_count == 0; }
+    unsigned int TakeDroppedCount();
+
+    static const int s_capacity = 512;
+
+protected:
+    queuedInputEvent* _Next();
+
+    queuedInputEvent m_events[s_capacity];
+    int m_count;
+    unsigned int m_dropped; ///< Events discarded because the buffer was full
+
+private: // Disallow copy ctor and assignment operator
+    InputEventBuffer(const InputEventBuffer&);
+    InputEventBuffer& operator=(const InputEventBuffer&);
+};
@@ -0,0 +1,376 @@
+// InputRecorder.cpp
+
+#include "InputRecorder.h"
+#include "Logging.h"
+
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#  define WINDOWS_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+// Header: magic, version, record size, reserved; 16 bytes keeps the
+// records' doubles aligned in the mapping.
+static const char s_logMagic[4] = { 'F', 'C', 'I', 'N' };
+static const unsigned int s_logVersion = 1;
+static const size_t s_headerSize = 16;
+
+// The file layout is the struct layout; catch a compiler that pads it.
+typedef char inputRecordSizeCheck[(sizeof(inputRecord) == 32) ? 1 : -1];
+
+static unsigned int readU32(const unsigned char* u)
+{
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<unsigned int>(u[3]) << 24);
+}
+
+static void writeU32(unsigned char* u, unsigned int v)
+{
+    u[0] = v & 0xff;
+    u[1] = (v >> 8) & 0xff;
+    u[2] = (v >> 16) & 0xff;
+    u[3] = (v >> 24) & 0xff;
+}
+
+InputRecorder::InputRecorder()
+: m_pFile(NULL)
+, m_filename()
+, m_buffer()
+, m_recordCount(0)
+, m_timer()
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    Stop();
+}
+
+///@brief Create the log, replacing any file of that name, and start the
+/// clock its timestamps count from.
+bool InputRecorder::Start(const std::string& filename)
+{
+    Stop();
+
+    m_pFile = fopen(filename.c_str(), "wb");
+    if (m_pFile == NULL)
+    {
+        LOG_ERROR("InputRecorder: could not open %s for writing.", filename.c_str());
+        return false;
+    }
+
+    unsigned char header[s_headerSize];
+    memset(header, 0, sizeof(header));
+    memcpy(header, s_logMagic, sizeof(s_logMagic));
+    writeU32(header + 4, s_logVersion);
+    writeU32(header + 8, sizeof(inputRecord));
+    fwrite(header, 1, sizeof(header), m_pFile);
+
+    m_filename = filename;
+    m_buffer.reserve(s_bufferRecords);
+    m_recordCount = 0;
+    m_timer.reset();
+    LOG_INFO("InputRecorder: recording to %s", filename.c_str());
+    return true;
+}
+
+void InputRecorder::Stop()
+{
+    if (m_pFile == NULL)
+        return;
+
+    _FlushBuffer();
+    fclose(m_pFile);
+    m_pFile = NULL;
+    LOG_INFO("InputRecorder: wrote %u events to %s", m_recordCount, m_filename.c_str());
+}
+
+void InputRecorder::_FlushBuffer()
+{
+    if (m_buffer.empty())
+        return;
+
+    if (fwrite(&m_buffer[0], sizeof(inputRecord), m_buffer.size(), m_pFile) != m_buffer.size())
+    {
+        LOG_ERROR("InputRecorder: write to %s failed.", m_filename.c_str());
+    }
+    m_buffer.clear();
+}
+
+///@return A zeroed record stamped with the current time, or NULL when not recording.
+inputRecord* InputRecorder::_Next(int type)
+{
+    if (m_pFile == NULL)
+        return NULL;
+
+    if (static_cast<int>(m_buffer.size()) >= s_bufferRecords)
+        _FlushBuffer();
+
+    m_buffer.resize(m_buffer.size() + 1);
+    inputRecord* pR = &m_buffer.back();
+    memset(pR, 0, sizeof(inputRecord));
+    pR->time = m_timer.seconds();
+    pR->type = type;
+    ++m_recordCount;
+    return pR;
+}
+
+void InputRecorder::RecordTouch(int pointerid, int action, float x, float y)
+{
+    inputRecord* pR = _Next(InputRecordTouch);
+    if (pR == NULL)
+        return;
+    pR->touch.pointerid = pointerid;
+    pR->touch.action = action;
+    pR->touch.x = x;
+    pR->touch.y = y;
+}
+
+void InputRecorder::RecordKey(int key, int scancode, int action, int mods)
+{
+    inputRecord* pR = _Next(InputRecordKey);
+    if (pR == NULL)
+        return;
+    pR->key.key = key;
+    pR->key.scancode = scancode;
+    pR->key.action = action;
+    pR->key.mods = mods;
+}
+
+void InputRecorder::RecordWheel(double dx, double dy)
+{
+    inputRecord* pR = _Next(InputRecordWheel);
+    if (pR == NULL)
+        return;
+    pR->wheel.dx = static_cast<float>(dx);
+    pR->wheel.dy = static_cast<float>(dy);
+}
+
+void InputRecorder::RecordAccelerometer(float x, float y, float z, int accuracy)
+{
+    inputRecord* pR = _Next(InputRecordAccelerometer);
+    if (pR == NULL)
+        return;
+    pR->accel.x = x;
+    pR->accel.y = y;
+    pR->accel.z = z;
+    pR->accel.accuracy = accuracy;
+}
+
+void InputRecorder::RecordWindowSize(int w, int h)
+{
+    inputRecord* pR = _Next(InputRecordWindowSize);
+    if (pR == NULL)
+        return;
+    pR->size.w = w;
+    pR->size.h = h;
+}
+
+
+InputReplayer::InputReplayer()
+: m_pBase(NULL)
+, m_mappedSize(0)
+, m_pRecords(NULL)
+, m_recordCount(0)
+, m_playbackIdx(0)
+, m_speed(1.)
+, m_startTime(0.)
+#ifdef _WIN32
+, m_hFile(INVALID_HANDLE_VALUE)
+, m_hMapping(NULL)
+#endif
+{
+}
+
+InputReplayer::~InputReplayer()
+{
+    Close();
+}
+
+void InputReplayer::Close()
+{
+    m_pRecords = NULL;
+    m_recordCount = 0;
+    m_playbackIdx = 0;
+    if (m_pBase == NULL)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_pBase);
+    CloseHandle(m_hMapping);
+    CloseHandle(m_hFile);
+    m_hMapping = NULL;
+    m_hFile = INVALID_HANDLE_VALUE;
+#else
+    munmap(const_cast<unsigned char*>(m_pBase), m_mappedSize);
+#endif
+    m_pBase = NULL;
+    m_mappedSize = 0;
+}
+
+///@brief Check a file's header without mapping it.
+bool InputReplayer::IsInputLog(const std::string& filename)
+{
+    FILE* pF = fopen(filename.c_str(), "rb");
+    if (pF == NULL)
+        return false;
+    char magic[sizeof(s_logMagic)];
+    const bool match = (fread(magic, 1, sizeof(magic), pF) == sizeof(magic)) &&
+        (memcmp(magic, s_logMagic, sizeof(magic)) == 0);
+    fclose(pF);
+    return match;
+}
+
+///@brief Map a log written by InputRecorder. A partial record at the end,
+/// as a crash while recording leaves, is ignored.
+///@return false, leaving nothing open, if the file is missing or malformed.
+bool InputReplayer::Open(const std::string& filename)
+{
+    Close();
+
+#ifdef _WIN32
+    m_hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+    {
+        LOG_ERROR("InputReplayer: %s not found.", filename.c_str());
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if ((GetFileSizeEx(m_hFile, &fileSize) == 0) ||
+        (fileSize.QuadPart < static_cast<LONGLONG>(s_headerSize)))
+    {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+        LOG_ERROR("InputReplayer: %s is not an input log.", filename.c_str());
+        return false;
+    }
+    m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_hMapping != NULL)
+    {
+        m_pBase = reinterpret_cast<const unsigned char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (m_pBase == NULL)
+    {
+        if (m_hMapping != NULL)
+            CloseHandle(m_hMapping);
+        CloseHandle(m_hFile);
+        m_hMapping = NULL;
+        m_hFile = INVALID_HANDLE_VALUE;
+        LOG_ERROR("InputReplayer: could not map %s", filename.c_str());
+        return false;
+    }
+    m_mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        LOG_ERROR("InputReplayer: %s not found.", filename.c_str());
+        return false;
+    }
+    struct stat fst;
+    if ((fstat(fd, &fst) != 0) || (fst.st_size < static_cast<off_t>(s_headerSize)))
+    {
+        close(fd);
+        LOG_ERROR("InputReplayer: %s is not an input log.", filename.c_str());
+        return false;
+    }
+    void* pMap = mmap(NULL, static_cast<size_t>(fst.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (pMap == MAP_FAILED)
+    {
+        LOG_ERROR("InputReplayer: could not map %s", filename.c_str());
+        return false;
+    }
+    m_pBase = reinterpret_cast<const unsigned char*>(pMap);
+    m_mappedSize = static_cast<size_t>(fst.st_size);
+#endif
+
+    if ((memcmp(m_pBase, s_logMagic, sizeof(s_logMagic)) != 0) ||
+        (readU32(m_pBase + 4) != s_logVersion) ||
+        (readU32(m_pBase + 8) != sizeof(inputRecord)))
+    {
+        LOG_ERROR("InputReplayer: %s is not a version %u input log.", filename.c_str(), s_logVersion);
+        Close();
+        return false;
+    }
+
+    m_pRecords = reinterpret_cast<const inputRecord*>(m_pBase + s_headerSize);
+    m_recordCount = (m_mappedSize - s_headerSize) / sizeof(inputRecord);
+    m_playbackIdx = 0;
+    LOG_INFO("InputReplayer: %s holds %u events over %.1f s",
+        filename.c_str(), static_cast<unsigned int>(m_recordCount), Duration());
+    return true;
+}
+
+double InputReplayer::Duration() const
+{
+    if (m_recordCount == 0)
+        return 0.;
+    return m_pRecords[m_recordCount - 1].time;
+}
+
+///@brief Rewind to the first event, to be played from now on.
+///@param speed Multiplies recorded time; 2 replays a session in half the time.
+///@param now Seconds on the clock later passed to Update.
+void InputReplayer::Start(double speed, double now)
+{
+    m_speed = (speed > 0.) ? speed : 1.;
+    m_playbackIdx = 0;
+    m_startTime = now;
+}
+
+///@brief Call back with every event whose time has come since the last
+/// Update, in recorded order.
+void InputReplayer::Update(double now, const callbacks& cb)
+{
+    if (m_pRecords == NULL)
+        return;
+
+    const double recordedTime = m_speed * (now - m_startTime);
+    while ((m_playbackIdx < m_recordCount) && (m_pRecords[m_playbackIdx].time <= recordedTime))
+    {
+        _Dispatch(m_pRecords[m_playbackIdx], cb);
+        ++m_playbackIdx;
+    }
+}
+
+void InputReplayer::_Dispatch(const inputRecord& r, const callbacks& cb) const
+{
+    switch (r.type)
+    {
+    default:
+        break;
+
+    case InputRecordTouch:
+        if (cb.touch != NULL)
+            cb.touch(r.touch.pointerid, r.touch.action, r.touch.x, r.touch.y);
+        break;
+
+    case InputRecordKey:
+        if (cb.key != NULL)
+            cb.key(r.key.key, r.key.scancode, r.key.action, r.key.mods);
+        break;
+
+    case InputRecordWheel:
+        if (cb.wheel != NULL)
+            cb.wheel(r.wheel.dx, r.wheel.dy);
+        break;
+
+    case InputRecordAccelerometer:
+        if (cb.accelerometer != NULL)
+            cb.accelerometer(r.accel.x, r.accel.y, r.accel.z, r.accel.accuracy);
+        break;
+
+    case InputRecordWindowSize:
+        if (cb.windowSize != NULL)
+            cb.windowSize(r.size.w, r.size.h);
+        break;
+    }
+}
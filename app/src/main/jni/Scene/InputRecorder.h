@@ -0,0 +1,132 @@
+// InputRecorder.h
+// Binary input logs: every event cpp_interface receives, with the time it
+// arrived, so a session can be driven through the scene again exactly.
+
+#pragma once
+
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/// Tags for inputRecord::type. Values are stored in log files - append only.
+enum InputRecordType {
+    InputRecordTouch = 0,
+    InputRecordKey = 1,
+    InputRecordWheel = 2,
+    InputRecordAccelerometer = 3,
+    InputRecordWindowSize = 4
+};
+
+struct recordedTouch { int pointerid; int action; float x; float y; };
+struct recordedKey { int key; int scancode; int action; int mods; };
+struct recordedWheel { float dx; float dy; };
+struct recordedAccelerometer { float x; float y; float z; int accuracy; };
+struct recordedWindowSize { int w; int h; };
+
+///@brief One event as stored in an input log: 32 bytes, little-endian, so
+/// a mapped log is an array of these right after the header.
+struct inputRecord {
+    double time; ///< Seconds since recording started, monotonic
+    int type;    ///< One of InputRecordType
+    union {
+        recordedTouch touch;
+        recordedKey key;
+        recordedWheel wheel;
+        recordedAccelerometer accel;
+        recordedWindowSize size;
+        int pad[5];
+    };
+};
+
+///@brief Writes the events passed to it to an input log.
+/// Records collect in memory and go to the file a few thousand at a time,
+/// so recording costs the input callbacks a copy. The header carries no
+/// count; a log cut short by a crash is still readable up to its last
+/// whole record.
+class InputRecorder
+{
+public:
+    InputRecorder();
+    virtual ~InputRecorder();
+
+    bool Start(const std::string& filename);
+    void Stop();
+    bool IsRecording() const { return m_pFile != NULL; }
+    unsigned int RecordCount() const { return m_recordCount; }
+
+    void RecordTouch(int pointerid, int action, float x, float y);
+    void RecordKey(int key, int scancode, int action, int mods);
+    void RecordWheel(double dx, double dy);
+    void RecordAccelerometer(float x, float y, float z, int accuracy);
+    void RecordWindowSize(int w, int h);
+
+    static const int s_bufferRecords = 4096;
+
+protected:
+    inputRecord* _Next(int type);
+    void _FlushBuffer();
+
+    FILE* m_pFile;
+    std::string m_filename;
+    std::vector<inputRecord> m_buffer;
+    unsigned int m_recordCount;
+    Timer m_timer;
+
+private: // Disallow copy ctor and assignment operator
+    InputRecorder(const InputRecorder&);
+    InputRecorder& operator=(const InputRecorder&);
+};
+
+///@brief Calls back with the events of an input log as their recorded
+/// times come up on the clock passed in, optionally faster than they were
+/// recorded.
+/// The log is mapped rather than read, so opening one takes the same time
+/// however long the session was.
+class InputReplayer
+{
+public:
+    struct callbacks {
+        void (*touch)(int pointerid, int action, float x, float y);
+        void (*key)(int key, int scancode, int action, int mods);
+        void (*wheel)(double dx, double dy);
+        void (*accelerometer)(float x, float y, float z, int accuracy);
+        void (*windowSize)(int w, int h);
+    };
+
+    InputReplayer();
+    virtual ~InputReplayer();
+
+    bool Open(const std::string& filename);
+    void Close();
+    bool IsOpen() const { return m_pRecords != NULL; }
+
+    void Start(double speed, double now);
+    void Update(double now, const callbacks& cb);
+    bool Finished() const { return m_playbackIdx >= m_recordCount; }
+    size_t RecordCount() const { return m_recordCount; }
+    double Duration() const;
+
+    static bool IsInputLog(const std::string& filename);
+
+protected:
+    void _Dispatch(const inputRecord& r, const callbacks& cb) const;
+
+    const unsigned char* m_pBase;
+    size_t m_mappedSize;
+    const inputRecord* m_pRecords; ///< Points into the mapping
+    size_t m_recordCount;
+    size_t m_playbackIdx;
+    double m_speed;
+    double m_startTime;
+#ifdef _WIN32
+    void* m_hFile;
+    void* m_hMapping;
+#endif
+
+private: // Disallow copy ctor and assignment operator
+    InputReplayer(const InputReplayer&);
+    InputReplayer& operator=(const InputReplayer&);
+};
@@ -0,0 +1,282 @@
+// LuaBundle.cpp
+
+#include "LuaBundle.h"
+#include "AssetArchive.h"
+#include "Logging.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char s_bundleMagic[4] = { 'F', 'C', 'L', 'B' };
+static const unsigned int s_bundleVersion = 1;
+static const size_t s_headerSize = 12;
+static const size_t s_indexEntrySize = 16;
+
+static unsigned int readU32(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<unsigned int>(u[3]) << 24);
+}
+
+LuaBundle::LuaBundle()
+: m_data()
+, m_entries()
+, m_sourceRoot()
+, m_bundleTime(0)
+, m_served(0)
+, m_stale(0)
+{
+}
+
+LuaBundle::~LuaBundle()
+{
+}
+
+void LuaBundle::Clear()
+{
+    m_data.clear();
+    m_entries.clear();
+    m_served = 0;
+    m_stale = 0;
+}
+
+///@brief Read the whole bundle into memory and check its index.
+///@return false, leaving the bundle empty, if the file is missing or malformed.
+bool LuaBundle::Load(const std::string& bundleFile, const std::string& sourceRoot)
+{
+    Clear();
+    m_sourceRoot = sourceRoot;
+
+    FILE* pF = fopen(bundleFile.c_str(), "rb");
+    if (pF == NULL)
+        return false;
+
+    fseek(pF, 0, SEEK_END);
+    const long size = ftell(pF);
+    fseek(pF, 0, SEEK_SET);
+    if (size > static_cast<long>(s_headerSize))
+    {
+        m_data.resize(static_cast<size_t>(size));
+        if (fread(&m_data[0], 1, m_data.size(), pF) != m_data.size())
+        {
+            m_data.clear();
+        }
+    }
+    fclose(pF);
+
+    if (m_data.empty() ||
+        (memcmp(&m_data[0], s_bundleMagic, sizeof(s_bundleMagic)) != 0) ||
+        (readU32(&m_data[4]) != s_bundleVersion))
+    {
+        LOG_ERROR("LuaBundle: %s is not a version %u bundle.", bundleFile.c_str(), s_bundleVersion);
+        Clear();
+        return false;
+    }
+
+    const size_t count = readU32(&m_data[8]);
+    if (s_headerSize + count * s_indexEntrySize > m_data.size())
+    {
+        LOG_ERROR("LuaBundle: %s index is truncated.", bundleFile.c_str());
+        Clear();
+        return false;
+    }
+
+    m_entries.resize(count);
+    for (size_t i=0; i<count; ++i)
+    {
+        const char* pIndex = &m_data[s_headerSize + i * s_indexEntrySize];
+        const size_t nameOffset = readU32(pIndex);
+        const size_t nameLength = readU32(pIndex + 4);
+        bundleEntry& e = m_entries[i];
+        e.dataOffset = readU32(pIndex + 8);
+        e.dataLength = readU32(pIndex + 12);
+        if ((nameOffset + nameLength >= m_data.size()) ||
+            (m_data[nameOffset + nameLength] != '\0') ||
+            (static_cast<size_t>(e.dataOffset) + e.dataLength > m_data.size()))
+        {
+            LOG_ERROR("LuaBundle: %s entry %d is out of range.", bundleFile.c_str(), static_cast<int>(i));
+            Clear();
+            return false;
+        }
+        e.pName = &m_data[nameOffset];
+    }
+
+    struct stat st;
+    m_bundleTime = (stat(bundleFile.c_str(), &st) == 0) ? st.st_mtime : 0;
+
+    LOG_INFO("LuaBundle: %d modules in %s", static_cast<int>(count), bundleFile.c_str());
+    return true;
+}
+
+///@return The entry for the given module name by binary search, or NULL.
+const LuaBundle::bundleEntry* LuaBundle::_Find(const char* pModuleName) const
+{
+    int lo = 0;
+    int hi = static_cast<int>(m_entries.size()) - 1;
+    while (lo <= hi)
+    {
+        const int mid = (lo + hi) / 2;
+        const int c = strcmp(pModuleName, m_entries[mid].pName);
+        if (c == 0)
+            return &m_entries[mid];
+        if (c < 0)
+            hi = mid - 1;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+bool LuaBundle::_SourceIsNewer(const char* pModuleName) const
+{
+#ifdef __ANDROID__
+    // Sources and bundle are unpacked together; their times say nothing.
+    (void)pModuleName;
+    return false;
+#else
+    std::string path = m_sourceRoot + pModuleName;
+    for (size_t i=m_sourceRoot.length(); i<path.length(); ++i)
+    {
+        if (path[i] == '.')
+            path[i] = '/';
+    }
+    path += ".lua";
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    return st.st_mtime > m_bundleTime;
+#endif
+}
+
+///@brief Push the compiled chunk for the given module.
+///@return false, with nothing pushed, if the bundle does not have it, has an
+/// older copy than the source, or it does not load (e.g. bytecode from a
+/// different LuaJIT build).
+bool LuaBundle::PushModule(lua_State* L, const char* pModuleName)
+{
+    const bundleEntry* pEntry = _Find(pModuleName);
+    if (pEntry == NULL)
+        return false;
+
+    if (_SourceIsNewer(pModuleName))
+    {
+        ++m_stale;
+        return false;
+    }
+
+    const std::string chunkName = std::string("=") + pModuleName;
+    if (luaL_loadbuffer(L, &m_data[pEntry->dataOffset], pEntry->dataLength, chunkName.c_str()) != 0)
+    {
+        LOG_ERROR("LuaBundle: could not load %s: %s", pModuleName, lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return false;
+    }
+    ++m_served;
+    return true;
+}
+
+// package.loaders entry: returns the module's chunk, or a message saying
+// why it was not found for require to list with the others.
+static int l_bundle_searcher(lua_State* L)
+{
+    LuaBundle* pBundle = reinterpret_cast<LuaBundle*>(lua_touserdata(L, lua_upvalueindex(1)));
+    const char* pName = luaL_checkstring(L, 1);
+    if ((pBundle != NULL) && pBundle->PushModule(L, pName))
+        return 1;
+
+    lua_pushfstring(L, "\n\tno module '%s' in bytecode bundle", pName);
+    return 1;
+}
+
+// Shift package.loaders[2..] up one and put the given searcher in slot 2,
+// right after the preload searcher.
+static void insertSearcher(lua_State* L, lua_CFunction searcher, void* pUpvalue)
+{
+    lua_getglobal(L, "package");
+    lua_getfield(L, -1, "loaders");
+    if (lua_istable(L, -1) == false)
+    {
+        lua_pop(L, 2);
+        return;
+    }
+
+    const int loaders = lua_gettop(L);
+    const int n = static_cast<int>(lua_objlen(L, loaders));
+    for (int i=n; i>=2; --i)
+    {
+        lua_rawgeti(L, loaders, i);
+        lua_rawseti(L, loaders, i+1);
+    }
+    lua_pushlightuserdata(L, pUpvalue);
+    lua_pushcclosure(L, searcher, 1);
+    lua_rawseti(L, loaders, 2);
+    lua_pop(L, 2);
+}
+
+///@brief Insert the bundle searcher into package.loaders right after the
+/// preload searcher, ahead of the source and C module searchers.
+void LuaBundle::InstallSearcher(lua_State* L)
+{
+    insertSearcher(L, l_bundle_searcher, this);
+}
+
+///@brief Push the source chunk for the given module from lua/ in the mounted
+/// asset archive, compiled but not run.
+///@return false, with nothing pushed, if the archive does not have it or it
+/// does not compile; the file searcher then reports the error as usual.
+bool PushArchivedModule(lua_State* L, const char* pModuleName)
+{
+    std::string path = std::string("lua/") + pModuleName;
+    for (size_t i=4; i<path.length(); ++i)
+    {
+        if (path[i] == '.')
+            path[i] = '/';
+    }
+    path += ".lua";
+
+    size_t size = 0;
+    bool compressed = false;
+    const AssetArchive& archive = AssetArchive::Instance();
+    const unsigned char* pSource = archive.Find(path.c_str(), size, compressed);
+    std::vector<unsigned char> unpacked;
+    if ((pSource == NULL) && compressed)
+    {
+        unpacked.resize(size);
+        if ((size > 0) && archive.Read(path.c_str(), &unpacked[0], size))
+            pSource = &unpacked[0];
+    }
+    if (pSource == NULL)
+        return false;
+
+    const std::string chunkName = std::string("@") + path;
+    if (luaL_loadbuffer(L, reinterpret_cast<const char*>(pSource), size, chunkName.c_str()) != 0)
+    {
+        LOG_ERROR("AssetArchive: could not load %s: %s", path.c_str(), lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
+static int l_archive_searcher(lua_State* L)
+{
+    const char* pName = luaL_checkstring(L, 1);
+    if (PushArchivedModule(L, pName))
+        return 1;
+
+    lua_pushfstring(L, "\n\tno module '%s' in asset archive", pName);
+    return 1;
+}
+
+///@brief Insert a searcher for Lua sources in the mounted asset archive into
+/// package.loaders after the preload searcher. Installed before the bundle
+/// searcher, which then goes ahead of it.
+void InstallArchiveSearcher(lua_State* L)
+{
+    if (AssetArchive::Instance().IsMounted())
+    {
+        insertSearcher(L, l_archive_searcher, NULL);
+    }
+}
@@ -0,0 +1,58 @@
+// LuaBundle.h
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <time.h>
+#include <lua.hpp>
+
+///@brief Precompiled LuaJIT bytecode for the scripts under deploy/lua, packed
+/// into one indexed file by tools/make_lua_bundle.lua. Installed as a
+/// package.loaders searcher ahead of the source file searcher, so require()
+/// skips parsing for every module in the bundle and falls back to source
+/// for the rest.
+///@note Off Android, a module whose source file is newer than the bundle is
+/// left to the source searcher so edits show up without rebuilding it.
+class LuaBundle
+{
+public:
+    LuaBundle();
+    virtual ~LuaBundle();
+
+    bool Load(const std::string& bundleFile, const std::string& sourceRoot);
+    void Clear();
+    bool IsLoaded() const { return m_entries.empty() == false; }
+    int ModuleCount() const { return static_cast<int>(m_entries.size()); }
+
+    void InstallSearcher(lua_State* L);
+    bool PushModule(lua_State* L, const char* pModuleName);
+
+    unsigned int ModulesServed() const { return m_served; }
+    unsigned int ModulesStale() const { return m_stale; }
+
+protected:
+    struct bundleEntry {
+        const char* pName; ///< Points into m_data
+        unsigned int dataOffset;
+        unsigned int dataLength;
+    };
+
+    const bundleEntry* _Find(const char* pModuleName) const;
+    bool _SourceIsNewer(const char* pModuleName) const;
+
+    std::vector<char> m_data;
+    std::vector<bundleEntry> m_entries; ///< Sorted by name
+    std::string m_sourceRoot;
+    time_t m_bundleTime;
+    unsigned int m_served;
+    unsigned int m_stale;
+
+private: // Disallow copy ctor and assignment operator
+    LuaBundle(const LuaBundle&);
+    LuaBundle& operator=(const LuaBundle&);
+};
+
+/// Lua sources served from lua/ in the mounted AssetArchive.
+bool PushArchivedModule(lua_State* L, const char* pModuleName);
+void InstallArchiveSearcher(lua_State* L);
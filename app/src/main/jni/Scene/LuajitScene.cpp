@@ -2,8 +2,18 @@
 
 #include "LuajitScene.h"
 #include "DataDirectoryLocation.h"
+#include "FrameProfiler.h"
+#include "MatrixMath.h"
+#include "AssetArchive.h"
+#include "TextureLoader.h"
+#include "RenderCommandStream.h"
+#include "JobSystem.h"
+#include "NBodySystem.h"
+#include "ShaderFunctions.h"
 #include "Logging.h"
+#include <string.h>
 #include <sstream>
+#include <algorithm>
 
 #ifdef USE_SIXENSE
 #include <sixense.h>
@@ -16,10 +26,31 @@ LuajitScene::LuajitScene()
 , m_errorOccurred(false)
 , m_errorText()
 , m_changeSceneOnNextTimestep(false)
-, m_queuedTouchEvents()
-, m_queuedAccelerometerEvents()
-, m_queuedKeyEvents()
+, m_queuedEvents()
+, m_bundle()
+, m_lookupsAvoided(0)
+, m_viewsThisFrame(0)
+, m_frameNumber(0)
+, m_drawAlpha(1.)
+, m_pAcquireGL(NULL)
+, m_frameTimer()
+, m_gcBudget(.001)
+, m_targetFrameTime(1. / 60.)
+, m_gcInCycle(false)
+, m_gcBaselineKb(s_gcMinBaselineKb)
+, m_gcTimeTotal(0.)
+, m_gcTimeMax(0.)
+, m_gcFrames(0)
+, m_gcForcedCycles(0)
 {
+    for (int i=0; i<CbCount; ++i)
+    {
+        m_callbackRefs[i] = LUA_NOREF;
+    }
+    memset(m_views, 0, sizeof(m_views));
+    // Construct the pool first so it is destroyed after a static scene,
+    // whose exitLua stops it.
+    JobSystem::Instance();
 }
 
 LuajitScene::~LuajitScene()
@@ -31,8 +62,13 @@ void LuajitScene::exitLua()
 {
     if (m_Lua != NULL)
     {
+        _ReleaseCallbacks();
+        // Jobs may still be writing to arrays the Lua state owns.
+        JobSystem::Instance().Stop();
         lua_close(m_Lua);
+        m_Lua = NULL;
     }
+    m_queuedEvents.Clear();
     m_errorOccurred = false;
     m_errorText = "";
 }
@@ -57,6 +93,53 @@ static int l_my_print(lua_State* L) {
     return 0;
 }
 
+// Lets luaentry.lua re-resolve our cached callbacks after it redefines globals,
+// e.g. when switch_to_scene reloads modules.
+static int l_refresh_callbacks(lua_State* L) {
+    LuajitScene* pScene = reinterpret_cast<LuajitScene*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (pScene != NULL)
+    {
+        pScene->RefreshCallbacks();
+    }
+    return 0;
+}
+
+// native_set_gc_budget(budgetMs [, targetFrameMs]); a budget of 0 returns
+// collection to LuaJIT's own pacing.
+static int l_set_gc_budget(lua_State* L) {
+    LuajitScene* pScene = reinterpret_cast<LuajitScene*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (pScene != NULL)
+    {
+        const double budgetMs = luaL_checknumber(L, 1);
+        const double frameMs = luaL_optnumber(L, 2, 1000. / 60.);
+        pScene->SetGCBudget(.001 * budgetMs, .001 * frameMs);
+    }
+    return 0;
+}
+
+// native_full_gc(): a full collection that also resets the pacing baseline,
+// for when a frame spike is expected anyway, e.g. at scene switches.
+static int l_full_gc(lua_State* L) {
+    LuajitScene* pScene = reinterpret_cast<LuajitScene*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (pScene != NULL)
+    {
+        pScene->CollectAllGarbage();
+    }
+    return 0;
+}
+
+// native_acquire_gl(): wait for the render thread, if there is one, to
+// finish with the GL context and take it back, before making GL calls
+// outside of on_lua_draw or on_lua_record.
+static int l_acquire_gl(lua_State* L) {
+    const LuajitScene* pScene = reinterpret_cast<const LuajitScene*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (pScene != NULL)
+    {
+        pScene->AcquireGL();
+    }
+    return 0;
+}
+
 static const struct luaL_Reg printlib [] = {
     {"print", l_my_print},
     {NULL, NULL} /* end of array */
@@ -69,9 +152,79 @@ extern void luaopen_luamylib(lua_State *L)
     lua_pop(L, 1);
 }
 
+static const char* s_callbackNames[CbCount] = {
+    "on_lua_initgl",
+    "on_lua_exitgl",
+    "on_lua_timestep",
+    "on_lua_draw",
+    "on_lua_events",
+    "on_lua_singletouch",
+    "on_lua_accelerometer",
+    "on_lua_keypressed",
+    "on_lua_setwindowsize",
+    "on_lua_changescene",
+    "on_lua_setTimeScale",
+    "on_lua_settracking",
+    "on_lua_getscenenames",
+    "on_lua_switchtoscene",
+    "on_lua_record",
+};
+
+void LuajitScene::_ReleaseCallbacks()
+{
+    for (int i=0; i<CbCount; ++i)
+    {
+        if (m_Lua != NULL)
+        {
+            luaL_unref(m_Lua, LUA_REGISTRYINDEX, m_callbackRefs[i]);
+        }
+        m_callbackRefs[i] = LUA_NOREF;
+    }
+}
+
+///@brief Look up every on_lua_* global once and hold a registry reference to it
+/// so the per-frame and per-event calls can skip the global table hash lookup.
+void LuajitScene::RefreshCallbacks()
+{
+    if (m_Lua == NULL)
+        return;
+
+    lua_State *L = m_Lua;
+    _ReleaseCallbacks();
+    for (int i=0; i<CbCount; ++i)
+    {
+        lua_getglobal(L, s_callbackNames[i]);
+        if (lua_isfunction(L, -1))
+        {
+            m_callbackRefs[i] = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+        else
+        {
+            lua_pop(L, 1);
+        }
+    }
+}
+
+///@brief Push the Lua function for the given entry point onto the stack.
+/// Falls back to a global lookup if it was not resolved, which leaves nil
+/// on the stack for a missing function just as before.
+void LuajitScene::_PushCallback(LuaCallback cb) const
+{
+    lua_State *L = m_Lua;
+    const int ref = m_callbackRefs[cb];
+    if (ref != LUA_NOREF)
+    {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+        ++m_lookupsAvoided;
+        return;
+    }
+    lua_getglobal(L, s_callbackNames[cb]);
+}
+
 void LuajitScene::initGL()
 {
     LOG_INFO("--- Lua ---");
+    Timer startupTimer;
 
     m_Lua = luaL_newstate();
     luaL_openlibs(m_Lua);
@@ -81,9 +234,60 @@ void LuajitScene::initGL()
     lua_State *L = m_Lua;
     luaopen_luamylib(L);
 
+    // Scenes mark profiler zones through FFI; see util/profiler.lua.
+    lua_pushlightuserdata(L, (void*)(GetFrameProfilerApi()));
+    lua_setglobal(L, "native_profiler_api");
+
+    // SIMD matrix kernels for util/simdmath.lua where ffi.C cannot see them.
+    lua_pushlightuserdata(L, (void*)(GetMatrixMathApi()));
+    lua_setglobal(L, "native_matrix_api");
+
+    // Program binaries cached across runs; see util/shaderfunctions.lua.
+    lua_pushlightuserdata(L, (void*)(GetShaderFunctionsApi()));
+    lua_setglobal(L, "native_shader_api");
+
+    // Data files out of the mapped asset archive; see util/assets.lua.
+    lua_pushlightuserdata(L, (void*)(GetAssetArchiveApi()));
+    lua_setglobal(L, "native_asset_api");
+
+    // Background texture loads; see util/textureloader.lua.
+    lua_pushlightuserdata(L, (void*)(GetTextureLoaderApi()));
+    lua_setglobal(L, "native_texture_api");
+
+    // Draw calls recorded for the render thread; see util/rendercommands.lua.
+    lua_pushlightuserdata(L, (void*)(GetRenderCommandApi()));
+    lua_setglobal(L, "native_render_api");
+
+    // Parallel-fors over cdata arrays on native workers; see util/jobs.lua.
+    lua_pushlightuserdata(L, (void*)(GetJobSystemApi()));
+    lua_setglobal(L, "native_job_api");
+
+    // CPU n-body steps for scene2/nbody07.lua; see util/nbody.lua.
+    lua_pushlightuserdata(L, (void*)(GetNBodyApi()));
+    lua_setglobal(L, "native_nbody_api");
+
+    // on_lua_draw reads camera matrices from here in place; see luaentry.lua.
+    lua_pushlightuserdata(L, (void*)(m_views));
+    lua_setglobal(L, "native_view_constants");
+    m_viewsThisFrame = 0;
+    m_frameNumber = 0;
+
     const std::string dataHome = APP_DATA_DIRECTORY;
     const std::string scriptName = dataHome + "lua/luaentry.lua";
-    if (luaL_dofile(L, scriptName.c_str()))
+
+    // Serve require() from precompiled bytecode where a bundle has been
+    // built; see tools/make_lua_bundle.lua. Without one, all is source,
+    // read from the asset archive where it has the file.
+    InstallArchiveSearcher(L);
+    if (m_bundle.Load(dataHome + "lua/bundle.luab", dataHome + "lua/"))
+    {
+        m_bundle.InstallSearcher(L);
+    }
+
+    const int loadResult =
+        (m_bundle.PushModule(L, "luaentry") || PushArchivedModule(L, "luaentry")) ?
+        0 : luaL_loadfile(L, scriptName.c_str());
+    if ((loadResult != 0) || (lua_pcall(L, 0, LUA_MULTRET, 0) != 0))
     {
         const std::string out(lua_tostring(L, -1));
         m_errorOccurred = true;
@@ -91,7 +295,21 @@ void LuajitScene::initGL()
         LOG_INFO("Error in scenebridge: %s", out.c_str());
     }
 
-    lua_getglobal(L, "on_lua_initgl");
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, l_refresh_callbacks, 1);
+    lua_setglobal(L, "refresh_native_callbacks");
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, l_set_gc_budget, 1);
+    lua_setglobal(L, "native_set_gc_budget");
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, l_full_gc, 1);
+    lua_setglobal(L, "native_full_gc");
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, l_acquire_gl, 1);
+    lua_setglobal(L, "native_acquire_gl");
+    RefreshCallbacks();
+
+    _PushCallback(CbInitGL);
     // Pass in a (GL function loader) function pointer. See scenebridge.lua.
     lua_Number LpLoaderFunc = (double)((intptr_t)m_pLoaderFunc);
     lua_pushnumber(L, LpLoaderFunc);
@@ -104,7 +322,7 @@ void LuajitScene::initGL()
     }
 
 #ifdef _LINUX
-    lua_getglobal(L, "on_lua_setTimeScale");
+    _PushCallback(CbSetTimeScale);
     lua_Number LtimeScale = .1;
     lua_pushnumber(L, LtimeScale);
     if (lua_pcall(L, 1, 0, 0) != 0)
@@ -113,6 +331,115 @@ void LuajitScene::initGL()
         m_errorOccurred = true;
     }
 #endif
+
+    LOG_INFO("Lua startup: %.1f ms, %u modules from bytecode, %u newer in source",
+        1000. * startupTimer.seconds(),
+        m_bundle.ModulesServed(),
+        m_bundle.ModulesStale());
+
+    // Loading ran with automatic collection, as a fresh state has it; from
+    // here on timestep paces the collector.
+    CollectAllGarbage();
+    ResetGCStats();
+    m_frameTimer.reset();
+}
+
+void LuajitScene::SetGCBudget(double budgetSeconds, double targetFrameSeconds)
+{
+    m_gcBudget = std::max(0., budgetSeconds);
+    m_targetFrameTime = targetFrameSeconds;
+    if ((m_gcBudget <= 0.) && (m_Lua != NULL))
+    {
+        lua_gc(m_Lua, LUA_GCRESTART, 0);
+    }
+}
+
+///@brief Run a full collection now and leave automatic collection stopped
+/// (unless pacing is disabled) with the baseline set to what survived.
+void LuajitScene::CollectAllGarbage()
+{
+    if (m_Lua == NULL)
+        return;
+
+    lua_State *L = m_Lua;
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    if (m_gcBudget > 0.)
+    {
+        lua_gc(L, LUA_GCSTOP, 0);
+    }
+    m_gcInCycle = false;
+    m_gcBaselineKb = std::max(static_cast<int>(s_gcMinBaselineKb), lua_gc(L, LUA_GCCOUNT, 0));
+}
+
+///@brief Let LuaJIT collect on its own again for a long call such as a
+/// scene switch, which may allocate far more than a frame does. The scene
+/// switch ends in native_full_gc, and so in CollectAllGarbage, which stops
+/// it again once per-frame pacing resumes; so does a failed switch.
+void LuajitScene::_RestartGarbageCollector()
+{
+    if (m_gcBudget > 0.)
+    {
+        lua_gc(m_Lua, LUA_GCRESTART, 0);
+    }
+}
+
+int LuajitScene::GetLuaHeapKb() const
+{
+    if (m_Lua == NULL)
+        return 0;
+    return lua_gc(m_Lua, LUA_GCCOUNT, 0);
+}
+
+void LuajitScene::ResetGCStats()
+{
+    m_gcTimeTotal = 0.;
+    m_gcTimeMax = 0.;
+    m_gcFrames = 0;
+    m_gcForcedCycles = 0;
+}
+
+///@brief Step the incremental collector for as long as the frame's slack
+/// and the budget allow. At least one step is taken while a cycle is under
+/// way so collection keeps moving when there is no slack at all. A cycle
+/// starts once the heap has grown s_gcPausePercent over the baseline, and
+/// is run to completion regardless of budget past s_gcForcePercent.
+///@note Each LUA_GCSTEP re-arms LuaJIT's own threshold, so it is stopped
+/// again afterwards; this also undoes any collectgarbage("step") in Lua.
+void LuajitScene::_StepGarbageCollector()
+{
+    if (m_gcBudget <= 0.)
+        return;
+
+    lua_State *L = m_Lua;
+    const int heapKb = lua_gc(L, LUA_GCCOUNT, 0);
+    const bool forced = heapKb * 100 > m_gcBaselineKb * s_gcForcePercent;
+    if ((m_gcInCycle == false) && (heapKb * 100 < m_gcBaselineKb * s_gcPausePercent))
+    {
+        ++m_gcFrames;
+        return;
+    }
+
+    PROFILE_ZONE("lua gc");
+    const double budget = std::min(m_gcBudget, m_targetFrameTime - m_frameTimer.seconds());
+    Timer t;
+    m_gcInCycle = true;
+    do
+    {
+        if (lua_gc(L, LUA_GCSTEP, 0) != 0)
+        {
+            m_gcInCycle = false;
+            m_gcBaselineKb = std::max(static_cast<int>(s_gcMinBaselineKb), lua_gc(L, LUA_GCCOUNT, 0));
+            if (forced)
+                ++m_gcForcedCycles;
+            break;
+        }
+    } while (forced || (t.seconds() < budget));
+    lua_gc(L, LUA_GCSTOP, 0);
+
+    const double elapsed = t.seconds();
+    m_gcTimeTotal += elapsed;
+    m_gcTimeMax = std::max(m_gcTimeMax, elapsed);
+    ++m_gcFrames;
 }
 
 void LuajitScene::exitGL()
@@ -121,7 +448,7 @@ void LuajitScene::exitGL()
         return;
 
     lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_exitgl");
+    _PushCallback(CbExitGL);
     if (lua_pcall(L, 0, 0, 0) != 0)
     {
         const std::string out(lua_tostring(L, -1));
@@ -143,11 +470,10 @@ void LuajitScene::keypressed(int key, int scancode, int action, int mods)
         return;
 
 #if 1
-    queuedKeyEvent e = {key, scancode, action, mods};
-    m_queuedKeyEvents.push(e);
+    m_queuedEvents.PushKey(key, scancode, action, mods);
 #else
     lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_keypressed");
+    _PushCallback(CbKeyPressed);
     lua_Number Lkey = key;
     lua_Number Lscancode = scancode;
     lua_Number Laction = action;
@@ -178,11 +504,10 @@ void LuajitScene::onAccelerometerChange(float x, float y, float z, int accuracy)
         return;
 
 #if 1
-    queuedAccelerometerEvent e = {x, y, z, accuracy};
-    m_queuedAccelerometerEvents.push(e);
+    m_queuedEvents.PushAccelerometer(x, y, z, accuracy);
 #else
     lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_accelerometer");
+    _PushCallback(CbAccelerometer);
     lua_Number Lx = x;
     lua_Number Ly = y;
     lua_Number Lz = z;
@@ -202,6 +527,15 @@ void LuajitScene::onAccelerometerChange(float x, float y, float z, int accuracy)
 }
 
 void LuajitScene::timestep(double absTime, double dt)
+{
+    timestep(absTime, dt, 1);
+}
+
+///@brief One frame's simulation: on_lua_timestep once for each of ticks
+/// steps of dt seconds, the last ending at absTime, then the frame's input
+/// and housekeeping. ticks is 0 on frames that come faster than a fixed
+/// tick rate.
+void LuajitScene::timestep(double absTime, double dt, int ticks)
 {
     if (m_errorOccurred == true)
         return;
@@ -212,83 +546,33 @@ void LuajitScene::timestep(double absTime, double dt)
     if (m_Lua == NULL)
         return;
 
-    lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_timestep");
-    lua_Number LabsTime = absTime;
-    lua_Number Ldt = dt;
-    lua_pushnumber(L, LabsTime);
-    lua_pushnumber(L, Ldt);
-    if (lua_pcall(L, 2, 0, 0) != 0)
-    {
-        const std::string out(lua_tostring(L, -1));
-        m_errorOccurred = true;
-        m_errorText += out;
-        LOG_INFO("Error running function `on_lua_timestep': %s", lua_tostring(L, -1));
-    }
-
-    if (m_queuedTouchEvents.empty() == false)
-    {
-        while (m_queuedTouchEvents.empty() == false)
-        {
-            const queuedTouchEvent e = m_queuedTouchEvents.front();
-            lua_getglobal(L, "on_lua_singletouch");
-            lua_pushinteger(L, e.pointerid);
-            lua_pushinteger(L, e.action);
-            lua_pushinteger(L, e.x);
-            lua_pushinteger(L, e.y);
-            if (lua_pcall(L, 4, 0, 0) != 0)
-            {
-                const std::string out(lua_tostring(L, -1));
-                m_errorOccurred = true;
-                m_errorText += out;
-                LOG_INFO("Error running function `on_lua_singletouch': %s", lua_tostring(L, -1));
-            }
-
-            m_queuedTouchEvents.pop();
-        }
-    }
-
-    if (m_queuedAccelerometerEvents.empty() == false) {
-        while (m_queuedAccelerometerEvents.empty() == false) {
-            const queuedAccelerometerEvent e = m_queuedAccelerometerEvents.front();
-            lua_getglobal(L, "on_lua_accelerometer");
-            lua_pushnumber(L, e.x);
-            lua_pushnumber(L, e.y);
-            lua_pushnumber(L, e.z);
-            lua_pushnumber(L, e.accuracy);
-            if (lua_pcall(L, 4, 0, 0) != 0) {
-                const std::string out(lua_tostring(L, -1));
-                m_errorOccurred = true;
-                m_errorText += out;
-                LOG_INFO("Error running function `on_lua_accelerometer': %s", lua_tostring(L, -1));
-            }
-
-            m_queuedAccelerometerEvents.pop();
-        }
-    }
+    m_viewsThisFrame = 0;
+    ++m_frameNumber;
 
-    while (m_queuedKeyEvents.empty() == false)
+    lua_State *L = m_Lua;
+    for (int i=0; (i<ticks) && (m_errorOccurred == false); ++i)
     {
-        const queuedKeyEvent e = m_queuedKeyEvents.front();
-        lua_getglobal(L, "on_lua_keypressed");
-        lua_pushnumber(L, e.key);
-        lua_pushnumber(L, e.scancode);
-        lua_pushnumber(L, e.action);
-        lua_pushnumber(L, e.mods);
-        if (lua_pcall(L, 4, 0, 0) != 0)
+        PROFILE_ZONE("lua timestep");
+        _PushCallback(CbTimestep);
+        lua_Number LabsTime = absTime - (ticks - 1 - i) * dt;
+        lua_Number Ldt = dt;
+        lua_pushnumber(L, LabsTime);
+        lua_pushnumber(L, Ldt);
+        if (lua_pcall(L, 2, 0, 0) != 0)
         {
             const std::string out(lua_tostring(L, -1));
             m_errorOccurred = true;
             m_errorText += out;
-            LOG_INFO("Error running function `on_lua_keypressed': %s", lua_tostring(L, -1));
+            LOG_INFO("Error running function `on_lua_timestep': %s", lua_tostring(L, -1));
         }
-
-        m_queuedKeyEvents.pop();
     }
 
+    _DeliverQueuedEvents();
+
     if (m_changeSceneOnNextTimestep)
     {
-        lua_getglobal(L, "on_lua_changescene");
+        _RestartGarbageCollector();
+        _PushCallback(CbChangeScene);
         lua_pushinteger(L, 0);
         if (lua_pcall(L, 1, 0, 0) != 0)
         {
@@ -296,11 +580,105 @@ void LuajitScene::timestep(double absTime, double dt)
             m_errorOccurred = true;
             m_errorText += out;
             LOG_INFO("Error running function `on_lua_changescene': %s", lua_tostring(L, -1));
+            CollectAllGarbage();
         }
 
         m_changeSceneOnNextTimestep = false;
     }
 
+    // Rendering for this frame is already done; spend the slack collecting.
+    _StepGarbageCollector();
+    m_frameTimer.reset();
+}
+
+///@brief Hand the whole frame's input to Lua in one call: on_lua_events(buf, count)
+/// receives a pointer to the contiguous array of queuedInputEvent structs.
+/// Scripts that do not define on_lua_events get the old per-event callbacks.
+void LuajitScene::_DeliverQueuedEvents()
+{
+    if (m_queuedEvents.Empty())
+        return;
+
+    const unsigned int dropped = m_queuedEvents.TakeDroppedCount();
+    if (dropped > 0)
+    {
+        LOG_ERROR("InputEventBuffer full(%d), dropped %u events.", m_queuedEvents.Capacity(), dropped);
+    }
+
+    PROFILE_ZONE("input drain");
+    lua_State *L = m_Lua;
+    _PushCallback(CbEvents);
+    if (lua_isfunction(L, -1) == false)
+    {
+        lua_pop(L, 1);
+        _DeliverQueuedEventsIndividually();
+        m_queuedEvents.Clear();
+        return;
+    }
+
+    lua_pushlightuserdata(L, (void*)(m_queuedEvents.Data()));
+    lua_pushinteger(L, m_queuedEvents.Count());
+    if (lua_pcall(L, 2, 0, 0) != 0)
+    {
+        const std::string out(lua_tostring(L, -1));
+        m_errorOccurred = true;
+        m_errorText += out;
+        LOG_INFO("Error running function `on_lua_events': %s", lua_tostring(L, -1));
+    }
+
+    m_queuedEvents.Clear();
+}
+
+///@brief Compatibility path: one lua_pcall per queued event.
+void LuajitScene::_DeliverQueuedEventsIndividually()
+{
+    lua_State *L = m_Lua;
+    const queuedInputEvent* pEvents = m_queuedEvents.Data();
+    for (int i=0; i<m_queuedEvents.Count(); ++i)
+    {
+        const queuedInputEvent& e = pEvents[i];
+        LuaCallback cb = CbCount;
+        switch (e.type)
+        {
+        default:
+            continue;
+
+        case EventTouch:
+            cb = CbSingleTouch;
+            _PushCallback(cb);
+            lua_pushinteger(L, e.touch.pointerid);
+            lua_pushinteger(L, e.touch.action);
+            lua_pushinteger(L, e.touch.x);
+            lua_pushinteger(L, e.touch.y);
+            break;
+
+        case EventAccelerometer:
+            cb = CbAccelerometer;
+            _PushCallback(cb);
+            lua_pushnumber(L, e.accel.x);
+            lua_pushnumber(L, e.accel.y);
+            lua_pushnumber(L, e.accel.z);
+            lua_pushnumber(L, e.accel.accuracy);
+            break;
+
+        case EventKey:
+            cb = CbKeyPressed;
+            _PushCallback(cb);
+            lua_pushnumber(L, e.key.key);
+            lua_pushnumber(L, e.key.scancode);
+            lua_pushnumber(L, e.key.action);
+            lua_pushnumber(L, e.key.mods);
+            break;
+        }
+
+        if (lua_pcall(L, 4, 0, 0) != 0)
+        {
+            const std::string out(lua_tostring(L, -1));
+            m_errorOccurred = true;
+            m_errorText += out;
+            LOG_INFO("Error running function `%s': %s", s_callbackNames[cb], lua_tostring(L, -1));
+        }
+    }
 }
 
 #ifdef USE_SIXENSE
@@ -398,7 +776,7 @@ void LuajitScene::setTracking_Hydra(double absTime, const void* pData) ///@todo
         return;
 
     lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_settracking");
+    _PushCallback(CbSetTracking);
     lua_Number LabsTime = absTime;
     lua_pushnumber(L, LabsTime);
 
@@ -483,7 +861,7 @@ void LuajitScene::setTracking_ViveWand(double absTime, int idx, const void* pPos
         return;
 
     lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_settracking");
+    _PushCallback(CbSetTracking);
     lua_Number LabsTime = absTime;
     lua_pushnumber(L, LabsTime);
 
@@ -520,10 +898,13 @@ void LuajitScene::RenderForOneEye(const float* pMview, const float* pPersp) cons
     if (m_Lua == NULL)
         return;
 
+    PROFILE_ZONE("lua draw");
+
+    const int slot = _SetViewConstants(pMview, pPersp);
     lua_State *L = m_Lua;
-    lua_getglobal(L, "on_lua_draw");
-    lua_pushlightuserdata(L, (void*)(pMview));
-    lua_pushlightuserdata(L, (void*)(pPersp));
+    _PushCallback(CbDraw);
+    lua_pushinteger(L, slot);
+    lua_pushnumber(L, m_drawAlpha);
     if (lua_pcall(L, 2, 0, 0) != 0)
     {
         const std::string out(lua_tostring(L, -1));
@@ -533,6 +914,58 @@ void LuajitScene::RenderForOneEye(const float* pMview, const float* pPersp) cons
     }
 }
 
+///@brief As RenderForOneEye, but on_lua_record records the view's draw
+/// calls into the RenderCommandStream instead of making them.
+///@return false if the scene cannot record, having recorded nothing; the
+/// view must then be drawn with RenderForOneEye.
+bool LuajitScene::RecordForOneEye(const float* pMview, const float* pPersp) const
+{
+    if ((m_errorOccurred == true) || (m_bDraw == false) || (m_Lua == NULL))
+        return true; // Nothing to draw either way
+
+    lua_State *L = m_Lua;
+    _PushCallback(CbRecord);
+    if (lua_isfunction(L, -1) == 0)
+    {
+        lua_pop(L, 1);
+        return false;
+    }
+
+    const int slot = _SetViewConstants(pMview, pPersp);
+    lua_pushinteger(L, slot);
+    lua_pushnumber(L, m_drawAlpha);
+    if (lua_pcall(L, 2, 1, 0) != 0)
+    {
+        const std::string out(lua_tostring(L, -1));
+        m_errorOccurred = true;
+        m_errorText += out;
+        LOG_INFO("Error running function `on_lua_record': %s", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return true;
+    }
+
+    const bool recorded = (lua_toboolean(L, -1) != 0);
+    lua_pop(L, 1);
+    if (recorded == false)
+    {
+        // Let RenderForOneEye have the slot over again.
+        --m_viewsThisFrame;
+    }
+    return recorded;
+}
+
+///@brief Fill the next view slot for on_lua_draw or on_lua_record.
+///@return The slot; extra views past s_maxViews reuse the last one.
+int LuajitScene::_SetViewConstants(const float* pMview, const float* pPersp) const
+{
+    const int slot = (m_viewsThisFrame < s_maxViews) ? m_viewsThisFrame : s_maxViews - 1;
+    viewConstants& v = m_views[slot];
+    memcpy(v.modelview.m, pMview, sizeof(v.modelview.m));
+    memcpy(v.projection.m, pPersp, sizeof(v.projection.m));
+    v.viewIndex = m_viewsThisFrame++;
+    v.frameNumber = m_frameNumber;
+    return slot;
+}
 
 void LuajitScene::onSingleTouch(int pointerid, int action, int x, int y)
 {
@@ -548,10 +981,9 @@ void LuajitScene::onSingleTouch(int pointerid, int action, int x, int y)
     lua_State *L = m_Lua;
 
 #if 1
-    queuedTouchEvent e = {pointerid, action, x, y};
-    m_queuedTouchEvents.push(e);
+    m_queuedEvents.PushTouch(pointerid, action, x, y);
 #else
-    lua_getglobal(L, "on_lua_singletouch");
+    _PushCallback(CbSingleTouch);
     lua_pushinteger (L, pointerid);
     lua_pushinteger (L, action);
     lua_pushinteger (L, x);
@@ -589,7 +1021,7 @@ void LuajitScene::setWindowSize(int w, int h)
 
     lua_State *L = m_Lua;
 
-    lua_getglobal(L, "on_lua_setwindowsize");
+    _PushCallback(CbSetWindowSize);
     lua_pushinteger(L, w);
     lua_pushinteger(L, h);
     if (lua_pcall(L, 2, 0, 0) != 0)
@@ -614,3 +1046,59 @@ void LuajitScene::ChangeScene(int d)
 
     m_changeSceneOnNextTimestep = true;
 }
+
+///@brief Fill the given list with the module names of all scenes luaentry.lua can cycle through.
+void LuajitScene::GetSceneNames(std::vector<std::string>& names)
+{
+    names.clear();
+    if (m_Lua == NULL)
+        return;
+
+    lua_State *L = m_Lua;
+    _PushCallback(CbGetSceneNames);
+    if (lua_pcall(L, 0, 1, 0) != 0)
+    {
+        const std::string out(lua_tostring(L, -1));
+        m_errorOccurred = true;
+        m_errorText += out;
+        LOG_INFO("Error running function `on_lua_getscenenames': %s", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        return;
+    }
+
+    const int n = static_cast<int>(lua_objlen(L, -1));
+    for (int i=1; i<=n; ++i)
+    {
+        lua_rawgeti(L, -1, i);
+        if (lua_isstring(L, -1))
+        {
+            names.push_back(lua_tostring(L, -1));
+        }
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+}
+
+///@brief Switch immediately to the scene at the given 0-based index of GetSceneNames.
+void LuajitScene::SwitchToScene(int idx)
+{
+    if (m_Lua == NULL)
+        return;
+
+    // The next scene starts clean; an error in the last should not stop it.
+    m_errorOccurred = false;
+    m_errorText = "";
+
+    lua_State *L = m_Lua;
+    _RestartGarbageCollector();
+    _PushCallback(CbSwitchToScene);
+    lua_pushinteger(L, idx+1);
+    if (lua_pcall(L, 1, 0, 0) != 0)
+    {
+        const std::string out(lua_tostring(L, -1));
+        m_errorOccurred = true;
+        m_errorText += out;
+        LOG_INFO("Error running function `on_lua_switchtoscene': %s", lua_tostring(L, -1));
+        CollectAllGarbage();
+    }
+}
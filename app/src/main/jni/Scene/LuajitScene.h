@@ -9,31 +9,35 @@
 #endif
 #include <stdlib.h>
 #include <string>
-#include <queue>
+#include <vector>
 #include <lua.hpp>
 
 #include "IScene.h"
 #include "GL_Includes.h"
+#include "InputEventBuffer.h"
+#include "LuaBundle.h"
+#include "ViewConstants.h"
+#include "Timer.h"
 
-struct queuedTouchEvent {
-    int pointerid;
-    int action;
-    int x;
-    int y;
-};
-
-struct queuedAccelerometerEvent {
-    float x;
-    float y;
-    float z;
-    int accuracy;
-};
-
-struct queuedKeyEvent {
-    int key;
-    int scancode;
-    int action;
-    int mods;
+/// Entry points into luaentry.lua, resolved once into registry references.
+///@note Order must match s_callbackNames in LuajitScene.cpp.
+enum LuaCallback {
+    CbInitGL = 0,
+    CbExitGL,
+    CbTimestep,
+    CbDraw,
+    CbEvents,
+    CbSingleTouch,
+    CbAccelerometer,
+    CbKeyPressed,
+    CbSetWindowSize,
+    CbChangeScene,
+    CbSetTimeScale,
+    CbSetTracking,
+    CbGetSceneNames,
+    CbSwitchToScene,
+    CbRecord,
+    CbCount
 };
 
 class LuajitScene : public IScene
@@ -47,13 +51,37 @@ public:
     virtual void exitGL();
     virtual void keypressed(int key, int scancode, int action, int mods);
     virtual void timestep(double absTime, double dt);
+    void timestep(double absTime, double dt, int ticks);
     virtual void RenderForOneEye(const float* pMview, const float* pPersp) const;
+    bool RecordForOneEye(const float* pMview, const float* pPersp) const;
     virtual void onSingleTouch(int pointerid, int action, int x, int y);
     virtual void onAccelerometerChange(float x, float y, float z, int accuracy);
     virtual void setWindowSize(int w, int h);
     virtual void ChangeScene(int d);
+    void GetSceneNames(std::vector<std::string>& names);
+    void SwitchToScene(int idx);
 
     virtual const std::string& ErrorText() const { return m_errorText; }
+    unsigned int CallbackLookupsAvoided() const { return m_lookupsAvoided; }
+
+    void RefreshCallbacks();
+
+    /// Passed to on_lua_draw: how far between the last two ticks to draw.
+    void SetInterpolationAlpha(double alpha) { m_drawAlpha = alpha; }
+
+    /// Called by native_acquire_gl before Lua makes GL calls outside of
+    /// drawing, e.g. on a scene switch, while frames render on another thread.
+    void SetGLAcquireHook(void (*pHook)()) { m_pAcquireGL = pHook; }
+    void AcquireGL() const { if (m_pAcquireGL != NULL) m_pAcquireGL(); }
+
+    void SetGCBudget(double budgetSeconds, double targetFrameSeconds);
+    void CollectAllGarbage();
+    double GetGCTimeTotal() const { return m_gcTimeTotal; } ///< Seconds since ResetGCStats
+    double GetGCTimeMax() const { return m_gcTimeMax; }     ///< Longest single frame's GC
+    int GetGCFrames() const { return m_gcFrames; }
+    int GetGCForcedCycles() const { return m_gcForcedCycles; }
+    int GetLuaHeapKb() const;
+    void ResetGCStats();
 
     virtual void setTracking_Hydra(double absTime, const void* pData);
     virtual void setTracking_ViveWand(double absTime, int idx, const void* pPose, const void* pState);
@@ -68,15 +96,53 @@ public:
 
     void* m_pLoaderFunc;
 
+    static const int s_maxViews = 2; ///< Enough for stereo
+
 protected:
     lua_State* m_Lua;
     mutable bool m_errorOccurred;
     mutable std::string m_errorText;
     bool m_changeSceneOnNextTimestep;
 
-    std::queue<queuedTouchEvent> m_queuedTouchEvents;
-    std::queue<queuedAccelerometerEvent> m_queuedAccelerometerEvents;
-    std::queue<queuedKeyEvent> m_queuedKeyEvents;
+    InputEventBuffer m_queuedEvents;
+    LuaBundle m_bundle;
+    int m_callbackRefs[CbCount]; ///< LUA_REGISTRYINDEX refs, LUA_NOREF if unresolved
+    mutable unsigned int m_lookupsAvoided; ///< lua_getglobal calls replaced by lua_rawgeti
+
+    /// Written by RenderForOneEye and read by on_lua_draw through the
+    /// native_view_constants pointer; one slot per view so the first eye's
+    /// matrices are still intact while the second is drawn.
+    mutable viewConstants m_views[s_maxViews];
+    mutable int m_viewsThisFrame;
+    int m_frameNumber;
+    double m_drawAlpha;
+    void (*m_pAcquireGL)();
+
+    /// Automatic collection is stopped once luaentry has loaded; timestep
+    /// steps the collector by hand in whatever is left of the frame. Scene
+    /// switches restart it until their closing CollectAllGarbage.
+    Timer m_frameTimer;         ///< Reset as each timestep ends
+    double m_gcBudget;          ///< Most seconds per frame to spend collecting; 0 hands GC back to LuaJIT
+    double m_targetFrameTime;   ///< Seconds; slack is what the frame leaves of this
+    bool m_gcInCycle;
+    int m_gcBaselineKb;         ///< Heap size when the last cycle finished
+    double m_gcTimeTotal;
+    double m_gcTimeMax;
+    int m_gcFrames;
+    int m_gcForcedCycles;
+
+    static const int s_gcPausePercent = 150;  ///< Heap growth over baseline that starts a cycle
+    static const int s_gcForcePercent = 300;  ///< Growth at which a cycle is finished regardless of budget
+    static const int s_gcMinBaselineKb = 1024;
+
+    int _SetViewConstants(const float* pMview, const float* pPersp) const;
+    void _ReleaseCallbacks();
+    void _PushCallback(LuaCallback cb) const;
+
+    void _DeliverQueuedEvents();
+    void _DeliverQueuedEventsIndividually();
+    void _StepGarbageCollector();
+    void _RestartGarbageCollector();
 
 private: // Disallow copy ctor and assignment operator
     LuajitScene(const LuajitScene&);
@@ -28,6 +28,9 @@
 
 #include "Logging.h"
 
+static const ShaderVar s_mvmtx("mvmtx");
+static const ShaderVar s_prmtx("prmtx");
+
 Scene::Scene()
 : m_basic()
 , m_plane()
@@ -184,7 +187,7 @@ void Scene::_DrawBouncingCubes(
             glm::vec3(0.0f, oscVal, radius));
         sinmtx = glm::scale(sinmtx, glm::vec3(scale));
 
-        glUniformMatrix4fv(m_basic.GetUniLoc("mvmtx"), 1, false, glm::value_ptr(sinmtx));
+        glUniformMatrix4fv(m_basic.GetUniLoc(s_mvmtx), 1, false, glm::value_ptr(sinmtx));
         DrawColorCube();
     }
 }
@@ -205,7 +208,7 @@ void Scene::_DrawScenePlanes(const glm::mat4& modelview) const
             modelview,
             glm::vec3(0.0f, ceilHeight, 0.0f));
 
-        glUniformMatrix4fv(m_basic.GetUniLoc("mvmtx"), 1, false, glm::value_ptr(ceilmtx));
+        glUniformMatrix4fv(m_basic.GetUniLoc(s_mvmtx), 1, false, glm::value_ptr(ceilmtx));
 
         // ceiling
         glDrawElements(GL_TRIANGLES,
@@ -225,8 +228,8 @@ void Scene::DrawScene(
 {
     glUseProgram(m_plane.prog());
     {
-        glUniformMatrix4fv(m_plane.GetUniLoc("mvmtx"), 1, false, glm::value_ptr(modelview));
-        glUniformMatrix4fv(m_plane.GetUniLoc("prmtx"), 1, false, glm::value_ptr(projection));
+        glUniformMatrix4fv(m_plane.GetUniLoc(s_mvmtx), 1, false, glm::value_ptr(modelview));
+        glUniformMatrix4fv(m_plane.GetUniLoc(s_prmtx), 1, false, glm::value_ptr(projection));
 
         _DrawScenePlanes(modelview);
     }
@@ -234,8 +237,8 @@ void Scene::DrawScene(
 
     glUseProgram(m_basic.prog());
     {
-        glUniformMatrix4fv(m_basic.GetUniLoc("mvmtx"), 1, false, glm::value_ptr(modelview));
-        glUniformMatrix4fv(m_basic.GetUniLoc("prmtx"), 1, false, glm::value_ptr(projection));
+        glUniformMatrix4fv(m_basic.GetUniLoc(s_mvmtx), 1, false, glm::value_ptr(modelview));
+        glUniformMatrix4fv(m_basic.GetUniLoc(s_prmtx), 1, false, glm::value_ptr(projection));
 
         _DrawBouncingCubes(modelview, glm::vec3(0.0f, 1.0f, 0.5f), 0.25f, 0.064f);
         _DrawBouncingCubes(modelview, glm::vec3(0.0f, 0.0f, 0.5f), 1.5f, 0.5f);
@@ -6,6 +6,9 @@
 #include "AndroidTouchEnums.h"
 #include "FontMgr.h"
 #include "FontRenderer.h"
+#include "FrameProfiler.h"
+#include "TextureLoader.h"
+#include "RenderCommandStream.h"
 #include "MatrixMath.h"
 #include "VectorMath.h"
 #include "Logging.h"
@@ -16,6 +19,11 @@ TabletWindow::TabletWindow()
 : m_luaScene()
 , m_fps()
 , m_logDumpTimer()
+, m_frameStats()
+, m_layoutStats()
+, m_gcStats()
+, m_errorSource()
+, m_errorLines()
 , m_iconx(20)
 , m_icony(240)
 , m_iconScale(1.f)
@@ -85,6 +93,8 @@ void TabletWindow::exitGL()
 {
     m_luaScene.exitGL();
     m_tp.exitGL();
+    TextureLoader::Instance().Destroy();
+    FrameProfiler::Instance().Destroy();
 }
 
 void TabletWindow::setWindowSize(int w, int h)
@@ -116,6 +126,9 @@ void TabletWindow::_DrawText(int winw, int winh)
         const float3 col = {.5f, 1.f, .5f};
         const bool doKerning = true;
 
+        // All overlay strings share one projection; draw them in one flush.
+        pFont24->BeginBatch();
+
         if (m_movingChassisFlag)
         {
             pFont24->DrawWString(
@@ -155,8 +168,13 @@ void TabletWindow::_DrawText(int winw, int winh)
                 doKerning);
         }
 
+        // Whole numbers, so the string repeats often enough to hit the layout cache.
         std::ostringstream oss;
-        oss << m_fps.GetFPS() << " fps";
+        oss << static_cast<int>(m_fps.GetFPS() + .5f) << " fps";
+        if (m_gcStats.empty() == false)
+        {
+            oss << ", " << m_gcStats;
+        }
         pFont24->DrawString(
             oss.str().c_str(),
             10,
@@ -165,28 +183,121 @@ void TabletWindow::_DrawText(int winw, int winh)
             proj,
             doKerning);
 
+        if (m_frameStats.empty() == false)
+        {
+            pFont24->DrawString(
+                m_frameStats.c_str(),
+                10,
+                y += lineh,
+                col,
+                proj,
+                doKerning);
+        }
+
+        if (m_layoutStats.empty() == false)
+        {
+            pFont24->DrawString(
+                m_layoutStats.c_str(),
+                10,
+                y += lineh,
+                col,
+                proj,
+                doKerning);
+        }
+
         const float3 red = { 1.f, .8f, .8f };
-        std::string err = m_luaScene.ErrorText();
-        const int cols = 40;
-        std::string chunk = err.substr(0, cols);
-        while (chunk.length() > 0)
+        _UpdateErrorLines();
+        for (std::vector<std::string>::const_iterator it = m_errorLines.begin();
+            it != m_errorLines.end();
+            ++it)
         {
-            chunk = err.substr(0, cols);
             pFont24->DrawString(
-                chunk.c_str(),
+                it->c_str(),
                 10,
                 y += lineh,
                 red,
                 proj,
                 doKerning);
-            err = err.substr(chunk.length());
         }
+
+        pFont24->EndBatch();
     }
     glDisable(GL_BLEND);
 }
 
+///@brief Split the Lua error text into overlay lines, only when it changes.
+void TabletWindow::_UpdateErrorLines()
+{
+    const std::string& err = m_luaScene.ErrorText();
+    if (err == m_errorSource)
+        return;
+
+    m_errorSource = err;
+    m_errorLines.clear();
+    const size_t cols = 40;
+    for (size_t pos = 0; pos < err.length(); pos += cols)
+    {
+        m_errorLines.push_back(err.substr(pos, cols));
+    }
+}
+
+///@brief Summarize the frame time histogram since the last log dump:
+/// percentiles in ms, then how many frames missed the 60 and 90 Hz budgets.
+std::string TabletWindow::_FormatFrameStats() const
+{
+    const FrameTimeHistogram& h = m_fps.GetHistogram();
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(1);
+    oss << "p50 " << 1000. * h.GetPercentile(.50)
+        << " p90 " << 1000. * h.GetPercentile(.90)
+        << " p99 " << 1000. * h.GetPercentile(.99)
+        << " max " << 1000. * h.GetMax() << " ms"
+        << ", >16.6ms: " << h.GetCountOver(0)
+        << ", >11.1ms: " << h.GetCountOver(1);
+    return oss.str();
+}
+
+///@brief Hit rate of the overlay font's layout cache since the last log dump.
+std::string TabletWindow::_FormatLayoutCacheStats() const
+{
+    const FontRenderer* pFont24 = FontMgr::Instance().GetFontOfSize(24);
+    if (pFont24 == NULL)
+        return "";
+
+    const unsigned int hits = pFont24->GetLayoutCacheHits();
+    const unsigned int total = hits + pFont24->GetLayoutCacheMisses();
+    std::ostringstream oss;
+    oss << "Text layout cache hits: " << hits << "/" << total;
+    return oss.str();
+}
+
+///@brief Lua collector time per frame, averaged and worst case, since the
+/// last log dump, and the heap size now.
+std::string TabletWindow::_FormatGCStats() const
+{
+    const int frames = m_luaScene.GetGCFrames();
+    if (frames == 0)
+        return "";
+
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    oss << "gc " << 1000. * m_luaScene.GetGCTimeTotal() / static_cast<double>(frames)
+        << " max " << 1000. * m_luaScene.GetGCTimeMax() << " ms";
+    oss.precision(1);
+    oss << ", heap " << static_cast<double>(m_luaScene.GetLuaHeapKb()) / 1024. << " MB";
+    const int forced = m_luaScene.GetGCForcedCycles();
+    if (forced > 0)
+    {
+        oss << ", " << forced << " forced";
+    }
+    return oss.str();
+}
+
 void TabletWindow::_DisplayOverlay(int winw, int winh)
 {
+    PROFILE_ZONE("overlay");
     _DrawText(winw, winh);
 
 #if 0 //ndef __ANDROID__
@@ -206,41 +317,79 @@ void TabletWindow::_DisplayOverlay(int winw, int winh)
 #endif
 }
 
-///@brief draws a 3D scene from a camera location
-void TabletWindow::_DisplayScene(int winw, int winh)
+void TabletWindow::_GetCameraMatrices(int winw, int winh, float* pMview, float* pPersp) const
 {
-    float mvmtx[16];
-    float prmtx[16];
-    MakeIdentityMatrix(mvmtx);
+    MakeIdentityMatrix(pMview);
 
-    glhTranslate(mvmtx, m_chassisPos.x, m_chassisPos.y, m_chassisPos.z);
+    glhTranslate(pMview, m_chassisPos.x, m_chassisPos.y, m_chassisPos.z);
 
-    glhRotate(mvmtx, m_chassisYaw, 0.f, 1.f, 0.f);
+    glhRotate(pMview, m_chassisYaw, 0.f, 1.f, 0.f);
 
-    glhPerspectivef2(prmtx,
+    glhPerspectivef2(pPersp,
         80.f,
         static_cast<float>(winw) / static_cast<float>(winh),
         .1f, 100.f);
+}
 
+///@brief draws a 3D scene from a camera location
+void TabletWindow::_DisplayScene(int winw, int winh)
+{
+    float mvmtx[16];
+    float prmtx[16];
+    _GetCameraMatrices(winw, winh, mvmtx, prmtx);
     m_luaScene.RenderForOneEye(mvmtx, prmtx);
 }
 
-void TabletWindow::display(int winw, int winh)
+void TabletWindow::display(int winw, int winh, double alpha)
 {
+    PROFILE_ZONE("display");
+    m_luaScene.SetInterpolationAlpha(alpha);
     glViewport(0, 0, winw, winh);
     const float g = .1f;
     glClearColor(g, g, g, 0.f);
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
     glEnable(GL_DEPTH_TEST);
-    _DisplayScene(winw, winh);
+    {
+        PROFILE_ZONE("scene");
+        _DisplayScene(winw, winh);
+    }
 
     glDisable(GL_DEPTH_TEST);
     _DisplayOverlay(winw, winh);
 }
 
-void TabletWindow::timestep(double absT, double dt)
+///@brief As display, but recorded into the RenderCommandStream for the
+/// render thread to replay. The overlay is left out: text is drawn
+/// straight from FontRenderer, which cannot record.
+///@return false, having recorded nothing, if the scene cannot record;
+/// the frame must then be drawn with display.
+bool TabletWindow::record(int winw, int winh, double alpha)
 {
+    m_luaScene.SetInterpolationAlpha(alpha);
+
+    float mvmtx[16];
+    float prmtx[16];
+    _GetCameraMatrices(winw, winh, mvmtx, prmtx);
+
+    RenderCommandStream& cmds = RenderCommandStream::Instance();
+    cmds.Push(CmdViewport, 0, 0, winw, winh);
+    const float g = .1f;
+    cmds.PushFloats(CmdClearColor, 0, g, g, g, 0.f);
+    cmds.Push(CmdClear, GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    cmds.Push(CmdEnable, GL_DEPTH_TEST);
+    if (m_luaScene.RecordForOneEye(mvmtx, prmtx) == false)
+    {
+        cmds.ClearRecording();
+        return false;
+    }
+    cmds.Push(CmdDisable, GL_DEPTH_TEST);
+    return true;
+}
+
+void TabletWindow::timestep(double absT, double dt, int ticks)
+{
+    PROFILE_ZONE("timestep");
     m_fps.OnFrame();
 
 #if 1
@@ -248,12 +397,27 @@ void TabletWindow::timestep(double absT, double dt)
     const float dumpInterval = 1.f;
     if (m_logDumpTimer.seconds() > dumpInterval)
     {
-        LOG_INFO("Frame rate: %d fps", static_cast<int>(m_fps.GetFPS()));
+        m_frameStats = _FormatFrameStats();
+        m_layoutStats = _FormatLayoutCacheStats();
+        m_gcStats = _FormatGCStats();
+        LOG_INFO("Frame rate: %d fps, %s, %s, %u Lua callback lookups avoided, %s",
+            static_cast<int>(m_fps.GetFPS()),
+            m_frameStats.c_str(),
+            m_gcStats.c_str(),
+            m_luaScene.CallbackLookupsAvoided(),
+            m_layoutStats.c_str());
+        m_fps.ResetHistogram();
+        m_luaScene.ResetGCStats();
+        const FontRenderer* pFont24 = FontMgr::Instance().GetFontOfSize(24);
+        if (pFont24 != NULL)
+        {
+            pFont24->ResetLayoutCacheStats();
+        }
         m_logDumpTimer.reset();
-}
+    }
 #endif
 
-    m_luaScene.timestep(absT, dt);
+    m_luaScene.timestep(absT, dt, ticks);
 }
 
 int getNumPointersDown(int mask)
@@ -411,8 +575,14 @@ void TabletWindow::OnKeyEvent(int key, int scancode, int action, int mods)
         m_movingChassisFlag = !m_movingChassisFlag;
         break;
 
+    case 295: // F6 in GLFW3
+    case 1073741887: // F6 in SDL2
+        FrameProfiler::Instance().WriteChromeTrace("frame_trace.json");
+        break;
+
     case 1073741886: // F5 in SDL2
         // Refresh Lua state
+        m_luaScene.AcquireGL();
         m_luaScene.exitLua();
         m_luaScene.initGL();
         m_luaScene.setWindowSize(m_winw, m_winh);
@@ -19,23 +19,39 @@ public:
     void initGL();
     void exitGL();
     void setWindowSize(int w, int h);
-    void display(int winw, int winh);
-    void timestep(double absT, double dt);
+    void display(int winw, int winh, double alpha);
+    bool record(int winw, int winh, double alpha);
+    void timestep(double absT, double dt, int ticks);
 
     void OnSingleTouch(int pointerid, int action, int x, int y);
     void OnWheelEvent(double dx, double dy);
     void OnKeyEvent(int key, int scancode, int action, int mods);
     void onAccelerometerChange(float x, float y, float z, int accuracy);
 
+    void GetSceneNames(std::vector<std::string>& names) { m_luaScene.GetSceneNames(names); }
+    void SwitchToScene(int idx) { m_luaScene.SwitchToScene(idx); }
+    const std::string& ErrorText() const { return m_luaScene.ErrorText(); }
+    void SetGLAcquireHook(void (*pHook)()) { m_luaScene.SetGLAcquireHook(pHook); }
+
 protected:
     void _DrawText(int winw, int winh);
+    std::string _FormatFrameStats() const;
+    std::string _FormatLayoutCacheStats() const;
+    std::string _FormatGCStats() const;
+    void _UpdateErrorLines();
     void _DisplayOverlay(int winw, int winh);
     void _DisplayScene(int winw, int winh);
+    void _GetCameraMatrices(int winw, int winh, float* pMview, float* pPersp) const;
 
     LuajitScene m_luaScene;
 
     FPSTimer m_fps;
     Timer m_logDumpTimer;
+    std::string m_frameStats; ///< Percentiles from the last completed log interval
+    std::string m_layoutStats; ///< Text layout cache hit rate over the same interval
+    std::string m_gcStats; ///< Lua GC time per frame and heap size over the same interval
+    std::string m_errorSource; ///< Lua error text that m_errorLines was split from
+    std::vector<std::string> m_errorLines;
     int m_winw;
     int m_winh;
     int m_iconx;
@@ -0,0 +1,19 @@
+// ViewConstants.h
+
+#pragma once
+
+/// A column-major 4x4 matrix, as GL expects it.
+///@note Mirrored by the ffi.cdef block in util/matrixmath.lua - keep them in sync.
+struct mat4f {
+    float m[16];
+};
+
+/// Camera constants for one view of one frame, plain old data so Lua can
+/// read them in place through the FFI rather than copying into tables.
+///@note Mirrored by the ffi.cdef block in luaentry.lua - keep them in sync.
+struct viewConstants {
+    mat4f modelview;
+    mat4f projection;
+    int viewIndex;   ///< Views drawn so far this frame, e.g. 0 and 1 for stereo
+    int frameNumber; ///< Frames simulated since initGL
+};
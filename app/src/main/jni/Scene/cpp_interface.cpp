@@ -3,69 +3,455 @@
 #include "cpp_interface.h"
 
 #include "TabletWindow.h"
+#include "DataDirectoryLocation.h"
+#include "AssetArchive.h"
+#include "FrameProfiler.h"
+#include "TextureLoader.h"
+#include "InputRecorder.h"
+#include "TimestepScheduler.h"
+#include "RenderThread.h"
+#include "FrameTimeHistogram.h"
+#include "JobSystem.h"
 #include "shader_utils.h"
 #include "Logging.h"
+#include <sstream>
 
 int g_winw;
 int g_winh;
 TabletWindow g_window;
 Timer g_timer;
-double g_lastFrameTime = 0.;
+TimestepScheduler g_scheduler;
+double g_drawAlpha = 1.;
+Timer g_startupTimer;
+bool g_firstFrameDrawn = false;
+InputRecorder g_inputRecorder;
+InputReplayer g_inputReplayer;
+bool g_replayWindowSize = false;
+
+// Frames are recorded here and replayed on g_renderThread when it runs;
+// see RenderThread.h. Both modes are timed alike for comparison.
+RenderThread g_renderThread;
+bool g_profilerWasEnabled = true;
+FrameTimeHistogram g_singleLatency;
+FrameTimeHistogram g_singleInterval;
+FrameTimeHistogram g_logicTime;
+double g_lastFrameStart = -1.;
+bool g_hostPresents = false;        ///< The host calls framePresented after swapping
+double g_unpresentedStart = -1.;    ///< Start of the frame awaiting framePresented
+double g_lastPresent = -1.;
+Timer g_pipelineTimer;
+Timer g_pipelineLogTimer;
 
 bool initScene()
 {
     LOG_INFO("initScene()");
+    g_startupTimer.reset();
+    g_firstFrameDrawn = false;
     printSomeGLInfo();
 
+    // Everything under the data directory comes out of one mapped file
+    // where tools/make_asset_archive.py has built it; see AssetArchive.h.
+    // Shaders are packed under shaders/ from where GetShaderSourceFromFile
+    // would otherwise read them.
+    const std::string dataHome = APP_DATA_DIRECTORY;
+    AssetArchive::Instance().SetSourceDir("shaders/", "../shaders/");
+    AssetArchive::Instance().Mount(dataHome + "assets.pak", dataHome);
+
     g_window.initGL();
     g_timer.reset();
+    g_scheduler.Reset();
+    g_drawAlpha = 1.;
 
     return true;
 }
 
 void exitScene()
 {
+    stopRenderThread();
+    g_inputRecorder.Stop();
+    g_inputReplayer.Close();
     g_window.exitGL();
+    // Before static destruction, while the arrays jobs write to are alive
+    JobSystem::Instance().Stop();
+    AssetArchive::Instance().Unmount();
+    LOG_FLUSH();
 }
 
-void surfaceChangedScene(int w, int h)
+// The scene's side of each input callback, shared by live and replayed input.
+static void windowSizeToScene(int w, int h)
 {
     LOG_INFO("setupGraphics(%d, %d)", w, h);
+    // Scenes may resize render targets.
+    g_renderThread.AcquireContext();
     g_winw = w;
     g_winh = h;
     g_window.setWindowSize(w, h);
 }
 
+static void touchToScene(int pointerid, int action, float x, float y)
+{
+    g_window.OnSingleTouch(pointerid, action, x, y);
+}
+
+static void wheelToScene(double dx, double dy)
+{
+    g_window.OnWheelEvent(dx, dy);
+}
+
+static void keyToScene(int key, int scancode, int action, int mods)
+{
+    g_window.OnKeyEvent(key, scancode, action, mods);
+}
+
+static void accelerometerToScene(float x, float y, float z, int accuracy)
+{
+    g_window.onAccelerometerChange(x, y, z, accuracy);
+}
+
+void surfaceChangedScene(int w, int h)
+{
+    g_inputRecorder.RecordWindowSize(w, h);
+    windowSizeToScene(w, h);
+}
+
+///@brief Record the frame for the render thread, then simulate while it
+/// is replayed. Scenes that cannot record are drawn here as before, and
+/// presented through the render thread's context callbacks.
+static void drawSceneThreaded(double frameStart)
+{
+    TextureLoader& loader = TextureLoader::Instance();
+    if (loader.PendingCount() > 0)
+    {
+        g_renderThread.AcquireContext();
+        loader.Update();
+    }
+
+    if (g_window.record(g_winw, g_winh, g_drawAlpha))
+    {
+        g_renderThread.Submit(frameStart);
+    }
+    else
+    {
+        g_renderThread.AcquireContext();
+        loader.Update();
+        g_window.display(g_winw, g_winh, g_drawAlpha);
+        g_renderThread.PresentFromCaller(frameStart);
+    }
+}
+
+static std::string formatPipelineStats()
+{
+    pipelineReport r;
+    getPipelineReport(r);
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(1);
+    oss << "Pipeline (" << (r.threaded ? "threaded" : "single") << "): "
+        << r.framesPerSecond << " fps"
+        << ", latency p50 " << 1000. * r.latencyP50 << " p99 " << 1000. * r.latencyP99 << " ms"
+        << ", interval p50 " << 1000. * r.intervalP50 << " p99 " << 1000. * r.intervalP99 << " ms"
+        << ", logic p50 " << 1000. * r.logicP50 << " p99 " << 1000. * r.logicP99 << " ms";
+    return oss.str();
+}
+
 void drawScene()
 {
-    g_window.display(g_winw, g_winh);
-    const double now = g_timer.seconds();
-    g_window.timestep(now, now - g_lastFrameTime);
-    g_lastFrameTime = now;
+    const bool threaded = g_renderThread.IsRunning();
+    const double frameStart = g_renderThread.Now();
+    g_scheduler.Advance(g_timer.seconds());
+
+    if (g_inputReplayer.IsOpen())
+    {
+        static const InputReplayer::callbacks cb = {
+            touchToScene,
+            keyToScene,
+            wheelToScene,
+            accelerometerToScene,
+            windowSizeToScene,
+        };
+        static const InputReplayer::callbacks cbFixedSize = {
+            touchToScene,
+            keyToScene,
+            wheelToScene,
+            accelerometerToScene,
+            NULL,
+        };
+        g_inputReplayer.Update(g_scheduler.Clock(), g_replayWindowSize ? cb : cbFixedSize);
+        if (g_inputReplayer.Finished())
+        {
+            LOG_INFO("Input replay finished.");
+            g_inputReplayer.Close();
+        }
+    }
+
+    // Drawing comes before this frame's ticks, so it interpolates by
+    // what the last frame's ticks left over.
+    if (threaded)
+    {
+        drawSceneThreaded(frameStart);
+    }
+    else
+    {
+        FrameProfiler::Instance().NextFrame();
+        TextureLoader::Instance().Update();
+        g_window.display(g_winw, g_winh, g_drawAlpha);
+    }
+    g_window.timestep(g_scheduler.SimTime(), g_scheduler.TickSeconds(), g_scheduler.Ticks());
+    g_drawAlpha = g_scheduler.Alpha();
+
+    const double frameEnd = g_renderThread.Now();
+    g_logicTime.AddSample(frameEnd - frameStart);
+    if (threaded == false)
+    {
+        if (g_hostPresents)
+        {
+            g_unpresentedStart = frameStart;
+        }
+        else
+        {
+            g_singleLatency.AddSample(frameEnd - frameStart);
+            if (g_lastFrameStart >= 0.)
+            {
+                g_singleInterval.AddSample(frameStart - g_lastFrameStart);
+            }
+        }
+    }
+    g_lastFrameStart = frameStart;
+
+    if (g_pipelineLogTimer.seconds() > 1.)
+    {
+        LOG_INFO("%s", formatPipelineStats().c_str());
+        g_pipelineLogTimer.reset();
+    }
+
+    if (g_firstFrameDrawn == false)
+    {
+        g_firstFrameDrawn = true;
+        LOG_INFO("Time to first frame: %.1f ms", 1000. * g_startupTimer.seconds());
+    }
 }
 
+// While a log is replaying, live input other than window size is dropped
+// so the session plays out the same on every run.
 void onSingleTouchEvent(int pointerid, int action, float x, float y)
 {
     //LOG_INFO("onSingleTouchEvent( @%f: %d, %d, %f, %f)\n", g_timer.seconds(), pointerid, action, x, y);
-    g_window.OnSingleTouch(pointerid, action, x, y);
+    if (g_inputReplayer.IsOpen())
+        return;
+    g_inputRecorder.RecordTouch(pointerid, action, x, y);
+    touchToScene(pointerid, action, x, y);
 }
 
 void onWheelEvent(double dx, double dy)
 {
-    g_window.OnWheelEvent(dx, dy);
+    if (g_inputReplayer.IsOpen())
+        return;
+    g_inputRecorder.RecordWheel(dx, dy);
+    wheelToScene(dx, dy);
 }
 
 void onKeyEvent(int key, int scancode, int action, int mods)
 {
-    g_window.OnKeyEvent(key, scancode, action, mods);
+    if (g_inputReplayer.IsOpen())
+        return;
+    g_inputRecorder.RecordKey(key, scancode, action, mods);
+    keyToScene(key, scancode, action, mods);
 }
 
 void onAccelerometerChange(float x, float y, float z, int accuracy)
 {
-    g_window.onAccelerometerChange(x, y, z, accuracy);
+    if (g_inputReplayer.IsOpen())
+        return;
+    g_inputRecorder.RecordAccelerometer(x, y, z, accuracy);
+    accelerometerToScene(x, y, z, accuracy);
+}
+
+///@brief Log every input event from here on to a binary file; see InputRecorder.h.
+/// The log starts with the current window size.
+bool startInputRecording(const std::string& filename)
+{
+    if (g_inputRecorder.Start(filename) == false)
+        return false;
+    g_inputRecorder.RecordWindowSize(g_winw, g_winh);
+    return true;
+}
+
+void stopInputRecording()
+{
+    g_inputRecorder.Stop();
+}
+
+///@brief Feed a log written by startInputRecording to the scene from the
+/// next drawScene on, speed times as fast as it was recorded.
+///@param replayWindowSize Resize the scene to the recorded window sizes.
+/// Hosts that own their surface size pass false: the scene would draw at
+/// the recorded size into a surface of another.
+bool startInputReplay(const std::string& filename, double speed, bool replayWindowSize)
+{
+    if (g_inputReplayer.Open(filename) == false)
+        return false;
+    g_replayWindowSize = replayWindowSize;
+    g_inputReplayer.Start(speed, g_scheduler.Clock());
+    return true;
+}
+
+void stopInputReplay()
+{
+    g_inputReplayer.Close();
+}
+
+bool isReplayingInput()
+{
+    return g_inputReplayer.IsOpen();
+}
+
+bool isInputLog(const std::string& filename)
+{
+    return InputReplayer::IsInputLog(filename);
+}
+
+///@brief Simulate in ticks of 1/ticksPerSecond, at most maxTicksPerFrame
+/// a frame; 0 ticks per second goes back to one tick per frame. See
+/// TimestepScheduler.h.
+void setFixedTimestep(double ticksPerSecond, int maxTicksPerFrame)
+{
+    g_scheduler.SetFixedRate(ticksPerSecond, maxTicksPerFrame);
+    g_drawAlpha = g_scheduler.Alpha();
+    LOG_INFO("Timestep: %s", g_scheduler.IsFixed() ? "fixed" : "variable");
+}
+
+///@brief Advance time by exactly 1/framesPerSecond each frame instead of
+/// by the wall clock, for runs that repeat exactly; 0 turns it off.
+void setVirtualClock(double framesPerSecond)
+{
+    g_scheduler.SetVirtualClock(framesPerSecond);
 }
 
 void setLoaderFunc(void* pFunc)
 {
     g_window.m_pLoaderFunc = pFunc;
 }
+
+static void acquireGLForLua()
+{
+    g_renderThread.AcquireContext();
+}
+
+///@brief Replay recorded frames on a thread of their own, which takes the
+/// host's GL context through the given callbacks; see RenderThread.h. The
+/// host must have the context current and stop swapping buffers itself
+/// while isRenderThreadRunning. The frame profiler is off meanwhile, as it
+/// issues GL queries from the logic thread.
+bool startRenderThread(const renderContextCallbacks& ctx)
+{
+    if (g_renderThread.IsRunning())
+        return true;
+    if (g_renderThread.Start(ctx) == false)
+        return false;
+    g_profilerWasEnabled = FrameProfiler::Instance().IsEnabled();
+    FrameProfiler::Instance().SetEnabled(false);
+    g_window.SetGLAcquireHook(acquireGLForLua);
+    resetPipelineStats();
+    return true;
+}
+
+///@brief Present the frame in flight and go back to drawing on the calling
+/// thread, which has the context current again.
+void stopRenderThread()
+{
+    if (g_renderThread.IsRunning() == false)
+        return;
+    g_renderThread.Stop();
+    g_window.SetGLAcquireHook(NULL);
+    FrameProfiler::Instance().SetEnabled(g_profilerWasEnabled);
+    resetPipelineStats();
+}
+
+bool isRenderThreadRunning()
+{
+    return g_renderThread.IsRunning();
+}
+
+///@brief Hosts that swap buffers themselves call this right after, so a
+/// single-threaded frame's latency runs to its swap as the render thread's
+/// does, and its interval is between swaps. Without it both are taken at
+/// drawScene, before the swap.
+void framePresented()
+{
+    if (g_renderThread.IsRunning())
+        return;
+    const double now = g_renderThread.Now();
+    if (g_hostPresents == false)
+    {
+        // This frame was sampled in drawScene; later ones are sampled here.
+        g_hostPresents = true;
+    }
+    else if (g_unpresentedStart >= 0.)
+    {
+        g_singleLatency.AddSample(now - g_unpresentedStart);
+        if (g_lastPresent >= 0.)
+        {
+            g_singleInterval.AddSample(now - g_lastPresent);
+        }
+    }
+    g_unpresentedStart = -1.;
+    g_lastPresent = now;
+}
+
+///@brief Wait until every frame drawn so far is on screen, e.g. before
+/// timing stops.
+void finishFrames()
+{
+    if (g_renderThread.IsRunning())
+    {
+        g_renderThread.WaitIdle();
+        return;
+    }
+    glFinish();
+}
+
+void getPipelineReport(pipelineReport& r)
+{
+    const bool threaded = g_renderThread.IsRunning();
+    const FrameTimeHistogram& latency = threaded ? g_renderThread.GetLatency() : g_singleLatency;
+    const FrameTimeHistogram& interval = threaded ? g_renderThread.GetInterval() : g_singleInterval;
+    r.threaded = threaded;
+    r.frames = latency.GetCount();
+    const double elapsed = g_pipelineTimer.seconds();
+    r.framesPerSecond = (elapsed > 0.) ? static_cast<double>(r.frames) / elapsed : 0.;
+    r.latencyP50 = latency.GetPercentile(.50);
+    r.latencyP99 = latency.GetPercentile(.99);
+    r.intervalP50 = interval.GetPercentile(.50);
+    r.intervalP99 = interval.GetPercentile(.99);
+    r.logicP50 = g_logicTime.GetPercentile(.50);
+    r.logicP99 = g_logicTime.GetPercentile(.99);
+}
+
+void resetPipelineStats()
+{
+    g_renderThread.ResetStats();
+    g_singleLatency.Reset();
+    g_singleInterval.Reset();
+    g_logicTime.Reset();
+    g_lastFrameStart = -1.;
+    g_unpresentedStart = -1.;
+    g_lastPresent = -1.;
+    g_pipelineTimer.reset();
+}
+
+void getSceneNames(std::vector<std::string>& names)
+{
+    g_window.GetSceneNames(names);
+}
+
+void switchToScene(int idx)
+{
+    g_renderThread.AcquireContext();
+    g_window.SwitchToScene(idx);
+    resetPipelineStats();
+}
+
+const std::string& getErrorText()
+{
+    return g_window.ErrorText();
+}
@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 bool initScene();
 void exitScene();
 void surfaceChangedScene(int w, int h);
@@ -12,3 +15,43 @@ void onWheelEvent(double dx, double dy);
 void onKeyEvent(int key, int scancode, int action, int mods);
 void onAccelerometerChange(float x, float y, float z, int accuracy);
 void setLoaderFunc(void* pFunc);
+
+bool startInputRecording(const std::string& filename);
+void stopInputRecording();
+bool startInputReplay(const std::string& filename, double speed, bool replayWindowSize);
+void stopInputReplay();
+bool isReplayingInput();
+bool isInputLog(const std::string& filename);
+
+void setFixedTimestep(double ticksPerSecond, int maxTicksPerFrame);
+void setVirtualClock(double framesPerSecond);
+
+struct renderContextCallbacks;
+bool startRenderThread(const renderContextCallbacks& ctx);
+void stopRenderThread();
+bool isRenderThreadRunning();
+void framePresented();
+void finishFrames();
+
+/// Frame timings since the last resetPipelineStats or scene switch, in
+/// seconds. Latency runs from the start of drawScene to the frame's swap;
+/// interval is between swaps; logic is drawScene on the calling thread.
+/// Single-threaded, the swap is the host's framePresented call; hosts that
+/// make none are timed to the end of drawScene and between its starts.
+struct pipelineReport {
+    bool threaded;
+    unsigned int frames;
+    double framesPerSecond;
+    double latencyP50;
+    double latencyP99;
+    double intervalP50;
+    double intervalP99;
+    double logicP50;
+    double logicP99;
+};
+void getPipelineReport(pipelineReport& r);
+void resetPipelineStats();
+
+void getSceneNames(std::vector<std::string>& names);
+void switchToScene(int idx);
+const std::string& getErrorText();
@@ -0,0 +1,444 @@
+// AssetArchive.cpp
+
+#include "AssetArchive.h"
+#include "Logging.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#  define WINDOWS_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+static const char s_archiveMagic[4] = { 'F', 'C', 'P', 'K' };
+static const unsigned int s_archiveVersion = 1;
+static const size_t s_headerSize = 16;
+static const size_t s_indexEntrySize = 24;
+static const unsigned int s_flagLZ4 = 1;
+
+static unsigned int readU32(const unsigned char* u)
+{
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<unsigned int>(u[3]) << 24);
+}
+
+///@brief Decode one LZ4 block (the raw block format, no frame header).
+///@return false if the input is malformed or does not fill pOut exactly.
+static bool decompressLZ4(const unsigned char* pIn, size_t inSize, unsigned char* pOut, size_t outSize)
+{
+    const unsigned char* ip = pIn;
+    const unsigned char* const iend = pIn + inSize;
+    unsigned char* op = pOut;
+    unsigned char* const oend = pOut + outSize;
+
+    while (ip < iend)
+    {
+        const unsigned int token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15)
+        {
+            unsigned int b = 255;
+            while ((ip < iend) && (b == 255))
+            {
+                b = *ip++;
+                literals += b;
+            }
+        }
+        if ((literals > static_cast<size_t>(iend - ip)) ||
+            (literals > static_cast<size_t>(oend - op)))
+            return false;
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence is literals only.
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > static_cast<size_t>(op - pOut)))
+            return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            unsigned int b = 255;
+            while ((ip < iend) && (b == 255))
+            {
+                b = *ip++;
+                matchLength += b;
+            }
+        }
+        matchLength += 4;
+        if (matchLength > static_cast<size_t>(oend - op))
+            return false;
+
+        // Matches may overlap their own output; copy bytewise.
+        const unsigned char* pMatch = op - offset;
+        for (size_t i=0; i<matchLength; ++i)
+        {
+            op[i] = pMatch[i];
+        }
+        op += matchLength;
+    }
+    return op == oend;
+}
+
+AssetArchive::AssetArchive()
+: m_pBase(NULL)
+, m_mappedSize(0)
+, m_entries()
+, m_rootDir()
+, m_archiveTime(0)
+#ifdef _WIN32
+, m_hFile(INVALID_HANDLE_VALUE)
+, m_hMapping(NULL)
+#endif
+{
+}
+
+AssetArchive::~AssetArchive()
+{
+    Unmount();
+}
+
+void AssetArchive::Unmount()
+{
+    m_entries.clear();
+    if (m_pBase == NULL)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_pBase);
+    CloseHandle(m_hMapping);
+    CloseHandle(m_hFile);
+    m_hMapping = NULL;
+    m_hFile = INVALID_HANDLE_VALUE;
+#else
+    munmap(const_cast<unsigned char*>(m_pBase), m_mappedSize);
+#endif
+    m_pBase = NULL;
+    m_mappedSize = 0;
+}
+
+///@brief Entries packed under prefix from a directory outside rootDir (see
+/// make_asset_archive.py) are checked for edits against their files in dir.
+/// Call before Mount.
+void AssetArchive::SetSourceDir(const std::string& prefix, const std::string& dir)
+{
+    m_sourceDirs.push_back(std::make_pair(prefix, dir));
+}
+
+///@brief Map the archive and check its index. Paths under rootDir are looked
+/// up by the part after it.
+///@return false, leaving nothing mounted, if the file is missing or malformed.
+bool AssetArchive::Mount(const std::string& archiveFile, const std::string& rootDir)
+{
+    Unmount();
+    m_rootDir = rootDir;
+
+#ifdef _WIN32
+    m_hFile = CreateFileA(archiveFile.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if ((GetFileSizeEx(m_hFile, &fileSize) == 0) ||
+        (fileSize.QuadPart <= static_cast<LONGLONG>(s_headerSize)))
+    {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_hMapping != NULL)
+    {
+        m_pBase = reinterpret_cast<const unsigned char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (m_pBase == NULL)
+    {
+        if (m_hMapping != NULL)
+            CloseHandle(m_hMapping);
+        CloseHandle(m_hFile);
+        m_hMapping = NULL;
+        m_hFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    m_mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = open(archiveFile.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fst;
+    if ((fstat(fd, &fst) != 0) || (fst.st_size <= static_cast<off_t>(s_headerSize)))
+    {
+        close(fd);
+        return false;
+    }
+    void* pMap = mmap(NULL, static_cast<size_t>(fst.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (pMap == MAP_FAILED)
+    {
+        LOG_ERROR("AssetArchive: could not map %s", archiveFile.c_str());
+        return false;
+    }
+    m_pBase = reinterpret_cast<const unsigned char*>(pMap);
+    m_mappedSize = static_cast<size_t>(fst.st_size);
+#endif
+
+    if ((memcmp(m_pBase, s_archiveMagic, sizeof(s_archiveMagic)) != 0) ||
+        (readU32(m_pBase + 4) != s_archiveVersion))
+    {
+        LOG_ERROR("AssetArchive: %s is not a version %u archive.", archiveFile.c_str(), s_archiveVersion);
+        Unmount();
+        return false;
+    }
+
+    const size_t count = readU32(m_pBase + 8);
+    if (s_headerSize + count * s_indexEntrySize > m_mappedSize)
+    {
+        LOG_ERROR("AssetArchive: %s index is truncated.", archiveFile.c_str());
+        Unmount();
+        return false;
+    }
+
+    m_entries.resize(count);
+    for (size_t i=0; i<count; ++i)
+    {
+        const unsigned char* pIndex = m_pBase + s_headerSize + i * s_indexEntrySize;
+        const size_t nameOffset = readU32(pIndex);
+        const size_t nameLength = readU32(pIndex + 4);
+        archiveEntry& e = m_entries[i];
+        e.dataOffset = readU32(pIndex + 8);
+        e.storedSize = readU32(pIndex + 12);
+        e.size = readU32(pIndex + 16);
+        e.flags = readU32(pIndex + 20);
+        if ((nameOffset + nameLength >= m_mappedSize) ||
+            (m_pBase[nameOffset + nameLength] != '\0') ||
+            (static_cast<size_t>(e.dataOffset) + e.storedSize > m_mappedSize) ||
+            (((e.flags & s_flagLZ4) == 0) && (e.storedSize != e.size)))
+        {
+            LOG_ERROR("AssetArchive: %s entry %d is out of range.", archiveFile.c_str(), static_cast<int>(i));
+            Unmount();
+            return false;
+        }
+        e.pName = reinterpret_cast<const char*>(m_pBase + nameOffset);
+    }
+
+    struct stat st;
+    m_archiveTime = (stat(archiveFile.c_str(), &st) == 0) ? st.st_mtime : 0;
+
+    LOG_INFO("AssetArchive: %d entries in %s", static_cast<int>(count), archiveFile.c_str());
+    return true;
+}
+
+///@return The entry for the given path by binary search, or NULL.
+const AssetArchive::archiveEntry* AssetArchive::_Find(const char* pPath) const
+{
+    if ((pPath == NULL) || m_entries.empty())
+        return NULL;
+
+    const char* pName = pPath;
+    if (strncmp(pPath, m_rootDir.c_str(), m_rootDir.length()) == 0)
+        pName += m_rootDir.length();
+
+    int lo = 0;
+    int hi = static_cast<int>(m_entries.size()) - 1;
+    while (lo <= hi)
+    {
+        const int mid = (lo + hi) / 2;
+        const int c = strcmp(pName, m_entries[mid].pName);
+        if (c == 0)
+            return _SourceIsNewer(pName) ? NULL : &m_entries[mid];
+        if (c < 0)
+            hi = mid - 1;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+bool AssetArchive::_SourceIsNewer(const char* pName) const
+{
+#ifdef __ANDROID__
+    // Sources and archive are unpacked together; their times say nothing.
+    (void)pName;
+    return false;
+#else
+    std::string path = m_rootDir + pName;
+    for (size_t i=0; i<m_sourceDirs.size(); ++i)
+    {
+        const std::string& prefix = m_sourceDirs[i].first;
+        if (strncmp(pName, prefix.c_str(), prefix.length()) == 0)
+        {
+            path = m_sourceDirs[i].second + (pName + prefix.length());
+            break;
+        }
+    }
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+    return st.st_mtime > m_archiveTime;
+#endif
+}
+
+///@brief Look up an asset without touching its bytes.
+///@return The stored bytes, valid until Unmount, or NULL if the path is not
+/// in the archive or is compressed there. size is the unpacked size
+/// whenever the entry exists.
+const unsigned char* AssetArchive::Find(const char* pPath, size_t& size, bool& compressed) const
+{
+    const archiveEntry* pEntry = _Find(pPath);
+    if (pEntry == NULL)
+    {
+        size = 0;
+        compressed = false;
+        return NULL;
+    }
+    size = pEntry->size;
+    compressed = (pEntry->flags & s_flagLZ4) != 0;
+    return compressed ? NULL : (m_pBase + pEntry->dataOffset);
+}
+
+///@brief Copy or decompress a whole entry into pOut, which must hold exactly
+/// its unpacked size.
+bool AssetArchive::Read(const char* pPath, unsigned char* pOut, size_t outSize) const
+{
+    const archiveEntry* pEntry = _Find(pPath);
+    if ((pEntry == NULL) || (pOut == NULL) || (outSize != pEntry->size))
+        return false;
+
+    const unsigned char* pStored = m_pBase + pEntry->dataOffset;
+    if ((pEntry->flags & s_flagLZ4) == 0)
+    {
+        memcpy(pOut, pStored, outSize);
+        return true;
+    }
+    if (decompressLZ4(pStored, pEntry->storedSize, pOut, outSize) == false)
+    {
+        LOG_ERROR("AssetArchive: corrupt LZ4 data in %s", pEntry->pName);
+        return false;
+    }
+    return true;
+}
+
+
+AssetFile::AssetFile()
+: m_pData(NULL)
+, m_size(0)
+, m_fromArchive(false)
+, m_buffer()
+{
+}
+
+AssetFile::~AssetFile()
+{
+}
+
+void AssetFile::Close()
+{
+    m_pData = NULL;
+    m_size = 0;
+    m_fromArchive = false;
+    std::vector<unsigned char>().swap(m_buffer);
+}
+
+///@brief Get the bytes of pPath from the mounted archive if it has them,
+/// otherwise from the file system.
+bool AssetFile::Open(const char* pPath)
+{
+    Close();
+    if (pPath == NULL)
+        return false;
+
+    const AssetArchive& archive = AssetArchive::Instance();
+    size_t size = 0;
+    bool compressed = false;
+    const unsigned char* pStored = archive.Find(pPath, size, compressed);
+    if (pStored != NULL)
+    {
+        m_pData = pStored;
+        m_size = size;
+        m_fromArchive = true;
+        return true;
+    }
+    if (compressed)
+    {
+        m_buffer.resize(size);
+        if ((size == 0) || archive.Read(pPath, &m_buffer[0], size))
+        {
+            m_pData = m_buffer.empty() ? NULL : &m_buffer[0];
+            m_size = size;
+            m_fromArchive = true;
+            return true;
+        }
+        m_buffer.clear();
+    }
+    return _ReadFile(pPath);
+}
+
+bool AssetFile::_ReadFile(const char* pPath)
+{
+    FILE* pF = fopen(pPath, "rb");
+    if (pF == NULL)
+        return false;
+
+    fseek(pF, 0, SEEK_END);
+    const long size = ftell(pF);
+    fseek(pF, 0, SEEK_SET);
+    bool ok = (size >= 0);
+    if (size > 0)
+    {
+        m_buffer.resize(static_cast<size_t>(size));
+        ok = (fread(&m_buffer[0], 1, m_buffer.size(), pF) == m_buffer.size());
+    }
+    fclose(pF);
+
+    if (ok == false)
+    {
+        m_buffer.clear();
+        return false;
+    }
+    m_pData = m_buffer.empty() ? NULL : &m_buffer[0];
+    m_size = m_buffer.size();
+    return true;
+}
+
+
+extern "C" {
+
+const void* fc_asset_find(const char* pPath, unsigned int* pSize)
+{
+    size_t size = 0;
+    bool compressed = false;
+    const unsigned char* pData = AssetArchive::Instance().Find(pPath, size, compressed);
+    if (pSize != NULL)
+        *pSize = static_cast<unsigned int>(size);
+    return pData;
+}
+
+int fc_asset_read(const char* pPath, void* pOut, unsigned int outSize)
+{
+    return AssetArchive::Instance().Read(pPath, reinterpret_cast<unsigned char*>(pOut), outSize) ? 1 : 0;
+}
+
+}
+
+const AssetArchiveApi* GetAssetArchiveApi()
+{
+    static const AssetArchiveApi api = {
+        fc_asset_find,
+        fc_asset_read,
+    };
+    return &api;
+}
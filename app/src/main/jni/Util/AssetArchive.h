@@ -0,0 +1,122 @@
+// AssetArchive.h
+
+#pragma once
+
+#include "Singleton.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <time.h>
+#include <stddef.h>
+
+///@brief Read-only view of the packed asset archive written by
+/// tools/make_asset_archive.py: every file under deploy/ in one file with a
+/// sorted index and 16-byte aligned payloads, some LZ4 compressed.
+/// Mount maps the whole archive; stored entries are then served as spans
+/// straight out of the mapping, with no open, read or copy per asset.
+///@note Off Android, an entry whose source file is newer than the archive is
+/// treated as missing so edits show up without rebuilding it.
+///@note Nothing changes after Mount, so lookups are safe from any thread.
+class AssetArchive : public Singleton
+{
+public:
+    static AssetArchive& Instance()
+    {
+        static AssetArchive instance;
+        return instance;
+    }
+
+    void SetSourceDir(const std::string& prefix, const std::string& dir);
+    bool Mount(const std::string& archiveFile, const std::string& rootDir);
+    void Unmount();
+    bool IsMounted() const { return m_pBase != NULL; }
+    int EntryCount() const { return static_cast<int>(m_entries.size()); }
+
+    // Paths may be given under rootDir or relative to it.
+    const unsigned char* Find(const char* pPath, size_t& size, bool& compressed) const;
+    bool Read(const char* pPath, unsigned char* pOut, size_t outSize) const;
+
+protected:
+    struct archiveEntry {
+        const char* pName; ///< Points into the mapping
+        unsigned int dataOffset;
+        unsigned int storedSize;
+        unsigned int size;
+        unsigned int flags;
+    };
+
+    const archiveEntry* _Find(const char* pPath) const;
+    bool _SourceIsNewer(const char* pName) const;
+
+    const unsigned char* m_pBase;
+    size_t m_mappedSize;
+    std::vector<archiveEntry> m_entries; ///< Sorted by name
+    std::string m_rootDir;
+    std::vector<std::pair<std::string, std::string> > m_sourceDirs; ///< Prefix, directory its entries came from
+    time_t m_archiveTime;
+#ifdef _WIN32
+    void* m_hFile;
+    void* m_hMapping;
+#endif
+
+private:
+    AssetArchive();
+    ~AssetArchive();
+    AssetArchive(AssetArchive const& copy);            // Not Implemented
+    AssetArchive& operator=(AssetArchive const& copy); // Not Implemented
+};
+
+///@brief The bytes of one asset: a span into the mounted archive where it is
+/// stored there uncompressed, or a buffer of its own holding the decompressed
+/// entry or the file as read from disk.
+class AssetFile
+{
+public:
+    AssetFile();
+    virtual ~AssetFile();
+
+    bool Open(const char* pPath);
+    void Close();
+
+    const unsigned char* Data() const { return m_pData; }
+    size_t Size() const { return m_size; }
+    bool FromArchive() const { return m_fromArchive; }
+
+protected:
+    bool _ReadFile(const char* pPath);
+
+    const unsigned char* m_pData;
+    size_t m_size;
+    bool m_fromArchive;
+    std::vector<unsigned char> m_buffer;
+
+private: // Disallow copy ctor and assignment operator
+    AssetFile(const AssetFile&);
+    AssetFile& operator=(const AssetFile&);
+};
+
+#if defined(_WIN32)
+#  define ASSETARCHIVE_EXPORT __declspec(dllexport)
+#else
+#  define ASSETARCHIVE_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// Lookups for Lua through ffi.C where the host exports its symbols.
+/// fc_asset_find returns the stored bytes of an uncompressed entry, or NULL
+/// with *pSize still set for a compressed one, which fc_asset_read unpacks
+/// into a buffer of that size. *pSize is 0 for paths not in the archive.
+/// Must match the cdef in deploy/lua/util/assets.lua.
+extern "C" {
+ASSETARCHIVE_EXPORT const void* fc_asset_find(const char* pPath, unsigned int* pSize);
+ASSETARCHIVE_EXPORT int fc_asset_read(const char* pPath, void* pOut, unsigned int outSize);
+}
+
+/// The same functions as pointers, handed to Lua as native_asset_api for
+/// hosts that do not export symbols (e.g. the Android .so).
+struct AssetArchiveApi {
+    const void* (*fc_asset_find)(const char* pPath, unsigned int* pSize);
+    int (*fc_asset_read)(const char* pPath, void* pOut, unsigned int outSize);
+};
+
+const AssetArchiveApi* GetAssetArchiveApi();
@@ -0,0 +1,79 @@
+// Atomics.h
+// Minimal atomic integer operations separated by #ifdefs, since neither
+// MSVC 2010 nor stlport on Android give us <atomic>.
+
+#pragma once
+
+#ifdef _WIN32
+#  define WINDOWS_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+
+/// Add delta to *p and return the previous value.
+inline long AtomicFetchAdd(volatile long* p, long delta)
+{
+    return InterlockedExchangeAdd(p, delta);
+}
+
+/// Replace *p with desired if it equals expected. Returns the previous value.
+inline long AtomicCompareExchange(volatile long* p, long expected, long desired)
+{
+    return InterlockedCompareExchange(p, desired, expected);
+}
+
+inline long AtomicLoad(const volatile long* p)
+{
+    MemoryBarrier();
+    const long v = *p;
+    MemoryBarrier();
+    return v;
+}
+
+inline void AtomicStore(volatile long* p, long v)
+{
+    InterlockedExchange(p, v);
+}
+
+#else // GCC and clang, including the Android NDK
+
+/// Add delta to *p and return the previous value.
+inline long AtomicFetchAdd(volatile long* p, long delta)
+{
+    return __sync_fetch_and_add(p, delta);
+}
+
+/// Replace *p with desired if it equals expected. Returns the previous value.
+inline long AtomicCompareExchange(volatile long* p, long expected, long desired)
+{
+    return __sync_val_compare_and_swap(p, expected, desired);
+}
+
+inline long AtomicLoad(const volatile long* p)
+{
+    __sync_synchronize();
+    const long v = *p;
+    __sync_synchronize();
+    return v;
+}
+
+inline void AtomicStore(volatile long* p, long v)
+{
+    __sync_synchronize();
+    *p = v;
+    __sync_synchronize();
+}
+
+#endif
+
+/// Raise *p to v if v is larger, without taking a lock.
+inline void AtomicMax(volatile long* p, long v)
+{
+    long cur = AtomicLoad(p);
+    while (v > cur)
+    {
+        const long prev = AtomicCompareExchange(p, cur, v);
+        if (prev == cur)
+            break;
+        cur = prev;
+    }
+}
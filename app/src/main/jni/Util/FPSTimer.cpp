@@ -7,6 +7,8 @@ FPSTimer::FPSTimer()
 , m_count(10)
 , m_frameTimes()
 , m_ringPtr(0)
+, m_lastFrameTime(-1.)
+, m_histogram()
 {
 }
 
@@ -16,14 +18,21 @@ FPSTimer::~FPSTimer()
 
 void FPSTimer::OnFrame()
 {
+    const double now = m_timer.seconds();
+    if (m_lastFrameTime >= 0.)
+    {
+        m_histogram.AddSample(now - m_lastFrameTime);
+    }
+    m_lastFrameTime = now;
+
     if (m_frameTimes.size() < m_count)
     {
-        m_frameTimes.push_back(m_timer.seconds());
+        m_frameTimes.push_back(now);
     }
     else
     {
         ++m_ringPtr %= m_count;
-        m_frameTimes[m_ringPtr] = m_timer.seconds();
+        m_frameTimes[m_ringPtr] = now;
     }
 }
 
@@ -31,6 +40,8 @@ void FPSTimer::Reset()
 {
     m_frameTimes.clear();
     m_ringPtr = 0;
+    m_lastFrameTime = -1.;
+    m_histogram.Reset();
 }
 
 float FPSTimer::GetFPS() const
@@ -3,9 +3,11 @@
 #pragma once
 
 #include "Timer.h"
+#include "FrameTimeHistogram.h"
 #include <vector>
 
-///@brief Keeps a history of elapsed frame times for calculating average FPS.
+///@brief Keeps a history of elapsed frame times for calculating average FPS,
+/// and a histogram of frame durations for percentiles and budget overruns.
 class FPSTimer
 {
 public:
@@ -17,11 +19,16 @@ public:
     float GetFPS() const;
     float GetInstantaneousFPS() const;
 
+    const FrameTimeHistogram& GetHistogram() const { return m_histogram; }
+    void ResetHistogram() { m_histogram.Reset(); }
+
 protected:
     Timer m_timer;
     unsigned int m_count; ///< Number of samples in history
     std::vector<double> m_frameTimes;
     unsigned int m_ringPtr;
+    double m_lastFrameTime; ///< Negative until the first frame
+    FrameTimeHistogram m_histogram;
 
 private: // Disallow copy ctor and assignment operator
     FPSTimer(const FPSTimer&);
@@ -0,0 +1,122 @@
+// FrameTimeHistogram.cpp
+
+#include "FrameTimeHistogram.h"
+#include "Atomics.h"
+
+#include <math.h>
+
+const double FrameTimeHistogram::s_budgets[FrameTimeHistogram::s_numBudgets] = {
+    1. / 60.,
+    1. / 90.,
+};
+
+FrameTimeHistogram::FrameTimeHistogram()
+{
+    Reset();
+}
+
+FrameTimeHistogram::~FrameTimeHistogram()
+{
+}
+
+void FrameTimeHistogram::Reset()
+{
+    for (int i=0; i<s_numBuckets; ++i)
+    {
+        AtomicStore(&m_buckets[i], 0);
+    }
+    for (int i=0; i<s_numBudgets; ++i)
+    {
+        AtomicStore(&m_overBudget[i], 0);
+    }
+    AtomicStore(&m_count, 0);
+    AtomicStore(&m_maxUs, 0);
+}
+
+///@brief Map a duration in microseconds to its bucket.
+/// frexp splits us into mantissa [.5,1) and exponent: the exponent picks the
+/// octave and the mantissa the linear sub-bucket within it.
+int FrameTimeHistogram::_BucketIndex(long us)
+{
+    if (us <= 0)
+        return 0;
+
+    int e = 0;
+    const double m = frexp(static_cast<double>(us), &e);
+    const int octave = e - s_minExponent;
+    if (octave < 0)
+        return 0;
+    if (octave >= s_octaves)
+        return s_numBuckets - 1;
+
+    const int sub = static_cast<int>((m - .5) * 2. * s_subBuckets);
+    return octave * s_subBuckets + sub;
+}
+
+///@return The upper edge of bucket idx in seconds
+double FrameTimeHistogram::_BucketUpperBound(int idx)
+{
+    const int octave = idx / s_subBuckets;
+    const int sub = idx % s_subBuckets;
+    const double octaveStartUs = ldexp(1., octave + s_minExponent - 1);
+    const double us = octaveStartUs * (1. + static_cast<double>(sub + 1) / static_cast<double>(s_subBuckets));
+    return 1.e-6 * us;
+}
+
+void FrameTimeHistogram::AddSample(double seconds)
+{
+    const long us = static_cast<long>(seconds * 1.e6);
+    AtomicFetchAdd(&m_buckets[_BucketIndex(us)], 1);
+    AtomicFetchAdd(&m_count, 1);
+    AtomicMax(&m_maxUs, us);
+
+    for (int i=0; i<s_numBudgets; ++i)
+    {
+        if (seconds > s_budgets[i])
+        {
+            AtomicFetchAdd(&m_overBudget[i], 1);
+        }
+    }
+}
+
+unsigned int FrameTimeHistogram::GetCount() const
+{
+    return static_cast<unsigned int>(AtomicLoad(&m_count));
+}
+
+///@param fraction Quantile in [0,1], e.g. .99 for the 99th percentile
+///@return Frame duration in seconds, never more than the largest sample seen
+double FrameTimeHistogram::GetPercentile(double fraction) const
+{
+    const long count = AtomicLoad(&m_count);
+    if (count <= 0)
+        return 0.;
+
+    const long target = static_cast<long>(ceil(fraction * static_cast<double>(count)));
+    long cumulative = 0;
+    for (int i=0; i<s_numBuckets; ++i)
+    {
+        cumulative += AtomicLoad(&m_buckets[i]);
+        if (cumulative >= target)
+        {
+            const double upper = _BucketUpperBound(i);
+            const double maxVal = GetMax();
+            return upper < maxVal ? upper : maxVal;
+        }
+    }
+    return GetMax();
+}
+
+double FrameTimeHistogram::GetMax() const
+{
+    return 1.e-6 * static_cast<double>(AtomicLoad(&m_maxUs));
+}
+
+///@param budgetIdx Index into s_budgets
+///@return Number of frames longer than that budget since the last Reset
+unsigned int FrameTimeHistogram::GetCountOver(int budgetIdx) const
+{
+    if ((budgetIdx < 0) || (budgetIdx >= s_numBudgets))
+        return 0;
+    return static_cast<unsigned int>(AtomicLoad(&m_overBudget[budgetIdx]));
+}
@@ -0,0 +1,45 @@
+// FrameTimeHistogram.h
+
+#pragma once
+
+///@brief Log-bucketed histogram of frame durations.
+/// Each power-of-two range of microseconds is split into s_subBuckets linear
+/// buckets, so relative error is bounded at 1/s_subBuckets across 64us..67s.
+/// Samples are added with atomic increments only, so another thread may read
+/// percentiles while the render thread is writing.
+class FrameTimeHistogram
+{
+public:
+    FrameTimeHistogram();
+    virtual ~FrameTimeHistogram();
+
+    void AddSample(double seconds);
+    void Reset();
+
+    unsigned int GetCount() const;
+    double GetPercentile(double fraction) const; ///< Upper bound of the bucket, in seconds
+    double GetMax() const;
+    unsigned int GetCountOver(int budgetIdx) const;
+
+    /// Frame budgets tracked exactly, in seconds: 60 Hz and 90 Hz.
+    static const int s_numBudgets = 2;
+    static const double s_budgets[s_numBudgets];
+
+protected:
+    static int _BucketIndex(long us);
+    static double _BucketUpperBound(int idx);
+
+    static const int s_subBuckets = 8;
+    static const int s_octaves = 20;
+    static const int s_minExponent = 7; ///< frexp exponent of the first octave, [64,128) us
+    static const int s_numBuckets = s_subBuckets * s_octaves;
+
+    volatile long m_buckets[s_numBuckets];
+    volatile long m_count;
+    volatile long m_maxUs;
+    volatile long m_overBudget[s_numBudgets];
+
+private: // Disallow copy ctor and assignment operator
+    FrameTimeHistogram(const FrameTimeHistogram&);
+    FrameTimeHistogram& operator=(const FrameTimeHistogram&);
+};
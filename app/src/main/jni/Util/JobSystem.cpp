@@ -0,0 +1,803 @@
+// JobSystem.cpp
+
+#include "JobSystem.h"
+#include "MatrixMath.h"
+#include "Atomics.h"
+#include "Logging.h"
+
+#include <string.h>
+#include <float.h>
+#include <algorithm>
+
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+JobSystem::JobSystem()
+: m_workers()
+, m_starts()
+, m_queues()
+, m_sleepMutex()
+, m_wake()
+, m_queuedJobs(0)
+, m_quit(false)
+, m_groupMutex()
+, m_groupDone()
+, m_groups(s_maxGroups)
+, m_freeGroups()
+{
+    m_freeGroups.reserve(s_maxGroups);
+    for (int i = s_maxGroups - 1; i >= 0; --i)
+    {
+        jobGroup& g = m_groups[i];
+        g.kernel = NULL;
+        g.pArg = NULL;
+        g.count = 0;
+        g.chunks = 0;
+        g.grain = 1;
+        g.remaining = 0;
+        g.unmetDeps = 0;
+        g.generation = 1;
+        g.inUse = false;
+        m_freeGroups.push_back(i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    // exitScene stops the workers while the arrays jobs write to are
+    // alive; this only catches hosts that do not.
+    Stop();
+}
+
+int JobSystem::HardwareThreads()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<int>(info.dwNumberOfProcessors);
+#else
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? static_cast<int>(n) : 1;
+#endif
+}
+
+///@brief Start the workers.
+///@param workers How many; by default one fewer than the hardware threads,
+/// since the submitting thread runs chunks too while it waits.
+void JobSystem::Start(int workers)
+{
+    if (m_workers.empty() == false)
+        return;
+
+    if (workers < 0)
+    {
+        workers = HardwareThreads() - 1;
+    }
+    workers = std::max(1, std::min(workers, static_cast<int>(s_maxWorkers)));
+
+    m_quit = false;
+    m_queuedJobs = 0;
+    for (int i = 0; i <= workers; ++i)
+    {
+        m_queues.push_back(new workerQueue());
+    }
+    m_starts.resize(workers);
+    for (int i = 0; i < workers; ++i)
+    {
+        m_starts[i].pSystem = this;
+        m_starts[i].index = i;
+        Thread* pThread = new Thread();
+        if (pThread->Start(_WorkerEntry, &m_starts[i]) == false)
+        {
+            LOG_ERROR("JobSystem: could not start a worker.");
+            delete pThread;
+            break;
+        }
+        m_workers.push_back(pThread);
+    }
+    LOG_INFO("JobSystem: started %d workers", static_cast<int>(m_workers.size()));
+}
+
+///@brief Run everything submitted to completion, then join the workers.
+void JobSystem::Stop()
+{
+    if (m_queues.empty())
+        return;
+
+    // Every group in use finishes: dependencies only name earlier handles.
+    const int q = _SubmitterQueue();
+    for (;;)
+    {
+        job j;
+        if (_TakeJob(q, j))
+        {
+            _Execute(j, q);
+            continue;
+        }
+        ScopedLock lock(m_groupMutex);
+        if (static_cast<int>(m_freeGroups.size()) == s_maxGroups)
+            break;
+        m_groupDone.Wait(m_groupMutex);
+    }
+
+    {
+        ScopedLock lock(m_sleepMutex);
+        m_quit = true;
+        m_wake.Broadcast();
+    }
+    for (std::vector<Thread*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        (*it)->Join();
+        delete *it;
+    }
+    m_workers.clear();
+    m_starts.clear();
+    for (std::vector<workerQueue*>::iterator it = m_queues.begin(); it != m_queues.end(); ++it)
+    {
+        delete *it;
+    }
+    m_queues.clear();
+    LOG_INFO("JobSystem: stopped");
+}
+
+///@brief Run kernel over [0, count) in chunks of grain indices.
+///@param pArg Passed to every chunk as it is; it must stay alive until done.
+///@param grain Indices per chunk, or 0 to choose; raised to fit s_maxChunks.
+///@param dependsOn A handle to finish first, or 0.
+int JobSystem::Submit(JobKernel kernel, void* pArg, int count, int grain, int dependsOn)
+{
+    return SubmitCopy(kernel, pArg, 0, count, grain, dependsOn);
+}
+
+///@brief Submit, with argSize bytes at pArg copied (argSize of 0 passes
+/// pArg as it is). Chunks get a pointer to the copy.
+int JobSystem::SubmitCopy(JobKernel kernel, const void* pArg, int argSize, int count, int grain, int dependsOn)
+{
+    if ((kernel == NULL) || (argSize < 0) || (argSize > s_maxArgBytes))
+    {
+        LOG_ERROR("JobSystem: bad submission (%d argument bytes).", argSize);
+        return 0;
+    }
+    if (m_queues.empty())
+    {
+        Start();
+    }
+
+    const int g = _Allocate(kernel, pArg, argSize, count, grain);
+    _AddDependency(g, dependsOn);
+    // Before the release: the group may be done, and its slot reused, by
+    // the time that returns.
+    const int handle = _Handle(g);
+    _Release(g, _SubmitterQueue());
+    return handle;
+}
+
+bool JobSystem::IsDone(int handle)
+{
+    ScopedLock lock(m_groupMutex);
+    return _IsDoneLocked(handle);
+}
+
+///@brief Run chunks on this thread until handle is done.
+void JobSystem::Wait(int handle)
+{
+    if (m_queues.empty())
+        return;
+
+    const int q = _SubmitterQueue();
+    for (;;)
+    {
+        if (IsDone(handle))
+            return;
+        job j;
+        if (_TakeJob(q, j))
+        {
+            _Execute(j, q);
+            continue;
+        }
+        // Nothing left to help with: what remains is on the workers, and
+        // their finishing is what wakes us.
+        ScopedLock lock(m_groupMutex);
+        if (_IsDoneLocked(handle))
+            return;
+        m_groupDone.Wait(m_groupMutex);
+    }
+}
+
+void JobSystem::_WorkerEntry(void* pArg)
+{
+    const workerStart* pStart = reinterpret_cast<const workerStart*>(pArg);
+    pStart->pSystem->_WorkerLoop(pStart->index);
+}
+
+void JobSystem::_WorkerLoop(int index)
+{
+    for (;;)
+    {
+        job j;
+        if (_TakeJob(index, j))
+        {
+            _Execute(j, index);
+            continue;
+        }
+        ScopedLock lock(m_sleepMutex);
+        while ((m_quit == false) && (AtomicLoad(&m_queuedJobs) <= 0))
+        {
+            m_wake.Wait(m_sleepMutex);
+        }
+        if (m_quit)
+            return;
+    }
+}
+
+/// Newest from our own queue, else the oldest from someone else's.
+bool JobSystem::_TakeJob(int index, job& out)
+{
+    if (AtomicLoad(&m_queuedJobs) <= 0)
+        return false;
+
+    const int queueCount = static_cast<int>(m_queues.size());
+    {
+        workerQueue& own = *m_queues[index];
+        ScopedLock lock(own.mutex);
+        if (own.jobs.empty() == false)
+        {
+            out = own.jobs.back();
+            own.jobs.pop_back();
+            AtomicFetchAdd(&m_queuedJobs, -1);
+            return true;
+        }
+    }
+    for (int i = 1; i < queueCount; ++i)
+    {
+        workerQueue& victim = *m_queues[(index + i) % queueCount];
+        ScopedLock lock(victim.mutex);
+        if (victim.jobs.empty() == false)
+        {
+            out = victim.jobs.front();
+            victim.jobs.pop_front();
+            AtomicFetchAdd(&m_queuedJobs, -1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::_Execute(const job& j, int index)
+{
+    jobGroup& g = m_groups[j.group];
+    g.kernel(g.pArg, j.begin, j.end);
+    if (AtomicFetchAdd(&g.remaining, -1) == 1)
+    {
+        _Finish(j.group, index);
+    }
+}
+
+/// Take a free slot and fill it in, held so it is not launched until
+/// _Release. While every slot is in use, run chunks to free one.
+int JobSystem::_Allocate(JobKernel kernel, const void* pArg, int argSize, int count, int grain)
+{
+    count = std::max(count, 0);
+    if (grain <= 0)
+    {
+        // A few chunks per thread, so stealing can even out uneven ones.
+        grain = count / (4 * static_cast<int>(m_queues.size()));
+    }
+    grain = std::max(grain, (count + s_maxChunks - 1) / s_maxChunks);
+    grain = std::max(grain, 1);
+
+    const int q = _SubmitterQueue();
+    for (;;)
+    {
+        {
+            ScopedLock lock(m_groupMutex);
+            if (m_freeGroups.empty() == false)
+            {
+                const int idx = m_freeGroups.back();
+                m_freeGroups.pop_back();
+
+                jobGroup& g = m_groups[idx];
+                g.kernel = kernel;
+                g.pArg = const_cast<void*>(pArg);
+                if (argSize > 0)
+                {
+                    memcpy(g.argStorage, pArg, argSize);
+                    g.pArg = g.argStorage;
+                }
+                g.count = count;
+                g.grain = grain;
+                g.chunks = (count + grain - 1) / grain;
+                g.remaining = g.chunks;
+                g.unmetDeps = 1;
+                g.dependents.clear();
+                g.inUse = true;
+                return idx;
+            }
+        }
+        job j;
+        if (_TakeJob(q, j))
+        {
+            _Execute(j, q);
+            continue;
+        }
+        ScopedLock lock(m_groupMutex);
+        if (m_freeGroups.empty())
+        {
+            m_groupDone.Wait(m_groupMutex);
+        }
+    }
+}
+
+void JobSystem::_AddDependency(int group, int dependsOn)
+{
+    ScopedLock lock(m_groupMutex);
+    if (_IsDoneLocked(dependsOn))
+        return;
+    m_groups[dependsOn % s_maxGroups].dependents.push_back(group);
+    ++m_groups[group].unmetDeps;
+}
+
+/// Drop one of the group's unmet dependencies, launching it onto queue
+/// index when that was the last.
+void JobSystem::_Release(int group, int index)
+{
+    bool ready = false;
+    {
+        ScopedLock lock(m_groupMutex);
+        ready = (--m_groups[group].unmetDeps == 0);
+    }
+    if (ready)
+    {
+        _Launch(group, index);
+    }
+}
+
+void JobSystem::_Launch(int group, int index)
+{
+    const jobGroup& g = m_groups[group];
+    if (g.chunks == 0)
+    {
+        _Finish(group, index);
+        return;
+    }
+
+    {
+        workerQueue& queue = *m_queues[index];
+        ScopedLock lock(queue.mutex);
+        for (int c = 0; c < g.chunks; ++c)
+        {
+            job j;
+            j.group = group;
+            j.begin = c * g.grain;
+            j.end = std::min(j.begin + g.grain, g.count);
+            queue.jobs.push_back(j);
+        }
+        AtomicFetchAdd(&m_queuedJobs, g.chunks);
+    }
+    ScopedLock lock(m_sleepMutex);
+    m_wake.Broadcast();
+}
+
+/// The group's last chunk is done: free its slot and release whatever
+/// was waiting on it.
+void JobSystem::_Finish(int group, int index)
+{
+    std::vector<int> dependents;
+    {
+        ScopedLock lock(m_groupMutex);
+        jobGroup& g = m_groups[group];
+        dependents.swap(g.dependents);
+        g.inUse = false;
+        g.generation = (g.generation < (1 << 20)) ? (g.generation + 1) : 1;
+        m_freeGroups.push_back(group);
+        m_groupDone.Broadcast();
+    }
+    for (std::vector<int>::const_iterator it = dependents.begin(); it != dependents.end(); ++it)
+    {
+        _Release(*it, index);
+    }
+}
+
+/// m_groupMutex must be locked.
+bool JobSystem::_IsDoneLocked(int handle) const
+{
+    if (handle <= 0)
+        return true;
+    const jobGroup& g = m_groups[handle % s_maxGroups];
+    return (g.inUse == false) || (g.generation != handle / s_maxGroups);
+}
+
+int JobSystem::_Handle(int group) const
+{
+    return m_groups[group].generation * s_maxGroups + group;
+}
+
+//
+// Built-in kernels
+//
+
+namespace
+{
+    struct fillArgs {
+        float* pOut;
+        int stride;
+        float pattern[JobSystem::s_maxStride];
+    };
+
+    void fillKernel(void* pArg, int begin, int end)
+    {
+        const fillArgs& a = *reinterpret_cast<const fillArgs*>(pArg);
+        for (int i = begin; i < end; ++i)
+        {
+            float* pDst = a.pOut + i * a.stride;
+            for (int k = 0; k < a.stride; ++k)
+            {
+                pDst[k] = a.pattern[k];
+            }
+        }
+    }
+
+    struct rampArgs {
+        float* pOut;
+        float start;
+        float step;
+    };
+
+    void rampKernel(void* pArg, int begin, int end)
+    {
+        const rampArgs& a = *reinterpret_cast<const rampArgs*>(pArg);
+        for (int i = begin; i < end; ++i)
+        {
+            a.pOut[i] = a.start + a.step * static_cast<float>(i);
+        }
+    }
+
+    struct scaleOffsetArgs {
+        float* pOut;
+        const float* pIn;
+        int stride;
+        float scale[JobSystem::s_maxStride];
+        float offset[JobSystem::s_maxStride];
+    };
+
+    void scaleOffsetKernel(void* pArg, int begin, int end)
+    {
+        const scaleOffsetArgs& a = *reinterpret_cast<const scaleOffsetArgs*>(pArg);
+        for (int i = begin; i < end; ++i)
+        {
+            const float* pSrc = a.pIn + i * a.stride;
+            float* pDst = a.pOut + i * a.stride;
+            for (int k = 0; k < a.stride; ++k)
+            {
+                pDst[k] = pSrc[k] * a.scale[k] + a.offset[k];
+            }
+        }
+    }
+
+    struct transformArgs {
+        float* pOut;
+        const float* pIn;
+        float matrix[16]; ///< Not a mat4: the copy is only 8-byte aligned
+    };
+
+    void transformPointsKernel(void* pArg, int begin, int end)
+    {
+        const transformArgs& a = *reinterpret_cast<const transformArgs*>(pArg);
+        mat4 m;
+        memcpy(m.m, a.matrix, sizeof(m.m));
+        mat4TransformPoints(reinterpret_cast<float3*>(a.pOut) + begin, m,
+            reinterpret_cast<const float3*>(a.pIn) + begin, end - begin);
+    }
+
+    void transformVectorsKernel(void* pArg, int begin, int end)
+    {
+        const transformArgs& a = *reinterpret_cast<const transformArgs*>(pArg);
+        mat4 m;
+        memcpy(m.m, a.matrix, sizeof(m.m));
+        mat4TransformVectors(reinterpret_cast<float3*>(a.pOut) + begin, m,
+            reinterpret_cast<const float3*>(a.pIn) + begin, end - begin);
+    }
+
+    /// Reductions run in two groups: one chunk of partialArgs per range
+    /// writes partials into the combine group's scratch, then a single
+    /// combineArgs chunk folds them into the outputs. Partials are double
+    /// so that long sums do not lose the small terms.
+    struct partialArgs {
+        const float* pIn;
+        int stride;
+        int grain;
+        double* pPartials;
+    };
+
+    struct combineArgs {
+        int chunks;
+        int stride;
+        const double* pPartials;
+        float* pOut0;
+        float* pOut1;
+    };
+
+    void sumPartialKernel(void* pArg, int begin, int end)
+    {
+        const partialArgs& a = *reinterpret_cast<const partialArgs*>(pArg);
+        double* pSum = a.pPartials + (begin / a.grain) * a.stride;
+        for (int k = 0; k < a.stride; ++k)
+        {
+            pSum[k] = 0.;
+        }
+        for (int i = begin; i < end; ++i)
+        {
+            const float* pSrc = a.pIn + i * a.stride;
+            for (int k = 0; k < a.stride; ++k)
+            {
+                pSum[k] += pSrc[k];
+            }
+        }
+    }
+
+    void sumCombineKernel(void* pArg, int, int)
+    {
+        const combineArgs& a = *reinterpret_cast<const combineArgs*>(pArg);
+        for (int k = 0; k < a.stride; ++k)
+        {
+            double sum = 0.;
+            for (int c = 0; c < a.chunks; ++c)
+            {
+                sum += a.pPartials[c * a.stride + k];
+            }
+            a.pOut0[k] = static_cast<float>(sum);
+        }
+    }
+
+    void minMaxPartialKernel(void* pArg, int begin, int end)
+    {
+        const partialArgs& a = *reinterpret_cast<const partialArgs*>(pArg);
+        double* pMin = a.pPartials + (begin / a.grain) * 2 * a.stride;
+        double* pMax = pMin + a.stride;
+        for (int k = 0; k < a.stride; ++k)
+        {
+            pMin[k] = FLT_MAX;
+            pMax[k] = -FLT_MAX;
+        }
+        for (int i = begin; i < end; ++i)
+        {
+            const float* pSrc = a.pIn + i * a.stride;
+            for (int k = 0; k < a.stride; ++k)
+            {
+                pMin[k] = std::min(pMin[k], static_cast<double>(pSrc[k]));
+                pMax[k] = std::max(pMax[k], static_cast<double>(pSrc[k]));
+            }
+        }
+    }
+
+    void minMaxCombineKernel(void* pArg, int, int)
+    {
+        const combineArgs& a = *reinterpret_cast<const combineArgs*>(pArg);
+        for (int k = 0; k < a.stride; ++k)
+        {
+            double lo = FLT_MAX;
+            double hi = -FLT_MAX;
+            for (int c = 0; c < a.chunks; ++c)
+            {
+                lo = std::min(lo, a.pPartials[c * 2 * a.stride + k]);
+                hi = std::max(hi, a.pPartials[c * 2 * a.stride + a.stride + k]);
+            }
+            a.pOut0[k] = static_cast<float>(lo);
+            a.pOut1[k] = static_cast<float>(hi);
+        }
+    }
+
+    bool strideInRange(int stride)
+    {
+        if ((stride >= 1) && (stride <= JobSystem::s_maxStride))
+            return true;
+        LOG_ERROR("JobSystem: stride %d is out of range.", stride);
+        return false;
+    }
+}
+
+int JobSystem::Fill(float* pOut, int count, int stride, const float* pPattern, int dependsOn)
+{
+    if (strideInRange(stride) == false)
+        return 0;
+    fillArgs a;
+    a.pOut = pOut;
+    a.stride = stride;
+    memcpy(a.pattern, pPattern, stride * sizeof(float));
+    return SubmitCopy(fillKernel, &a, sizeof(a), count, 0, dependsOn);
+}
+
+int JobSystem::Ramp(float* pOut, int count, float start, float step, int dependsOn)
+{
+    rampArgs a;
+    a.pOut = pOut;
+    a.start = start;
+    a.step = step;
+    return SubmitCopy(rampKernel, &a, sizeof(a), count, 0, dependsOn);
+}
+
+///@brief pOut = pIn * pScale + pOffset, per component. pOut may be pIn;
+/// a NULL pScale is 1 and a NULL pOffset 0.
+int JobSystem::ScaleOffset(float* pOut, const float* pIn, int count, int stride,
+    const float* pScale, const float* pOffset, int dependsOn)
+{
+    if (strideInRange(stride) == false)
+        return 0;
+    scaleOffsetArgs a;
+    a.pOut = pOut;
+    a.pIn = pIn;
+    a.stride = stride;
+    for (int k = 0; k < stride; ++k)
+    {
+        a.scale[k] = pScale ? pScale[k] : 1.f;
+        a.offset[k] = pOffset ? pOffset[k] : 0.f;
+    }
+    return SubmitCopy(scaleOffsetKernel, &a, sizeof(a), count, 0, dependsOn);
+}
+
+///@brief Transform count xyz points by a column-order matrix.
+int JobSystem::TransformPoints(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn)
+{
+    transformArgs a;
+    a.pOut = pOut;
+    a.pIn = pIn;
+    memcpy(a.matrix, pMatrix, sizeof(a.matrix));
+    return SubmitCopy(transformPointsKernel, &a, sizeof(a), count, 0, dependsOn);
+}
+
+///@brief Transform count xyz directions by a column-order matrix, ignoring
+/// its translation.
+int JobSystem::TransformVectors(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn)
+{
+    transformArgs a;
+    a.pOut = pOut;
+    a.pIn = pIn;
+    memcpy(a.matrix, pMatrix, sizeof(a.matrix));
+    return SubmitCopy(transformVectorsKernel, &a, sizeof(a), count, 0, dependsOn);
+}
+
+///@brief Sum count elements into the stride floats at pOut.
+int JobSystem::ReduceSum(const float* pIn, int count, int stride, float* pOut, int dependsOn)
+{
+    if (strideInRange(stride) == false)
+        return 0;
+    return _Reduce(sumPartialKernel, sumCombineKernel, pIn, count, stride, pOut, NULL, dependsOn);
+}
+
+///@brief Per-component minimum and maximum of count elements. With no
+/// elements they come out as FLT_MAX and -FLT_MAX.
+int JobSystem::ReduceMinMax(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn)
+{
+    if (strideInRange(stride) == false)
+        return 0;
+    return _Reduce(minMaxPartialKernel, minMaxCombineKernel, pIn, count, stride, pMin, pMax, dependsOn);
+}
+
+/// The combine group is taken first so that the partial chunks can write
+/// into its scratch, which stays put until it has run.
+int JobSystem::_Reduce(JobKernel partial, JobKernel combine, const float* pIn, int count, int stride,
+    float* pOut0, float* pOut1, int dependsOn)
+{
+    if (m_queues.empty())
+    {
+        Start();
+    }
+
+    combineArgs c;
+    memset(&c, 0, sizeof(c));
+    const int combineGroup = _Allocate(combine, &c, sizeof(c), 1, 1);
+
+    partialArgs p;
+    memset(&p, 0, sizeof(p));
+    const int partialGroup = _Allocate(partial, &p, sizeof(p), count, 0);
+
+    // Neither is launched yet, so both are ours to fill in.
+    const jobGroup& pg = m_groups[partialGroup];
+    jobGroup& cg = m_groups[combineGroup];
+    const int valuesPerChunk = (pOut1 != NULL) ? 2 * stride : stride;
+    cg.scratch.resize(std::max(pg.chunks, 1) * valuesPerChunk);
+
+    combineArgs* pCombine = reinterpret_cast<combineArgs*>(cg.argStorage);
+    pCombine->chunks = pg.chunks;
+    pCombine->stride = stride;
+    pCombine->pPartials = &cg.scratch[0];
+    pCombine->pOut0 = pOut0;
+    pCombine->pOut1 = pOut1;
+
+    partialArgs* pPartial = reinterpret_cast<partialArgs*>(m_groups[partialGroup].argStorage);
+    pPartial->pIn = pIn;
+    pPartial->stride = stride;
+    pPartial->grain = pg.grain;
+    pPartial->pPartials = &cg.scratch[0];
+
+    _AddDependency(partialGroup, dependsOn);
+    _AddDependency(combineGroup, _Handle(partialGroup));
+    const int handle = _Handle(combineGroup);
+    _Release(partialGroup, _SubmitterQueue());
+    _Release(combineGroup, _SubmitterQueue());
+    return handle;
+}
+
+//
+// Lua interface
+//
+
+int fc_job_worker_count()
+{
+    JobSystem& js = JobSystem::Instance();
+    if (js.WorkerCount() == 0)
+    {
+        js.Start();
+    }
+    return js.WorkerCount();
+}
+
+int fc_job_parallel_for(JobKernel kernel, void* pArg, int count, int grain, int dependsOn)
+{
+    return JobSystem::Instance().Submit(kernel, pArg, count, grain, dependsOn);
+}
+
+int fc_job_is_done(int handle)
+{
+    return JobSystem::Instance().IsDone(handle) ? 1 : 0;
+}
+
+void fc_job_wait(int handle)
+{
+    JobSystem::Instance().Wait(handle);
+}
+
+int fc_job_fill(float* pOut, int count, int stride, const float* pPattern, int dependsOn)
+{
+    return JobSystem::Instance().Fill(pOut, count, stride, pPattern, dependsOn);
+}
+
+int fc_job_ramp(float* pOut, int count, float start, float step, int dependsOn)
+{
+    return JobSystem::Instance().Ramp(pOut, count, start, step, dependsOn);
+}
+
+int fc_job_scale_offset(float* pOut, const float* pIn, int count, int stride,
+    const float* pScale, const float* pOffset, int dependsOn)
+{
+    return JobSystem::Instance().ScaleOffset(pOut, pIn, count, stride, pScale, pOffset, dependsOn);
+}
+
+int fc_job_transform_points(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn)
+{
+    return JobSystem::Instance().TransformPoints(pOut, pMatrix, pIn, count, dependsOn);
+}
+
+int fc_job_transform_vectors(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn)
+{
+    return JobSystem::Instance().TransformVectors(pOut, pMatrix, pIn, count, dependsOn);
+}
+
+int fc_job_reduce_sum(const float* pIn, int count, int stride, float* pOut, int dependsOn)
+{
+    return JobSystem::Instance().ReduceSum(pIn, count, stride, pOut, dependsOn);
+}
+
+int fc_job_reduce_minmax(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn)
+{
+    return JobSystem::Instance().ReduceMinMax(pIn, count, stride, pMin, pMax, dependsOn);
+}
+
+const JobSystemApi* GetJobSystemApi()
+{
+    static const JobSystemApi api = {
+        fc_job_worker_count,
+        fc_job_parallel_for,
+        fc_job_is_done,
+        fc_job_wait,
+        fc_job_fill,
+        fc_job_ramp,
+        fc_job_scale_offset,
+        fc_job_transform_points,
+        fc_job_transform_vectors,
+        fc_job_reduce_sum,
+        fc_job_reduce_minmax,
+    };
+    return &api;
+}
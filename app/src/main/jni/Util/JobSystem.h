@@ -0,0 +1,176 @@
+// JobSystem.h
+
+#pragma once
+
+#include "Singleton.h"
+#include "Threads.h"
+
+#include <deque>
+#include <vector>
+
+/// A range of a parallel-for: called with [begin, end) of its count.
+typedef void (*JobKernel)(void* pArg, int begin, int end);
+
+///@brief A pool of worker threads running parallel-fors over index ranges.
+/// Submit splits [0, count) into chunks of grain indices and returns a
+/// handle at once. Each worker has a deque of chunks: it takes its own
+/// from the back, newest first, and when that is empty steals the oldest
+/// from another's front. A submission may name another handle it depends
+/// on; its chunks are queued only when that one has finished, by whichever
+/// thread finishes it. Wait runs chunks on the calling thread until the
+/// handle is done, so a machine with one core still makes progress.
+///
+/// Handles are a slot and a generation: once done the slot is reused, and
+/// an old handle to it simply reads as done. 0 is never a handle and
+/// reads as done, so it can be passed as "no dependency".
+///@note Submissions come from one thread, the one running Lua; the first
+/// starts the workers if Start has not been called. Kernels run on the
+/// workers, so they must be native code: a LuaJIT callback would run Lua
+/// on the wrong thread.
+class JobSystem : public Singleton
+{
+public:
+    static JobSystem& Instance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    void Start(int workers = -1);
+    void Stop();
+    int WorkerCount() const { return static_cast<int>(m_workers.size()); }
+
+    int Submit(JobKernel kernel, void* pArg, int count, int grain, int dependsOn = 0);
+    int SubmitCopy(JobKernel kernel, const void* pArg, int argSize, int count, int grain, int dependsOn = 0);
+    bool IsDone(int handle);
+    void Wait(int handle);
+
+    // Built-in kernels over float arrays, each returning its handle. Arrays
+    // hold count elements of stride floats, tightly packed, and must stay
+    // alive until the handle is done; patterns and matrices are copied.
+    int Fill(float* pOut, int count, int stride, const float* pPattern, int dependsOn = 0);
+    int Ramp(float* pOut, int count, float start, float step, int dependsOn = 0);
+    int ScaleOffset(float* pOut, const float* pIn, int count, int stride,
+        const float* pScale, const float* pOffset, int dependsOn = 0);
+    int TransformPoints(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn = 0);
+    int TransformVectors(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn = 0);
+    int ReduceSum(const float* pIn, int count, int stride, float* pOut, int dependsOn = 0);
+    int ReduceMinMax(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn = 0);
+
+    static int HardwareThreads();
+
+    static const int s_maxWorkers = 16;
+    static const int s_maxGroups = 1024;   ///< Submissions in flight at once
+    static const int s_maxArgBytes = 256;  ///< For SubmitCopy
+    static const int s_maxChunks = 256;    ///< Per submission; grain is raised to fit
+    static const int s_maxStride = 16;     ///< Floats per element for the built-ins
+
+protected:
+    struct job {
+        int group;
+        int begin;
+        int end;
+    };
+
+    struct jobGroup {
+        JobKernel kernel;
+        void* pArg;
+        int count;
+        int chunks;
+        int grain;
+        volatile long remaining;    ///< Chunks not yet finished
+        int unmetDeps;              ///< Guarded by m_groupMutex; includes the submitter's hold
+        std::vector<int> dependents; ///< Guarded by m_groupMutex
+        int generation;             ///< Guarded by m_groupMutex
+        bool inUse;                 ///< Guarded by m_groupMutex
+        double argStorage[s_maxArgBytes / sizeof(double)]; ///< SubmitCopy's copy, aligned
+        std::vector<double> scratch; ///< Reduction partials; kept across reuse of the slot
+    };
+
+    struct workerQueue {
+        Mutex mutex;
+        std::deque<job> jobs;
+    };
+
+    struct workerStart {
+        JobSystem* pSystem;
+        int index;
+    };
+
+    static void _WorkerEntry(void* pArg);
+    void _WorkerLoop(int index);
+    bool _TakeJob(int index, job& out);
+    void _Execute(const job& j, int index);
+    int _Allocate(JobKernel kernel, const void* pArg, int argSize, int count, int grain);
+    void _AddDependency(int group, int dependsOn);
+    void _Release(int group, int index);
+    void _Launch(int group, int index);
+    void _Finish(int group, int index);
+    bool _IsDoneLocked(int handle) const;
+    int _Handle(int group) const;
+    int _SubmitterQueue() const { return static_cast<int>(m_queues.size()) - 1; }
+    int _Reduce(JobKernel partial, JobKernel combine, const float* pIn, int count, int stride,
+        float* pOut0, float* pOut1, int dependsOn);
+
+    std::vector<Thread*> m_workers;
+    std::vector<workerStart> m_starts;
+    std::vector<workerQueue*> m_queues; ///< One per worker, then the submitting thread's last
+
+    Mutex m_sleepMutex;
+    ConditionVariable m_wake;
+    volatile long m_queuedJobs;
+    bool m_quit;                ///< Guarded by m_sleepMutex
+
+    Mutex m_groupMutex;
+    ConditionVariable m_groupDone;
+    std::vector<jobGroup> m_groups;
+    std::vector<int> m_freeGroups; ///< Guarded by m_groupMutex
+
+private:
+    JobSystem();
+    ~JobSystem();
+    JobSystem(JobSystem const& copy);            // Not Implemented
+    JobSystem& operator=(JobSystem const& copy); // Not Implemented
+};
+
+#if defined(_WIN32)
+#  define JOBSYSTEM_EXPORT __declspec(dllexport)
+#else
+#  define JOBSYSTEM_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// For Lua through ffi.C where the host exports its symbols.
+/// Must match the cdef in deploy/lua/util/jobs.lua.
+extern "C" {
+JOBSYSTEM_EXPORT int  fc_job_worker_count();
+JOBSYSTEM_EXPORT int  fc_job_parallel_for(JobKernel kernel, void* pArg, int count, int grain, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_is_done(int handle);
+JOBSYSTEM_EXPORT void fc_job_wait(int handle);
+JOBSYSTEM_EXPORT int  fc_job_fill(float* pOut, int count, int stride, const float* pPattern, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_ramp(float* pOut, int count, float start, float step, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_scale_offset(float* pOut, const float* pIn, int count, int stride,
+    const float* pScale, const float* pOffset, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_transform_points(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_transform_vectors(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_reduce_sum(const float* pIn, int count, int stride, float* pOut, int dependsOn);
+JOBSYSTEM_EXPORT int  fc_job_reduce_minmax(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn);
+}
+
+/// The same functions as pointers, handed to Lua as native_job_api for
+/// hosts that do not export symbols (e.g. the Android .so).
+struct JobSystemApi {
+    int  (*fc_job_worker_count)();
+    int  (*fc_job_parallel_for)(JobKernel kernel, void* pArg, int count, int grain, int dependsOn);
+    int  (*fc_job_is_done)(int handle);
+    void (*fc_job_wait)(int handle);
+    int  (*fc_job_fill)(float* pOut, int count, int stride, const float* pPattern, int dependsOn);
+    int  (*fc_job_ramp)(float* pOut, int count, float start, float step, int dependsOn);
+    int  (*fc_job_scale_offset)(float* pOut, const float* pIn, int count, int stride,
+        const float* pScale, const float* pOffset, int dependsOn);
+    int  (*fc_job_transform_points)(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+    int  (*fc_job_transform_vectors)(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+    int  (*fc_job_reduce_sum)(const float* pIn, int count, int stride, float* pOut, int dependsOn);
+    int  (*fc_job_reduce_minmax)(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn);
+};
+
+const JobSystemApi* GetJobSystemApi();
@@ -7,6 +7,7 @@
 #define LOG_INFO(...) LOGI(__VA_ARGS__)
 #define LOG_INFO_NONEWLINE(...) LOGI(__VA_ARGS__)
 #define LOG_ERROR(...) LOGE(__VA_ARGS__)
+#define LOG_FLUSH()
 
 #include <android/log.h>
 #define  LOG_TAG    "flickercladding"
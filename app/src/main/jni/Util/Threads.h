@@ -0,0 +1,199 @@
+// Threads.h
+// Minimal thread, mutex and condition variable wrappers separated by
+// #ifdefs, since neither MSVC 2010 nor stlport on Android give us <thread>.
+
+#pragma once
+
+#ifdef _WIN32
+#  define WINDOWS_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+
+class Mutex
+{
+public:
+    Mutex() { InitializeCriticalSection(&m_cs); }
+    ~Mutex() { DeleteCriticalSection(&m_cs); }
+    void Lock() { EnterCriticalSection(&m_cs); }
+    void Unlock() { LeaveCriticalSection(&m_cs); }
+
+private:
+    friend class ConditionVariable;
+    CRITICAL_SECTION m_cs;
+
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+};
+
+/// Needs Vista or later.
+class ConditionVariable
+{
+public:
+    ConditionVariable() { InitializeConditionVariable(&m_cv); }
+    ~ConditionVariable() {}
+    /// Mutex must be locked; it is released while waiting.
+    void Wait(Mutex& m) { SleepConditionVariableCS(&m_cv, &m.m_cs, INFINITE); }
+    /// As Wait, but gives up after milliseconds.
+    void WaitFor(Mutex& m, unsigned int milliseconds) { SleepConditionVariableCS(&m_cv, &m.m_cs, milliseconds); }
+    void Signal() { WakeConditionVariable(&m_cv); }
+    void Broadcast() { WakeAllConditionVariable(&m_cv); }
+
+private:
+    CONDITION_VARIABLE m_cv;
+
+    ConditionVariable(const ConditionVariable&);
+    ConditionVariable& operator=(const ConditionVariable&);
+};
+
+/// Runs one function on its own thread until Join.
+class Thread
+{
+public:
+    typedef void (*ThreadFunc)(void* pArg);
+
+    Thread() : m_handle(NULL), m_pFunc(NULL), m_pArg(NULL) {}
+    ~Thread() { Join(); }
+
+    bool Start(ThreadFunc pFunc, void* pArg)
+    {
+        if (m_handle != NULL)
+            return false;
+        m_pFunc = pFunc;
+        m_pArg = pArg;
+        m_handle = CreateThread(NULL, 0, _Entry, this, 0, NULL);
+        return m_handle != NULL;
+    }
+    void Join()
+    {
+        if (m_handle == NULL)
+            return;
+        WaitForSingleObject(m_handle, INFINITE);
+        CloseHandle(m_handle);
+        m_handle = NULL;
+    }
+    bool IsRunning() const { return m_handle != NULL; }
+
+private:
+    static DWORD WINAPI _Entry(LPVOID p)
+    {
+        Thread* pThread = reinterpret_cast<Thread*>(p);
+        pThread->m_pFunc(pThread->m_pArg);
+        return 0;
+    }
+
+    HANDLE m_handle;
+    ThreadFunc m_pFunc;
+    void* m_pArg;
+
+    Thread(const Thread&);
+    Thread& operator=(const Thread&);
+};
+
+#else // pthreads: Linux, MacOS and the Android NDK
+#  include <pthread.h>
+#  include <sys/time.h>
+
+class Mutex
+{
+public:
+    Mutex() { pthread_mutex_init(&m_mutex, NULL); }
+    ~Mutex() { pthread_mutex_destroy(&m_mutex); }
+    void Lock() { pthread_mutex_lock(&m_mutex); }
+    void Unlock() { pthread_mutex_unlock(&m_mutex); }
+
+private:
+    friend class ConditionVariable;
+    pthread_mutex_t m_mutex;
+
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+};
+
+class ConditionVariable
+{
+public:
+    ConditionVariable() { pthread_cond_init(&m_cond, NULL); }
+    ~ConditionVariable() { pthread_cond_destroy(&m_cond); }
+    /// Mutex must be locked; it is released while waiting.
+    void Wait(Mutex& m) { pthread_cond_wait(&m_cond, &m.m_mutex); }
+    /// As Wait, but gives up after milliseconds.
+    void WaitFor(Mutex& m, unsigned int milliseconds)
+    {
+        timeval now;
+        gettimeofday(&now, NULL);
+        const unsigned long long nsec =
+            (static_cast<unsigned long long>(now.tv_usec) + 1000ULL * milliseconds) * 1000ULL;
+        timespec until;
+        until.tv_sec = now.tv_sec + static_cast<time_t>(nsec / 1000000000ULL);
+        until.tv_nsec = static_cast<long>(nsec % 1000000000ULL);
+        pthread_cond_timedwait(&m_cond, &m.m_mutex, &until);
+    }
+    void Signal() { pthread_cond_signal(&m_cond); }
+    void Broadcast() { pthread_cond_broadcast(&m_cond); }
+
+private:
+    pthread_cond_t m_cond;
+
+    ConditionVariable(const ConditionVariable&);
+    ConditionVariable& operator=(const ConditionVariable&);
+};
+
+/// Runs one function on its own thread until Join.
+class Thread
+{
+public:
+    typedef void (*ThreadFunc)(void* pArg);
+
+    Thread() : m_thread(), m_running(false), m_pFunc(NULL), m_pArg(NULL) {}
+    ~Thread() { Join(); }
+
+    bool Start(ThreadFunc pFunc, void* pArg)
+    {
+        if (m_running)
+            return false;
+        m_pFunc = pFunc;
+        m_pArg = pArg;
+        m_running = (pthread_create(&m_thread, NULL, _Entry, this) == 0);
+        return m_running;
+    }
+    void Join()
+    {
+        if (m_running == false)
+            return;
+        pthread_join(m_thread, NULL);
+        m_running = false;
+    }
+    bool IsRunning() const { return m_running; }
+
+private:
+    static void* _Entry(void* p)
+    {
+        Thread* pThread = reinterpret_cast<Thread*>(p);
+        pThread->m_pFunc(pThread->m_pArg);
+        return NULL;
+    }
+
+    pthread_t m_thread;
+    bool m_running;
+    ThreadFunc m_pFunc;
+    void* m_pArg;
+
+    Thread(const Thread&);
+    Thread& operator=(const Thread&);
+};
+
+#endif
+
+/// Holds a Mutex locked for the scope it is declared in.
+class ScopedLock
+{
+public:
+    explicit ScopedLock(Mutex& m) : m_mutex(m) { m_mutex.Lock(); }
+    ~ScopedLock() { m_mutex.Unlock(); }
+
+private:
+    Mutex& m_mutex;
+
+    ScopedLock(const ScopedLock&);
+    ScopedLock& operator=(const ScopedLock&);
+};
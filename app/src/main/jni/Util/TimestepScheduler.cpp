@@ -0,0 +1,112 @@
+// TimestepScheduler.cpp
+
+#include "TimestepScheduler.h"
+#include "Logging.h"
+
+// Frame times that are whole multiples of the tick are only nearly so in
+// floating point; without the slack a 60Hz virtual clock at 60 ticks/s
+// would alternate between 0 and 2 ticks.
+static const double s_tickSlack = 1.e-9;
+
+TimestepScheduler::TimestepScheduler()
+: m_fixedStep(0.)
+, m_virtualFrame(0.)
+, m_maxTicks(s_defaultMaxTicks)
+, m_lastWall(0.)
+, m_clock(0.)
+, m_accumulator(0.)
+, m_simTime(0.)
+, m_ticks(0)
+, m_tickSeconds(0.)
+, m_alpha(1.)
+, m_droppedTicks(0)
+, m_dropping(false)
+{
+}
+
+TimestepScheduler::~TimestepScheduler()
+{
+}
+
+void TimestepScheduler::SetFixedRate(double ticksPerSecond, int maxTicksPerFrame)
+{
+    m_fixedStep = (ticksPerSecond > 0.) ? 1. / ticksPerSecond : 0.;
+    m_maxTicks = (maxTicksPerFrame > 0) ? maxTicksPerFrame : s_defaultMaxTicks;
+    m_accumulator = 0.;
+    m_alpha = IsFixed() ? 0. : 1.;
+}
+
+void TimestepScheduler::SetVirtualClock(double framesPerSecond)
+{
+    m_virtualFrame = (framesPerSecond > 0.) ? 1. / framesPerSecond : 0.;
+}
+
+///@brief Start over from time 0, e.g. when the wall clock passed to
+/// Advance has been reset.
+void TimestepScheduler::Reset()
+{
+    m_lastWall = 0.;
+    m_clock = 0.;
+    m_accumulator = 0.;
+    m_simTime = 0.;
+    m_ticks = 0;
+    m_tickSeconds = 0.;
+    m_alpha = IsFixed() ? 0. : 1.;
+    m_droppedTicks = 0;
+    m_dropping = false;
+}
+
+///@brief Work out this frame's ticks.
+///@param wallSeconds The wall clock now; only tracked with a virtual clock.
+void TimestepScheduler::Advance(double wallSeconds)
+{
+    double frameSeconds = wallSeconds - m_lastWall;
+    m_lastWall = wallSeconds;
+    if (IsVirtual())
+    {
+        frameSeconds = m_virtualFrame;
+    }
+    m_clock += frameSeconds;
+
+    if (IsFixed() == false)
+    {
+        m_ticks = 1;
+        m_tickSeconds = frameSeconds;
+        m_simTime = m_clock;
+        m_alpha = 1.;
+        return;
+    }
+
+    m_accumulator += frameSeconds;
+    int ticks = 0;
+    while (m_accumulator + s_tickSlack >= m_fixedStep)
+    {
+        m_accumulator -= m_fixedStep;
+        ++ticks;
+    }
+
+    if (ticks > m_maxTicks)
+    {
+        const int dropped = ticks - m_maxTicks;
+        if (m_dropping == false)
+        {
+            LOG_INFO("TimestepScheduler: frame took %.1f ms, dropping %d ticks.",
+                1000. * frameSeconds, dropped);
+        }
+        m_dropping = true;
+        m_droppedTicks += dropped;
+        ticks = m_maxTicks;
+    }
+    else
+    {
+        m_dropping = false;
+    }
+
+    if (m_accumulator < 0.)
+        m_accumulator = 0.;
+
+    m_ticks = ticks;
+    m_tickSeconds = m_fixedStep;
+    m_simTime += ticks * m_fixedStep;
+    m_alpha = m_accumulator / m_fixedStep;
+}
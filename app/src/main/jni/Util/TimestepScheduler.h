@@ -0,0 +1,55 @@
+// TimestepScheduler.h
+
+#pragma once
+
+///@brief Turns frame times into simulation ticks.
+/// By default there is one tick per frame, as long as the frame took.
+/// With a fixed rate, frame time accumulates and is spent in ticks of
+/// exactly 1/rate seconds; what is left over becomes Alpha, the fraction
+/// of a tick to interpolate by when drawing. A frame runs at most
+/// s_defaultMaxTicks ticks (or the count set) and drops the rest, so one
+/// slow frame cannot make the next slower still.
+/// With a virtual clock every frame advances time by exactly
+/// 1/framesPerSecond, whatever the wall clock says, so runs repeat tick
+/// for tick.
+class TimestepScheduler
+{
+public:
+    TimestepScheduler();
+    virtual ~TimestepScheduler();
+
+    void SetFixedRate(double ticksPerSecond, int maxTicksPerFrame); ///< 0 ticks/s for variable steps
+    void SetVirtualClock(double framesPerSecond); ///< 0 follows the wall clock
+    void Reset();
+    void Advance(double wallSeconds);
+
+    double Clock() const { return m_clock; }            ///< Frame time so far, wall or virtual
+    int Ticks() const { return m_ticks; }               ///< This frame's
+    double TickSeconds() const { return m_tickSeconds; }
+    double SimTime() const { return m_simTime; }        ///< At the end of this frame's last tick
+    double Alpha() const { return m_alpha; }            ///< In [0,1); 1 with variable steps
+    unsigned int DroppedTicks() const { return m_droppedTicks; }
+    bool IsFixed() const { return m_fixedStep > 0.; }
+    bool IsVirtual() const { return m_virtualFrame > 0.; }
+
+    static const int s_defaultMaxTicks = 5;
+
+protected:
+    double m_fixedStep;    ///< Seconds per tick; 0 for variable
+    double m_virtualFrame; ///< Seconds per frame; 0 for the wall clock
+    int m_maxTicks;
+
+    double m_lastWall;
+    double m_clock;
+    double m_accumulator;  ///< Frame time not yet spent in ticks
+    double m_simTime;
+    int m_ticks;
+    double m_tickSeconds;
+    double m_alpha;
+    unsigned int m_droppedTicks;
+    bool m_dropping;       ///< Only the first of a run of drops is logged
+
+private: // Disallow copy ctor and assignment operator
+    TimestepScheduler(const TimestepScheduler&);
+    TimestepScheduler& operator=(const TimestepScheduler&);
+};
@@ -8,21 +8,58 @@ package.path = "../deploy/lua/?.lua;" .. package.path
 local ffi = require("ffi")
 local openGL -- @todo select GL or GLES header
 
+-- Input events queued by LuajitScene, delivered once per frame to on_lua_events.
+-- Must match the layout in InputEventBuffer.h.
+ffi.cdef[[
+typedef struct { int pointerid; int action; int x; int y; } queuedTouchEvent;
+typedef struct { float x; float y; float z; int accuracy; } queuedAccelerometerEvent;
+typedef struct { int key; int scancode; int action; int mods; } queuedKeyEvent;
+typedef struct {
+    int type;
+    union {
+        queuedTouchEvent touch;
+        queuedAccelerometerEvent accel;
+        queuedKeyEvent key;
+    };
+} queuedInputEvent;
+]]
+local EventTouch, EventAccelerometer, EventKey = 0, 1, 2
+
 local clock = os.clock
 
 local Scene = nil
 require("util.glfont")
 local mm = require("util.matrixmath")
 local kc = require("util.glfw_keycodes")
+local assets = require("util.assets")
+
+-- Camera constants written by LuajitScene::RenderForOneEye, one slot per view.
+-- Must match the layout in ViewConstants.h.
+ffi.cdef[[
+typedef struct {
+    mat4f modelview;
+    mat4f projection;
+    int viewIndex;
+    int frameNumber;
+} viewConstants;
+]]
+local views = nil
+if native_view_constants then
+    views = ffi.cast("viewConstants*", native_view_constants)
+end
 
 local ANDROID = false
 local win_w,win_h = 800,800
 local lastSceneChangeTime = 0
+local sim_time = 0 -- absTime of the last timestep; follows the virtual clock when set
 
 local scenedir = "scene2"
 
 function switch_to_scene(name)
     local fullname = scenedir.."."..name
+    -- Scenes load and free GL objects here; take the context back from
+    -- the render thread if it has it.
+    if native_acquire_gl then native_acquire_gl() end
     if Scene and Scene.exitGL then
         Scene:exitGL()
     end
@@ -46,13 +83,18 @@ function switch_to_scene(name)
             if Scene.setWindowSize then Scene:setWindowSize(win_w, win_h) end
             Scene:initGL()
             local initTime = clock() - now
-            lastSceneChangeTime = now
-            collectgarbage()
+            lastSceneChangeTime = sim_time
+            -- The switch is a hitch anyway; collect fully while we are at it.
+            -- native_full_gc also resets LuajitScene's GC pacing.
+            if native_full_gc then native_full_gc() else collectgarbage() end
             print(name,
                 "init time: "..math.floor(1000*initTime).." ms",
                 "memory: "..math.floor(collectgarbage("count")).." kB")
         end
     end
+
+    -- The scene may have replaced on_lua_* globals; have LuajitScene re-resolve them.
+    if refresh_native_callbacks then refresh_native_callbacks() end
 end
 
 local scene_modules = {
@@ -105,16 +147,28 @@ function switch_scene(reverse)
     switch_to_scene(scene_modules[scene_module_idx])
 end
 
+-- Lets the native side enumerate and select scenes, e.g. for benchmarking.
+function on_lua_getscenenames()
+    return scene_modules
+end
+
+function on_lua_switchtoscene(idx)
+    scene_module_idx = idx
+    switch_to_scene(scene_modules[scene_module_idx])
+end
+
+local overlay_mv = mm.mat4()
+local overlay_pr = mm.mat4()
 local function display_scene_overlay()
     if not glfont then return end
 
     local showTime = 2
-    local age = clock() - lastSceneChangeTime
+    local age = sim_time - lastSceneChangeTime
     -- TODO a nice fade or something
     if age > showTime then return end
 
-    local m = {}
-    local p = {}
+    local m = overlay_mv
+    local p = overlay_pr
     mm.make_identity_matrix(m)
     local s = .5
     mm.glh_scale(m, s, s, s)
@@ -132,23 +186,29 @@ local function display_scene_overlay()
     glfont:render_string(m, p, scene_modules[scene_module_idx])
 end
 
--- Cast the array cdata ptr(passes from glm::value_ptr(glm::mat4),
--- which gives a float[16]) to a table for further manipulation here in Lua.
-function array_to_table(array)
-    local m0 = ffi.cast("float*", array)
-    -- The cdata array is 0-indexed. Here we clumsily jam it back
-    -- into a Lua-style, 1-indexed table(array portion).
-    local tab = {}
-    for i=0,15 do tab[i+1] = m0[i] end
-    return tab
+-- Scenes get the matrices as mat4 cdata pointing into native memory,
+-- valid for this call only; mm.copy them to keep them.
+-- alpha is how far past the last timestep to draw, as a fraction of dt:
+-- in [0,1) with fixed timesteps, 1 when each frame is a timestep.
+function on_lua_draw(slot, alpha)
+    local v = views[slot]
+    local mv = v.modelview
+    Scene:render_for_one_eye(mv, v.projection, alpha)
+    if Scene.set_origin_matrix then Scene:set_origin_matrix(mv) end
+    display_scene_overlay()
 end
 
-function on_lua_draw(pmv, ppr)
-    local mv = array_to_table(pmv)
-    local pr = array_to_table(ppr)
-    Scene:render_for_one_eye(mv, pr)
+-- As on_lua_draw, for frames replayed on the render thread: the scene
+-- records its draw calls through util.rendercommands. Returns false,
+-- having recorded nothing, for scenes that cannot; they get on_lua_draw.
+-- The scene name overlay is not drawn in recorded frames.
+function on_lua_record(slot, alpha)
+    if not Scene.record_for_one_eye then return false end
+    local v = views[slot]
+    local mv = v.modelview
+    if not Scene:record_for_one_eye(mv, v.projection, alpha) then return false end
     if Scene.set_origin_matrix then Scene:set_origin_matrix(mv) end
-    display_scene_overlay()
+    return true
 end
 
 function on_lua_initgl(pLoaderFunc)
@@ -179,10 +239,13 @@ function on_lua_initgl(pLoaderFunc)
         typedef GLFWglproc (*GLFWGPAProc)(const char*);
         ]]
         openGL = require("opengl")
-        openGL.loader = ffi.cast('GLFWGPAProc', pLoaderFunc)
+        openGL:load(ffi.cast('GLFWGPAProc', pLoaderFunc))
     end
     openGL:import()
 
+    -- Data paths the scenes build under here are looked up in the asset archive.
+    assets.add_root(ANDROID and appDir or "../deploy")
+
     switch_to_scene(scene_modules[scene_module_idx])
 
 
@@ -210,6 +273,7 @@ function on_lua_exitgl()
 end
 
 function on_lua_timestep(absTime, dt)
+    sim_time = absTime
     if Scene.timestep then Scene:timestep(absTime, dt) end
 end
 
@@ -303,6 +367,34 @@ function on_lua_accelerometer(x,y,z,accuracy)
     if Scene.accelerometer then Scene:accelerometer(x,y,z,accuracy) end
 end
 
+-- The event buffer lives in LuajitScene and never moves, so the cast to
+-- cdata is done only when the pointer changes, not every frame.
+local event_buf_ptr = nil
+local event_buf = nil
+
+-- Called once per frame with all input events queued since the last timestep.
+-- Dispatches each to the per-event handlers above; scenes see no difference.
+function on_lua_events(buf, count)
+    if buf ~= event_buf_ptr then
+        event_buf_ptr = buf
+        event_buf = ffi.cast("const queuedInputEvent*", buf)
+    end
+    for i=0,count-1 do
+        local e = event_buf[i]
+        local t = e.type
+        if t == EventTouch then
+            local te = e.touch
+            on_lua_singletouch(te.pointerid, te.action, te.x, te.y)
+        elseif t == EventAccelerometer then
+            local ae = e.accel
+            on_lua_accelerometer(ae.x, ae.y, ae.z, ae.accuracy)
+        elseif t == EventKey then
+            local ke = e.key
+            on_lua_keypressed(ke.key, ke.scancode, ke.action, ke.mods)
+        end
+    end
+end
+
 function on_lua_setTimeScale(t)
 end
 
@@ -142,18 +142,23 @@ function clockface:exitGL()
     gl.glBindVertexArray(0)
 end
 
+-- Per-frame matrices, reused so drawing allocates nothing.
+local m_sec = mm.mat4()
+local m_tenths = mm.mat4()
+local m_min = mm.mat4()
+
 function clockface:render_for_one_eye(view, proj)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
     
-    local m = {}
+    local m = m_sec
     mm.make_identity_matrix(m)
     mm.glh_rotate(m, 360*self.absoluteTime, 0,0,-1)
     mm.pre_multiply(m, view)
 
-    local m10 = {}
+    local m10 = m_tenths
     mm.make_identity_matrix(m10)
     mm.glh_translate(m10, 0,0,.02)
     local rotations10 = 10*self.absoluteTime
@@ -161,7 +166,7 @@ function clockface:render_for_one_eye(view, proj)
     mm.glh_scale(m10, .5,.5,.5)
     mm.pre_multiply(m10, view)
 
-    local m01= {}
+    local m01 = m_min
     mm.make_identity_matrix(m01)
     mm.glh_translate(m01, 0,0,-.02)
     local rotations01 = .1*self.absoluteTime
@@ -172,11 +177,11 @@ function clockface:render_for_one_eye(view, proj)
 
     gl.glBindVertexArray(self.vao)
 
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
     gl.glDrawElements(GL.GL_TRIANGLES, 3, GL.GL_UNSIGNED_INT, nil)
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m10))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m10))
     gl.glDrawElements(GL.GL_TRIANGLES, 3, GL.GL_UNSIGNED_INT, nil)
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m01))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m01))
     gl.glDrawElements(GL.GL_TRIANGLES, 3, GL.GL_UNSIGNED_INT, nil)
 
     gl.glBindVertexArray(0)
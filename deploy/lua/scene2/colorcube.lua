@@ -23,12 +23,14 @@ function colorcube:init()
     self.vao = 0
     self.prog = 0
     self.rotation = 0
+    self.lastRotation = 0
 end
 
 --local openGL = require("opengl")
 local ffi = require("ffi")
 local mm = require("util.matrixmath")
 local sf = require("util.shaderfunctions")
+local rc = require("util.rendercommands")
 
 local glIntv   = ffi.typeof('GLint[?]')
 local glUintv  = ffi.typeof('GLuint[?]')
@@ -130,6 +132,10 @@ function colorcube:initGL()
 
     self:init_cube_attributes()
     gl.glBindVertexArray(0)
+
+    -- Recorded frames cannot look these up on the fly.
+    self.umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
+    self.upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
 end
 
 function colorcube:exitGL()
@@ -143,26 +149,50 @@ function colorcube:exitGL()
     gl.glDeleteVertexArrays(1, vaoId)
 end
 
-function colorcube:render_for_one_eye(view, proj)
-    -- Rotate the cube slowly around its center
-    local m = {}
-    for i=1,16 do m[i] = view[i] end
-    mm.glh_rotate(m, 30*self.rotation, 0,1,0)
-    mm.glh_rotate(m, 13*self.rotation, 1,0,0)
+local m_cube = mm.mat4()
+
+-- Rotate the cube slowly around its center
+function colorcube:cube_matrix(view, alpha)
+    alpha = alpha or 1
+    local r = self.lastRotation + alpha * (self.rotation - self.lastRotation)
+    local m = m_cube
+    mm.copy(m, view)
+    mm.glh_rotate(m, 30*r, 0,1,0)
+    mm.glh_rotate(m, 13*r, 1,0,0)
     mm.glh_translate(m, -.5,-.5,-.5)
+    return m
+end
+
+function colorcube:render_for_one_eye(view, proj, alpha)
+    local m = self:cube_matrix(view, alpha)
 
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
     gl.glBindVertexArray(self.vao)
     gl.glDrawElements(GL.GL_TRIANGLES, 6*3*2, GL.GL_UNSIGNED_INT, nil)
     gl.glBindVertexArray(0)
     gl.glUseProgram(0)
 end
 
+function colorcube:record_for_one_eye(view, proj, alpha)
+    if not rc.available then return false end
+    local m = self:cube_matrix(view, alpha)
+
+    rc.use_program(self.prog)
+    rc.uniform_matrix4fv(self.upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
+    rc.uniform_matrix4fv(self.umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
+    rc.bind_vertex_array(self.vao)
+    rc.draw_elements(GL.GL_TRIANGLES, 6*3*2, GL.GL_UNSIGNED_INT, 0)
+    rc.bind_vertex_array(0)
+    rc.use_program(0)
+    return true
+end
+
 function colorcube:timestep(absTime, dt)
+    self.lastRotation = self.rotation
     self.rotation = absTime
 end
 
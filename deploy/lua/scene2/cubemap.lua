@@ -29,6 +29,7 @@ end
 local ffi = require("ffi")
 local mm = require("util.matrixmath")
 local sf = require("util.shaderfunctions")
+local textureloader = require("util.textureloader")
 
 local glIntv   = ffi.typeof('GLint[?]')
 local glUintv  = ffi.typeof('GLuint[?]')
@@ -90,26 +91,22 @@ function cubemap:loadtextures()
     gl.glGenTextures(1, dtxId)
     self.texID = dtxId[0]
     gl.glBindTexture(GL.GL_TEXTURE_CUBE_MAP, self.texID)
+    gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_MIN_FILTER, GL.GL_LINEAR_MIPMAP_LINEAR)
+    gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_MAG_FILTER, GL.GL_LINEAR)
+    gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_WRAP_S, GL.GL_CLAMP_TO_EDGE)
+    gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_WRAP_T, GL.GL_CLAMP_TO_EDGE)
+    gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_WRAP_R, GL.GL_CLAMP_TO_EDGE)
+    gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_MAX_LEVEL, 0)
+    gl.glBindTexture(GL.GL_TEXTURE_CUBE_MAP, 0)
+
+    -- Faces arrive over the next few frames as ETC2 with their mip chains
+    -- (make TextureKtx); the map is black until then.
     local dim = 128
     for i,name in ipairs(texfilenames) do
-        local fn = name..dim..".raw"
+        local fn = name..dim..".ktx"
         if self.dataDir then fn = self.dataDir .. "/images/" .. fn end
-        local w,h = dim,dim
-        local inp = assert(io.open(fn, "rb"))
-        local data = inp:read("*all")
-        assert(inp:close())
-        gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_MIN_FILTER, GL.GL_LINEAR)
-        gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_MAG_FILTER, GL.GL_LINEAR)
-        gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_WRAP_S, GL.GL_CLAMP_TO_EDGE)
-        gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_WRAP_T, GL.GL_CLAMP_TO_EDGE)
-        gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_WRAP_R, GL.GL_CLAMP_TO_EDGE)
-        gl.glTexParameteri(GL.GL_TEXTURE_CUBE_MAP, GL.GL_TEXTURE_MAX_LEVEL, 0)
-        gl.glTexImage2D(GL.GL_TEXTURE_CUBE_MAP_POSITIVE_X + i - 1,
-            0, GL.GL_RGB,
-            w, h, 0,
-            GL.GL_RGB, GL.GL_UNSIGNED_BYTE, data)
+        textureloader.load_ktx(fn, self.texID, GL.GL_TEXTURE_CUBE_MAP_POSITIVE_X + i - 1)
     end
-    gl.glBindTexture(GL.GL_TEXTURE_CUBE_MAP, 0)
 end
 
 function cubemap:init_cube_attributes()
@@ -199,27 +196,31 @@ function cubemap:exitGL()
     local vaoId = ffi.new("GLuint[1]", self.vao)
     gl.glDeleteVertexArrays(1, vaoId)
 
+    textureloader.cancel(self.texID)
     local dtexId = ffi.new("GLuint[1]", self.texID)
     gl.glDeleteTextures(1, dtexId)
 end
 
+local m_box = mm.mat4()
+
 function cubemap:render_for_one_eye(view, proj)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     gl.glActiveTexture(GL.GL_TEXTURE0)
     gl.glBindTexture(GL.GL_TEXTURE_CUBE_MAP, self.texID)
     local stex_loc = gl.glGetUniformLocation(self.prog, "sTex")
     gl.glUniform1i(stex_loc, 0)
 
-    local m = {1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1}
+    local m = m_box
+    mm.make_identity_matrix(m)
     local s = 15
     mm.glh_scale(m, s, s, s)
     mm.glh_translate(m, -.5,-.5,-.5)
     mm.pre_multiply(m, view)
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
 
     gl.glBindVertexArray(self.vao)
     gl.glDrawElements(GL.GL_TRIANGLES, 6*3*2, GL.GL_UNSIGNED_INT, nil)
@@ -22,6 +22,7 @@ end
 
 --local openGL = require("opengl")
 local ffi = require("ffi")
+local mm = require("util.matrixmath")
 local sf = require("util.shaderfunctions")
 local Geom_Lib = require("util.geometry_functions")
 
@@ -201,8 +202,8 @@ function droid:render_for_one_eye(view, proj)
     --gl.glEnable(GL.GL_CULL_FACE)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, view))
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(view))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
     gl.glBindVertexArray(self.vao)
     gl.glDrawElements(GL.GL_TRIANGLES, self.numTris, GL.GL_UNSIGNED_INT, nil)
     gl.glBindVertexArray(0)
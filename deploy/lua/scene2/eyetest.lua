@@ -52,8 +52,11 @@ function eyetest:exitGL()
     -- NOTE: memory leak here
 end
 
+local m_text = mm.mat4()
+
 function eyetest:render_for_one_eye(view, proj)
-    local m = {1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1}
+    local m = m_text
+    mm.make_identity_matrix(m)
     local s = .01
     mm.glh_translate(m, 0, 2, 0)
     mm.glh_scale(m, s, -s, s)
@@ -26,6 +26,7 @@ end
 
 require("util.glfont")
 local mm = require("util.matrixmath")
+local assets = require("util.assets")
 
 -- Since data files must be loaded from disk, we have to know
 -- where to find them. Set the directory with this standard entry point.
@@ -37,9 +38,9 @@ function font_test:initGL()
     -- Load text file
     local filename = "loremipsumbreaks.txt"
     if self.dataDir then filename = self.dataDir .. "/" .. filename end
-    local file = io.open(filename)
-    if file then
-        for line in file:lines() do
+    local lines = assets.lines(filename)
+    if lines then
+        for line in lines do
             table.insert(self.lines, line)
         end
     end
@@ -56,8 +57,10 @@ function font_test:exitGL()
     self.glfont:exitGL()
 end
 
+local m_text = mm.mat4()
+
 function font_test:render_for_one_eye(view, proj)
-    local m = {}
+    local m = m_text
     local s = .002
     mm.make_identity_matrix(m)
     mm.glh_translate(m, -2, 1.2, 0)
@@ -162,6 +162,8 @@ function gridcube:exitGL()
     gl.glDeleteVertexArrays(1, vaoId)
 end
 
+local m_model = mm.mat4()
+
 function gridcube:render_for_one_eye(view, proj)
     gl.glDisable(GL.GL_CULL_FACE)
 
@@ -170,15 +172,15 @@ function gridcube:render_for_one_eye(view, proj)
     local uv_loc = gl.glGetUniformLocation(prog, "viewmtx")
     local up_loc = gl.glGetUniformLocation(prog, "projmtx")
     gl.glUseProgram(prog)
-    gl.glUniformMatrix4fv(uv_loc, 1, GL.GL_FALSE, glFloatv(16, view))
-    gl.glUniformMatrix4fv(up_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(uv_loc, 1, GL.GL_FALSE, mm.as_floats(view))
+    gl.glUniformMatrix4fv(up_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
 
-    local m = {}
+    local m = m_model
     mm.make_identity_matrix(m)
     local s = .5
     mm.glh_scale(m,s,s,s)
     mm.glh_translate(m, -.5, -.5, -.5)
-    gl.glUniformMatrix4fv(um_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+    gl.glUniformMatrix4fv(um_loc, 1, GL.GL_FALSE, mm.as_floats(m))
     gl.glBindVertexArray(self.vao)
     --gl.glPolygonMode(GL.GL_FRONT_AND_BACK, GL.GL_LINE)
     gl.glDrawElements(GL.GL_TRIANGLES,
@@ -56,20 +56,22 @@ function hybrid_scene:exitGL()
     self.glfont:exitGL()
 end
 
+local m_label = mm.mat4()
+
 function hybrid_scene:render_for_one_eye(view, proj)
     self.Raster:render_for_one_eye(view, proj)
     self.Raymarch:render_for_one_eye(view, proj)
 
     local col = {1, 1, 1}
-    local m = {1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1}
+    local m = m_label
+    mm.make_identity_matrix(m)
     local s = .002
     mm.glh_translate(m, -1, .8, .5)
     mm.glh_scale(m, s, -s, s)
     mm.pre_multiply(m, view)
     self.glfont:render_string(m, proj, col, "Raymarched CSG Shape")
 
-    local m = {1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1}
-    local s = .002
+    mm.make_identity_matrix(m)
     mm.glh_translate(m, 1, 0.2, -.5)
     mm.glh_scale(m, s, -s, s)
     mm.pre_multiply(m, view)
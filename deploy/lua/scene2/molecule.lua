@@ -31,6 +31,8 @@ end
 local ffi = require("ffi")
 local mm = require("util.matrixmath")
 local sf = require("util.shaderfunctions")
+local assets = require("util.assets")
+local jobs = require("util.jobs")
 
 local glIntv     = ffi.typeof('GLint[?]')
 local glUintv    = ffi.typeof('GLuint[?]')
@@ -152,10 +154,11 @@ function molecule:init_molecule(mol)
     self.num_atoms = #mol
     print(#mol)
 
-    local coords_array = {}
-    local colors_array = {}
-    local cx, cy, cz = 0,0,0
-    local total = 0
+    -- Three vertices per atom, each x,y,z,radius and r,g,b.
+    local nverts = 3*self.num_atoms
+    local verts = glFloatv(4*nverts)
+    local colors = glFloatv(3*nverts)
+    local v = 0
     for i, atom in pairs(mol) do
         local element = atom[1]
         local rad,r,g,b = 1,1,1,1
@@ -173,36 +176,44 @@ function molecule:init_molecule(mol)
         local x = tonumber(atom[2])
         local y = tonumber(atom[3])
         local z = tonumber(atom[4])
-        cx = cx + x
-        cy = cy + y
-        cz = cz + z
-        total = total + 1
         for i=0,2 do
-            coords_array[#coords_array+1] = x
-            coords_array[#coords_array+1] = y
-            coords_array[#coords_array+1] = z
-            coords_array[#coords_array+1] = rad
-            colors_array[#colors_array+1] = r
-            colors_array[#colors_array+1] = g
-            colors_array[#colors_array+1] = b
+            verts[4*v  ] = x
+            verts[4*v+1] = y
+            verts[4*v+2] = z
+            verts[4*v+3] = rad
+            colors[3*v  ] = r
+            colors[3*v+1] = g
+            colors[3*v+2] = b
+            v = v + 1
         end
     end
 
-    cx = cx / total
-    cy = cy / total
-    cz = cz / total
-
-    print("CENTER",cx, cy, cz)
-    print("TOTAL", total)
-
-    for i=0, total*3-1 do
-        coords_array[4*i+1] = coords_array[4*i+1] - cx
-        coords_array[4*i+2] = coords_array[4*i+2] - cy
-        coords_array[4*i+3] = coords_array[4*i+3] - cz
+    -- Move the center of the atoms to the origin, on the workers when
+    -- there are some: large proteins have hundreds of thousands.
+    local cx, cy, cz = 0,0,0
+    if jobs.available and nverts > 0 then
+        local sum = ffi.new("float[4]")
+        jobs.wait(jobs.reduce_sum(verts, nverts, 4, sum))
+        cx, cy, cz = sum[0]/nverts, sum[1]/nverts, sum[2]/nverts
+        jobs.wait(jobs.scale_offset(verts, verts, nverts, 4, nil, {-cx, -cy, -cz, 0}))
+    elseif nverts > 0 then
+        for i=0, nverts-1 do
+            cx = cx + verts[4*i]
+            cy = cy + verts[4*i+1]
+            cz = cz + verts[4*i+2]
+        end
+        cx = cx / nverts
+        cy = cy / nverts
+        cz = cz / nverts
+        for i=0, nverts-1 do
+            verts[4*i  ] = verts[4*i  ] - cx
+            verts[4*i+1] = verts[4*i+1] - cy
+            verts[4*i+2] = verts[4*i+2] - cz
+        end
     end
 
-    local verts = glFloatv(4*3*self.num_atoms, coords_array)
-    local colors = glFloatv(3*3*self.num_atoms, colors_array)
+    print("CENTER",cx, cy, cz)
+    print("TOTAL", self.num_atoms)
 
     local vvbo = glIntv(0)
     gl.glGenBuffers(1, vvbo)
@@ -229,15 +240,15 @@ end
 function molecule:read_xyz(file_name)
     if self.dataDir then file_name = self.dataDir .. "/" .. file_name end
 
-    local file = io.open(file_name, "r")
-    print(file, file_name)
+    local nextline = assets.lines(file_name)
+    print(nextline, file_name)
 
-    file:read() -- number of atoms
-    file:read() -- molecule name
+    nextline() -- number of atoms
+    nextline() -- molecule name
 
     mol = {}
     while (true) do
-        local line = file:read()
+        local line = nextline()
         if not line then break end
         t = {}
 
@@ -252,12 +263,12 @@ end
 function molecule:read_pdb(file_name)
     if self.dataDir then file_name = self.dataDir .. "/" .. file_name end
 
-    local file = io.open(file_name, "r")
-    print(file, file_name)
+    local nextline = assets.lines(file_name)
+    print(nextline, file_name)
 
     mol = {}
     while (true) do
-        local line = file:read()
+        local line = nextline()
         if not line then break end
         if string.find(line, "ATOM") ~= nil then
             element = string.sub(line, 78, 80)
@@ -313,8 +324,8 @@ end
 
 function molecule:render_for_one_eye(mview, proj)
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(0, 1, GL.GL_FALSE, glFloatv(16, mview))
-    gl.glUniformMatrix4fv(1, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(0, 1, GL.GL_FALSE, mm.as_floats(mview))
+    gl.glUniformMatrix4fv(1, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     gl.glBindVertexArray(self.vao)
     gl.glDrawArrays(GL.GL_TRIANGLES, 0, 3 * self.num_atoms)
@@ -30,10 +30,15 @@ end
 local ffi = require("ffi")
 local sf = require("util.shaderfunctions")
 local mm = require("util.matrixmath")
+local profiler = require("util.profiler")
 local SceneLibrary = require("scene2.hybrid_scene") -- any scene here
 local EffectLibrary = require("effect2.effect_chain")
 local FrustumLibrary = require("scene2.frustum") -- for visualization
 
+local z_prepass = profiler.zone("multipass pre-pass")
+local z_inspace = profiler.zone("multipass scene in space")
+local z_hud = profiler.zone("multipass hud")
+
 local glIntv = ffi.typeof('GLint[?]')
 local glUintv = ffi.typeof('GLuint[?]')
 local glFloatv = ffi.typeof('GLfloat[?]')
@@ -225,8 +230,8 @@ function multipass_example:render_fbo_quad(view, proj, tex)
     gl.glUseProgram(self.prog)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, view))
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(view))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     gl.glActiveTexture(GL.GL_TEXTURE0)
     gl.glBindTexture(GL.GL_TEXTURE_2D, tex)
@@ -241,14 +246,22 @@ end
 
 -- Draw the 3D scene within a scene with a textured quad showing
 -- the content of the first fbo floating right there in space.
+-- Per-frame matrices, reused so drawing allocates nothing.
+local m_space = mm.mat4()
+local m_quads = mm.mat4()
+local m_hud_proj = mm.mat4()
+local m_hud_view = mm.mat4()
+local m_cam = mm.mat4()
+local m_txfm = mm.mat4()
+
 function multipass_example:render_scene_in_space(view, proj)
     gl.glEnable(GL.GL_DEPTH_TEST)
-    local m = {}
-    for i=1,16 do m[i] = view[i] end
+    local m = m_space
+    mm.copy(m, view)
 
     -- Render a stack of fbo quads in space behind the view frustum
-    local q = {}
-    for i=1,16 do q[i] = m[i] end
+    local q = m_quads
+    mm.copy(q, m)
     local s = 3.5
     mm.glh_scale(q, s,s,1)
     --mm.glh_translate(q, 1,1,0)
@@ -274,9 +287,9 @@ end
 function multipass_example:render_hud(view, proj)
     gl.glDisable(GL.GL_DEPTH_TEST)
 
-    local p = {}
+    local p = m_hud_proj
     mm.make_identity_matrix(p)
-    local v = {}
+    local v = m_hud_view
     mm.make_identity_matrix(v)
     -- Line up all quads along the right side of the screen
     local s = .5
@@ -295,24 +308,30 @@ end
 -- with an extra preceding step
 function multipass_example:render_for_one_eye(view, proj)
     -- Fixed camera view for the scene within a scene
-    local cam = {}
+    local cam = m_cam
     mm.make_identity_matrix(cam)
     mm.glh_translate(cam, 0,0,-1)
+    local h = profiler.begin_zone(z_prepass)
     self:render_pre_pass(cam, proj)
+    profiler.end_zone(h)
 
     -- Here is a view of the scene within a scene:
     -- External camera transform; move the whole scene
     -- back a bit and turn.
-    local txfm = {}
+    local txfm = m_txfm
     mm.make_identity_matrix(txfm)
     mm.glh_rotate(txfm, 60, 0,1,0)
     mm.glh_translate(txfm, 1,0,-2)
     mm.post_multiply(view, txfm)
     
+    h = profiler.begin_zone(z_inspace)
     self:render_scene_in_space(view, proj)
+    profiler.end_zone(h)
 
     -- TODO: draw these first with depth written out as topmost
+    h = profiler.begin_zone(z_hud)
     self:render_hud(view, proj)
+    profiler.end_zone(h)
 end
 
 function multipass_example:timestep(absTime, dt)
@@ -2,6 +2,11 @@
 --
 -- same as 05 but with 04's variable block sizes
 --
+-- Without compute shaders the bodies are stepped on the CPU by
+-- util/nbody.lua, which writes positions straight into the vertex buffer
+-- the display shaders read. M cycles through the methods available:
+-- gpu, tree (Barnes-Hut) and direct.
+--
 -- began as comp_scene.lua (c) 2015 James Susinno
 -- portions (c) 2016 Mark Stock (markjstock@gmail.com)
 
@@ -24,12 +29,17 @@ function nbody07:init()
     self.prog_accel = 0
     self.prog_acceltiled = 0
     self.prog_integrate = 0
+    self.vboP = 0
+    self.modes = {}
+    self.mode = "gpu"
 end
 
 --local openGL = require("opengl")
 local ffi = require("ffi")
 local sf = require("util.shaderfunctions")
 local mm = require("util.matrixmath")
+local nbody = require("util.nbody")
+local rc = require("util.rendercommands")
 
 -- Types from:
 -- https://github.com/nanoant/glua/blob/master/init.lua
@@ -177,6 +187,14 @@ void main() {
 local particles = 24*1024/2
 local galaxysize = 10.0
 local aspect = 0.1
+local step_dt = 1/1000
+
+local function linked(prog)
+    if prog == 0 then return false end
+    local status = glIntv(1)
+    gl.glGetProgramiv(prog, GL.GL_LINK_STATUS, status)
+    return status[0] == GL.GL_TRUE
+end
 
 function nbody07:init_point_attributes()
     -- attribute array: mass, radsq, brite, rad
@@ -296,15 +314,54 @@ function nbody07:init_point_attributes()
     table.insert(self.vbos, vboM)
     table.insert(self.vbos, vboV)
     table.insert(self.vbos, vboA)
+    self.vboP = vboP
     
-    local dt = 1/1000
-    
-    gl.glUseProgram(self.prog_accel)
-    gl.glUniform1f(0, dt)
-    gl.glUseProgram(self.prog_acceltiled)
-    gl.glUniform1f(0, dt)
-    gl.glUseProgram(self.prog_integrate)
-    gl.glUniform1f(0, dt)
+    if self.modes[1] == "gpu" then
+        gl.glUseProgram(self.prog_accel)
+        gl.glUniform1f(0, step_dt)
+        gl.glUseProgram(self.prog_acceltiled)
+        gl.glUniform1f(0, step_dt)
+        gl.glUseProgram(self.prog_integrate)
+        gl.glUniform1f(0, step_dt)
+        gl.glUseProgram(0)
+    end
+    if nbody.available then
+        nbody.init(particles, pos_array, att_array, vel_array)
+    end
+end
+
+-- Start over from the initial bodies, as the gpu and cpu states differ.
+function nbody07:restart()
+    local vboV = self.vbos[3]
+    local vboA = self.vbos[4]
+    gl.glBindBuffer(GL.GL_ARRAY_BUFFER, self.vboP)
+    gl.glBufferSubData(GL.GL_ARRAY_BUFFER, 0, ffi.sizeof(pos_array), pos_array)
+    gl.glBindBuffer(GL.GL_ARRAY_BUFFER, 0)
+    gl.glBindBuffer(GL.GL_SHADER_STORAGE_BUFFER, vboV)
+    gl.glBufferSubData(GL.GL_SHADER_STORAGE_BUFFER, 0, ffi.sizeof(vel_array), vel_array)
+    gl.glBindBuffer(GL.GL_SHADER_STORAGE_BUFFER, vboA)
+    gl.glBufferSubData(GL.GL_SHADER_STORAGE_BUFFER, 0, ffi.sizeof(acc_array), acc_array)
+    gl.glBindBuffer(GL.GL_SHADER_STORAGE_BUFFER, 0)
+    if nbody.available then
+        nbody.init(particles, pos_array, att_array, vel_array)
+    end
+end
+
+function nbody07:set_mode(mode)
+    if mode == self.mode then return end
+    local was_gpu = (self.mode == "gpu")
+    self.mode = mode
+    if mode ~= "gpu" then
+        nbody.set_method(mode == "direct" and nbody.direct or nbody.tree)
+    end
+    if was_gpu ~= (mode == "gpu") then
+        self:restart()
+    end
+    if mode == "gpu" then
+        print("nbody07: gpu compute")
+    else
+        print("nbody07: cpu "..mode..", "..nbody.kernel_name().." kernel")
+    end
 end
 
 function nbody07:init_quad_attributes()
@@ -346,6 +403,20 @@ function nbody07:initGL()
         compsrc = integ_comp,
         })
 
+    self.modes = {}
+    if linked(self.prog_acceltiled) and linked(self.prog_integrate) then
+        table.insert(self.modes, "gpu")
+    end
+    if nbody.available then
+        table.insert(self.modes, "tree")
+        table.insert(self.modes, "direct")
+    end
+    self.mode = self.modes[1] or "gpu"
+    if self.mode ~= "gpu" then
+        print("nbody07: no compute shaders; stepping on the cpu")
+        nbody.set_method(nbody.tree)
+    end
+
     self:init_point_attributes()
     self:init_quad_attributes()
     gl.glBindVertexArray(0)
@@ -358,6 +429,9 @@ function nbody07:exitGL()
         gl.glDeleteBuffers(1,vboId)
     end
     self.vbos = {}
+    if nbody.available then
+        nbody.clear()
+    end
     gl.glDeleteProgram(self.prog_display)
     gl.glDeleteProgram(self.prog_accel)
     gl.glDeleteProgram(self.prog_acceltiled)
@@ -371,8 +445,8 @@ function nbody07:render_for_one_eye(mview, proj)
     gl.glClearColor(0,0,0,0)
     gl.glClear(GL.GL_COLOR_BUFFER_BIT)
     
-    gl.glUniformMatrix4fv(0, 1, GL.GL_FALSE, glFloatv(16, mview))
-    gl.glUniformMatrix4fv(1, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(0, 1, GL.GL_FALSE, mm.as_floats(mview))
+    gl.glUniformMatrix4fv(1, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     gl.glDisable(GL.GL_DEPTH_TEST)
     gl.glEnable(GL.GL_BLEND)
@@ -390,7 +464,13 @@ function nbody07:render_for_one_eye(mview, proj)
 end
 
 function nbody07:timestep(absTime, dt)
-    
+    if self.mode ~= "gpu" then
+        -- The buffer is mapped, so the render thread must be done with it.
+        rc.acquire_gl()
+        nbody.step_to_buffer(step_dt, self.vboP)
+        return
+    end
+
     gl.glUseProgram(self.prog_acceltiled)
     --gl.glUseProgram(prog_accel)
     gl.glDispatchCompute(particles/128, 1, 1)
@@ -400,4 +480,14 @@ function nbody07:timestep(absTime, dt)
     gl.glUseProgram(0)
 end
 
+function nbody07:keypressed(key)
+    if key ~= string.byte('M') or #self.modes < 2 then return false end
+    local next = 1
+    for i,m in ipairs(self.modes) do
+        if m == self.mode then next = i % #self.modes + 1 end
+    end
+    self:set_mode(self.modes[next])
+    return true
+end
+
 return nbody07
@@ -133,12 +133,10 @@ function origin:render_for_one_eye(mview, proj)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
     
     --gl.glLineWidth(2)
-    local m = {}
-    for i=1,16 do m[i] = mview[i] end
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(mview))
     gl.glBindVertexArray(self.vao)
     gl.glDrawArrays(GL.GL_LINES, 0, 6*3)
     gl.glBindVertexArray(0)
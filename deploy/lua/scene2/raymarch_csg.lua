@@ -21,6 +21,7 @@ function raymarch_csg:init()
 end
 
 local ffi = require("ffi")
+local mm = require("util.matrixmath")
 require("util.fullscreen_shader")
 
 local glIntv = ffi.typeof('GLint[?]')
@@ -240,9 +241,9 @@ end
 function raymarch_csg:render_for_one_eye(view, proj)
     local function set_variables(prog)
         local umv_loc = gl.glGetUniformLocation(prog, "mvmtx")
-        gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, view))
+        gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(view))
         local upr_loc = gl.glGetUniformLocation(prog, "prmtx")
-        gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+        gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
     end
 
     self.shader:render(view, proj, set_variables)
@@ -181,40 +181,44 @@ function simple_game:draw_color_cube()
     gl.glBindVertexArray(0)
 end
 
+-- Per-frame matrices, reused so drawing allocates nothing.
+local m_obj = mm.mat4()
+local m_origin = mm.mat4()
+
 function simple_game:render_for_one_eye(mview, proj)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     -- draw shots
     for _,s in pairs(self.shots) do
-        local m = {}
-        for i=1,16 do m[i] = mview[i] end
+        local m = m_obj
+        mm.copy(m, mview)
         local p = s.p
         mm.glh_translate(m, p[1], p[2], p[3])
         local z = s.r
         mm.glh_scale(m, z, z, z)
 
-        gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+        gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
         self:draw_color_cube()
     end
 
     -- draw targets
     for _,t in pairs(self.targets) do
-        local m = {}
-        for i=1,16 do m[i] = mview[i] end
+        local m = m_obj
+        mm.copy(m, mview)
         local p = t.p
         mm.glh_translate(m, p[1], p[2], p[3])
 
-        gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+        gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
         self:draw_color_cube()
     end
 
     -- Draw tracking origin markers over hands
     do
-        local mx = {}
-        for i=1,16 do mx[i] = mview[i] end
+        local mx = m_origin
+        mm.copy(mx, mview)
         if self.origin_matrix[1] ~= nil then
             mm.post_multiply(mx, self.origin_matrix)
         end
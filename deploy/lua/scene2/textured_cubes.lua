@@ -36,6 +36,7 @@ local openGL = require("opengl")
 local ffi = require("ffi")
 local mm = require("util.matrixmath")
 local sf = require("util.shaderfunctions")
+local textureloader = require("util.textureloader")
 
 local glIntv   = ffi.typeof('GLint[?]')
 local glUintv  = ffi.typeof('GLuint[?]')
@@ -89,15 +90,8 @@ function textured_cubes:setDataDirectory(dir)
 end
 
 function textured_cubes:loadtextures()
-    local texfilename = "stone_128x128.raw"
+    local texfilename = "stone_128x128.ktx"
     if self.dataDir then texfilename = self.dataDir .. "/images/" .. texfilename end
-    local w,h = 128,128
-    local inp = io.open(texfilename, "rb")
-    local data = nil
-    if inp then
-        data = inp:read("*all")
-        assert(inp:close())
-    end
 
     local dtxId = ffi.new("GLuint[1]")
     gl.glGenTextures(1, dtxId)
@@ -106,13 +100,11 @@ function textured_cubes:loadtextures()
     gl.glBindTexture(GL.GL_TEXTURE_2D, self.texID)
     gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_WRAP_S, GL.GL_CLAMP_TO_EDGE)
     gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_WRAP_T, GL.GL_CLAMP_TO_EDGE)
-    gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MIN_FILTER, GL.GL_NEAREST)
+    gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MIN_FILTER, GL.GL_LINEAR_MIPMAP_LINEAR)
     gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MAG_FILTER, GL.GL_NEAREST)
     gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MAX_LEVEL, 0)
-    gl.glTexImage2D(GL.GL_TEXTURE_2D, 0, GL.GL_RGB,
-                  w, h, 0,
-                  GL.GL_RGB, GL.GL_UNSIGNED_BYTE, data)
     gl.glBindTexture(GL.GL_TEXTURE_2D, 0)
+    textureloader.load_ktx(texfilename, self.texID)
 
 end
 
@@ -220,6 +212,7 @@ function textured_cubes:exitGL()
     self.vbos = {}
 
     gl.glDeleteProgram(self.prog)
+    textureloader.cancel(self.texID)
     local texdel = ffi.new("GLuint[1]", self.texID)
     gl.glDeleteTextures(1,texdel)
 
@@ -228,11 +221,13 @@ function textured_cubes:exitGL()
     gl.glBindVertexArray(0)
 end
 
+local m_cube = mm.mat4()
+
 function textured_cubes:render_for_one_eye(view, proj)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     gl.glActiveTexture(GL.GL_TEXTURE0)
     gl.glBindTexture(GL.GL_TEXTURE_2D, self.texID)
@@ -243,14 +238,14 @@ function textured_cubes:render_for_one_eye(view, proj)
     local s = 2
     for j=-s,s do
         for i=-s,s do
-            local m = {}
+            local m = m_cube
             mm.make_identity_matrix(m)
             mm.glh_translate(m, .1, 0., .2)
             mm.glh_translate(m, i, -.6, -j)
             mm.glh_scale(m, .5, .5, .5)
             mm.pre_multiply(m, view)
 
-            gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, m))
+            gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(m))
             gl.glBindVertexArray(self.vao)
             gl.glDrawElements(GL.GL_TRIANGLES, 6*3*2, GL.GL_UNSIGNED_INT, nil)
             gl.glBindVertexArray(0)
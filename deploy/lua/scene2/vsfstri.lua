@@ -30,6 +30,7 @@ end
 
 --local openGL = require("opengl")
 local ffi = require("ffi")
+local mm = require("util.matrixmath")
 local sf = require("util.shaderfunctions")
 
 local glIntv = ffi.typeof('GLint[?]')
@@ -131,8 +132,8 @@ function vsfstri:render_for_one_eye(view, proj)
     gl.glUseProgram(self.prog)
     local umv_loc = gl.glGetUniformLocation(self.prog, "mvmtx")
     local upr_loc = gl.glGetUniformLocation(self.prog, "prmtx")
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, view))
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(view))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
     gl.glBindVertexArray(self.vao)
     gl.glDrawArrays(GL.GL_TRIANGLES, 0, 3)
     gl.glBindVertexArray(0)
@@ -0,0 +1,105 @@
+-- assets.lua
+-- Data files out of the asset archive mapped at startup (see AssetArchive.h
+-- and tools/make_asset_archive.py), falling back to the file system for
+-- anything not in it. Paths are the ones scenes already build, e.g.
+-- self.dataDir.."/images/stone.raw"; luaentry registers the directory that
+-- stands for the archive root.
+--
+-- local assets = require("util.assets")
+-- local ptr, size, anchor = assets.open(path) -- const uint8_t*, keep anchor referenced while using ptr
+-- local text = assets.read(path)              -- whole file as a Lua string
+-- for line in assets.lines(path) do ... end
+-- if assets.exists(path) then ... end
+
+local ffi = require("ffi")
+local assets = {}
+
+-- Must match the extern "C" block and AssetArchiveApi in AssetArchive.h.
+ffi.cdef[[
+const void* fc_asset_find(const char* pPath, unsigned int* pSize);
+int fc_asset_read(const char* pPath, void* pOut, unsigned int outSize);
+
+typedef struct {
+    const void* (*fc_asset_find)(const char* pPath, unsigned int* pSize);
+    int (*fc_asset_read)(const char* pPath, void* pOut, unsigned int outSize);
+} AssetArchiveApi;
+]]
+
+local api = nil
+if pcall(function() return ffi.C.fc_asset_find end) then
+    api = ffi.C
+elseif native_asset_api then
+    api = ffi.cast("AssetArchiveApi*", native_asset_api)
+end
+
+local const_bytes = ffi.typeof("const uint8_t*")
+local bytes = ffi.typeof("uint8_t[?]")
+local size_out = ffi.new("unsigned int[1]")
+local roots = {}
+
+-- Paths starting with dir are looked up by the part after it.
+function assets.add_root(dir)
+    if dir:sub(-1) ~= "/" then dir = dir.."/" end
+    table.insert(roots, dir)
+end
+
+-- The name path has in the archive.
+function assets.name(path)
+    for _,root in ipairs(roots) do
+        if path:sub(1, #root) == root then return path:sub(#root + 1) end
+    end
+    return path
+end
+local archive_name = assets.name
+
+-- Returns a pointer to the file's bytes, their count, and an anchor the
+-- caller must keep referenced for as long as it uses the pointer. Files
+-- stored uncompressed in the archive come straight out of the mapping
+-- and the anchor is nil. Returns nil if the file is nowhere to be found.
+function assets.open(path)
+    if api then
+        local name = archive_name(path)
+        local p = api.fc_asset_find(name, size_out)
+        local size = size_out[0]
+        if p ~= nil then return ffi.cast(const_bytes, p), size, nil end
+        if size > 0 then
+            local buf = bytes(size)
+            if api.fc_asset_read(name, buf, size) ~= 0 then return buf, size, buf end
+        end
+    end
+
+    local inp = io.open(path, "rb")
+    if not inp then return nil end
+    local data = inp:read("*all")
+    inp:close()
+    return ffi.cast(const_bytes, data), #data, data
+end
+
+function assets.exists(path)
+    if api then
+        local p = api.fc_asset_find(archive_name(path), size_out)
+        if p ~= nil or size_out[0] > 0 then return true end
+    end
+    local inp = io.open(path, "rb")
+    if not inp then return false end
+    inp:close()
+    return true
+end
+
+function assets.read(path)
+    local ptr, size, anchor = assets.open(path)
+    if not ptr then return nil end
+    if type(anchor) == "string" then return anchor end
+    return ffi.string(ptr, size)
+end
+
+-- Iterates the lines of a text file without their line feeds, as
+-- file:lines() does. Returns nil if the file is not found.
+function assets.lines(path)
+    local text = assets.read(path)
+    if not text then return nil end
+    if text ~= "" and text:sub(-1) ~= "\n" then text = text.."\n" end
+    return text:gmatch("(.-)\n")
+end
+
+return assets
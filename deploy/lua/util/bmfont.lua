@@ -1,5 +1,7 @@
 -- Ripped from https://github.com/gideros/BMFont
 
+local assets = require("util.assets")
+
 -- check if string1 starts with string2
 local function startsWith(string1, string2)
    return string1:sub(1, #string2) == string2
@@ -33,9 +35,9 @@ function BMFont:init(fontfile, imagefile, filtering)
     -- Read character layout from BMFont's .fnt
     -- and store them in chars table.
     self.chars = {}
-    file = io.open(fontfile, "rt")
-    if not file then print("File not found: "..fontfile) return end
-    for line in file:lines() do
+    local lines = assets.lines(fontfile)
+    if not lines then print("File not found: "..fontfile) return end
+    for line in lines do
         if startsWith(line, "char ") then
             local char = lineToTable(line)
             self.chars[char.id] = char
@@ -45,7 +47,6 @@ function BMFont:init(fontfile, imagefile, filtering)
             self.common = lineToTable(line)
         end
     end
-    io.close(file)
 end
 
 function BMFont:getcharquad(ch, x, y, tw, th)
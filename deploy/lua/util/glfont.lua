@@ -4,6 +4,8 @@ require("opengl")
 require("util.bmfont")
 local ffi = require("ffi")
 local sf = require("util.shaderfunctions")
+local textureloader = require("util.textureloader")
+local assets = require("util.assets")
 local mm = require("util.matrixmath")
 
 -- Types from:
@@ -109,23 +111,25 @@ function GLFont:initGL()
     self.tex = texId[0]
 
     -- $ convert papyrus_512_0.png  -size 512x512 -depth 32 -channel RGBA gray:papyrus_512_0.raw
-    local fontname, texname, tw, th, td, format = self.fontfile, self.imagefile, 512, 512, 4, GL.GL_RGBA
+    local fontname, texname, tw, th, td = self.fontfile, self.imagefile, 512, 512, 4
     self.tex_w = tw
     self.tex_h = th
     if self.dataDir then fontname = self.dataDir .. "/" .. fontname end
     if self.dataDir then texname = self.dataDir .. "/" .. texname end
 
     self.font = BMFont.new(fontname, nil)
-    local inp = io.open(texname, "rb")
-    if inp then
-        local data = inp:read("*all")
-        local pixels = glCharv(self.tex_w*self.tex_h*td, data)
-
-        gl.glBindTexture(GL.GL_TEXTURE_2D, self.tex)
-        gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MIN_FILTER, GL.GL_LINEAR)
-        gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MAG_FILTER, GL.GL_LINEAR)
-        gl.glTexImage2D(GL.GL_TEXTURE_2D, 0, format, self.tex_w, self.tex_h, 0, format, GL.GL_UNSIGNED_BYTE, pixels)
-        gl.glBindTexture(GL.GL_TEXTURE_2D, 0)
+    gl.glBindTexture(GL.GL_TEXTURE_2D, self.tex)
+    gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MIN_FILTER, GL.GL_LINEAR)
+    gl.glTexParameteri(GL.GL_TEXTURE_2D, GL.GL_TEXTURE_MAG_FILTER, GL.GL_LINEAR)
+    gl.glBindTexture(GL.GL_TEXTURE_2D, 0)
+    -- Text draws blank until the page has loaded in the background.
+    -- A page converted by Flickercladding-TexCompress is used if present:
+    -- EAC R11, swizzled so that .xyz stays gray.
+    local ktxname = texname:gsub("%.raw$", ".ktx")
+    if ktxname ~= texname and assets.exists(ktxname) then
+        textureloader.load_ktx(ktxname, self.tex)
+    else
+        textureloader.load_raw(texname, self.tex_w, self.tex_h, td, self.tex)
     end
 end
 
@@ -134,6 +138,7 @@ function GLFont:exitGL()
         gl.glDeleteBuffers(1,v)
     end
 
+    textureloader.cancel(self.tex)
     local texdel = ffi.new("GLuint[1]", self.tex)
     gl.glDeleteTextures(1,texdel)
 
@@ -164,8 +169,8 @@ function GLFont:render_string(mview, proj, color, str)
     local uc_loc = gl.glGetUniformLocation(self.prog, "uColor")
 
     gl.glUseProgram(self.prog)
-    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, glFloatv(16, mview))
-    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, glFloatv(16, proj))
+    gl.glUniformMatrix4fv(umv_loc, 1, GL.GL_FALSE, mm.as_floats(mview))
+    gl.glUniformMatrix4fv(upr_loc, 1, GL.GL_FALSE, mm.as_floats(proj))
 
     gl.glActiveTexture(GL.GL_TEXTURE0)
     gl.glBindTexture(GL.GL_TEXTURE_2D, self.tex)
@@ -0,0 +1,164 @@
+-- jobs.lua
+-- Parallel-fors over cdata arrays on the native worker pool in
+-- JobSystem.cpp. Every call returns a handle at once; pass it to wait(),
+-- or as the last argument of another call to run that one after it.
+-- Arrays are float cdata of count elements, stride floats each; this
+-- module keeps them referenced until their job is done.
+--
+-- Kernels are native: a LuaJIT callback cannot be run on the workers.
+-- parallel_for takes a C function pointer, e.g. from ffi.C or a library
+-- loaded with ffi.load.
+--
+-- scene2/molecule.lua is the one user so far. geometry_functions.lua and
+-- simple_game.lua stay in Lua on purpose. Their loops build Lua tables of a
+-- few thousand vertices once at init, and test a handful of shots against
+-- 121 targets while removing from both tables, which no native kernel can
+-- do. Copying those tables to cdata and back would cost more than the work.
+--
+-- local jobs = require("util.jobs")
+-- local h = jobs.transform_points(out, mvmtx, pts, n)
+-- local sum = ffi.new("float[3]")
+-- jobs.wait(jobs.reduce_sum(out, n, 3, sum, h))
+
+local ffi = require("ffi")
+local mm = require("util.matrixmath")
+local jobs = {}
+
+-- Must match the extern "C" block and JobSystemApi in JobSystem.h.
+ffi.cdef[[
+typedef void (*JobKernel)(void* pArg, int begin, int end);
+
+int  fc_job_worker_count();
+int  fc_job_parallel_for(JobKernel kernel, void* pArg, int count, int grain, int dependsOn);
+int  fc_job_is_done(int handle);
+void fc_job_wait(int handle);
+int  fc_job_fill(float* pOut, int count, int stride, const float* pPattern, int dependsOn);
+int  fc_job_ramp(float* pOut, int count, float start, float step, int dependsOn);
+int  fc_job_scale_offset(float* pOut, const float* pIn, int count, int stride,
+    const float* pScale, const float* pOffset, int dependsOn);
+int  fc_job_transform_points(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+int  fc_job_transform_vectors(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+int  fc_job_reduce_sum(const float* pIn, int count, int stride, float* pOut, int dependsOn);
+int  fc_job_reduce_minmax(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn);
+
+typedef struct {
+    int  (*fc_job_worker_count)();
+    int  (*fc_job_parallel_for)(JobKernel kernel, void* pArg, int count, int grain, int dependsOn);
+    int  (*fc_job_is_done)(int handle);
+    void (*fc_job_wait)(int handle);
+    int  (*fc_job_fill)(float* pOut, int count, int stride, const float* pPattern, int dependsOn);
+    int  (*fc_job_ramp)(float* pOut, int count, float start, float step, int dependsOn);
+    int  (*fc_job_scale_offset)(float* pOut, const float* pIn, int count, int stride,
+        const float* pScale, const float* pOffset, int dependsOn);
+    int  (*fc_job_transform_points)(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+    int  (*fc_job_transform_vectors)(float* pOut, const float* pMatrix, const float* pIn, int count, int dependsOn);
+    int  (*fc_job_reduce_sum)(const float* pIn, int count, int stride, float* pOut, int dependsOn);
+    int  (*fc_job_reduce_minmax)(const float* pIn, int count, int stride, float* pMin, float* pMax, int dependsOn);
+} JobSystemApi;
+]]
+
+local api = nil
+if pcall(function() return ffi.C.fc_job_wait end) then
+    api = ffi.C
+elseif native_job_api then
+    api = ffi.cast("JobSystemApi*", native_job_api)
+end
+
+-- Without the pool, scenes should do the work in Lua as before.
+jobs.available = (api ~= nil)
+
+-- Arrays in use by jobs not yet known to be done, by handle.
+local pending = {}
+local pending_count = 0
+
+local function sweep()
+    for h in pairs(pending) do
+        if api.fc_job_is_done(h) ~= 0 then
+            pending[h] = nil
+            pending_count = pending_count - 1
+        end
+    end
+end
+
+local function keep(h, a, b)
+    if h ~= 0 then
+        pending[h] = { a, b }
+        pending_count = pending_count + 1
+        if pending_count > 64 then sweep() end
+    end
+    return h
+end
+
+local mat4f = ffi.typeof("mat4f")
+local function matrix_floats(m)
+    if ffi.istype(mat4f, m) then return m.m end
+    return m
+end
+
+-- A table of up to 16 numbers as floats; cdata is passed as it is.
+-- These are copied when the job is submitted, so need not be kept.
+local function small_floats(t)
+    if type(t) == "table" then
+        return ffi.new("float[?]", #t, t)
+    end
+    return t
+end
+
+function jobs.worker_count()
+    return api.fc_job_worker_count()
+end
+
+function jobs.is_done(h)
+    return api.fc_job_is_done(h) ~= 0
+end
+
+-- Runs jobs on this thread too while it waits.
+function jobs.wait(h)
+    api.fc_job_wait(h)
+    if pending[h] then
+        pending[h] = nil
+        pending_count = pending_count - 1
+    end
+end
+
+-- kernel(arg, begin, end) over [0, count) in chunks of grain (0 to choose).
+function jobs.parallel_for(kernel, arg, count, grain, after)
+    return keep(api.fc_job_parallel_for(kernel, arg, count, grain or 0, after or 0), arg)
+end
+
+function jobs.fill(out, count, stride, pattern, after)
+    return keep(api.fc_job_fill(out, count, stride, small_floats(pattern), after or 0), out)
+end
+
+-- out[i] = start + step * i
+function jobs.ramp(out, count, start, step, after)
+    return keep(api.fc_job_ramp(out, count, start, step, after or 0), out)
+end
+
+-- out = inp * scale + offset per component; either may be nil. out may be inp.
+function jobs.scale_offset(out, inp, count, stride, scale, offset, after)
+    return keep(api.fc_job_scale_offset(out, inp, count, stride,
+        small_floats(scale), small_floats(offset), after or 0), out, inp)
+end
+
+-- count xyz triples; w = 1
+function jobs.transform_points(out, m, inp, count, after)
+    return keep(api.fc_job_transform_points(out, matrix_floats(m), inp, count, after or 0), out, inp)
+end
+
+-- count xyz triples; w = 0
+function jobs.transform_vectors(out, m, inp, count, after)
+    return keep(api.fc_job_transform_vectors(out, matrix_floats(m), inp, count, after or 0), out, inp)
+end
+
+-- out gets stride floats, the per-component sum.
+function jobs.reduce_sum(inp, count, stride, out, after)
+    return keep(api.fc_job_reduce_sum(inp, count, stride, out, after or 0), inp, out)
+end
+
+function jobs.reduce_minmax(inp, count, stride, mins, maxs, after)
+    return keep(api.fc_job_reduce_minmax(inp, count, stride, mins, maxs, after or 0),
+        inp, { mins, maxs })
+end
+
+return jobs
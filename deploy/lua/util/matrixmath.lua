@@ -1,6 +1,41 @@
 -- matrixmath.lua
+-- Matrices are column-major and 1-indexed: either Lua tables or mat4
+-- cdata, which index the same way, so every function here takes both.
+local ffi = require("ffi")
 local matrixmath = {}
 
+-- Must match mat4f in ViewConstants.h.
+ffi.cdef[[
+typedef struct { float m[16]; } mat4f;
+]]
+
+-- mat4 cdata is what on_lua_draw hands scenes for camera data. It stays in
+-- native memory; m[1]..m[16] read and write m.m[0]..m.m[15] in place.
+matrixmath.mat4 = ffi.metatype("mat4f", {
+    __index = function(self, i) return self.m[i-1] end,
+    __newindex = function(self, i, v) self.m[i-1] = v end,
+    __len = function() return 16 end,
+})
+
+local glFloatv = ffi.typeof("float[?]")
+
+-- Returns a float pointer for glUniformMatrix4fv. A mat4 is passed through
+-- as is; a table is copied into a new array.
+function matrixmath.as_floats(m)
+    if type(m) == "cdata" then return m.m end
+    return glFloatv(16, m)
+end
+
+function matrixmath.copy(dst, src)
+    for i = 1,16 do
+        dst[i] = src[i]
+    end
+end
+
+-- Scratch space so the in-place helpers below need not allocate.
+local product = {}
+local factor = {}
+
 function matrixmath.transform(pt, mtx)
     tx = {
         mtx[1]*pt[1] + mtx[5]*pt[2] + mtx[9]*pt[3] + mtx[13]*pt[4],
@@ -12,33 +47,26 @@ function matrixmath.transform(pt, mtx)
 end
 
 function matrixmath.make_identity_matrix(m)
-    local mtx = {
-        1,0,0,0,
-        0,1,0,0,
-        0,0,1,0,
-        0,0,0,1
-    }
     for i = 1,16 do
-        m[i] = mtx[i]
+        m[i] = 0
     end
+    m[1] = 1
+    m[6] = 1
+    m[11] = 1
+    m[16] = 1
 end
 
 function matrixmath.affine_inverse(m)
-    local mtx = {
-        m[1], m[5], m[9], 0,
-        m[2], m[6], m[10], 0,
-        m[3], m[7], m[11], 0,
-        0, 0, 0, 1
-    }
-    local t = {-m[13], -m[14], -m[15], 1}
-    t = matrixmath.transform(t, mtx)
-    mtx[13] = t[1]
-    mtx[14] = t[2]
-    mtx[15] = t[3]
-
-    for i=1,16 do
-        m[i] = mtx[i]
-    end
+    -- Transpose the rotation, then rotate the negated translation by it.
+    local m2, m3, m7 = m[2], m[3], m[7]
+    m[2], m[3], m[7] = m[5], m[9], m[10]
+    m[5], m[9], m[10] = m2, m3, m7
+    m[4], m[8], m[12], m[16] = 0, 0, 0, 1
+
+    local x, y, z = -m[13], -m[14], -m[15]
+    m[13] = m[1]*x + m[5]*y + m[9]*z
+    m[14] = m[2]*x + m[6]*y + m[10]*z
+    m[15] = m[3]*x + m[7]*y + m[11]*z
 end
 
 function matrixmath.make_translation_matrix(m, x, y, z)
@@ -88,10 +116,7 @@ end
 
 -- stores result in a
 function matrixmath.pre_multiply(a, b)
-    local r = {}
-    for i = 1,16 do
-        r[i] = 0.0
-    end
+    local r = product
     for i = 1,16,4 do
         for j = 1,4 do
             r[i+j-1] = -- 1-indexing artifact
@@ -108,10 +133,7 @@ end
 
 -- stores result in a
 function matrixmath.post_multiply(a, b)
-    local r = {}
-    for i = 1,16 do
-        r[i] = 0.0
-    end
+    local r = product
     for i = 1,16,4 do
         for j = 1,4 do
             r[i+j-1] = -- 1-indexing artifact
@@ -127,19 +149,19 @@ function matrixmath.post_multiply(a, b)
 end
 
 function matrixmath.glh_translate(m, x, y, z)
-    local tx = {}
+    local tx = factor
     matrixmath.make_translation_matrix(tx, x, y, z)
     matrixmath.post_multiply(m, tx)
 end
 
 function matrixmath.glh_rotate(m, theta, x, y, z)
-    local rx = {}
+    local rx = factor
     matrixmath.make_rotation_matrix(rx, -theta * math.pi/180, x, y, z)
     matrixmath.post_multiply(m, rx)
 end
 
 function matrixmath.glh_scale(m, x, y, z)
-    local tx = {}
+    local tx = factor
     matrixmath.make_scale_matrix(tx, x, y, z)
     matrixmath.post_multiply(m, tx)
 end
@@ -0,0 +1,99 @@
+-- nbody.lua
+-- Gravitational n-body steps on the CPU, on the native worker pool in
+-- NBodySystem.cpp, for scenes without compute shaders. The physics is
+-- that of nbody07's accel and integ shaders. There is one system: init
+-- copies the bodies in, and each step writes their new positions out.
+--
+-- Arrays are count x,y,z,w float quadruples as nbody07 keeps them;
+-- attributes are mass, softening, brightness, radius.
+--
+-- local nbody = require("util.nbody")
+-- nbody.init(count, pos_array, att_array, vel_array)
+-- nbody.set_method(nbody.tree)
+-- nbody.step_to_buffer(dt, vboP) -- in timestep, after rc.acquire_gl()
+
+local ffi = require("ffi")
+local nbody = {}
+
+-- Must match the extern "C" block and NBodyApi in NBodySystem.h.
+ffi.cdef[[
+int    fc_nbody_init(int count, const float* pPositions, const float* pAttributes, const float* pVelocities);
+void   fc_nbody_clear();
+void   fc_nbody_set_method(int method);
+void   fc_nbody_set_theta(float theta);
+void   fc_nbody_step(float dt, float* pPositionsOut);
+int    fc_nbody_step_to_buffer(float dt, unsigned int vbo);
+double fc_nbody_interactions_per_second();
+double fc_nbody_step_seconds();
+const char* fc_nbody_kernel_name();
+
+typedef struct {
+    int    (*fc_nbody_init)(int count, const float* pPositions, const float* pAttributes, const float* pVelocities);
+    void   (*fc_nbody_clear)();
+    void   (*fc_nbody_set_method)(int method);
+    void   (*fc_nbody_set_theta)(float theta);
+    void   (*fc_nbody_step)(float dt, float* pPositionsOut);
+    int    (*fc_nbody_step_to_buffer)(float dt, unsigned int vbo);
+    double (*fc_nbody_interactions_per_second)();
+    double (*fc_nbody_step_seconds)();
+    const char* (*fc_nbody_kernel_name)();
+} NBodyApi;
+]]
+
+local api = nil
+if pcall(function() return ffi.C.fc_nbody_step end) then
+    api = ffi.C
+elseif native_nbody_api then
+    api = ffi.cast("NBodyApi*", native_nbody_api)
+end
+
+nbody.available = (api ~= nil)
+
+-- Methods, as NBodyMethod
+nbody.direct = 0 -- every pair
+nbody.tree = 1   -- Barnes-Hut octree
+
+-- Returns the number of bodies taken, 0 on failure. vel may be nil.
+function nbody.init(count, pos, att, vel)
+    return api.fc_nbody_init(count, pos, att, vel)
+end
+
+function nbody.clear()
+    api.fc_nbody_clear()
+end
+
+function nbody.set_method(method)
+    api.fc_nbody_set_method(method)
+end
+
+-- Tree cells are taken whole when side < theta * distance.
+function nbody.set_theta(theta)
+    api.fc_nbody_set_theta(theta)
+end
+
+-- out, if given, gets count x,y,z,1 positions.
+function nbody.step(dt, out)
+    api.fc_nbody_step(dt, out)
+end
+
+-- Writes the positions into vertex buffer vbo; returns true if it could
+-- be mapped, false if they were uploaded from a copy.
+function nbody.step_to_buffer(dt, vbo)
+    return api.fc_nbody_step_to_buffer(dt, vbo) ~= 0
+end
+
+-- Of the last step
+function nbody.interactions_per_second()
+    return api.fc_nbody_interactions_per_second()
+end
+
+function nbody.step_seconds()
+    return api.fc_nbody_step_seconds()
+end
+
+-- "SSE2", "NEON" or "scalar"
+function nbody.kernel_name()
+    return ffi.string(api.fc_nbody_kernel_name())
+end
+
+return nbody
@@ -0,0 +1,55 @@
+-- profiler.lua
+-- Marks named zones in the native FrameProfiler so they show up, nested
+-- under the C++ frame phases, in the Chrome trace it writes out.
+--
+-- local profiler = require("util.profiler")
+-- local z_physics = profiler.zone("physics") -- once, at load time
+-- ...
+-- local h = profiler.begin_zone(z_physics)
+-- step_physics()
+-- profiler.end_zone(h)
+
+local ffi = require("ffi")
+local profiler = {}
+
+-- Must match FrameProfilerApi in FrameProfiler.h.
+ffi.cdef[[
+typedef struct {
+    int (*registerName)(const char* pName);
+    int (*beginZone)(int nameId);
+    void (*endZone)(int zoneIdx);
+    int (*writeTrace)(const char* pFilename);
+} FrameProfilerApi;
+]]
+
+-- Set by LuajitScene before luaentry runs; absent when hosted elsewhere.
+local api = nil
+if native_profiler_api then
+    api = ffi.cast("FrameProfilerApi*", native_profiler_api)
+end
+
+-- Returns an id for name. Look ids up once and keep them; registering
+-- costs a string map lookup in C++.
+function profiler.zone(name)
+    if not api then return -1 end
+    return api.registerName(name)
+end
+
+-- Returns a handle to pass to end_zone.
+function profiler.begin_zone(id)
+    if not api then return -1 end
+    return api.beginZone(id)
+end
+
+function profiler.end_zone(handle)
+    if not api then return end
+    api.endZone(handle)
+end
+
+-- Writes the last frames recorded as Chrome trace-event JSON.
+function profiler.write_trace(filename)
+    if not api then return false end
+    return api.writeTrace(filename) ~= 0
+end
+
+return profiler
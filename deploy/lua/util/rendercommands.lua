@@ -0,0 +1,129 @@
+-- rendercommands.lua
+-- Draw calls recorded into RenderCommandStream.cpp for the render thread
+-- to make, so a scene's next frame can be simulated while this one is
+-- drawn. Arguments are those of the GL call of the same name; the
+-- uniform matrix values are copied when recorded.
+--
+-- A scene takes part by defining record_for_one_eye(view, proj, alpha),
+-- which records what render_for_one_eye would draw and returns true.
+-- Without one, or when it returns false, the frame is drawn as usual.
+-- Anything that creates objects or reads back from GL cannot be recorded:
+-- do it in initGL, or call rc.acquire_gl() first.
+--
+-- local rc = require("util.rendercommands")
+-- rc.use_program(prog)
+-- rc.uniform_matrix4fv(loc, 1, GL.GL_FALSE, mm.as_floats(m))
+-- rc.bind_vertex_array(vao)
+-- rc.draw_elements(GL.GL_TRIANGLES, count, GL.GL_UNSIGNED_INT, 0)
+
+local ffi = require("ffi")
+local rendercommands = {}
+
+-- Must match the extern "C" block and RenderCommandApi in RenderCommandStream.h.
+ffi.cdef[[
+void fc_cmd_viewport(int x, int y, int w, int h);
+void fc_cmd_clear_color(float r, float g, float b, float a);
+void fc_cmd_clear(unsigned int mask);
+void fc_cmd_enable(unsigned int cap);
+void fc_cmd_disable(unsigned int cap);
+void fc_cmd_blend_func(unsigned int sfactor, unsigned int dfactor);
+void fc_cmd_depth_mask(int flag);
+void fc_cmd_use_program(unsigned int program);
+void fc_cmd_bind_vertex_array(unsigned int vao);
+void fc_cmd_bind_buffer(unsigned int target, unsigned int buffer);
+void fc_cmd_active_texture(unsigned int unit);
+void fc_cmd_bind_texture(unsigned int target, unsigned int texture);
+void fc_cmd_uniform1i(int location, int v);
+void fc_cmd_uniform1f(int location, float v);
+void fc_cmd_uniform2f(int location, float x, float y);
+void fc_cmd_uniform3f(int location, float x, float y, float z);
+void fc_cmd_uniform4f(int location, float x, float y, float z, float w);
+void fc_cmd_uniform_matrix4fv(int location, int count, int transpose, const float* pValues);
+void fc_cmd_draw_arrays(unsigned int mode, int first, int count);
+void fc_cmd_draw_elements(unsigned int mode, int count, unsigned int type, unsigned int offset);
+void fc_cmd_draw_arrays_instanced(unsigned int mode, int first, int count, int instances);
+void fc_cmd_draw_elements_instanced(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances);
+
+typedef struct {
+    void (*fc_cmd_viewport)(int x, int y, int w, int h);
+    void (*fc_cmd_clear_color)(float r, float g, float b, float a);
+    void (*fc_cmd_clear)(unsigned int mask);
+    void (*fc_cmd_enable)(unsigned int cap);
+    void (*fc_cmd_disable)(unsigned int cap);
+    void (*fc_cmd_blend_func)(unsigned int sfactor, unsigned int dfactor);
+    void (*fc_cmd_depth_mask)(int flag);
+    void (*fc_cmd_use_program)(unsigned int program);
+    void (*fc_cmd_bind_vertex_array)(unsigned int vao);
+    void (*fc_cmd_bind_buffer)(unsigned int target, unsigned int buffer);
+    void (*fc_cmd_active_texture)(unsigned int unit);
+    void (*fc_cmd_bind_texture)(unsigned int target, unsigned int texture);
+    void (*fc_cmd_uniform1i)(int location, int v);
+    void (*fc_cmd_uniform1f)(int location, float v);
+    void (*fc_cmd_uniform2f)(int location, float x, float y);
+    void (*fc_cmd_uniform3f)(int location, float x, float y, float z);
+    void (*fc_cmd_uniform4f)(int location, float x, float y, float z, float w);
+    void (*fc_cmd_uniform_matrix4fv)(int location, int count, int transpose, const float* pValues);
+    void (*fc_cmd_draw_arrays)(unsigned int mode, int first, int count);
+    void (*fc_cmd_draw_elements)(unsigned int mode, int count, unsigned int type, unsigned int offset);
+    void (*fc_cmd_draw_arrays_instanced)(unsigned int mode, int first, int count, int instances);
+    void (*fc_cmd_draw_elements_instanced)(unsigned int mode, int count, unsigned int type, unsigned int offset, int instances);
+} RenderCommandApi;
+]]
+
+local api = nil
+if pcall(function() return ffi.C.fc_cmd_viewport end) then
+    api = ffi.C
+elseif native_render_api then
+    api = ffi.cast("RenderCommandApi*", native_render_api)
+end
+
+-- Without the native stream nothing is ever recorded; scenes should
+-- return false from record_for_one_eye and draw directly.
+rendercommands.available = (api ~= nil)
+
+-- Wait for the render thread to finish with the context and take it, if
+-- frames are being rendered on one.
+function rendercommands.acquire_gl()
+    if native_acquire_gl then native_acquire_gl() end
+end
+
+function rendercommands.viewport(x, y, w, h) api.fc_cmd_viewport(x, y, w, h) end
+function rendercommands.clear_color(r, g, b, a) api.fc_cmd_clear_color(r, g, b, a) end
+function rendercommands.clear(mask) api.fc_cmd_clear(mask) end
+function rendercommands.enable(cap) api.fc_cmd_enable(cap) end
+function rendercommands.disable(cap) api.fc_cmd_disable(cap) end
+function rendercommands.blend_func(s, d) api.fc_cmd_blend_func(s, d) end
+function rendercommands.depth_mask(flag) api.fc_cmd_depth_mask(flag) end
+function rendercommands.use_program(prog) api.fc_cmd_use_program(prog) end
+function rendercommands.bind_vertex_array(vao) api.fc_cmd_bind_vertex_array(vao) end
+function rendercommands.bind_buffer(target, buf) api.fc_cmd_bind_buffer(target, buf) end
+function rendercommands.active_texture(unit) api.fc_cmd_active_texture(unit) end
+function rendercommands.bind_texture(target, tex) api.fc_cmd_bind_texture(target, tex) end
+function rendercommands.uniform1i(loc, v) api.fc_cmd_uniform1i(loc, v) end
+function rendercommands.uniform1f(loc, v) api.fc_cmd_uniform1f(loc, v) end
+function rendercommands.uniform2f(loc, x, y) api.fc_cmd_uniform2f(loc, x, y) end
+function rendercommands.uniform3f(loc, x, y, z) api.fc_cmd_uniform3f(loc, x, y, z) end
+function rendercommands.uniform4f(loc, x, y, z, w) api.fc_cmd_uniform4f(loc, x, y, z, w) end
+
+function rendercommands.uniform_matrix4fv(loc, count, transpose, values)
+    api.fc_cmd_uniform_matrix4fv(loc, count, transpose, values)
+end
+
+function rendercommands.draw_arrays(mode, first, count)
+    api.fc_cmd_draw_arrays(mode, first, count)
+end
+
+-- offset is into the bound element array buffer, in bytes.
+function rendercommands.draw_elements(mode, count, type, offset)
+    api.fc_cmd_draw_elements(mode, count, type, offset or 0)
+end
+
+function rendercommands.draw_arrays_instanced(mode, first, count, instances)
+    api.fc_cmd_draw_arrays_instanced(mode, first, count, instances)
+end
+
+function rendercommands.draw_elements_instanced(mode, count, type, offset, instances)
+    api.fc_cmd_draw_elements_instanced(mode, count, type, offset or 0, instances)
+end
+
+return rendercommands
@@ -21,6 +21,37 @@ local glSizeiv   = ffi.typeof('GLsizei[?]')
 local glFloatv   = ffi.typeof('GLfloat[?]')
 local glConstCharpp = ffi.typeof('const GLchar *[1]')
 
+-- Linked programs are cached as program binaries by ShaderFunctions.cpp.
+-- Must match the extern "C" block and ShaderFunctionsApi in ShaderFunctions.h.
+ffi.cdef[[
+unsigned int fc_program_load_cached(const char* pSources);
+int fc_program_link_cached(unsigned int program, const char* pSources);
+
+typedef struct {
+    unsigned int (*fc_program_load_cached)(const char* pSources);
+    int (*fc_program_link_cached)(unsigned int program, const char* pSources);
+} ShaderFunctionsApi;
+]]
+
+local api = nil
+if pcall(function() return ffi.C.fc_program_load_cached end) then
+    api = ffi.C
+elseif native_shader_api then
+    api = ffi.cast("ShaderFunctionsApi*", native_shader_api)
+end
+
+-- The cache key: every stage's source, each under its field name.
+local stage_fields = { "vsrc", "tcsrc", "tesrc", "gsrc", "fsrc", "compsrc" }
+local function program_cache_key(sources)
+    local parts = {}
+    for _,field in ipairs(stage_fields) do
+        if type(sources[field]) == "string" then
+            table.insert(parts, "//"..field.."\n"..sources[field])
+        end
+    end
+    return table.concat(parts, "\n")
+end
+
 function load_and_compile_shader_source(src, type)
     -- Version replacement for various GL implementations 
     if ffi.os == "OSX" then
@@ -59,6 +90,15 @@ function load_and_compile_shader_source(src, type)
 end
 
 function shaderfunctions.make_shader_from_source(sources)
+    local key = nil
+    if api then
+        key = program_cache_key(sources)
+        local cached = api.fc_program_load_cached(key)
+        if cached ~= 0 then
+            return cached
+        end
+    end
+
     local program = gl.glCreateProgram()
 
     -- Deleted shaders, once attached, will be deleted when program is.
@@ -93,7 +133,11 @@ function shaderfunctions.make_shader_from_source(sources)
         gl.glDeleteShader(comps)
     end
 
-    gl.glLinkProgram(program)
+    if key then
+        api.fc_program_link_cached(program, key)
+    else
+        gl.glLinkProgram(program)
+    end
 
     local ill = glIntv(0)
     gl.glGetProgramiv(program, GL.GL_INFO_LOG_LENGTH, ill)
@@ -0,0 +1,90 @@
+-- simdmath.lua
+-- The native SIMD matrix kernels from MatrixMath.cpp. Matrices are mat4
+-- cdata from util.matrixmath or float arrays of 16, column-major; point
+-- and vector batches are float arrays of 3 (or 4) floats per element.
+-- Lua tables are not accepted: use matrixmath for those.
+--
+-- local sm = require("util.simdmath")
+-- sm.post_multiply(mvmtx, model)           -- mvmtx = mvmtx * model
+-- sm.transform_points(out, mvmtx, pts, n)  -- n xyz triples, w = 1
+
+local ffi = require("ffi")
+local mm = require("util.matrixmath")
+local simdmath = {}
+
+-- Must match the extern "C" block and MatrixMathApi in MatrixMath.h.
+ffi.cdef[[
+void fc_mat4_multiply(float* pOut, const float* pA, const float* pB);
+int  fc_mat4_affine_inverse(float* pOut, const float* pA);
+void fc_mat4_transform_float4(float* pOut, const float* pM, const float* pIn, int count);
+void fc_mat4_transform_points(float* pOut, const float* pM, const float* pIn, int count);
+void fc_mat4_transform_vectors(float* pOut, const float* pM, const float* pIn, int count);
+const char* fc_mat4_kernel_name();
+
+typedef struct {
+    void (*fc_mat4_multiply)(float* pOut, const float* pA, const float* pB);
+    int  (*fc_mat4_affine_inverse)(float* pOut, const float* pA);
+    void (*fc_mat4_transform_float4)(float* pOut, const float* pM, const float* pIn, int count);
+    void (*fc_mat4_transform_points)(float* pOut, const float* pM, const float* pIn, int count);
+    void (*fc_mat4_transform_vectors)(float* pOut, const float* pM, const float* pIn, int count);
+    const char* (*fc_mat4_kernel_name)();
+} MatrixMathApi;
+]]
+
+-- Call straight through ffi.C where the host exports its symbols (the
+-- desktop builds do). Otherwise use the table LuajitScene hands us.
+local api = nil
+if pcall(function() return ffi.C.fc_mat4_multiply end) then
+    api = ffi.C
+elseif native_matrix_api then
+    api = ffi.cast("MatrixMathApi*", native_matrix_api)
+end
+
+simdmath.available = (api ~= nil)
+simdmath.kernel = api and ffi.string(api.fc_mat4_kernel_name()) or "none"
+
+local mat4f = ffi.typeof("mat4f")
+local function floats(m)
+    if ffi.istype(mat4f, m) then return m.m end
+    return m
+end
+
+-- out = a * b
+function simdmath.multiply(out, a, b)
+    api.fc_mat4_multiply(floats(out), floats(a), floats(b))
+end
+
+-- stores result in a, like matrixmath.post_multiply
+function simdmath.post_multiply(a, b)
+    local fa = floats(a)
+    api.fc_mat4_multiply(fa, fa, floats(b))
+end
+
+-- stores result in a, like matrixmath.pre_multiply
+function simdmath.pre_multiply(a, b)
+    local fa = floats(a)
+    api.fc_mat4_multiply(fa, floats(b), fa)
+end
+
+-- Inverts any affine matrix in place, not just rigid ones.
+-- Returns false and leaves m alone if it is singular.
+function simdmath.affine_inverse(m)
+    local fm = floats(m)
+    return api.fc_mat4_affine_inverse(fm, fm) ~= 0
+end
+
+function simdmath.transform_float4(out, m, src, count)
+    api.fc_mat4_transform_float4(out, floats(m), src, count)
+end
+
+function simdmath.transform_points(out, m, src, count)
+    api.fc_mat4_transform_points(out, floats(m), src, count)
+end
+
+function simdmath.transform_vectors(out, m, src, count)
+    api.fc_mat4_transform_vectors(out, floats(m), src, count)
+end
+
+simdmath.mat4 = mm.mat4
+
+return simdmath
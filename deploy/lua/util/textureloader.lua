@@ -0,0 +1,195 @@
+-- textureloader.lua
+-- Raw textures loaded in the background by TextureLoader.cpp. load_raw
+-- returns a texture at once, holding a 1x1 transparent black placeholder,
+-- and the pixels arrive a few frames later. Files are found in the asset
+-- archive as util.assets would find them. load_mips loads every level of
+-- a .mip file baked by Flickercladding-MipBake, load_ktx every level of
+-- a KTX file in its compressed format (see Flickercladding-TexCompress).
+--
+-- local tl = require("util.textureloader")
+-- local tex = tl.load_raw(path, w, h, channels)          -- new texture, linear, clamped
+-- local tex = tl.load_mips(mippath, w, h, channels)      -- new texture, trilinear, clamped
+-- local tex = tl.load_ktx(ktxpath)                       -- new texture, trilinear, clamped
+-- tl.load_raw(path, w, h, 3, cubetex, GL.GL_TEXTURE_CUBE_MAP_POSITIVE_X + i)
+-- if tl.is_ready(tex) then ... end
+-- tl.cancel(tex) -- before deleting a texture that may still be loading
+
+local ffi = require("ffi")
+local assets = require("util.assets")
+local textureloader = {}
+
+-- Must match the extern "C" block and TextureLoaderApi in TextureLoader.h.
+ffi.cdef[[
+unsigned int fc_texture_load_raw(
+    const char* pPath, const char* pArchiveName,
+    int width, int height, int channels,
+    unsigned int texture, unsigned int imageTarget);
+int fc_texture_is_ready(unsigned int texture);
+void fc_texture_cancel(unsigned int texture);
+unsigned int fc_texture_load_mips(
+    const char* pPath, const char* pArchiveName,
+    int width, int height, int channels,
+    unsigned int texture, unsigned int imageTarget);
+unsigned int fc_texture_load_ktx(
+    const char* pPath, const char* pArchiveName,
+    unsigned int texture, unsigned int imageTarget);
+
+typedef struct {
+    unsigned int (*fc_texture_load_raw)(
+        const char* pPath, const char* pArchiveName,
+        int width, int height, int channels,
+        unsigned int texture, unsigned int imageTarget);
+    int (*fc_texture_is_ready)(unsigned int texture);
+    void (*fc_texture_cancel)(unsigned int texture);
+    unsigned int (*fc_texture_load_mips)(
+        const char* pPath, const char* pArchiveName,
+        int width, int height, int channels,
+        unsigned int texture, unsigned int imageTarget);
+    unsigned int (*fc_texture_load_ktx)(
+        const char* pPath, const char* pArchiveName,
+        unsigned int texture, unsigned int imageTarget);
+} TextureLoaderApi;
+]]
+
+local api = nil
+if pcall(function() return ffi.C.fc_texture_load_raw end) then
+    api = ffi.C
+elseif native_texture_api then
+    api = ffi.cast("TextureLoaderApi*", native_texture_api)
+end
+
+textureloader.available = (api ~= nil)
+
+-- Without the native loader, load synchronously. A .mip file (see
+-- MipChain.h) has a 32 byte header and then its levels.
+local function load_now(path, w, h, channels, texture, target, mips)
+    local formats = { GL.GL_RED, GL.GL_RG, GL.GL_RGB, GL.GL_RGBA }
+    local bind_target = GL.GL_TEXTURE_2D
+    if target ~= GL.GL_TEXTURE_2D then bind_target = GL.GL_TEXTURE_CUBE_MAP end
+    if texture == 0 then
+        local texId = ffi.new("GLuint[1]")
+        gl.glGenTextures(1, texId)
+        texture = texId[0]
+        gl.glBindTexture(bind_target, texture)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_WRAP_S, GL.GL_CLAMP_TO_EDGE)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_WRAP_T, GL.GL_CLAMP_TO_EDGE)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MIN_FILTER, mips and GL.GL_LINEAR_MIPMAP_LINEAR or GL.GL_LINEAR)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MAG_FILTER, GL.GL_LINEAR)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MAX_LEVEL, 0)
+    end
+    local pixels, size, anchor = assets.open(path)
+    local levels = 1
+    if mips and pixels and size >= 32 and ffi.string(pixels, 4) == "FCMP" then
+        levels = ffi.cast("const uint32_t*", pixels)[5]
+        pixels = pixels + 32
+        size = size - 32
+    end
+    local format = formats[channels]
+    if pixels and size >= w*h*channels then
+        gl.glBindTexture(bind_target, texture)
+        gl.glPixelStorei(GL.GL_UNPACK_ALIGNMENT, 1)
+        for level=0,levels-1 do
+            local lw, lh = math.max(1, bit.rshift(w, level)), math.max(1, bit.rshift(h, level))
+            gl.glTexImage2D(target, level, format, lw, lh, 0, format, GL.GL_UNSIGNED_BYTE, pixels)
+            pixels = pixels + lw*lh*channels
+        end
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MAX_LEVEL, levels-1)
+        gl.glBindTexture(bind_target, 0)
+    else
+        print("textureloader: could not read "..path)
+    end
+    return texture
+end
+
+-- Without the native loader, upload a KTX 1.1 file of compressed blocks
+-- as it is, with no decoding for formats GL cannot sample.
+local function load_ktx_now(path, texture, target)
+    local bind_target = GL.GL_TEXTURE_2D
+    if target ~= GL.GL_TEXTURE_2D then bind_target = GL.GL_TEXTURE_CUBE_MAP end
+    if texture == 0 then
+        local texId = ffi.new("GLuint[1]")
+        gl.glGenTextures(1, texId)
+        texture = texId[0]
+        gl.glBindTexture(bind_target, texture)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_WRAP_S, GL.GL_CLAMP_TO_EDGE)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_WRAP_T, GL.GL_CLAMP_TO_EDGE)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MIN_FILTER, GL.GL_LINEAR_MIPMAP_LINEAR)
+        gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MAG_FILTER, GL.GL_LINEAR)
+    end
+    local data, size, anchor = assets.open(path)
+    local header = data and size >= 64 and ffi.cast("const uint32_t*", data)
+    if not header or ffi.string(data, 12) ~= "\171KTX 11\187\r\n\026\n"
+        or header[3] ~= 0x04030201 or header[4] ~= 0 or header[13] ~= 1 then
+        print("textureloader: could not load "..path)
+        return texture
+    end
+    local format, w, h = header[7], header[9], header[10]
+    local levels = math.max(1, header[14])
+    local swizzle = nil
+    local kvd = data + 64
+    if header[15] >= 15 and ffi.string(kvd + 4, 11) == "KTXswizzle\0" then
+        swizzle = ffi.string(kvd + 15, 4)
+    end
+
+    gl.glBindTexture(bind_target, texture)
+    local pos = 64 + header[15]
+    for level=0,levels-1 do
+        if pos + 4 > size then break end
+        local image_size = ffi.cast("const uint32_t*", data + pos)[0]
+        if pos + 4 + image_size > size then break end
+        local lw, lh = math.max(1, bit.rshift(w, level)), math.max(1, bit.rshift(h, level))
+        gl.glCompressedTexImage2D(target, level, format, lw, lh, 0, image_size, data + pos + 4)
+        pos = pos + 4 + bit.band(image_size + 3, bit.bnot(3))
+    end
+    gl.glTexParameteri(bind_target, GL.GL_TEXTURE_MAX_LEVEL, levels-1)
+    if swizzle then
+        local channel = { r = GL.GL_RED, g = GL.GL_GREEN, b = GL.GL_BLUE, a = GL.GL_ALPHA, ["0"] = GL.GL_ZERO, ["1"] = GL.GL_ONE }
+        local params = { GL.GL_TEXTURE_SWIZZLE_R, GL.GL_TEXTURE_SWIZZLE_G, GL.GL_TEXTURE_SWIZZLE_B, GL.GL_TEXTURE_SWIZZLE_A }
+        for i=1,4 do
+            local c = channel[swizzle:sub(i, i)]
+            if c then gl.glTexParameteri(bind_target, params[i], c) end
+        end
+    end
+    gl.glBindTexture(bind_target, 0)
+    return texture
+end
+
+-- Load a tightly packed, uncompressed image of w*h pixels with 1 to 4
+-- 8-bit channels. texture defaults to a new one; target to GL_TEXTURE_2D.
+function textureloader.load_raw(path, w, h, channels, texture, target)
+    texture = texture or 0
+    target = target or GL.GL_TEXTURE_2D
+    if not api then return load_now(path, w, h, channels, texture, target, false) end
+    return api.fc_texture_load_raw(path, assets.name(path), w, h, channels, texture, target)
+end
+
+-- Load all levels of a w*h image from a .mip file, or build them from a
+-- raw file of level 0. Its GL_TEXTURE_MAX_LEVEL is raised as they arrive,
+-- so a texture passed in should have a mipmapped minification filter.
+function textureloader.load_mips(path, w, h, channels, texture, target)
+    texture = texture or 0
+    target = target or GL.GL_TEXTURE_2D
+    if not api then return load_now(path, w, h, channels, texture, target, true) end
+    return api.fc_texture_load_mips(path, assets.name(path), w, h, channels, texture, target)
+end
+
+-- Load every level of a KTX 1.1 or KTX2 file, kept compressed where GL
+-- can sample its format and decoded to 8-bit channels on a worker thread
+-- where it cannot. Its swizzle metadata, if any, is applied.
+function textureloader.load_ktx(path, texture, target)
+    texture = texture or 0
+    target = target or GL.GL_TEXTURE_2D
+    if not api then return load_ktx_now(path, texture, target) end
+    return api.fc_texture_load_ktx(path, assets.name(path), texture, target)
+end
+
+function textureloader.is_ready(texture)
+    if not api then return true end
+    return api.fc_texture_is_ready(texture) ~= 0
+end
+
+function textureloader.cancel(texture)
+    if api then api.fc_texture_cancel(texture) end
+end
+
+return textureloader
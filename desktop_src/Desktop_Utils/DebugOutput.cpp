@@ -30,3 +30,14 @@ void OutputPrint(char* format, ...)
     OutputDebugString(osw.str().c_str());
 #endif
 }
+
+void OutputString(const char* pText)
+{
+    std::cout << pText << std::flush;
+
+#ifdef _WIN32
+    std::wostringstream osw;
+    osw << pText;
+    OutputDebugString(osw.str().c_str());
+#endif
+}
@@ -3,3 +3,4 @@
 #pragma once
 
 void OutputPrint(char* format, ...);
+void OutputString(const char* pText); // As is, no formatting or newline
@@ -1,6 +1,7 @@
 // Logger.cpp
 
 #include "Logger.h"
+#include "Atomics.h"
 
 #ifdef _WIN32
 #include "WindowsFunctions.h"
@@ -9,19 +10,426 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
 #include <time.h>
+#include <vector>
 
-const int Logger::s_bufferSz = 2048*8;
+#ifndef va_copy
+#  ifdef __va_copy
+#    define va_copy(dst, src) __va_copy(dst, src)
+#  else
+#    define va_copy(dst, src) ((dst) = (src))
+#  endif
+#endif
+
+/// Leads each message's record, in its first slot.
+struct messageHeader {
+    const char* pFormat;
+    unsigned short slots;
+    unsigned short bytes;  ///< Header and arguments
+    unsigned char kind;
+    unsigned char preformatted; ///< Arguments are the formatted text
+};
+
+/// Argument tags in a record, each followed by its value; strings by their
+/// length (unsigned short) and bytes.
+enum argumentTag {
+    ArgSigned = 'i',
+    ArgUnsigned = 'u',
+    ArgChar = 'c',
+    ArgDouble = 'd',
+    ArgString = 's',
+    ArgPointer = 'p',
+    ArgStar = 'w' ///< Width or precision given as *
+};
+
+enum lengthModifier {
+    LengthNone,
+    LengthChar,
+    LengthShort,
+    LengthLong,
+    LengthLongLong,
+    LengthIntMax,
+    LengthSize,
+    LengthPtrDiff,
+    LengthLongDouble
+};
+
+/// One conversion in a format string.
+struct formatSpec {
+    size_t prefixLength; ///< From the '%' up to the length modifier
+    int stars;
+    lengthModifier length;
+    char conversion;
+};
+
+// Parse the conversion at p, just past a '%'. Returns the character after
+// it, or NULL for ones the writer cannot format from a record.
+static const char* parseSpec(const char* p, formatSpec& spec)
+{
+    const char* pStart = p - 1;
+    spec.stars = 0;
+    while ((*p != '\0') && (strchr("-+ #0'", *p) != NULL))
+        ++p;
+    if (*p == '*')
+    {
+        ++spec.stars;
+        ++p;
+    }
+    while ((*p >= '0') && (*p <= '9'))
+        ++p;
+    if (*p == '.')
+    {
+        ++p;
+        if (*p == '*')
+        {
+            ++spec.stars;
+            ++p;
+        }
+        while ((*p >= '0') && (*p <= '9'))
+            ++p;
+    }
+    spec.prefixLength = p - pStart;
+
+    spec.length = LengthNone;
+    switch (*p)
+    {
+    case 'h': ++p; spec.length = LengthShort; if (*p == 'h') { ++p; spec.length = LengthChar; } break;
+    case 'l': ++p; spec.length = LengthLong;  if (*p == 'l') { ++p; spec.length = LengthLongLong; } break;
+    case 'q': ++p; spec.length = LengthLongLong; break;
+    case 'j': ++p; spec.length = LengthIntMax; break;
+    case 'z': ++p; spec.length = LengthSize; break;
+    case 't': ++p; spec.length = LengthPtrDiff; break;
+    case 'L': ++p; spec.length = LengthLongDouble; break;
+    default: break;
+    }
+
+    spec.conversion = *p;
+    switch (spec.conversion)
+    {
+    case '%':
+        return (spec.prefixLength == 1) && (spec.length == LengthNone) ? p + 1 : NULL;
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        return (spec.length != LengthLongDouble) ? p + 1 : NULL;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        return ((spec.length == LengthNone) || (spec.length == LengthLong) || (spec.length == LengthLongDouble)) ? p + 1 : NULL;
+    case 'c': case 's': case 'p':
+        return (spec.length == LengthNone) ? p + 1 : NULL;
+    default:
+        return NULL; // Wide strings, %n, platform extensions
+    }
+}
+
+/// Appends arguments to a record, up to its size.
+class recordWriter
+{
+public:
+    recordWriter(char* pRecord, size_t size) : m_p(pRecord), m_used(0), m_size(size) {}
+
+    template <typename T> bool Put(char tag, T value)
+    {
+        if (m_used + 1 + sizeof(T) > m_size)
+            return false;
+        m_p[m_used++] = tag;
+        memcpy(m_p + m_used, &value, sizeof(T));
+        m_used += sizeof(T);
+        return true;
+    }
+    bool PutString(const char* pStr)
+    {
+        if (m_used + 1 + sizeof(unsigned short) > m_size)
+            return false;
+        size_t length = strlen(pStr);
+        const size_t room = m_size - m_used - 1 - sizeof(unsigned short);
+        length = (length < room) ? length : room; // Truncated to fit
+        const unsigned short stored = static_cast<unsigned short>(length);
+        m_p[m_used++] = ArgString;
+        memcpy(m_p + m_used, &stored, sizeof(stored));
+        m_used += sizeof(stored);
+        memcpy(m_p + m_used, pStr, length);
+        m_used += length;
+        return true;
+    }
+    size_t Used() const { return m_used; }
+
+private:
+    char* m_p;
+    size_t m_used;
+    size_t m_size;
+};
+
+/// Reads arguments back in the order they were put.
+class recordReader
+{
+public:
+    recordReader(const char* pRecord, size_t size) : m_p(pRecord), m_used(0), m_size(size) {}
+
+    template <typename T> bool Get(char tag, T& value)
+    {
+        if ((m_used + 1 + sizeof(T) > m_size) || (m_p[m_used] != tag))
+            return false;
+        memcpy(&value, m_p + m_used + 1, sizeof(T));
+        m_used += 1 + sizeof(T);
+        return true;
+    }
+    bool GetString(std::string& str)
+    {
+        unsigned short length = 0;
+        if ((Get(ArgString, length) == false) || (m_used + length > m_size))
+            return false;
+        str.assign(m_p + m_used, length);
+        m_used += length;
+        return true;
+    }
+
+private:
+    const char* m_p;
+    size_t m_used;
+    size_t m_size;
+};
+
+// Copy the arguments of every conversion in pFormat into the record.
+// Returns false for formats the writer cannot format from a record.
+static bool captureArguments(const char* pFormat, va_list args, recordWriter& record)
+{
+    bool fits = true;
+    for (const char* p = strchr(pFormat, '%'); p != NULL; p = strchr(p, '%'))
+    {
+        formatSpec spec;
+        p = parseSpec(p + 1, spec);
+        if (p == NULL)
+            return false;
+        if (spec.conversion == '%')
+            continue;
+
+        for (int i=0; i<spec.stars; ++i)
+        {
+            fits = fits && record.Put(ArgStar, va_arg(args, int));
+        }
+        switch (spec.conversion)
+        {
+        case 'd': case 'i':
+        {
+            long long v;
+            switch (spec.length)
+            {
+            case LengthLong:     v = va_arg(args, long); break;
+            case LengthLongLong: v = va_arg(args, long long); break;
+            case LengthIntMax:   v = va_arg(args, long long); break;
+            case LengthSize:     v = static_cast<long long>(va_arg(args, size_t)); break;
+            case LengthPtrDiff:  v = va_arg(args, ptrdiff_t); break;
+            case LengthChar:     v = static_cast<signed char>(va_arg(args, int)); break;
+            case LengthShort:    v = static_cast<short>(va_arg(args, int)); break;
+            default:             v = va_arg(args, int); break;
+            }
+            fits = fits && record.Put(ArgSigned, v);
+            break;
+        }
+        case 'o': case 'u': case 'x': case 'X':
+        {
+            unsigned long long v;
+            switch (spec.length)
+            {
+            case LengthLong:     v = va_arg(args, unsigned long); break;
+            case LengthLongLong: v = va_arg(args, unsigned long long); break;
+            case LengthIntMax:   v = va_arg(args, unsigned long long); break;
+            case LengthSize:     v = va_arg(args, size_t); break;
+            case LengthPtrDiff:  v = static_cast<unsigned long long>(va_arg(args, ptrdiff_t)); break;
+            case LengthChar:     v = static_cast<unsigned char>(va_arg(args, unsigned int)); break;
+            case LengthShort:    v = static_cast<unsigned short>(va_arg(args, unsigned int)); break;
+            default:             v = va_arg(args, unsigned int); break;
+            }
+            fits = fits && record.Put(ArgUnsigned, v);
+            break;
+        }
+        case 'c':
+            fits = fits && record.Put(ArgChar, va_arg(args, int));
+            break;
+        case 's':
+        {
+            const char* pStr = va_arg(args, const char*);
+            fits = fits && record.PutString((pStr != NULL) ? pStr : "(null)");
+            break;
+        }
+        case 'p':
+            fits = fits && record.Put(ArgPointer, va_arg(args, void*));
+            break;
+        default:
+        {
+            const double v = (spec.length == LengthLongDouble) ?
+                static_cast<double>(va_arg(args, long double)) : va_arg(args, double);
+            fits = fits && record.Put(ArgDouble, v);
+            break;
+        }
+        }
+    }
+    // Whatever did not fit is left out; the writer stops formatting there.
+    (void)fits;
+    return true;
+}
+
+template <typename T>
+static void appendFormatted(std::string& out, const char* pSpec, int stars, const int* pStars, T value)
+{
+    char buffer[512];
+    for (int pass=0; pass<2; ++pass)
+    {
+        std::vector<char> big;
+        char* pOut = buffer;
+        size_t size = sizeof(buffer);
+        int n = -1;
+        if (pass == 1)
+        {
+            big.resize(size = 64 * 1024);
+            pOut = &big[0];
+        }
+        switch (stars)
+        {
+        case 0:  n = snprintf(pOut, size, pSpec, value); break;
+        case 1:  n = snprintf(pOut, size, pSpec, pStars[0], value); break;
+        default: n = snprintf(pOut, size, pSpec, pStars[0], pStars[1], value); break;
+        }
+        if ((n >= 0) && (static_cast<size_t>(n) < size))
+        {
+            out.append(pOut, n);
+            return;
+        }
+        if (pass == 1)
+        {
+            pOut[size - 1] = '\0';
+            out.append(pOut);
+        }
+    }
+}
+
+// Writer: format a message's record onto out.
+static void formatRecord(const messageHeader& header, const char* pArgs, size_t argBytes, std::string& out)
+{
+    if (header.preformatted)
+    {
+        out.append(pArgs, argBytes);
+        return;
+    }
+
+    recordReader record(pArgs, argBytes);
+    const char* p = header.pFormat;
+    std::string str;
+    for (;;)
+    {
+        const char* pPercent = strchr(p, '%');
+        if (pPercent == NULL)
+        {
+            out.append(p);
+            return;
+        }
+        out.append(p, pPercent - p);
+
+        formatSpec spec;
+        p = parseSpec(pPercent + 1, spec);
+        if (p == NULL)
+            return;
+        if (spec.conversion == '%')
+        {
+            out.push_back('%');
+            continue;
+        }
+
+        int stars[2] = { 0, 0 };
+        bool ok = true;
+        for (int i=0; i<spec.stars; ++i)
+        {
+            ok = ok && record.Get(ArgStar, stars[i]);
+        }
+        // The spec with its length modifier replaced by the stored type's.
+        std::string conversion(pPercent, spec.prefixLength);
+        switch (spec.conversion)
+        {
+        case 'd': case 'i':
+        {
+            long long v = 0;
+            ok = ok && record.Get(ArgSigned, v);
+            if (ok)
+                appendFormatted(out, (conversion + "ll" + spec.conversion).c_str(), spec.stars, stars, v);
+            break;
+        }
+        case 'o': case 'u': case 'x': case 'X':
+        {
+            unsigned long long v = 0;
+            ok = ok && record.Get(ArgUnsigned, v);
+            if (ok)
+                appendFormatted(out, (conversion + "ll" + spec.conversion).c_str(), spec.stars, stars, v);
+            break;
+        }
+        case 'c':
+        {
+            int v = 0;
+            ok = ok && record.Get(ArgChar, v);
+            if (ok)
+                appendFormatted(out, (conversion + spec.conversion).c_str(), spec.stars, stars, v);
+            break;
+        }
+        case 's':
+            ok = ok && record.GetString(str);
+            if (ok && (spec.stars == 0) && (spec.prefixLength == 1))
+                out.append(str);
+            else if (ok)
+                appendFormatted(out, (conversion + 's').c_str(), spec.stars, stars, str.c_str());
+            break;
+        case 'p':
+        {
+            void* v = NULL;
+            ok = ok && record.Get(ArgPointer, v);
+            if (ok)
+                appendFormatted(out, (conversion + 'p').c_str(), spec.stars, stars, v);
+            break;
+        }
+        default:
+        {
+            double v = 0.;
+            ok = ok && record.Get(ArgDouble, v);
+            if (ok)
+                appendFormatted(out, (conversion + spec.conversion).c_str(), spec.stars, stars, v);
+            break;
+        }
+        }
+        if (ok == false)
+        {
+            out.append("...");
+            return;
+        }
+    }
+}
+
+static inline long positionDiff(long a, long b)
+{
+    return static_cast<long>(static_cast<unsigned long>(a) - static_cast<unsigned long>(b));
+}
 
 ///@brief Default constructor: called the first time Instance() is called.
-/// Open the output file.
 Logger::Logger()
-: m_logFilename("log.txt")
+: m_enqueuePos(0)
+, m_dropped(0)
+, m_writerState(WriterStopped)
+, m_dequeuePos(0)
+, m_droppedReported(0)
+, m_thread()
+, m_mutex()
+, m_wake()
+, m_written()
+, m_writtenPos(0)
+, m_flushRequested(false)
+, m_quit(false)
+, m_logFilename("log.txt")
 {
     ///@note Logger will dump to the current working directory unless SetOutputFilename is called.
+    for (int i=0; i<s_slotCount; ++i)
+    {
+        m_slots[i].sequence = i;
+    }
 }
 
-///@brief Flush and close the output file.
+///@brief Write out what is queued and close the output file.
 Logger::~Logger()
 {
     CloseStream();
@@ -31,9 +439,10 @@ void Logger::SetOutputFilename(const std::string& filename)
 {
     CloseStream();
     m_logFilename = filename;
-    OpenStream();
 }
 
+///@brief Writer thread (or a caller holding m_mutex when there is none):
+/// open the log for the first batch.
 void Logger::OpenStream()
 {
     m_stream.open(m_logFilename.c_str(), std::ios::out);
@@ -57,86 +466,282 @@ void Logger::OpenStream()
 #endif
 }
 
+///@brief Stop the writer once everything queued so far is written, and
+/// close the file. The next message starts them again.
 void Logger::CloseStream()
 {
+    {
+        ScopedLock lock(m_mutex);
+        m_quit = true;
+        m_wake.Signal();
+    }
+    m_thread.Join();
+
+    ScopedLock lock(m_mutex);
+    std::string text, console;
+    _Drain(text, console);
+    _WriteOut(text, console);
     if (m_stream.is_open())
     {
         m_stream.close();
     }
+    m_quit = false;
+    AtomicStore(&m_writerState, WriterStopped);
 }
 
-///@brief Write a message to the log's output stream with a trailing newline.
-///@param format The string to write to the log.
-void Logger::WriteLn(const char* format, ...)
+///@brief Wait until every message logged before the call is written out.
+void Logger::Flush()
 {
-    if (m_stream.is_open() == false)
+    const long target = AtomicLoad(&m_enqueuePos);
+    _StartWriter();
+    ScopedLock lock(m_mutex);
+    if (AtomicLoad(&m_writerState) != WriterRunning)
     {
-        OpenStream();
+        std::string text, console;
+        _Drain(text, console);
+        _WriteOut(text, console);
+        return;
+    }
+    // m_quit: CloseStream is stopping the writer and writes the rest itself.
+    while ((positionDiff(m_writtenPos, target) < 0) && (m_quit == false))
+    {
+        m_flushRequested = true;
+        m_wake.Signal();
+        m_written.WaitFor(m_mutex, s_idleWaitMs);
     }
+}
 
-    char buffer[s_bufferSz];
+///@return Messages dropped because the ring was full.
+long Logger::DroppedCount() const
+{
+    return AtomicLoad(&m_dropped);
+}
 
+///@brief Write a message to the log's output stream with a trailing newline.
+///@param format The string to write to the log.
+void Logger::WriteLn(const char* format, ...)
+{
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, s_bufferSz, format, args);
+    _Capture(MessageWriteLn, format, args);
     va_end(args);
-
-    m_stream
-        << buffer
-        << std::endl;
-
-    m_stream.flush();
-
-    OutputPrint(buffer);
 }
 
 ///@brief Write a message to the log's output stream.
 ///@param format The string to write to the log.
 void Logger::Write(const char* format, ...)
 {
-    if (m_stream.is_open() == false)
-    {
-        OpenStream();
-    }
-
-    char buffer[s_bufferSz];
+    va_list args;
+    va_start(args, format);
+    _Capture(MessageWrite, format, args);
+    va_end(args);
+}
 
+///@brief Write a message to the log's output stream with a noticeable error
+/// message, and wait for it to be written.
+///@param format The string to write to the log.
+void Logger::WriteError(const char* format, ...)
+{
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, s_bufferSz, format, args);
+    _Capture(MessageError, format, args);
     va_end(args);
+    Flush();
+}
 
-    m_stream << buffer;
+///@brief Any thread: queue a message without locking, or count it dropped
+/// if the ring is full. Formats the message here only if its format has
+/// conversions the writer cannot redo from a record.
+void Logger::_Capture(messageKind kind, const char* pFormat, va_list args)
+{
+    char record[s_maxRecordBytes];
+    messageHeader header;
+    header.pFormat = pFormat;
+    header.kind = static_cast<unsigned char>(kind);
+    header.preformatted = 0;
 
-    m_stream.flush();
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    recordWriter writer(record + sizeof(header), sizeof(record) - sizeof(header));
+    size_t argBytes = 0;
+    if (captureArguments(pFormat, args, writer))
+    {
+        argBytes = writer.Used();
+    }
+    else
+    {
+        const size_t room = sizeof(record) - sizeof(header);
+        const int n = vsnprintf(record + sizeof(header), room, pFormat, argsCopy);
+        argBytes = (n < 0) ? 0 : ((static_cast<size_t>(n) < room) ? n : room - 1);
+        header.preformatted = 1;
+    }
+    va_end(argsCopy);
+
+    header.bytes = static_cast<unsigned short>(sizeof(header) + argBytes);
+    header.slots = static_cast<unsigned short>((header.bytes + s_slotPayload - 1) / s_slotPayload);
+    memcpy(record, &header, sizeof(header));
+
+    // Claim header.slots consecutive slots. The writer frees them in order,
+    // so if the last is free for this lap, so are the others.
+    long pos = AtomicLoad(&m_enqueuePos);
+    for (;;)
+    {
+        const long last = pos + header.slots - 1;
+        const long sequence = AtomicLoad(&m_slots[last & (s_slotCount - 1)].sequence);
+        const long diff = positionDiff(sequence, last);
+        if (diff < 0)
+        {
+            AtomicFetchAdd(&m_dropped, 1);
+            _StartWriter();
+            return;
+        }
+        if (diff == 0)
+        {
+            const long prev = AtomicCompareExchange(&m_enqueuePos, pos, pos + header.slots);
+            if (prev == pos)
+                break;
+            pos = prev;
+        }
+        else
+        {
+            pos = AtomicLoad(&m_enqueuePos);
+        }
+    }
 
-    OutputPrint(buffer);
+    // Fill them, then publish the first last so the writer sees whole messages.
+    for (int i=0; i<header.slots; ++i)
+    {
+        const size_t offset = i * s_slotPayload;
+        const size_t bytes = (header.bytes - offset < static_cast<size_t>(s_slotPayload)) ?
+            header.bytes - offset : s_slotPayload;
+        memcpy(m_slots[(pos + i) & (s_slotCount - 1)].payload, record + offset, bytes);
+    }
+    for (int i=header.slots-1; i>=0; --i)
+    {
+        AtomicStore(&m_slots[(pos + i) & (s_slotCount - 1)].sequence, pos + i + 1);
+    }
+
+    _StartWriter();
+    if (AtomicLoad(&m_writerState) == WriterFailed)
+    {
+        ScopedLock lock(m_mutex);
+        std::string text, console;
+        _Drain(text, console);
+        _WriteOut(text, console);
+    }
 }
 
-///@brief Write a message to the log's output stream with a noticeable error message.
-///@param format The string to write to the log.
-void Logger::WriteError(const char* format, ...)
+void Logger::_StartWriter()
 {
-    if (m_stream.is_open() == false)
+    if (AtomicLoad(&m_writerState) != WriterStopped)
+        return;
+    ScopedLock lock(m_mutex);
+    if (AtomicLoad(&m_writerState) != WriterStopped)
+        return;
+    const bool started = m_thread.Start(_WriterEntry, this);
+    AtomicStore(&m_writerState, started ? WriterRunning : WriterFailed);
+}
+
+void Logger::_WriterEntry(void* pArg)
+{
+    reinterpret_cast<Logger*>(pArg)->_WriterLoop();
+}
+
+void Logger::_WriterLoop()
+{
+    std::string text;
+    std::string console;
+    for (;;)
     {
-        OpenStream();
+        const bool wrote = _Drain(text, console);
+        _WriteOut(text, console);
+
+        ScopedLock lock(m_mutex);
+        m_writtenPos = m_dequeuePos;
+        m_written.Broadcast();
+        if (m_quit)
+            return;
+        if ((wrote == false) && (m_flushRequested == false))
+        {
+            m_wake.WaitFor(m_mutex, s_idleWaitMs);
+        }
+        m_flushRequested = false;
     }
+}
 
-    char buffer[s_bufferSz];
+///@brief Format every whole message in the ring onto text (for the file)
+/// and console, freeing their slots.
+///@return true if there were any.
+bool Logger::_Drain(std::string& text, std::string& console)
+{
+    const long dropped = AtomicLoad(&m_dropped);
+    if (dropped != m_droppedReported)
+    {
+        char note[128];
+        snprintf(note, sizeof(note), "Logger: ring full, %ld messages dropped\n", dropped - m_droppedReported);
+        text.append(note);
+        console.append(note);
+        m_droppedReported = dropped;
+    }
 
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, s_bufferSz, format, args);
-    va_end(args);
+    bool any = false;
+    char record[s_maxRecordBytes];
+    std::string message;
+    for (;;)
+    {
+        slot& first = m_slots[m_dequeuePos & (s_slotCount - 1)];
+        if (positionDiff(AtomicLoad(&first.sequence), m_dequeuePos + 1) != 0)
+            break;
 
-    m_stream
-        << std::endl
-        << "    *** ERROR *** "
-        << buffer
-        << std::endl
-        << std::endl;
+        messageHeader header;
+        memcpy(&header, first.payload, sizeof(header));
+        for (int i=0; i<header.slots; ++i)
+        {
+            const size_t offset = i * s_slotPayload;
+            const size_t bytes = (header.bytes - offset < static_cast<size_t>(s_slotPayload)) ?
+                header.bytes - offset : s_slotPayload;
+            slot& s = m_slots[(m_dequeuePos + i) & (s_slotCount - 1)];
+            memcpy(record + offset, s.payload, bytes);
+            AtomicStore(&s.sequence, m_dequeuePos + i + s_slotCount);
+        }
+        m_dequeuePos += header.slots;
+        any = true;
 
-    m_stream.flush();
+        message.clear();
+        formatRecord(header, record + sizeof(header), header.bytes - sizeof(header), message);
+        switch (header.kind)
+        {
+        case MessageWriteLn:
+            text.append(message);
+            text.push_back('\n');
+            break;
+        case MessageError:
+            text.append("\n    *** ERROR *** ");
+            text.append(message);
+            text.append("\n\n");
+            break;
+        default:
+            text.append(message);
+            break;
+        }
+        console.append(message);
+        console.push_back('\n');
+    }
+    return any;
+}
 
-    OutputPrint(buffer);
+///@brief Writer: write a batch to the file and console, flushing both.
+void Logger::_WriteOut(std::string& text, std::string& console)
+{
+    if (text.empty() && console.empty())
+        return;
+    if (m_stream.is_open() == false)
+    {
+        OpenStream();
+    }
+    m_stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    m_stream.flush();
+    OutputString(console.c_str());
+    text.clear();
+    console.clear();
 }
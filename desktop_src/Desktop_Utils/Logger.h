@@ -2,41 +2,60 @@
 
 #pragma once
 
+#include "Threads.h"
+
+#include <stdarg.h>
 #include <fstream>
+#include <string>
 
 #ifdef _DEBUG
 #define VERBOSE_LOGGING
 #endif
 
+// The "" makes the format a string literal, as Logger keeps only a pointer
+// to it until its writer thread gets to the message. Errors are flushed at
+// once: they are the messages most likely to come just before a crash.
 #ifdef _WIN32
 #  ifdef VERBOSE_LOGGING
-#  define LOG_INFO(string, ...) Logger::Instance().WriteLn(string , __VA_ARGS__)
-#  define LOG_INFO_NONEWLINE(string, ...) Logger::Instance().Write(string , __VA_ARGS__)
+#  define LOG_INFO(string, ...) Logger::Instance().WriteLn("" string , __VA_ARGS__)
+#  define LOG_INFO_NONEWLINE(string, ...) Logger::Instance().Write("" string , __VA_ARGS__)
 #  else
 #  define LOG_INFO(string, ...)
 #  define LOG_INFO_NONEWLINE(string, ...)
 #  endif
 
-#  define LOG_WARNING(string, ...) Logger::Instance().WriteLn(string , __VA_ARGS__)
-#  define LOG_ERROR(string, ...) Logger::Instance().WriteError(string , __VA_ARGS__)
+#  define LOG_WARNING(string, ...) Logger::Instance().WriteLn("" string , __VA_ARGS__)
+#  define LOG_ERROR(string, ...) Logger::Instance().WriteError("" string , __VA_ARGS__)
 #endif
 
 #ifdef _UNIX
-#  define LOG_INFO(string, args...) Logger::Instance().Write(string, ## args)
-#  define LOG_INFO_NONEWLINE(string, args...) Logger::Instance().Write(string, ## args)
-#  define LOG_WARNING(string, args...) Logger::Instance().Write(string, ## args)
-#  define LOG_ERROR(string, args...) Logger::Instance().Write(string, ## args)
+#  define LOG_INFO(string, args...) Logger::Instance().Write("" string, ## args)
+#  define LOG_INFO_NONEWLINE(string, args...) Logger::Instance().Write("" string, ## args)
+#  define LOG_WARNING(string, args...) Logger::Instance().Write("" string, ## args)
+#  define LOG_ERROR(string, args...) (Logger::Instance().Write("" string, ## args), Logger::Instance().Flush())
 #endif
 
 #ifdef _MACOS
-#  define LOG_INFO(string, args...) Logger::Instance().Write(string, ## args)
-#  define LOG_INFO_NONEWLINE(string, args...) Logger::Instance().Write(string, ## args)
-#  define LOG_WARNING(string, args...) Logger::Instance().Write(string, ## args)
-#  define LOG_ERROR(string, args...) Logger::Instance().Write(string, ## args)
+#  define LOG_INFO(string, args...) Logger::Instance().Write("" string, ## args)
+#  define LOG_INFO_NONEWLINE(string, args...) Logger::Instance().Write("" string, ## args)
+#  define LOG_WARNING(string, args...) Logger::Instance().Write("" string, ## args)
+#  define LOG_ERROR(string, args...) (Logger::Instance().Write("" string, ## args), Logger::Instance().Flush())
 #endif
 
+#define LOG_FLUSH() Logger::Instance().Flush()
+
 
-///@brief Writes log messages to output stream.
+///@brief Writes log messages to the output stream and console from a
+/// background thread, so that logging costs the caller no formatting and
+/// no I/O, from any thread.
+/// Write* copy the format pointer and the arguments (strings by value) into
+/// a lock-free ring of fixed-size slots, one or more per message, shared by
+/// every thread that logs. The writer thread formats what it finds there,
+/// writes it out in one batch and flushes the stream, then sleeps briefly.
+/// When the ring is full a message is dropped and counted instead of
+/// blocking; the writer reports the count. Flush waits until everything
+/// logged before it is written; WriteError runs it, and CloseStream writes
+/// out whatever is left.
 class Logger
 {
 public:
@@ -47,6 +66,9 @@ public:
     void Write(const char*, ...);
     void WriteLn(const char*, ...);
     void WriteError(const char*, ...);
+    void Flush();
+
+    long DroppedCount() const;
 
     static Logger& Instance()
     {
@@ -54,7 +76,52 @@ public:
         return theLogger;
     }
 
-    static const int s_bufferSz;
+    static const int s_slotCount = 1024; ///< Power of 2
+    static const int s_slotBytes = 128;
+    static const int s_maxMessageSlots = 32; ///< Longer messages are truncated
+    static const unsigned int s_idleWaitMs = 20;
+
+protected:
+    enum messageKind {
+        MessageWrite,
+        MessageWriteLn,
+        MessageError
+    };
+
+    enum writerState {
+        WriterStopped,
+        WriterRunning,
+        WriterFailed ///< No thread: callers write out under m_mutex
+    };
+
+    struct slot {
+        volatile long sequence; ///< Position it may be filled at; +1 once filled
+        char payload[s_slotBytes - sizeof(long)];
+    };
+    static const int s_slotPayload = s_slotBytes - sizeof(long);
+    static const int s_maxRecordBytes = s_slotPayload * s_maxMessageSlots;
+
+    void _Capture(messageKind kind, const char* pFormat, va_list args);
+    void _StartWriter();
+    static void _WriterEntry(void* pArg);
+    void _WriterLoop();
+    bool _Drain(std::string& text, std::string& console);
+    void _WriteOut(std::string& text, std::string& console);
+
+    slot m_slots[s_slotCount];
+    volatile long m_enqueuePos;
+    volatile long m_dropped;
+    volatile long m_writerState;
+    long m_dequeuePos;       ///< Writer only
+    long m_droppedReported;  ///< Writer only
+
+    Thread m_thread;
+    Mutex m_mutex;
+    ConditionVariable m_wake;    ///< Flush or quit for the writer
+    ConditionVariable m_written; ///< Writer progress for Flush
+    long m_writtenPos;           ///< Guarded by m_mutex
+    bool m_flushRequested;       ///< Guarded by m_mutex
+    bool m_quit;                 ///< Guarded by m_mutex
 
 private:
     Logger();                           ///< disallow default constructor
@@ -13,6 +13,8 @@
 #include <GLFW/glfw3.h>
 
 #include "cpp_interface.h"
+#include "FrameProfiler.h"
+#include "RenderThread.h"
 #include "AndroidTouchEnums.h"
 #include "TouchReplayer.h"
 #include "Timer.h"
@@ -26,6 +28,75 @@ bool portrait = true;
 TouchReplayer g_trp;
 Timer g_playbackTimer;
 
+// -record <file> logs this session's input; -replay <file> drives the
+// scene from such a log instead, -speed times as fast as it was recorded.
+// -fixedstep <ticks/s> simulates in fixed ticks; -virtualclock <fps>
+// advances time by one frame of that rate per frame drawn.
+// -renderthread replays scenes' recorded frames on a second thread.
+std::string g_recordFile;
+std::string g_replayFile;
+double g_replaySpeed = 1.;
+double g_fixedStepRate = 0.;
+double g_virtualFrameRate = 0.;
+bool g_renderThread = false;
+
+void parseOptions(int argc, char** argv)
+{
+    for (int arg=1; arg<argc; ++arg)
+    {
+        if (strcmp(argv[arg], "-renderthread") == 0)
+            g_renderThread = true;
+        else if (arg+1 >= argc)
+            break;
+        else if (strcmp(argv[arg], "-record") == 0)
+            g_recordFile = argv[++arg];
+        else if (strcmp(argv[arg], "-replay") == 0)
+            g_replayFile = argv[++arg];
+        else if (strcmp(argv[arg], "-speed") == 0)
+            g_replaySpeed = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "-fixedstep") == 0)
+            g_fixedStepRate = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "-virtualclock") == 0)
+            g_virtualFrameRate = atof(argv[++arg]);
+    }
+}
+
+// The render thread takes the context to replay frames and present them.
+void makeContextCurrent(void*)
+{
+    glfwMakeContextCurrent(g_pWindow);
+}
+
+void releaseContext(void*)
+{
+    glfwMakeContextCurrent(NULL);
+}
+
+void swapWindow(void*)
+{
+    glfwSwapBuffers(g_pWindow);
+}
+
+void applyOptions()
+{
+    setFixedTimestep(g_fixedStepRate, 0);
+    setVirtualClock(g_virtualFrameRate);
+    if (g_replayFile.empty() == false)
+        startInputReplay(g_replayFile, g_replaySpeed, false);
+    else if (g_recordFile.empty() == false)
+        startInputRecording(g_recordFile);
+    if (g_renderThread)
+    {
+        const renderContextCallbacks ctx = {
+            makeContextCurrent,
+            releaseContext,
+            swapWindow,
+            NULL,
+        };
+        startRenderThread(ctx);
+    }
+}
+
 void initGL()
 {
     initScene();
@@ -174,6 +245,11 @@ void drop(GLFWwindow* pWindow, int count, const char** paths)
         return;
 
     const std::string touchFile(paths[0]);
+    if (isInputLog(touchFile))
+    {
+        startInputReplay(touchFile, 1., false);
+        return;
+    }
     g_trp.LoadTouchLogFromFile(touchFile);
     g_playbackTimer.reset();
 }
@@ -243,6 +319,7 @@ void error_callback(int error, const char* description)
 
 int main(int argc, char** argv)
 {
+    parseOptions(argc, argv);
     glfwSetErrorCallback(error_callback);
     LOG_INFO("Compiled against GLFW %i.%i.%i\n",
         GLFW_VERSION_MAJOR,
@@ -337,13 +414,19 @@ int main(int argc, char** argv)
     setLoaderFunc((void*)&glfwGetProcAddress);
     initGL();
     surfaceChangedScene(winw, winh);
+    applyOptions();
 
     while (!glfwWindowShouldClose(l_Window))
     {
         g_trp.PlaybackRecentEvents(g_playbackTimer.seconds(), onSingleTouchEvent);
         glfwPollEvents();
         display();
-        glfwSwapBuffers(l_Window);
+        if (isRenderThreadRunning() == false)
+        {
+            PROFILE_ZONE("swap");
+            glfwSwapBuffers(l_Window);
+            framePresented();
+        }
     }
 
     exitGL();
@@ -0,0 +1,449 @@
+// headless_main.cpp
+// Offscreen benchmark harness: renders every scene in luaentry.lua's
+// scene_modules list into an EGL pbuffer with no window system and
+// writes per-scene frame time statistics as JSON.
+//
+// Usage: Flickercladding-Headless [-replay input.log [-speed x]] [-fixedstep ticksPerSecond] [-virtualclock fps]
+//            [-renderthread] [warmupFrames] [measuredFrames] [width] [height] [outfile.json] [scene ...]
+// Listing scene names restricts the run to those scenes, e.g. to skip compute-heavy ones.
+// -replay feeds each scene the session recorded by a -record run of the
+// windowed hosts, restarted as its measured frames begin.
+// -virtualclock advances time by exactly one frame at that rate per frame,
+// so scenes simulate the same steps however long the frames take.
+// -renderthread replays recorded frames on a second thread, as the windowed
+// hosts can; each scene's "pipeline" object gives latency and throughput
+// in either mode for comparison. GPU times are not taken with it.
+// With Mesa installed, LIBGL_ALWAYS_SOFTWARE=1 forces the llvmpipe rasterizer.
+// The last frames of each scene are also written as a Chrome trace, <scene>_trace.json.
+
+#include "GL_Includes.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "cpp_interface.h"
+#include "FrameProfiler.h"
+#include "RenderThread.h"
+#include "Timer.h"
+#include "Logging.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+int warmupFrames = 30;
+int measuredFrames = 300;
+int winw = 800;
+int winh = 800;
+
+EGLDisplay g_display = EGL_NO_DISPLAY;
+EGLSurface g_surface = EGL_NO_SURFACE;
+EGLContext g_context = EGL_NO_CONTEXT;
+
+struct sceneResult {
+    std::string name;
+    std::vector<double> cpuMs;
+    std::vector<double> gpuMs;
+    pipelineReport pipeline;
+    std::string error;
+};
+
+///@brief Prefer Mesa's surfaceless platform so no X server is needed;
+/// fall back to whatever the default display is.
+EGLDisplay getHeadlessDisplay()
+{
+    typedef EGLDisplay (EGLAPIENTRYP GetPlatformDisplayProc)(EGLenum, void*, const EGLint*);
+    GetPlatformDisplayProc pGetPlatformDisplay =
+        (GetPlatformDisplayProc)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (pGetPlatformDisplay != NULL)
+    {
+        EGLDisplay d = pGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (d != EGL_NO_DISPLAY)
+            return d;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool init()
+{
+    g_display = getHeadlessDisplay();
+    EGLint major = 0, minor = 0;
+    if ((g_display == EGL_NO_DISPLAY) || !eglInitialize(g_display, &major, &minor))
+    {
+        LOG_ERROR("Could not initialize EGL display.");
+        return false;
+    }
+    LOG_INFO("EGL %d.%d: %s", major, minor, eglQueryString(g_display, EGL_VENDOR));
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 16,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(g_display, configAttribs, &config, 1, &numConfigs) || (numConfigs < 1))
+    {
+        LOG_ERROR("No suitable EGL config.");
+        return false;
+    }
+
+    const EGLint pbufferAttribs[] = {
+        EGL_WIDTH, winw,
+        EGL_HEIGHT, winh,
+        EGL_NONE,
+    };
+    g_surface = eglCreatePbufferSurface(g_display, config, pbufferAttribs);
+    if (g_surface == EGL_NO_SURFACE)
+    {
+        LOG_ERROR("Could not create %dx%d pbuffer.", winw, winh);
+        return false;
+    }
+
+    // Match the context glfw_main.cpp asks for.
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    g_context = eglCreateContext(g_display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (g_context == EGL_NO_CONTEXT)
+    {
+        LOG_ERROR("Could not create OpenGL 4.3 core context.");
+        return false;
+    }
+
+    return eglMakeCurrent(g_display, g_surface, g_surface, g_context) == EGL_TRUE;
+}
+
+// The context moves between threads when -renderthread is given. The
+// bound client API is per thread, so bind it before every move.
+static void eglMakeContextCurrent(void*)
+{
+    eglBindAPI(EGL_OPENGL_API);
+    eglMakeCurrent(g_display, g_surface, g_surface, g_context);
+}
+
+static void eglReleaseContext(void*)
+{
+    eglMakeCurrent(g_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+static void eglSwapSurface(void*)
+{
+    eglSwapBuffers(g_display, g_surface);
+}
+
+void exitEGL()
+{
+    if (g_display == EGL_NO_DISPLAY)
+        return;
+    eglMakeCurrent(g_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (g_context != EGL_NO_CONTEXT)
+        eglDestroyContext(g_display, g_context);
+    if (g_surface != EGL_NO_SURFACE)
+        eglDestroySurface(g_display, g_surface);
+    eglTerminate(g_display);
+}
+
+///@brief Percentile of an already sorted list: the sample nearest the
+/// interpolated index p * (n - 1).
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.;
+    const int idx = static_cast<int>(p * static_cast<double>(sorted.size() - 1) + .5);
+    return sorted[idx];
+}
+
+void writeStats(FILE* pF, const char* pName, std::vector<double> ms)
+{
+    std::sort(ms.begin(), ms.end());
+    double sum = 0.;
+    for (std::vector<double>::const_iterator it = ms.begin(); it != ms.end(); ++it)
+    {
+        sum += *it;
+    }
+    const double mean = ms.empty() ? 0. : sum / static_cast<double>(ms.size());
+    fprintf(pF, "      \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+        pName,
+        mean,
+        percentile(ms, .50),
+        percentile(ms, .95),
+        percentile(ms, .99),
+        ms.empty() ? 0. : ms.back());
+}
+
+///@brief Escape quotes, backslashes and control characters for a JSON string literal.
+std::string jsonEscape(const std::string& s)
+{
+    std::string out;
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+        const char c = *it;
+        if ((c == '"') || (c == '\\'))
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            out += ' ';
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return out;
+}
+
+void writeJson(FILE* pF, const std::vector<sceneResult>& results)
+{
+    fprintf(pF, "{\n");
+    fprintf(pF, "  \"renderer\": \"%s\",\n", jsonEscape(reinterpret_cast<const char*>(glGetString(GL_RENDERER))).c_str());
+    fprintf(pF, "  \"version\": \"%s\",\n", jsonEscape(reinterpret_cast<const char*>(glGetString(GL_VERSION))).c_str());
+    fprintf(pF, "  \"width\": %d, \"height\": %d,\n", winw, winh);
+    fprintf(pF, "  \"warmupFrames\": %d, \"measuredFrames\": %d,\n", warmupFrames, measuredFrames);
+    fprintf(pF, "  \"scenes\": [\n");
+    for (std::vector<sceneResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+    {
+        const sceneResult& r = *it;
+        fprintf(pF, "    {\n      \"name\": \"%s\",\n", jsonEscape(r.name).c_str());
+        if (r.error.empty() == false)
+        {
+            fprintf(pF, "      \"error\": \"%s\",\n", jsonEscape(r.error).c_str());
+        }
+        fprintf(pF, "      \"frames\": %d,\n", static_cast<int>(r.cpuMs.size()));
+        writeStats(pF, "cpuMs", r.cpuMs);
+        if (r.gpuMs.empty() == false)
+        {
+            fprintf(pF, ",\n");
+            writeStats(pF, "gpuMs", r.gpuMs);
+        }
+        const pipelineReport& p = r.pipeline;
+        fprintf(pF, ",\n      \"pipeline\": { \"mode\": \"%s\", \"fps\": %.2f, "
+            "\"latencyMs\": { \"p50\": %.4f, \"p99\": %.4f }, "
+            "\"intervalMs\": { \"p50\": %.4f, \"p99\": %.4f }, "
+            "\"logicMs\": { \"p50\": %.4f, \"p99\": %.4f } }",
+            p.threaded ? "threaded" : "single",
+            p.framesPerSecond,
+            1000. * p.latencyP50, 1000. * p.latencyP99,
+            1000. * p.intervalP50, 1000. * p.intervalP99,
+            1000. * p.logicP50, 1000. * p.logicP99);
+        fprintf(pF, "\n    }%s\n", (it+1 == results.end()) ? "" : ",");
+    }
+    fprintf(pF, "  ]\n}\n");
+}
+
+///@brief Draw the given number of frames, timing each on the CPU and,
+/// where timer queries exist, on the GPU. Query results are read back
+/// only after all frames are submitted so the pipeline is not stalled.
+/// With the render thread running it swaps, and the GPU is not timed.
+void runFrames(int count, sceneResult* pResult)
+{
+    const bool threaded = isRenderThreadRunning();
+    const bool useQueries = (threaded == false) &&
+        (pResult != NULL) && (glGenQueries != NULL) && (glGetQueryObjectui64v != NULL);
+    std::vector<GLuint> queries;
+    if (useQueries)
+    {
+        queries.resize(count);
+        glGenQueries(count, &queries[0]);
+    }
+
+    Timer t;
+    for (int i=0; i<count; ++i)
+    {
+        if (useQueries)
+            glBeginQuery(GL_TIME_ELAPSED, queries[i]);
+
+        const double start = t.seconds();
+        drawScene();
+        const double end = t.seconds();
+
+        if (useQueries)
+            glEndQuery(GL_TIME_ELAPSED);
+
+        if (threaded == false)
+        {
+            PROFILE_ZONE("swap");
+            eglSwapBuffers(g_display, g_surface);
+            framePresented();
+        }
+        if (pResult != NULL)
+            pResult->cpuMs.push_back(1000. * (end - start));
+    }
+    finishFrames();
+
+    if (useQueries)
+    {
+        for (int i=0; i<count; ++i)
+        {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+            pResult->gpuMs.push_back(1.e-6 * static_cast<double>(ns));
+        }
+        glDeleteQueries(count, &queries[0]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string replayFile;
+    double replaySpeed = 1.;
+    double fixedStepRate = 0.;
+    double virtualFrameRate = 0.;
+    bool renderThread = false;
+    int arg = 1;
+    // A flag missing its value, or unknown, is left at argv[arg] for the
+    // usage check below.
+    for (; (arg < argc) && (argv[arg][0] == '-'); ++arg)
+    {
+        if (strcmp(argv[arg], "-renderthread") == 0)
+            renderThread = true;
+        else if (arg+1 >= argc)
+            break;
+        else if (strcmp(argv[arg], "-replay") == 0)
+            replayFile = argv[++arg];
+        else if (strcmp(argv[arg], "-speed") == 0)
+            replaySpeed = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "-fixedstep") == 0)
+            fixedStepRate = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "-virtualclock") == 0)
+            virtualFrameRate = atof(argv[++arg]);
+        else
+            break;
+    }
+
+    if (argc > arg) warmupFrames = atoi(argv[arg]);
+    if (argc > arg+1) measuredFrames = atoi(argv[arg+1]);
+    if (argc > arg+2) winw = atoi(argv[arg+2]);
+    if (argc > arg+3) winh = atoi(argv[arg+3]);
+    const char* pOutFile = (argc > arg+4) ? argv[arg+4] : "scene_benchmark.json";
+    if ((measuredFrames < 1) || (winw < 1) || (winh < 1) ||
+        ((arg < argc) && (argv[arg][0] == '-')))
+    {
+        LOG_ERROR("Usage: %s [-replay input.log [-speed x]] [-fixedstep ticksPerSecond] [-virtualclock fps] [-renderthread] [warmupFrames] [measuredFrames] [width] [height] [outfile.json] [scene ...]", argv[0]);
+        return 1;
+    }
+    if ((replayFile.empty() == false) && (isInputLog(replayFile) == false))
+    {
+        LOG_ERROR("%s is not an input log; nothing benchmarked.", replayFile.c_str());
+        return 1;
+    }
+
+    if (init() == false)
+    {
+        exitEGL();
+        return 1;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        LOG_ERROR("Failed to initialize OpenGL context");
+        exitEGL();
+        return -1;
+    }
+
+    // eglGetProcAddress has the same signature as glfwGetProcAddress,
+    // which is what luaentry.lua casts the loader to.
+    setLoaderFunc((void*)&eglGetProcAddress);
+    initScene();
+    surfaceChangedScene(winw, winh);
+    setFixedTimestep(fixedStepRate, 0);
+    setVirtualClock(virtualFrameRate);
+    if (renderThread)
+    {
+        const renderContextCallbacks ctx = {
+            eglMakeContextCurrent,
+            eglReleaseContext,
+            eglSwapSurface,
+            NULL,
+        };
+        startRenderThread(ctx);
+    }
+
+    std::vector<std::string> names;
+    getSceneNames(names);
+    std::vector<std::string> only;
+    for (int a=arg+5; a<argc; ++a)
+    {
+        only.push_back(argv[a]);
+    }
+    LOG_INFO("Benchmarking %d scenes at %dx%d: %d warmup, %d measured frames each.",
+        static_cast<int>(names.size()), winw, winh, warmupFrames, measuredFrames);
+
+    std::vector<sceneResult> results;
+    for (int i=0; i<static_cast<int>(names.size()); ++i)
+    {
+        if (!only.empty() && (std::find(only.begin(), only.end(), names[i]) == only.end()))
+            continue;
+
+        sceneResult r;
+        r.name = names[i];
+
+        switchToScene(i);
+        runFrames(warmupFrames, NULL);
+        if (replayFile.empty() == false)
+        {
+            // Checked up front, but a partial baseline is worse than none.
+            if (startInputReplay(replayFile, replaySpeed, false) == false)
+            {
+                LOG_ERROR("Could not replay %s in scene %s.", replayFile.c_str(), r.name.c_str());
+                exitScene();
+                exitEGL();
+                return 1;
+            }
+        }
+        resetPipelineStats();
+        runFrames(measuredFrames, &r);
+        getPipelineReport(r.pipeline);
+        stopInputReplay();
+
+        const std::string traceFile = r.name + "_trace.json";
+        FrameProfiler::Instance().WriteChromeTrace(traceFile.c_str());
+
+        // A Lua error halts only this scene; record it and go on to the
+        // next, which switchToScene starts clean.
+        r.error = getErrorText();
+        results.push_back(r);
+        if (r.error.empty() == false)
+        {
+            LOG_ERROR("Scene %s failed: %s", r.name.c_str(), r.error.c_str());
+        }
+    }
+
+    // The JSON header reads GL strings; take the context back for good.
+    stopRenderThread();
+
+    // Log output goes to stdout too, so results get a file of their own.
+    FILE* pF = fopen(pOutFile, "w");
+    if (pF != NULL)
+    {
+        writeJson(pF, results);
+        fclose(pF);
+        LOG_INFO("Wrote %s", pOutFile);
+    }
+    else
+    {
+        LOG_ERROR("Could not open %s for writing.", pOutFile);
+    }
+
+    exitScene();
+    exitEGL();
+    LOG_FLUSH();
+    return 0;
+}
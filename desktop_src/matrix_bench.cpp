@@ -0,0 +1,297 @@
+// matrix_bench.cpp
+// Microbenchmark for the SIMD kernels in MatrixMath.cpp: checks and times
+// them against the scalar C++ functions, then runs matrix_bench.lua to do
+// the same for the pure-Lua matrixmath module against the same kernels
+// called through ffi.C. Exits with 1 if any kernel's result is off.
+//
+// Usage: Flickercladding-MatrixBench [pointCount] [repeats]
+
+#include "MatrixMath.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <lua.hpp>
+
+// Keeps the optimizer from discarding results.
+static volatile float g_sink = 0.f;
+
+// Largest difference from the scalar result a kernel may have. Rounding
+// differs only in the last bits; a wrong lane or shuffle is far off.
+static const float s_maxAbsError = 1.e-3f;
+
+static void makeMatrix(float* m, float t)
+{
+    const float3 axis = {.3f, .8f, .5f};
+    MakeRotationMatrix(m, t, axis);
+    glhTranslate(m, 1.f + t, -2.f, .5f);
+    glhScale(m, 1.5f, 1.5f, 1.5f);
+}
+
+// There is no scalar affine inverse elsewhere in C++, so the plain
+// kernel is written out here.
+static void scalarAffineInverse(float* pOut, const float* a)
+{
+    const float3 c0 = {a[0], a[1], a[2]};
+    const float3 c1 = {a[4], a[5], a[6]};
+    const float3 c2 = {a[8], a[9], a[10]};
+    const float3 r0 = cross(c1, c2);
+    const float3 r1 = cross(c2, c0);
+    const float3 r2 = cross(c0, c1);
+    const float s = 1.f / dot(c0, r0);
+    const float3 tr = {a[12], a[13], a[14]};
+    const float r[16] = {
+        s*r0.x, s*r1.x, s*r2.x, 0.f,
+        s*r0.y, s*r1.y, s*r2.y, 0.f,
+        s*r0.z, s*r1.z, s*r2.z, 0.f,
+        -s*dot(r0, tr), -s*dot(r1, tr), -s*dot(r2, tr), 1.f,
+    };
+    memcpy(pOut, r, sizeof(r));
+}
+
+static float maxAbsError(const float* pA, const float* pB, int n)
+{
+    float e = 0.f;
+    for (int i=0; i<n; ++i)
+    {
+        e = std::max(e, static_cast<float>(fabs(pA[i] - pB[i])));
+    }
+    return e;
+}
+
+static bool reportError(const char* pName, float err)
+{
+    const bool ok = (err <= s_maxAbsError);
+    printf("%-18s max error %g%s\n", pName, err, ok ? "" : "  FAILED");
+    return ok;
+}
+
+///@brief Compare each kernel's output with the scalar path's.
+///@return false if any differs by more than s_maxAbsError.
+static bool checkKernels(int count)
+{
+    mat4 a, b, simd;
+    makeMatrix(a.m, .1f);
+    makeMatrix(b.m, .2f);
+    bool ok = true;
+
+    float scalar[16];
+    memcpy(scalar, a.m, sizeof(scalar));
+    postMultiply(scalar, b.m);
+    mat4Multiply(simd, a, b);
+    ok &= reportError("multiply", maxAbsError(scalar, simd.m, 16));
+
+    scalarAffineInverse(scalar, a.m);
+    ok &= mat4AffineInverse(simd, a);
+    ok &= reportError("affine inverse", maxAbsError(scalar, simd.m, 16));
+
+    std::vector<float3> pts(count);
+    std::vector<float4> pts4(count);
+    std::vector<float3> ref(count);
+    std::vector<float3> out(count);
+    std::vector<float4> ref4(count);
+    std::vector<float4> out4(count);
+    for (int i=0; i<count; ++i)
+    {
+        const float3 p = {(float)(i % 97), (float)(i % 13) - 6.f, (float)(i % 7)};
+        pts[i] = p;
+        const float4 p4 = {p.x, p.y, p.z, (float)(i % 3)};
+        pts4[i] = p4;
+    }
+    const float* m = a.m;
+
+    for (int i=0; i<count; ++i)
+    {
+        ref[i] = transform(pts[i], m);
+    }
+    mat4TransformPoints(&out[0], a, &pts[0], count);
+    ok &= reportError("transform points",
+        maxAbsError(&ref[0].x, &out[0].x, 3 * count));
+
+    for (int i=0; i<count; ++i)
+    {
+        const float3 v = pts[i];
+        const float3 r = {
+            m[0]*v.x + m[4]*v.y + m[ 8]*v.z,
+            m[1]*v.x + m[5]*v.y + m[ 9]*v.z,
+            m[2]*v.x + m[6]*v.y + m[10]*v.z,
+        };
+        ref[i] = r;
+    }
+    mat4TransformVectors(&out[0], a, &pts[0], count);
+    ok &= reportError("transform vectors",
+        maxAbsError(&ref[0].x, &out[0].x, 3 * count));
+
+    for (int i=0; i<count; ++i)
+    {
+        const float4 v = pts4[i];
+        const float4 r = {
+            m[0]*v.x + m[4]*v.y + m[ 8]*v.z + m[12]*v.w,
+            m[1]*v.x + m[5]*v.y + m[ 9]*v.z + m[13]*v.w,
+            m[2]*v.x + m[6]*v.y + m[10]*v.z + m[14]*v.w,
+            m[3]*v.x + m[7]*v.y + m[11]*v.z + m[15]*v.w,
+        };
+        ref4[i] = r;
+    }
+    mat4TransformFloat4(&out4[0], a, &pts4[0], count);
+    ok &= reportError("transform float4",
+        maxAbsError(&ref4[0].x, &out4[0].x, 4 * count));
+
+    return ok;
+}
+
+static void report(const char* pName, double scalarSec, double simdSec, int ops)
+{
+    printf("%-18s scalar %8.2f ns   %-6s %8.2f ns   x%.2f\n",
+        pName,
+        1.e9 * scalarSec / ops,
+        mat4KernelName(),
+        1.e9 * simdSec / ops,
+        scalarSec / simdSec);
+}
+
+static void benchMultiply(int repeats)
+{
+    const int n = 1000 * repeats;
+    mat4 a, b;
+    makeMatrix(a.m, .1f);
+    makeMatrix(b.m, .2f);
+
+    Timer t;
+    for (int i=0; i<n; ++i)
+    {
+        postMultiply(a.m, b.m);
+        a.m[12] = .1f;
+    }
+    const double scalar = t.seconds();
+    g_sink += a.m[0];
+
+    t.reset();
+    for (int i=0; i<n; ++i)
+    {
+        mat4Multiply(a, a, b);
+        a.m[12] = .1f;
+    }
+    const double simd = t.seconds();
+    g_sink += a.m[0];
+    report("multiply", scalar, simd, n);
+}
+
+static void benchInverse(int repeats)
+{
+    const int n = 1000 * repeats;
+    mat4 a, inv;
+    makeMatrix(a.m, .3f);
+
+    Timer t;
+    for (int i=0; i<n; ++i)
+    {
+        scalarAffineInverse(inv.m, a.m);
+        a.m[12] += inv.m[0] * 1.e-7f;
+    }
+    const double scalar = t.seconds();
+    g_sink += inv.m[0];
+
+    t.reset();
+    for (int i=0; i<n; ++i)
+    {
+        mat4AffineInverse(inv, a);
+        a.m[12] += inv.m[0] * 1.e-7f;
+    }
+    const double simd = t.seconds();
+    g_sink += inv.m[0];
+    report("affine inverse", scalar, simd, n);
+}
+
+static void benchTransform(int count, int repeats)
+{
+    mat4 m;
+    makeMatrix(m.m, .4f);
+    std::vector<float3> pts(count);
+    std::vector<float3> out(count);
+    std::vector<float4> pts4(count);
+    std::vector<float4> out4(count);
+    for (int i=0; i<count; ++i)
+    {
+        const float3 p = {(float)(i % 97), (float)(i % 13), (float)(i % 7)};
+        pts[i] = p;
+        const float4 p4 = {p.x, p.y, p.z, 1.f};
+        pts4[i] = p4;
+    }
+
+    Timer t;
+    for (int r=0; r<repeats; ++r)
+    {
+        for (int i=0; i<count; ++i)
+        {
+            out[i] = transform(pts[i], m.m);
+        }
+    }
+    const double scalar = t.seconds();
+    g_sink += out[count-1].x;
+
+    t.reset();
+    for (int r=0; r<repeats; ++r)
+    {
+        mat4TransformPoints(&out[0], m, &pts[0], count);
+    }
+    const double simd = t.seconds();
+    g_sink += out[count-1].x;
+    report("transform points", scalar, simd, count * repeats);
+
+    t.reset();
+    for (int r=0; r<repeats; ++r)
+    {
+        mat4TransformFloat4(&out4[0], m, &pts4[0], count);
+    }
+    const double simd4 = t.seconds();
+    g_sink += out4[count-1].x;
+    report("transform float4", scalar, simd4, count * repeats);
+}
+
+int main(int argc, char** argv)
+{
+    const int count = (argc > 1) ? atoi(argv[1]) : 100000;
+    const int repeats = (argc > 2) ? atoi(argv[2]) : 100;
+    if ((count <= 0) || (repeats <= 0))
+    {
+        printf("Usage: %s [pointCount] [repeats]\n", argv[0]);
+        return 1;
+    }
+
+    printf("C++, %s against scalar:\n", mat4KernelName());
+    if (!checkKernels(std::min(count, 10000)))
+    {
+        return 1;
+    }
+
+    printf("C++, per operation:\n");
+    benchMultiply(repeats);
+    benchInverse(repeats);
+    benchTransform(count, repeats);
+
+    lua_State* L = luaL_newstate();
+    luaL_openlibs(L);
+    lua_pushinteger(L, count);
+    lua_setglobal(L, "bench_point_count");
+    lua_pushinteger(L, repeats);
+    lua_setglobal(L, "bench_repeats");
+    lua_pushstring(L, APP_DATA_DIRECTORY "lua/?.lua");
+    lua_setglobal(L, "bench_package_path");
+
+    const std::string script = std::string(APP_DATA_DIRECTORY) + "../desktop_src/matrix_bench.lua";
+    if (luaL_dofile(L, script.c_str()) != 0)
+    {
+        printf("Lua error: %s\n", lua_tostring(L, -1));
+        lua_close(L);
+        return 1;
+    }
+    lua_close(L);
+    return 0;
+}
@@ -0,0 +1,149 @@
+-- matrix_bench.lua
+-- Run by matrix_bench.cpp: checks and times util.matrixmath in pure Lua
+-- against the SIMD kernels in util.simdmath, called through ffi.C. Raises
+-- an error, failing the bench, if any kernel's result is off.
+
+package.path = bench_package_path .. ";" .. package.path
+
+local ffi = require("ffi")
+local mm = require("util.matrixmath")
+local sm = require("util.simdmath")
+
+local count = bench_point_count
+local repeats = bench_repeats
+
+local function report(name, lua_sec, ffi_sec, ops)
+    print(string.format("%-18s Lua    %8.2f ns   ffi.C  %8.2f ns   x%.2f",
+        name, 1e9 * lua_sec / ops, 1e9 * ffi_sec / ops, lua_sec / ffi_sec))
+end
+
+local function make_matrix(m, t)
+    mm.make_rotation_matrix(m, t, .3, .8, .5)
+    mm.glh_translate(m, 1 + t, -2, .5)
+    mm.glh_scale(m, 1.5, 1.5, 1.5)
+end
+
+print("Lua, per operation (kernel: "..sm.kernel..", "..(sm.available and "found" or "missing")..")")
+if not sm.available then return end
+
+-- Largest difference from the pure-Lua result a kernel may have; as in
+-- matrix_bench.cpp.
+local max_abs_error = 1e-3
+
+local function check(name, err)
+    local ok = (err <= max_abs_error)
+    print(string.format("%-18s max error %g%s", name, err, ok and "" or "  FAILED"))
+    return ok
+end
+
+local function max_abs_diff(a, b, n)
+    local e = 0
+    for i = 1,n do e = math.max(e, math.abs(a[i] - b[i])) end
+    return e
+end
+
+-- Each kernel through ffi.C against util.matrixmath.
+do
+    local ok = true
+    local a, b = {}, {}
+    make_matrix(a, .1)
+    make_matrix(b, .2)
+    local ca, cb, cout = mm.mat4(), mm.mat4(), mm.mat4()
+    mm.copy(ca, a)
+    mm.copy(cb, b)
+    sm.multiply(cout, ca, cb)
+    mm.post_multiply(a, b)
+    ok = check("multiply", max_abs_diff(a, cout, 16)) and ok
+
+    -- matrixmath's inverse only handles rotation and translation.
+    local r = {}
+    mm.make_rotation_matrix(r, .7, .3, .8, .5)
+    mm.glh_translate(r, 1, -2, .5)
+    local cr = mm.mat4()
+    mm.copy(cr, r)
+    ok = sm.affine_inverse(cr) and ok
+    mm.affine_inverse(r)
+    ok = check("affine inverse", max_abs_diff(r, cr, 16)) and ok
+
+    local n = math.min(count, 10000)
+    local src = ffi.new("float[?]", 3*n)
+    local dst = ffi.new("float[?]", 3*n)
+    for i = 0,n-1 do
+        src[3*i], src[3*i+1], src[3*i+2] = i % 97, i % 13 - 6, i % 7
+    end
+    for w = 0,1 do
+        if w == 1 then
+            sm.transform_points(dst, ca, src, n)
+        else
+            sm.transform_vectors(dst, ca, src, n)
+        end
+        local e = 0
+        for i = 0,n-1 do
+            local t = mm.transform({src[3*i], src[3*i+1], src[3*i+2], w}, ca)
+            e = math.max(e,
+                math.abs(t[1] - dst[3*i]),
+                math.abs(t[2] - dst[3*i+1]),
+                math.abs(t[3] - dst[3*i+2]))
+        end
+        ok = check(w == 1 and "transform points" or "transform vectors", e) and ok
+    end
+
+    if not ok then error("util.simdmath differs from util.matrixmath") end
+end
+
+-- Matrices as tables, the way most scenes still keep them.
+do
+    local n = 1000 * repeats
+    local a, b = {}, {}
+    make_matrix(a, .1)
+    make_matrix(b, .2)
+    local t0 = os.clock()
+    for i = 1,n do
+        mm.post_multiply(a, b)
+        a[13] = .1
+    end
+    local lua_sec = os.clock() - t0
+
+    local ca, cb = mm.mat4(), mm.mat4()
+    make_matrix(ca, .1)
+    make_matrix(cb, .2)
+    t0 = os.clock()
+    for i = 1,n do
+        sm.post_multiply(ca, cb)
+        ca[13] = .1
+    end
+    report("multiply", lua_sec, os.clock() - t0, n)
+end
+
+-- Table-of-tables points through mm.transform, against one batch call.
+do
+    local m = {}
+    make_matrix(m, .4)
+    local pts = {}
+    local src = ffi.new("float[?]", 3*count)
+    local dst = ffi.new("float[?]", 3*count)
+    for i = 1,count do
+        local x, y, z = (i-1) % 97, (i-1) % 13, (i-1) % 7
+        pts[i] = {x, y, z, 1}
+        src[3*i-3], src[3*i-2], src[3*i-1] = x, y, z
+    end
+    local reps = math.max(1, math.floor(repeats / 10))
+
+    local t0 = os.clock()
+    local last
+    for r = 1,reps do
+        for i = 1,count do
+            last = mm.transform(pts[i], m)
+        end
+    end
+    local lua_sec = os.clock() - t0
+
+    local cm = mm.mat4()
+    mm.copy(cm, m)
+    t0 = os.clock()
+    for r = 1,reps do
+        sm.transform_points(dst, cm, src, count)
+    end
+    report("transform points", lua_sec, os.clock() - t0, count * reps)
+    assert(math.abs(dst[3*count-3] - last[1]) < 1e-3)
+end
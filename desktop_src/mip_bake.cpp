@@ -0,0 +1,100 @@
+// mip_bake.cpp
+// Bakes a raw texture into a .mip file holding its full mip chain (see
+// MipChain.h), so loaders upload every level as is instead of leaving
+// minified textures to sample level 0.
+//
+// Usage: Flickercladding-MipBake [-linear] [-threads N] width height channels input.raw output.mip
+//
+// Color (3 or 4 channel) images are filtered in linear light unless -linear
+// is given, e.g. for normal or height maps.
+
+#include "MipChain.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static int usage(const char* pProgram)
+{
+    printf("Usage: %s [-linear] [-threads N] width height channels input.raw output.mip\n", pProgram);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    bool linear = false;
+    int threadCount = 4;
+    int arg = 1;
+    for (; (arg < argc) && (argv[arg][0] == '-'); ++arg)
+    {
+        if (strcmp(argv[arg], "-linear") == 0)
+        {
+            linear = true;
+        }
+        else if ((strcmp(argv[arg], "-threads") == 0) && (arg + 1 < argc))
+        {
+            threadCount = atoi(argv[++arg]);
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - arg != 5)
+        return usage(argv[0]);
+
+    const int width = atoi(argv[arg]);
+    const int height = atoi(argv[arg+1]);
+    const int channels = atoi(argv[arg+2]);
+    const char* pInput = argv[arg+3];
+    const char* pOutput = argv[arg+4];
+    if ((width <= 0) || (height <= 0) || (channels < 1) || (channels > 4))
+        return usage(argv[0]);
+
+    const size_t levelSize = static_cast<size_t>(width) * height * channels;
+    std::vector<unsigned char> chain(MipChainSize(width, height, channels));
+    FILE* pIn = fopen(pInput, "rb");
+    if (pIn == NULL)
+    {
+        printf("Could not open %s\n", pInput);
+        return 1;
+    }
+    const size_t got = fread(&chain[0], 1, levelSize, pIn);
+    fclose(pIn);
+    if (got != levelSize)
+    {
+        printf("%s is shorter than %dx%dx%d bytes\n", pInput, width, height, channels);
+        return 1;
+    }
+
+    const bool srgb = (linear == false) && (channels >= 3);
+    Timer t;
+    BuildMipChain(&chain[0], width, height, channels, srgb, threadCount);
+    const double sec = t.seconds();
+
+    MipChainHeader header;
+    WriteMipChainHeader(header, width, height, channels, srgb ? MipChainSRGB : 0);
+    FILE* pOut = fopen(pOutput, "wb");
+    if (pOut == NULL)
+    {
+        printf("Could not write %s\n", pOutput);
+        return 1;
+    }
+    const bool ok =
+        (fwrite(&header, sizeof(header), 1, pOut) == 1) &&
+        (fwrite(&chain[0], 1, chain.size(), pOut) == chain.size());
+    fclose(pOut);
+    if (ok == false)
+    {
+        printf("Could not write %s\n", pOutput);
+        return 1;
+    }
+
+    printf("%s: %dx%d, %u levels, %s, %.2f ms (%s)\n",
+        pOutput, width, height, header.levels,
+        srgb ? "sRGB" : "linear",
+        1000. * sec, mipKernelName());
+    return 0;
+}
@@ -9,15 +9,21 @@
 #include "GL_Includes.h"
 
 #include "cpp_interface.h"
+#include "FrameProfiler.h"
+#include "RenderThread.h"
 #include "AndroidTouchEnums.h"
 #include "TouchReplayer.h"
 #include "Timer.h"
 #include "Logging.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <SDL.h>
 #undef main
 
 SDL_Window* g_pWindow = NULL;
+SDL_GLContext g_glContext = NULL;
 int winw = 800;
 int winh = 800;
 bool portrait = true;
@@ -25,6 +31,75 @@ bool portrait = true;
 TouchReplayer g_trp;
 Timer g_playbackTimer;
 
+// -record <file> logs this session's input; -replay <file> drives the
+// scene from such a log instead, -speed times as fast as it was recorded.
+// -fixedstep <ticks/s> simulates in fixed ticks; -virtualclock <fps>
+// advances time by one frame of that rate per frame drawn.
+// -renderthread replays scenes' recorded frames on a second thread.
+std::string g_recordFile;
+std::string g_replayFile;
+double g_replaySpeed = 1.;
+double g_fixedStepRate = 0.;
+double g_virtualFrameRate = 0.;
+bool g_renderThread = false;
+
+void parseOptions(int argc, char** argv)
+{
+    for (int arg=1; arg<argc; ++arg)
+    {
+        if (strcmp(argv[arg], "-renderthread") == 0)
+            g_renderThread = true;
+        else if (arg+1 >= argc)
+            break;
+        else if (strcmp(argv[arg], "-record") == 0)
+            g_recordFile = argv[++arg];
+        else if (strcmp(argv[arg], "-replay") == 0)
+            g_replayFile = argv[++arg];
+        else if (strcmp(argv[arg], "-speed") == 0)
+            g_replaySpeed = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "-fixedstep") == 0)
+            g_fixedStepRate = atof(argv[++arg]);
+        else if (strcmp(argv[arg], "-virtualclock") == 0)
+            g_virtualFrameRate = atof(argv[++arg]);
+    }
+}
+
+// The render thread takes the context to replay frames and present them.
+void makeContextCurrent(void*)
+{
+    SDL_GL_MakeCurrent(g_pWindow, g_glContext);
+}
+
+void releaseContext(void*)
+{
+    SDL_GL_MakeCurrent(g_pWindow, NULL);
+}
+
+void swapWindow(void*)
+{
+    SDL_GL_SwapWindow(g_pWindow);
+}
+
+void applyOptions()
+{
+    setFixedTimestep(g_fixedStepRate, 0);
+    setVirtualClock(g_virtualFrameRate);
+    if (g_replayFile.empty() == false)
+        startInputReplay(g_replayFile, g_replaySpeed, false);
+    else if (g_recordFile.empty() == false)
+        startInputRecording(g_recordFile);
+    if (g_renderThread)
+    {
+        const renderContextCallbacks ctx = {
+            makeContextCurrent,
+            releaseContext,
+            swapWindow,
+            NULL,
+        };
+        startRenderThread(ctx);
+    }
+}
+
 void initGL()
 {
     initScene();
@@ -84,14 +159,14 @@ bool init()
     }
 
     // thank you http://www.brandonfoltz.com/2013/12/example-using-opengl-3-0-with-sdl2-and-glew/
-    SDL_GLContext glContext = SDL_GL_CreateContext(g_pWindow);
-    if (glContext == NULL)
+    g_glContext = SDL_GL_CreateContext(g_pWindow);
+    if (g_glContext == NULL)
     {
         printf("There was an error creating the OpenGL context!\n");
         return 0;
     }
 
-    SDL_GL_MakeCurrent(g_pWindow, glContext);
+    SDL_GL_MakeCurrent(g_pWindow, g_glContext);
 
     //SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     //SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
@@ -105,6 +180,11 @@ void drop(const char* path)
         return;
 
     const std::string touchFile(path);
+    if (isInputLog(touchFile))
+    {
+        startInputReplay(touchFile, 1., false);
+        return;
+    }
     g_trp.LoadTouchLogFromFile(touchFile);
     g_playbackTimer.reset();
 
@@ -113,6 +193,7 @@ void drop(const char* path)
 
 int main(int argc, char *argv[])
 {
+    parseOptions(argc, argv);
     if (init() == false)
         return 1;
 
@@ -125,6 +206,7 @@ int main(int argc, char *argv[])
     setLoaderFunc((void*)&SDL_GL_GetProcAddress);
     initGL();
     surfaceChangedScene(winw, winh);
+    applyOptions();
 
     SDL_Event event;
     int quit = 0;
@@ -244,9 +326,15 @@ int main(int argc, char *argv[])
         }
 
         display();
-        SDL_GL_SwapWindow(g_pWindow);
+        if (isRenderThreadRunning() == false)
+        {
+            PROFILE_ZONE("swap");
+            SDL_GL_SwapWindow(g_pWindow);
+            framePresented();
+        }
     }
 
+    stopRenderThread();
     SDL_Quit();
     return 0;
 }
@@ -0,0 +1,575 @@
+// texture_compress.cpp
+// Converts a raw texture, or a .mip file baked by Flickercladding-MipBake,
+// into a KTX 1.1 file of ETC2 or EAC blocks that GLES 3 samples directly.
+// TextureLoader::LoadKtx and CreateTextureFromKtxFile load the result.
+//
+// Usage: Flickercladding-TexCompress [-format etc2|rgba|r11|rg11] [-swizzle rgba]
+//            [-mips] width height channels input output.ktx
+//
+// The format defaults to the input's channels: r11, rg11, etc2 (RGB) or
+// rgba (ETC2 RGB plus EAC alpha). Extra input channels are dropped, so
+// e.g. a gray RGBA font page can be stored as r11 with -swizzle rrr1.
+// With -mips, or a .mip input, every mip level is stored.
+//
+// ETC2 RGB blocks use its ETC1-compatible individual and differential
+// modes, found by searching base colors around each half's average.
+
+#include "EtcDecoder.h"
+#include "MipChain.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const int s_etc1Modifiers[8][4] = {
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 },
+};
+
+static const int s_eacModifiers[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+static inline int clampInt(int v, int lo, int hi) { return (v < lo) ? lo : ((v > hi) ? hi : v); }
+static inline int extend4(int v) { return (v << 4) | v; }
+static inline int extend5(int v) { return (v << 3) | (v >> 2); }
+
+/// A 4x4 block's pixels in index order: pixel i is at x = i / 4, y = i % 4.
+struct blockPixels {
+    int c[16][4];
+};
+
+// Copy a block out of an image, repeating the last row and column past its edges.
+static void gatherBlock(const unsigned char* pImage, unsigned int width, unsigned int height,
+    int channels, unsigned int bx, unsigned int by, blockPixels& block)
+{
+    for (int i=0; i<16; ++i)
+    {
+        const unsigned int x = (bx + (i >> 2) < width) ? (bx + (i >> 2)) : (width - 1);
+        const unsigned int y = (by + (i & 3) < height) ? (by + (i & 3)) : (height - 1);
+        const unsigned char* p = pImage + (static_cast<size_t>(y) * width + x) * channels;
+        for (int c=0; c<4; ++c)
+        {
+            block.c[i][c] = (c < channels) ? p[c] : 255;
+        }
+    }
+}
+
+static inline bool inHalf(int i, bool flip, int half)
+{
+    return (flip ? ((i & 3) >> 1) : (i >> 3)) == half;
+}
+
+/// Best table and indices for one half block around a given base color.
+struct halfFit {
+    int error;
+    int table;
+    int indices[16];
+};
+
+static void fitHalf(const blockPixels& block, bool flip, int half, const int base[3], halfFit& fit)
+{
+    fit.error = 0x7fffffff;
+    for (int t=0; t<8; ++t)
+    {
+        int error = 0;
+        int indices[16];
+        for (int i=0; (i<16) && (error < fit.error); ++i)
+        {
+            if (inHalf(i, flip, half) == false)
+                continue;
+            int bestError = 0x7fffffff;
+            for (int m=0; m<4; ++m)
+            {
+                int e = 0;
+                for (int c=0; c<3; ++c)
+                {
+                    const int d = clampInt(base[c] + s_etc1Modifiers[t][m], 0, 255) - block.c[i][c];
+                    e += d * d;
+                }
+                if (e < bestError)
+                {
+                    bestError = e;
+                    indices[i] = m;
+                }
+            }
+            error += bestError;
+        }
+        if (error < fit.error)
+        {
+            fit.error = error;
+            fit.table = t;
+            memcpy(fit.indices, indices, sizeof(indices));
+        }
+    }
+}
+
+// Quantized base colors near a half's average, at 4 or 5 bits per channel.
+static int candidateColors(const blockPixels& block, bool flip, int half, int bits, int candidates[27][3])
+{
+    int sum[3] = { 0, 0, 0 };
+    for (int i=0; i<16; ++i)
+    {
+        if (inHalf(i, flip, half))
+        {
+            for (int c=0; c<3; ++c)
+                sum[c] += block.c[i][c];
+        }
+    }
+    const int maxValue = (1 << bits) - 1;
+    int center[3];
+    for (int c=0; c<3; ++c)
+    {
+        center[c] = clampInt((sum[c] * maxValue + 8 * 255 / 2) / (8 * 255), 0, maxValue);
+    }
+    int count = 0;
+    for (int dr=-1; dr<=1; ++dr)
+    for (int dg=-1; dg<=1; ++dg)
+    for (int db=-1; db<=1; ++db)
+    {
+        candidates[count][0] = clampInt(center[0] + dr, 0, maxValue);
+        candidates[count][1] = clampInt(center[1] + dg, 0, maxValue);
+        candidates[count][2] = clampInt(center[2] + db, 0, maxValue);
+        ++count;
+    }
+    return count;
+}
+
+static void packEtc1Block(unsigned char* b, bool differential, bool flip,
+    const int q0[3], const int q1[3], const halfFit& f0, const halfFit& f1)
+{
+    for (int c=0; c<3; ++c)
+    {
+        b[c] = differential ?
+            static_cast<unsigned char>((q0[c] << 3) | ((q1[c] - q0[c]) & 7)) :
+            static_cast<unsigned char>((q0[c] << 4) | q1[c]);
+    }
+    b[3] = static_cast<unsigned char>((f0.table << 5) | (f1.table << 2) | (differential ? 2 : 0) | (flip ? 1 : 0));
+
+    // Modifier m is stored as index bits: 0 -> 00, 1 -> 01, 2 -> 10, 3 -> 11
+    // select +small, +large, -small, -large.
+    unsigned int indexBits = 0;
+    for (int i=0; i<16; ++i)
+    {
+        const int m = inHalf(i, flip, 0) ? f0.indices[i] : f1.indices[i];
+        indexBits |= ((m >> 1) << (16 + i)) | ((m & 1) << i);
+    }
+    b[4] = static_cast<unsigned char>(indexBits >> 24);
+    b[5] = static_cast<unsigned char>(indexBits >> 16);
+    b[6] = static_cast<unsigned char>(indexBits >> 8);
+    b[7] = static_cast<unsigned char>(indexBits);
+}
+
+///@brief Encode a block's RGB as 8 bytes of ETC2 (ETC1-compatible modes).
+static void encodeEtc2RgbBlock(const blockPixels& block, unsigned char* pOut)
+{
+    int bestError = 0x7fffffff;
+    for (int flipIndex=0; flipIndex<2; ++flipIndex)
+    {
+        const bool flip = (flipIndex != 0);
+
+        // Individual mode: each half has its own 4-bit color.
+        int q0[3] = { 0, 0, 0 }, q1[3] = { 0, 0, 0 };
+        halfFit f0, f1;
+        f0.error = f1.error = 0x7fffffff;
+        for (int half=0; half<2; ++half)
+        {
+            int candidates[27][3];
+            const int count = candidateColors(block, flip, half, 4, candidates);
+            for (int k=0; k<count; ++k)
+            {
+                const int base[3] = { extend4(candidates[k][0]), extend4(candidates[k][1]), extend4(candidates[k][2]) };
+                halfFit fit;
+                fitHalf(block, flip, half, base, fit);
+                halfFit& best = half ? f1 : f0;
+                if (fit.error < best.error)
+                {
+                    best = fit;
+                    memcpy(half ? q1 : q0, candidates[k], sizeof(q0));
+                }
+            }
+        }
+        if (f0.error + f1.error < bestError)
+        {
+            bestError = f0.error + f1.error;
+            packEtc1Block(pOut, false, flip, q0, q1, f0, f1);
+        }
+
+        // Differential mode: 5-bit colors no more than -4..3 apart.
+        int candidates[2][27][3];
+        halfFit fits[2][27];
+        int counts[2];
+        for (int half=0; half<2; ++half)
+        {
+            counts[half] = candidateColors(block, flip, half, 5, candidates[half]);
+            for (int k=0; k<counts[half]; ++k)
+            {
+                const int* q = candidates[half][k];
+                const int base[3] = { extend5(q[0]), extend5(q[1]), extend5(q[2]) };
+                fitHalf(block, flip, half, base, fits[half][k]);
+            }
+        }
+        for (int k0=0; k0<counts[0]; ++k0)
+        {
+            for (int k1=0; k1<counts[1]; ++k1)
+            {
+                const int* a = candidates[0][k0];
+                const int* b = candidates[1][k1];
+                bool valid = true;
+                for (int c=0; c<3; ++c)
+                {
+                    const int d = b[c] - a[c];
+                    valid = valid && (d >= -4) && (d <= 3);
+                }
+                const int error = fits[0][k0].error + fits[1][k1].error;
+                if (valid && (error < bestError))
+                {
+                    bestError = error;
+                    packEtc1Block(pOut, true, flip, a, b, fits[0][k0], fits[1][k1]);
+                }
+            }
+        }
+    }
+}
+
+///@brief Encode one channel of a block as 8 bytes of EAC: 11-bit values for
+/// R11/RG11 (from 8-bit input), else the 8-bit alpha of RGBA8_ETC2_EAC.
+static void encodeEacBlock(const blockPixels& block, int channel, bool elevenBit, unsigned char* pOut)
+{
+    int target[16];
+    int lo = 0x7fffffff, hi = -1;
+    for (int i=0; i<16; ++i)
+    {
+        const int v = block.c[i][channel];
+        target[i] = elevenBit ? ((v * 2047 + 127) / 255) : v;
+        lo = (target[i] < lo) ? target[i] : lo;
+        hi = (target[i] > hi) ? target[i] : hi;
+    }
+    const int scale = elevenBit ? 8 : 1;
+    const int maxValue = elevenBit ? 2047 : 255;
+
+    int bestError = 0x7fffffff;
+    int bestBase = 0, bestMultiplier = 0, bestTable = 0;
+    int bestIndices[16] = { 0 };
+    for (int t=0; t<16; ++t)
+    {
+        const int* modifiers = s_eacModifiers[t];
+        const int span = modifiers[7] - modifiers[3];
+        const int m0 = (hi - lo + span * scale / 2) / (span * scale);
+        const int center = (lo + hi) / 2;
+        const int midModifier = (modifiers[7] + modifiers[3]) / 2;
+        for (int multiplier=((m0 > 1) ? m0 - 1 : 1); multiplier<=m0+1 && multiplier<=15; ++multiplier)
+        {
+            const int step = multiplier * scale;
+            const int baseEstimate = elevenBit ?
+                ((center - 4 - midModifier * step) / 8) : (center - midModifier * multiplier);
+            for (int base=baseEstimate-2; base<=baseEstimate+2; ++base)
+            {
+                if ((base < 0) || (base > 255))
+                    continue;
+                const int zero = elevenBit ? (base * 8 + 4) : base;
+                int error = 0;
+                int indices[16];
+                for (int i=0; (i<16) && (error < bestError); ++i)
+                {
+                    int best = 0x7fffffff;
+                    for (int m=0; m<8; ++m)
+                    {
+                        const int d = clampInt(zero + modifiers[m] * step, 0, maxValue) - target[i];
+                        if (d * d < best)
+                        {
+                            best = d * d;
+                            indices[i] = m;
+                        }
+                    }
+                    error += best;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestBase = base;
+                    bestMultiplier = multiplier;
+                    bestTable = t;
+                    memcpy(bestIndices, indices, sizeof(indices));
+                }
+            }
+        }
+    }
+
+    pOut[0] = static_cast<unsigned char>(bestBase);
+    pOut[1] = static_cast<unsigned char>((bestMultiplier << 4) | bestTable);
+    unsigned long long bits = 0;
+    for (int i=0; i<16; ++i)
+    {
+        bits |= static_cast<unsigned long long>(bestIndices[i]) << (45 - 3 * i);
+    }
+    for (int k=0; k<6; ++k)
+    {
+        pOut[2 + k] = static_cast<unsigned char>(bits >> (40 - 8 * k));
+    }
+}
+
+struct formatInfo {
+    const char* pName;
+    GLenum internalFormat;
+    GLenum baseFormat;
+    int channels;
+    int blockBytes;
+};
+
+static const formatInfo s_formats[] = {
+    { "r11",  GL_COMPRESSED_R11_EAC,         GL_RED,  1, 8 },
+    { "rg11", GL_COMPRESSED_RG11_EAC,        GL_RG,   2, 16 },
+    { "etc2", GL_COMPRESSED_RGB8_ETC2,       GL_RGB,  3, 8 },
+    { "rgba", GL_COMPRESSED_RGBA8_ETC2_EAC,  GL_RGBA, 4, 16 },
+};
+
+static void encodeImage(const formatInfo& format, const unsigned char* pImage,
+    unsigned int width, unsigned int height, int channels, std::vector<unsigned char>& out)
+{
+    out.clear();
+    blockPixels block;
+    unsigned char bytes[16];
+    for (unsigned int by=0; by<height; by+=4)
+    {
+        for (unsigned int bx=0; bx<width; bx+=4)
+        {
+            gatherBlock(pImage, width, height, channels, bx, by, block);
+            switch (format.channels)
+            {
+            case 1:
+                encodeEacBlock(block, 0, true, bytes);
+                break;
+            case 2:
+                encodeEacBlock(block, 0, true, bytes);
+                encodeEacBlock(block, 1, true, bytes + 8);
+                break;
+            case 3:
+                encodeEtc2RgbBlock(block, bytes);
+                break;
+            default:
+                encodeEacBlock(block, 3, false, bytes);
+                encodeEtc2RgbBlock(block, bytes + 8);
+                break;
+            }
+            out.insert(out.end(), bytes, bytes + format.blockBytes);
+        }
+    }
+}
+
+// Peak signal to noise ratio of the decoded blocks against the input.
+static double psnr(const formatInfo& format, const std::vector<unsigned char>& blocks,
+    const unsigned char* pImage, unsigned int width, unsigned int height, int channels)
+{
+    std::vector<unsigned char> decoded(static_cast<size_t>(width) * height * format.channels);
+    DecodeEtcImage(format.internalFormat, &blocks[0], width, height, &decoded[0], width * format.channels);
+    double sum = 0.;
+    for (size_t p=0; p<static_cast<size_t>(width) * height; ++p)
+    {
+        for (int c=0; c<format.channels; ++c)
+        {
+            const double d = static_cast<double>(decoded[p * format.channels + c]) - pImage[p * channels + c];
+            sum += d * d;
+        }
+    }
+    const double mse = sum / (static_cast<double>(width) * height * format.channels);
+    return (mse > 0.) ? 10. * log10(255. * 255. / mse) : 99.;
+}
+
+static void putU32(std::vector<unsigned char>& out, unsigned int v)
+{
+    const unsigned char b[4] = {
+        static_cast<unsigned char>(v), static_cast<unsigned char>(v >> 8),
+        static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 24) };
+    out.insert(out.end(), b, b + 4);
+}
+
+static int usage(const char* pProgram)
+{
+    printf("Usage: %s [-format etc2|rgba|r11|rg11] [-swizzle rgba] [-mips] width height channels input output.ktx\n", pProgram);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    const char* pFormat = NULL;
+    const char* pSwizzle = NULL;
+    bool mips = false;
+    int arg = 1;
+    for (; (arg < argc) && (argv[arg][0] == '-'); ++arg)
+    {
+        if ((strcmp(argv[arg], "-format") == 0) && (arg + 1 < argc))
+        {
+            pFormat = argv[++arg];
+        }
+        else if ((strcmp(argv[arg], "-swizzle") == 0) && (arg + 1 < argc) && (strlen(argv[arg+1]) == 4))
+        {
+            pSwizzle = argv[++arg];
+        }
+        else if (strcmp(argv[arg], "-mips") == 0)
+        {
+            mips = true;
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+    if (argc - arg != 5)
+        return usage(argv[0]);
+
+    const int width = atoi(argv[arg]);
+    const int height = atoi(argv[arg+1]);
+    const int channels = atoi(argv[arg+2]);
+    const char* pInput = argv[arg+3];
+    const char* pOutput = argv[arg+4];
+    if ((width <= 0) || (height <= 0) || (channels < 1) || (channels > 4))
+        return usage(argv[0]);
+
+    const formatInfo* pInfo = NULL;
+    for (size_t f=0; f<sizeof(s_formats)/sizeof(s_formats[0]); ++f)
+    {
+        if ((pFormat != NULL) ? (strcmp(pFormat, s_formats[f].pName) == 0) : (s_formats[f].channels == channels))
+            pInfo = &s_formats[f];
+    }
+    if (pInfo == NULL)
+        return usage(argv[0]);
+    if (pInfo->channels > channels)
+    {
+        printf("%s needs %d channels, the input has %d\n", pInfo->pName, pInfo->channels, channels);
+        return 1;
+    }
+
+    // Read the whole file: level 0, or a .mip file holding every level.
+    std::vector<unsigned char> input;
+    FILE* pIn = fopen(pInput, "rb");
+    if (pIn == NULL)
+    {
+        printf("Could not open %s\n", pInput);
+        return 1;
+    }
+    unsigned char buffer[65536];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), pIn)) > 0)
+    {
+        input.insert(input.end(), buffer, buffer + got);
+    }
+    fclose(pIn);
+
+    const size_t levelSize = static_cast<size_t>(width) * height * channels;
+    std::vector<unsigned char> chain;
+    const unsigned char* pChain = NULL;
+    unsigned int levels = 1;
+    const MipChainHeader* pHeader = input.empty() ? NULL : ParseMipChain(&input[0], input.size());
+    if (pHeader != NULL)
+    {
+        if ((pHeader->width != static_cast<unsigned int>(width)) ||
+            (pHeader->height != static_cast<unsigned int>(height)) ||
+            (pHeader->channels != static_cast<unsigned int>(channels)))
+        {
+            printf("%s is %ux%ux%u, not %dx%dx%d\n", pInput,
+                pHeader->width, pHeader->height, pHeader->channels, width, height, channels);
+            return 1;
+        }
+        pChain = &input[0] + sizeof(MipChainHeader);
+        levels = pHeader->levels;
+    }
+    else if (input.size() < levelSize)
+    {
+        printf("%s is shorter than %dx%dx%d bytes\n", pInput, width, height, channels);
+        return 1;
+    }
+    else if (mips)
+    {
+        chain.resize(MipChainSize(width, height, channels));
+        memcpy(&chain[0], &input[0], levelSize);
+        BuildMipChain(&chain[0], width, height, channels, channels >= 3, 4);
+        pChain = &chain[0];
+        levels = MipLevelCount(width, height);
+    }
+    else
+    {
+        pChain = &input[0];
+    }
+
+    // KTX 1.1 header, then the optional swizzle as key/value data.
+    std::vector<unsigned char> out;
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    out.insert(out.end(), identifier, identifier + sizeof(identifier));
+    std::vector<unsigned char> keyValues;
+    if (pSwizzle != NULL)
+    {
+        static const char key[] = "KTXswizzle";
+        putU32(keyValues, sizeof(key) + 5);
+        keyValues.insert(keyValues.end(), key, key + sizeof(key));
+        keyValues.insert(keyValues.end(), pSwizzle, pSwizzle + 4);
+        keyValues.push_back(0);
+        while (keyValues.size() & 3)
+            keyValues.push_back(0);
+    }
+    const unsigned int header[13] = {
+        0x04030201, 0, 1, 0, pInfo->internalFormat, pInfo->baseFormat,
+        static_cast<unsigned int>(width), static_cast<unsigned int>(height), 0, 0, 1, levels,
+        static_cast<unsigned int>(keyValues.size()) };
+    for (int i=0; i<13; ++i)
+        putU32(out, header[i]);
+    out.insert(out.end(), keyValues.begin(), keyValues.end());
+
+    Timer t;
+    double levelZeroPsnr = 0.;
+    size_t rawBytes = 0;
+    std::vector<unsigned char> blocks;
+    for (unsigned int level=0; level<levels; ++level)
+    {
+        unsigned int w, h;
+        MipLevelDimensions(width, height, level, w, h);
+        const unsigned char* pLevel = pChain + MipLevelOffset(width, height, channels, level);
+        encodeImage(*pInfo, pLevel, w, h, channels, blocks);
+        if (level == 0)
+            levelZeroPsnr = psnr(*pInfo, blocks, pLevel, w, h, channels);
+        putU32(out, static_cast<unsigned int>(blocks.size()));
+        out.insert(out.end(), blocks.begin(), blocks.end());
+        rawBytes += static_cast<size_t>(w) * h * pInfo->channels;
+    }
+    const double sec = t.seconds();
+
+    FILE* pOut = fopen(pOutput, "wb");
+    if ((pOut == NULL) || (fwrite(&out[0], 1, out.size(), pOut) != out.size()))
+    {
+        if (pOut != NULL)
+            fclose(pOut);
+        printf("Could not write %s\n", pOutput);
+        return 1;
+    }
+    fclose(pOut);
+
+    printf("%s: %dx%d %s, %u levels, %u bytes (raw %u), PSNR %.2f dB, %.0f ms\n",
+        pOutput, width, height, pInfo->pName, levels,
+        static_cast<unsigned int>(out.size()), static_cast<unsigned int>(rawBytes),
+        levelZeroPsnr, 1000. * sec);
+    return 0;
+}
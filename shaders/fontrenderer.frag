@@ -8,9 +8,9 @@ precision mediump float;
 #endif
 
 in vec2 v_texCoord;
+in vec3 v_color;
 out vec4 fragColor;
 
-uniform vec3 u_fontColor;
 uniform sampler2D s_texture;
 
 void main()
@@ -31,5 +31,5 @@ void main()
     //lum = sqrt(sin(lum*1.57079632679));
 
 
-    fragColor = vec4(u_fontColor, lum);
+    fragColor = vec4(v_color, lum);
 }
@@ -5,8 +5,10 @@
 
 in vec3 a_position;
 in vec2 a_texCoord;
+in vec3 a_color;
 
 out vec2 v_texCoord;
+out vec3 v_color;
 
 uniform mat4 mvmtx;
 uniform mat4 prmtx;
@@ -15,4 +17,5 @@ void main()
 {
     gl_Position = prmtx * mvmtx * vec4(a_position, 1.0);
     v_texCoord = a_texCoord;
+    v_color = a_color;
 }
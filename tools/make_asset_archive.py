@@ -0,0 +1,167 @@
+# make_asset_archive.py
+#
+# Packs the files under deploy/ into one archive that AssetArchive (see
+# app/src/main/jni/Util/AssetArchive.h) maps at startup, so fonts, textures,
+# data files, Lua sources and shaders come out of one open file instead of
+# one each. Directories outside the root are packed under a prefix of their
+# own, given as prefix=dir. Run from the repository root, or through the
+# AssetArchive CMake target:
+#
+#     python tools/make_asset_archive.py deploy/assets.pak deploy shaders=shaders
+#
+# Layout, all integers little-endian uint32:
+#   header   "FCPK", version, entry count, 0
+#   index    per entry: name offset, name length, data offset,
+#            stored size, size, flags - sorted by name
+#   names    NUL-terminated paths relative to the root, '/' separated
+#   payloads each starting on a 16-byte boundary
+# Flag 1 marks a payload stored as one raw LZ4 block. Entries are compressed
+# only where that saves at least an eighth; the rest are stored as they are
+# and served without a copy.
+
+from __future__ import print_function
+import os
+import struct
+import sys
+
+magic = b"FCPK"
+version = 1
+headerSize = 16
+indexEntrySize = 24
+payloadAlign = 16
+flagLZ4 = 1
+
+# Build products and things nothing loads through the archive.
+excludedDirs = ["shadercache"]
+excludedSuffixes = [".pak", ".luab", ".dll"]
+
+def writeLength(out, n):
+	while n >= 255:
+		out.append(255)
+		n -= 255
+	out.append(n)
+
+def emitSequence(out, src, litStart, litEnd, offset, matchLength):
+	litLength = litEnd - litStart
+	token = min(litLength, 15) << 4
+	if matchLength:
+		token |= min(matchLength - 4, 15)
+	out.append(token)
+	if litLength >= 15:
+		writeLength(out, litLength - 15)
+	out += src[litStart:litEnd]
+	if matchLength:
+		out.append(offset & 255)
+		out.append(offset >> 8)
+		if matchLength - 4 >= 15:
+			writeLength(out, matchLength - 4 - 15)
+
+def compressLZ4(src):
+	"""
+	Greedy LZ4 block compressor: one hash lookup per position, no lazy
+	matching. Slower to build and a little larger than liblz4's output,
+	but the blocks decode the same.
+	"""
+	n = len(src)
+	out = bytearray()
+	table = {}
+	anchor = 0
+	i = 0
+	# The format wants the last match to start 12 bytes before the end
+	# and the last 5 bytes to be literals.
+	matchLimit = n - 12
+	while i < matchLimit:
+		key = bytes(src[i:i+4])
+		candidate = table.get(key)
+		table[key] = i
+		if candidate is None or i - candidate > 65535:
+			i += 1
+			continue
+		length = 4
+		maxLength = n - 5 - i
+		while length < maxLength and src[candidate + length] == src[i + length]:
+			length += 1
+		emitSequence(out, src, anchor, i, i - candidate, length)
+		i += length
+		anchor = i
+	emitSequence(out, src, anchor, n, 0, 0)
+	return out
+
+def collectFiles(root, prefix):
+	"""
+	Returns (name in the archive, path on disk) for each file under root.
+	"""
+	files = []
+	for dirpath, dirs, filenames in os.walk(root):
+		dirs[:] = [d for d in dirs if d not in excludedDirs]
+		for f in filenames:
+			if any(f.endswith(s) for s in excludedSuffixes):
+				continue
+			full = os.path.join(dirpath, f)
+			files.append((prefix + os.path.relpath(full, root).replace("\\", "/"), full))
+	return files
+
+def align(n):
+	return (n + payloadAlign - 1) & ~(payloadAlign - 1)
+
+def writeArchive(outFile, root, prefixedRoots, compress):
+	files = collectFiles(root, "")
+	for prefix, prefixedRoot in prefixedRoots:
+		files += collectFiles(prefixedRoot, prefix + "/")
+	files.sort()
+	names = [f[0] for f in files]
+	encodedNames = [n.encode("utf-8") for n in names]
+
+	entries = []
+	for name, full in files:
+		with open(full, "rb") as inStream:
+			data = bytearray(inStream.read())
+		flags = 0
+		stored = data
+		if compress and len(data) >= 64:
+			packed = compressLZ4(data)
+			if len(packed) <= len(data) - len(data) // 8:
+				stored = packed
+				flags = flagLZ4
+		entries.append((stored, len(data), flags))
+
+	nameOffset = headerSize + len(names) * indexEntrySize
+	nameOffsets = []
+	for en in encodedNames:
+		nameOffsets.append(nameOffset)
+		nameOffset += len(en) + 1
+
+	dataOffset = align(nameOffset)
+	dataOffsets = []
+	for stored, size, flags in entries:
+		dataOffsets.append(dataOffset)
+		dataOffset = align(dataOffset + len(stored))
+
+	out = bytearray()
+	out += magic
+	out += struct.pack("<III", version, len(names), 0)
+	for i in range(len(names)):
+		stored, size, flags = entries[i]
+		out += struct.pack("<IIIIII", nameOffsets[i], len(encodedNames[i]),
+			dataOffsets[i], len(stored), size, flags)
+	for en in encodedNames:
+		out += en + b"\0"
+	for i in range(len(names)):
+		out += b"\0" * (dataOffsets[i] - len(out))
+		out += entries[i][0]
+
+	with open(outFile, "wb") as outStream:
+		outStream.write(out)
+
+	packedCount = sum(1 for e in entries if e[2] & flagLZ4)
+	total = sum(e[1] for e in entries)
+	print("make_asset_archive.py:", len(names), "files,", packedCount, "compressed,",
+		total, "bytes in,", len(out), "bytes written to", outFile)
+
+if __name__ == "__main__":
+	args = [a for a in sys.argv[1:] if a != "--no-compress"]
+	if len(args) < 2 or any("=" not in a for a in args[2:]):
+		print("Usage: make_asset_archive.py [--no-compress] <archive> <root dir> [<prefix>=<dir> ...]")
+		sys.exit(1)
+	prefixedRoots = [tuple(a.split("=", 1)) for a in args[2:]]
+	writeArchive(args[0], args[1], prefixedRoots, "--no-compress" not in sys.argv)
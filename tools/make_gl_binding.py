@@ -0,0 +1,242 @@
+# make_gl_binding.py
+#
+# Generates deploy/lua/opengl.lua and deploy/lua/opengles3.lua from the
+# Khronos headers in tools/glheaders/. Each binding declares only the
+# gl.* entry points and GL.* constants that scripts under deploy/lua use,
+# with constants as plain Lua numbers, so loading it is no more than a
+# short ffi.cdef. Rerun from the repository root after using a new name:
+#
+#     python tools/make_gl_binding.py
+
+from __future__ import print_function
+import os
+import re
+
+luaDir = "deploy/lua/"
+headerDir = "tools/glheaders/"
+outputs = ["opengl.lua", "opengles3.lua"]
+
+def findUsedNames():
+	"""
+	Collect every gl.glName and GL.GL_NAME referenced by the Lua scripts.
+	"""
+	functions = set()
+	constants = set()
+	for root, dirs, files in os.walk(luaDir):
+		for f in files:
+			if not f.endswith(".lua"):
+				continue
+			path = os.path.join(root, f).replace("\\", "/")
+			if path in [luaDir + o for o in outputs]:
+				continue
+			with open(path) as inStream:
+				text = inStream.read()
+			functions.update(re.findall(r"\bgl\.(gl[A-Z]\w*)", text))
+			constants.update(re.findall(r"\bGL\.(GL_\w+)", text))
+	return sorted(functions), sorted(constants)
+
+def readHeader(name):
+	with open(headerDir + name) as inStream:
+		return inStream.read()
+
+def parseConstants(header):
+	"""
+	Map GL_ names to Lua literals: u suffixes dropped, ull kept as LuaJIT's
+	own 64 bit literal since the value does not fit a double.
+	"""
+	values = {}
+	for name, value in re.findall(r"^#define\s+(GL_\w+)\s+(\S+)", header, re.M):
+		if value.lower().endswith("ull"):
+			value = value[:-3] + "ULL"
+		elif value.lower().endswith("u"):
+			value = value[:-1]
+		values[name] = value
+	return values
+
+def baseTypedefs(header):
+	lines = [l for l in header.splitlines() if l.startswith("typedef") and "PFNGL" not in l]
+	return lines
+
+def luaStringList(names, indent):
+	return "".join('%s"%s",\n' % (indent, n) for n in names)
+
+def luaConstantTable(used, values, missing):
+	out = ""
+	for name in used:
+		if name in values:
+			out += "\t%s = %s,\n" % (name, values[name])
+		else:
+			missing.append(name)
+	return out
+
+fileHeader = """-- %s
+-- GENERATED FILE - DO NOT EDIT! Created by tools/make_gl_binding.py from
+-- tools/glheaders/%s, with only the names used under deploy/lua.
+-- Rerun the script after using a new gl.* function or GL.* constant;
+-- until then, reading one raises an error naming it.
+"""
+
+checkedTables = """
+-- Only reached on a miss, so the linear search costs nothing in use.
+local function unknown_name(kind, known)
+	return function(_, name)
+		for _,k in ipairs(known or {}) do
+			if k == name then
+				error(kind .. name .. " was not loaded from this GL context", 2)
+			end
+		end
+		error(kind .. tostring(name) .. " is not in the generated GL binding; rerun tools/make_gl_binding.py", 2)
+	end
+end
+"""
+
+importFunction = """
+	import = function(self)
+		rawset(_G, "GL", self.GL)
+		rawset(_G, "gl", self.gl)
+	end,
+"""
+
+def writeDesktop(functions, constants):
+	header = readHeader("glcorearb.h")
+	values = parseConstants(header)
+	pfn = {}
+	for line in header.splitlines():
+		m = re.match(r"typedef .*\(APIENTRYP (PFN(GL\w+)PROC)\)", line)
+		if m:
+			pfn[m.group(2)] = line
+
+	missing = []
+	present = []
+	cdef = ["struct _cl_context;", "struct _cl_event;"] + baseTypedefs(header)
+	for f in functions:
+		key = f.upper()
+		if key in pfn:
+			cdef.append(pfn[key])
+			present.append(f)
+		else:
+			missing.append(f)
+
+	out = fileHeader % (outputs[0], "glcorearb.h")
+	out += """
+local ffi = require("ffi")
+
+-- APIENTRY is __stdcall on Windows; this is a few kB, not the whole header.
+local decls = [[
+%s
+]]
+if ffi.os == "Windows" then
+	decls = decls:gsub("APIENTRYP", "__stdcall *"):gsub("APIENTRY", "__stdcall")
+else
+	decls = decls:gsub("APIENTRYP", "*"):gsub("APIENTRY", "")
+end
+ffi.cdef(decls)
+
+local functions = {
+%s}
+
+local GL = {
+%s}
+%s
+local openGL = {
+	GL = GL,
+	gl = {},
+	loader = nil,
+%s
+	-- Resolve every entry point in one pass through the loader handed to
+	-- on_lua_initgl. Names the context lacks are left out of gl.
+	load = function(self, loader)
+		self.loader = loader
+		for _,name in ipairs(functions) do
+			local p = loader(name)
+			if p ~= nil then
+				rawset(self.gl, name, ffi.cast("PFN" .. name:upper() .. "PROC", p))
+			end
+		end
+	end,
+}
+
+setmetatable(GL, { __index = unknown_name("GL.") })
+setmetatable(openGL.gl, { __index = unknown_name("gl.", functions) })
+
+return openGL
+""" % ("\n".join(cdef), luaStringList(present, "\t"),
+		luaConstantTable(constants, values, missing), checkedTables, importFunction)
+
+	with open(luaDir + outputs[0], "w") as outStream:
+		outStream.write(out)
+	return present, missing
+
+def writeGles(functions, constants):
+	header = readHeader("gl31.h")
+	values = parseConstants(header)
+	protos = {}
+	for line in header.splitlines():
+		m = re.match(r"GL_APICALL\s+(.*?)\s*GL_APIENTRY\s+(gl\w+)\s*(\(.*\);)", line)
+		if m:
+			protos[m.group(2)] = "%s %s %s" % (m.group(1), m.group(2), m.group(3))
+
+	missing = []
+	present = []
+	cdef = [l for l in baseTypedefs(header)]
+	for f in functions:
+		if f in protos:
+			cdef.append(protos[f])
+			present.append(f)
+		else:
+			missing.append(f)
+
+	out = fileHeader % (outputs[1], "gl31.h")
+	out += """
+local ffi = require("ffi")
+
+ffi.cdef[[
+%s
+]]
+
+local functions = {
+%s}
+
+local GL = {
+%s}
+%s
+local openGL = {
+	GL = GL,
+	gl = {},
+	loader = nil,
+%s
+	-- Look every entry point up in libGLESv3 once, up front.
+	load = function(self)
+		local lib = ffi.load("GLESv3")
+		for _,name in ipairs(functions) do
+			local ok, func = pcall(function() return lib[name] end)
+			if ok then
+				rawset(self.gl, name, func)
+			end
+		end
+	end,
+}
+
+setmetatable(GL, { __index = unknown_name("GL.") })
+setmetatable(openGL.gl, { __index = unknown_name("gl.", functions) })
+
+openGL:load()
+return openGL
+""" % ("\n".join(cdef), luaStringList(present, "\t"),
+		luaConstantTable(constants, values, missing), checkedTables, importFunction)
+
+	with open(luaDir + outputs[1], "w") as outStream:
+		outStream.write(out)
+	return present, missing
+
+def main():
+	functions, constants = findUsedNames()
+	print("make_gl_binding.py:", len(functions), "functions and", len(constants), "constants in use")
+	for writer, name in ((writeDesktop, outputs[0]), (writeGles, outputs[1])):
+		present, missing = writer(functions, constants)
+		print("    wrote", luaDir + name + ":", len(present), "functions")
+		for m in missing:
+			print("        not in its header:", m)
+
+if __name__ == "__main__":
+	main()
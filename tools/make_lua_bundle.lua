@@ -0,0 +1,91 @@
+-- make_lua_bundle.lua
+-- Compiles Lua sources to LuaJIT bytecode and packs them into one indexed
+-- bundle that LuaBundle.cpp serves to require() ahead of the source files.
+--
+-- Usage: luajit make_lua_bundle.lua [-s] <out.luab> <root dir> <file.lua> ...
+--   -s strips debug info (smaller, but errors lose their line numbers)
+-- Module names are paths relative to root: <root>/util/glfont.lua is util.glfont.
+--
+-- Bytecode only loads into the same LuaJIT version, and on 2.1 only into a
+-- build with the same GC64 setting, as the luajit that ran this script.
+--
+-- Layout, all integers little-endian uint32:
+--   "FCLB" version count
+--   count x { nameOffset nameLength dataOffset dataLength }, sorted by name
+--   names, each followed by a NUL
+--   bytecode
+
+local version = 1
+
+local function u32(n)
+    return string.char(n % 256, math.floor(n / 256) % 256,
+        math.floor(n / 65536) % 256, math.floor(n / 16777216) % 256)
+end
+
+local args = {...}
+local strip = false
+if args[1] == "-s" then
+    strip = true
+    table.remove(args, 1)
+end
+local outname, root = args[1], args[2]
+if not outname or not root or #args < 3 then
+    io.stderr:write("Usage: luajit make_lua_bundle.lua [-s] <out.luab> <root dir> <file.lua> ...\n")
+    os.exit(1)
+end
+root = root:gsub("\\", "/"):gsub("/$", "")
+
+local modules = {}
+local failed = 0
+for i = 3, #args do
+    local path = args[i]:gsub("\\", "/")
+    local rel = path
+    if path:sub(1, #root + 1) == root.."/" then
+        rel = path:sub(#root + 2)
+    end
+    local name = rel:gsub("%.lua$", ""):gsub("/", ".")
+
+    local f = io.open(path, "rb")
+    local src = f and f:read("*a")
+    if f then f:close() end
+    -- Chunk names match what the source searcher would give, relative to
+    -- deploy/, so tracebacks read the same either way.
+    local chunk, err = nil, "could not read file"
+    if src then
+        chunk, err = loadstring(src, "@lua/"..rel)
+    end
+    if chunk then
+        table.insert(modules, { name = name, code = string.dump(chunk, strip) })
+    else
+        -- Leave it out; require will find the source instead and report
+        -- the error where it can be seen.
+        io.stderr:write("make_lua_bundle: skipping "..path..": "..tostring(err).."\n")
+        failed = failed + 1
+    end
+end
+table.sort(modules, function(a, b) return a.name < b.name end)
+
+local headerSize = 12 + 16 * #modules
+local namesSize = 0
+for _,m in ipairs(modules) do
+    namesSize = namesSize + #m.name + 1
+end
+
+local index, names, blobs = {}, {}, {}
+local nameOffset = headerSize
+local dataOffset = headerSize + namesSize
+for _,m in ipairs(modules) do
+    table.insert(index, u32(nameOffset)..u32(#m.name)..u32(dataOffset)..u32(#m.code))
+    table.insert(names, m.name.."\0")
+    table.insert(blobs, m.code)
+    nameOffset = nameOffset + #m.name + 1
+    dataOffset = dataOffset + #m.code
+end
+
+local out = assert(io.open(outname, "wb"))
+out:write("FCLB", u32(version), u32(#modules))
+out:write(table.concat(index), table.concat(names), table.concat(blobs))
+out:close()
+
+print(string.format("make_lua_bundle: %d modules, %d bytes to %s%s",
+    #modules, dataOffset, outname, failed > 0 and (", "..failed.." skipped") or ""))